@@ -17,6 +17,31 @@
 
 static int _precalculated = 0;
 
+// Values and derivatives of the Lobatto shape functions in the Gauss points of each
+// quadrature order on the reference element, stored function by function (the tables
+// lobatto_*_ref_tab are stored point by point). Built on the first use of the order.
+static double *shape_val_tab[MAX_QUAD_ORDER];
+static double *shape_der_tab[MAX_QUAD_ORDER];
+
+static void get_ref_shape_tables(int order, double *&val, double *&der)
+{
+  if (shape_val_tab[order] == NULL) {
+    int pts_num = g_quad_1d_std.get_num_points(order);
+    double *v = new double[(MAX_P + 1) * pts_num];
+    double *d = new double[(MAX_P + 1) * pts_num];
+    for (int k = 0; k <= MAX_P; k++) {
+      for (int i = 0; i < pts_num; i++) {
+        v[k*pts_num + i] = lobatto_val_ref_tab[order][i][k];
+        d[k*pts_num + i] = lobatto_der_ref_tab[order][i][k];
+      }
+    }
+    shape_val_tab[order] = v;
+    shape_der_tab[order] = d;
+  }
+  val = shape_val_tab[order];
+  der = shape_der_tab[order];
+}
+
 DiscreteProblem::DiscreteProblem(WeakForm* wf, Space* space, bool is_linear) : wf(wf), 
 space(space), is_linear(is_linear)
 {
@@ -52,10 +77,9 @@ void DiscreteProblem::process_vol_forms(SparseMatrix *mat, Vector *rhs, bool rhs
     int    pts_num;                                     // num of quad points
     double phys_pts[MAX_QUAD_PTS_NUM];                  // quad points
     double phys_weights[MAX_QUAD_PTS_NUM];              // quad weights
-    double phys_u[MAX_QUAD_PTS_NUM];                    // basis function 
-    double phys_dudx[MAX_QUAD_PTS_NUM];                 // basis function x-derivative
-    double phys_v[MAX_QUAD_PTS_NUM];                    // test function
-    double phys_dvdx[MAX_QUAD_PTS_NUM];                 // test function x-derivative
+    double *phys_u, *phys_dudx;                         // basis function and its x-derivative
+    double *phys_v, *phys_dvdx;                         // test function and its x-derivative
+    double phys_shape_der[MAX_P + 1][MAX_QUAD_PTS_NUM]; // x-derivatives of all shape functions
     if (n_eq > MAX_EQN_NUM) error("number of equations exceeded in process_vol_forms().");
     // all previous solutions (all components)
     double phys_u_prev[MAX_SLN_NUM][MAX_EQN_NUM][MAX_QUAD_PTS_NUM];     
@@ -70,6 +94,15 @@ void DiscreteProblem::process_vol_forms(SparseMatrix *mat, Vector *rhs, bool rhs
     create_phys_element_quadrature(e->x1, e->x2,  
                                order, phys_pts, phys_weights, &pts_num); 
 
+    // transform the shape functions to element 'e' once, the values are 
+    // taken from the reference element, the derivatives are scaled
+    double *ref_val, *ref_der;
+    get_ref_shape_tables(order, ref_val, ref_der);
+    double jac = (e->x2 - e->x1)/2.;
+    for (int k = 0; k <= e->p; k++)
+      for (int i = 0; i < pts_num; i++)
+        phys_shape_der[k][i] = ref_der[k*pts_num + i] / jac;
+
     // evaluate previous solution and its derivative 
     // at all quadrature points in the element, 
     // for every solution component
@@ -91,18 +124,18 @@ void DiscreteProblem::process_vol_forms(SparseMatrix *mat, Vector *rhs, bool rhs
 	        int pos_i = e->dof[c_i][i]; // row in matrix
           //printf("elem (%g, %g): pos_i = %d\n", e->x1, e->x2, pos_i);
 	        if(pos_i != -1) {
-	          // transform i-th test function to element 'm'
-            //printf("Elem (%g, %g): i = %d, order = %d\n", e->x1, e->x2, i, order);
-	          element_shapefn(e->x1, e->x2, i, order, phys_v, phys_dvdx); 
+	          // i-th test function on element 'm'
+	          phys_v = ref_val + i*pts_num;
+	          phys_dvdx = phys_shape_der[i];
 	          // if we are constructing the matrix
             // loop over basis functions (columns)
             for(int j=0; j < e->p + 1; j++) {
 	            int pos_j = e->dof[c_j][j]; // matrix column
               //printf("elem (%g, %g): pos_j = %d\n", e->x1, e->x2, pos_j);
 	            // if j-th basis function is active
-	              // transform j-th basis function to element 'm'
-              element_shapefn(e->x1, e->x2,  
-		          j, order, phys_u, phys_dudx); 
+	              // j-th basis function on element 'm'
+              phys_u = ref_val + j*pts_num;
+              phys_dudx = phys_shape_der[j];
               // evaluate the bilinear form
               double val_ij = mfv->fn(pts_num, phys_pts,
 	            phys_weights, phys_u, phys_dudx, phys_v, phys_dvdx,
@@ -138,9 +171,9 @@ void DiscreteProblem::process_vol_forms(SparseMatrix *mat, Vector *rhs, bool rhs
         // if i-th test function is active
         int pos_i = e->dof[c_i][i]; // row in residual vector
         if(pos_i != -1) {
-          // transform i-th test function to element 'm'
-          element_shapefn(e->x1, e->x2,  
-		      i, order, phys_v, phys_dvdx); 
+          // i-th test function on element 'm'
+          phys_v = ref_val + i*pts_num;
+          phys_dvdx = phys_shape_der[i];
           // contribute to residual vector
           double val_i = vfv->fn(pts_num, phys_pts, phys_weights, 
 			       phys_u_prev, phys_du_prevdx, phys_v,
@@ -285,9 +318,18 @@ void DiscreteProblem::assemble(scalar *coeff_vec, SparseMatrix *mat, Vector *rhs
   {
     mat->free();
     mat->prealloc(ndof);
-    for(int i = 0; i < ndof; i++)
-      for(int j = 0; j< ndof; j++)
-        mat->pre_add_ij(i, j);
+    // only the basis functions of the same element are coupled
+    Iterator *I = new Iterator(space);
+    Element *e;
+    while ((e = I->next_active_element()) != NULL) {
+      for(int c_i = 0; c_i < n_eq; c_i++)
+        for(int i = 0; i <= e->p; i++)
+          if (e->dof[c_i][i] >= 0)
+            for(int c_j = 0; c_j < n_eq; c_j++)
+              for(int j = 0; j <= e->p; j++)
+                if (e->dof[c_j][j] >= 0) mat->pre_add_ij(e->dof[c_i][i], e->dof[c_j][j]);
+    }
+    delete I;
     mat->alloc();
     // Zero the matrix, which should be done by the appropriate implementation anyway.
     mat->zero();
@@ -600,26 +600,31 @@ void Space::set_bc_right_dirichlet(int eqn, double val)
 int Space::assign_dofs()
 {
   Iterator *I = new Iterator(this);
-  // (1) enumerate vertex dofs
+  // enumerate dofs element by element (all components together), so that 
+  // the dofs of each element are close to each other and the matrix is banded 
+  // with the bandwidth about n_eq*(p+1)
   int count_dof = 0;
-  // loop over solution components
-  for(int c=0; c<this->n_eq; c++) {    
-    Element *e;
-    I->reset();
-    while ((e = I->next_active_element()) != NULL) {
-      if (e->dof[c][0] != -1) e->dof[c][0] = count_dof++; 
-      if (e->dof[c][1] != -1) e->dof[c][1] = count_dof; 
-      else count_dof--;
+  Element *e, *e_prev = NULL;
+  while ((e = I->next_active_element()) != NULL) {
+    // (1) left vertex dofs, shared with the previous element
+    for(int c=0; c<this->n_eq; c++) {
+      if (e->dof[c][0] != -1) {
+        if (e_prev != NULL && e_prev->dof[c][1] != -1) e->dof[c][0] = e_prev->dof[c][1];
+        else e->dof[c][0] = count_dof++;
+      }
     }
-    count_dof++;
-    // (2) enumerate bubble dofs
-    I->reset();
-    while ((e = I->next_active_element()) != NULL) {
+    // (2) bubble dofs
+    for(int c=0; c<this->n_eq; c++) {
       for(int j=2; j <= e->p; j++) {
         e->dof[c][j] = count_dof;
         count_dof++;
       }
     }
+    // (3) right vertex dofs
+    for(int c=0; c<this->n_eq; c++) {
+      if (e->dof[c][1] != -1) e->dof[c][1] = count_dof++; 
+    }
+    e_prev = e;
   }
   this->n_dof = count_dof;
 
@@ -0,0 +1,195 @@
+#define HERMES_REPORT_WARN
+#define HERMES_REPORT_INFO
+#define HERMES_REPORT_VERBOSE
+#define HERMES_REPORT_FILE "application.log"
+#include "hermes1d.h"
+
+// This test makes sure that the band solver (SOLVER_BANDED) solves the problem
+// -u'' = sin(x) in (0, 2*pi), u(0) = u(2*pi) = 1, whose exact solution is
+// u(x) = sin(x) + 1, and a small band system with zeros on the diagonal, which
+// can only be solved with row pivoting, also transposed (Solver::solve_transposed()).
+
+#define ERROR_SUCCESS                               0
+#define ERROR_FAILURE                               -1
+
+const int NEQ = 1;                      // Number of equations.
+const int NELEM = 10;                   // Number of elements.
+const double A = 0, B = 2*M_PI;         // Domain end points.
+const int P_INIT = 6;                   // Polynomial degree.
+const int NORM = 1;                     // To measure errors.
+                                        // 1... H1 norm.
+                                        // 0... L2 norm.
+const double TOL = 1e-6;                // Tolerance for the relative error.
+
+MatrixSolverType matrix_solver = SOLVER_BANDED;
+
+// Boundary conditions.
+Tuple<BCSpec *> DIR_BC_LEFT =  Tuple<BCSpec *>(new BCSpec(0,1));
+Tuple<BCSpec *> DIR_BC_RIGHT = Tuple<BCSpec *>(new BCSpec(0,1));
+
+// Function f(x).
+double f(double x)
+{
+  return sin(x);
+}
+
+// Exact solution.
+void exact_sol(double x, double u[MAX_EQN_NUM], double dudx[MAX_EQN_NUM])
+{
+  u[0] = sin(x) + 1;
+  dudx[0] = cos(x);
+}
+
+// Weak forms for Jacobi matrix and residual.
+double jacobian(int num, double *x, double *weights,
+                double *u, double *dudx, double *v, double *dvdx,
+                double u_prev[MAX_SLN_NUM][MAX_EQN_NUM][MAX_QUAD_PTS_NUM],
+                double du_prevdx[MAX_SLN_NUM][MAX_EQN_NUM][MAX_QUAD_PTS_NUM],
+                void *user_data)
+{
+  double val = 0;
+  for(int i = 0; i<num; i++) {
+    val += dudx[i]*dvdx[i]*weights[i];
+  }
+  return val;
+};
+
+double residual(int num, double *x, double *weights,
+                double u_prev[MAX_SLN_NUM][MAX_EQN_NUM][MAX_QUAD_PTS_NUM],
+                double du_prevdx[MAX_SLN_NUM][MAX_EQN_NUM][MAX_QUAD_PTS_NUM],
+                double *v, double *dvdx, void *user_data)
+{
+  double val = 0;
+  for(int i = 0; i<num; i++) {
+    val += (du_prevdx[0][0][i]*dvdx[i] - f(x[i])*v[i])*weights[i];
+  }
+  return val;
+};
+
+// Solves the finite element problem, returns the relative error in the H1 norm.
+double solve_fe_problem()
+{
+  Space* space = new Space(A, B, NELEM, DIR_BC_LEFT, DIR_BC_RIGHT, P_INIT, NEQ);
+  int ndof = Space::get_num_dofs(space);
+  info("ndof: %d", ndof);
+
+  WeakForm wf;
+  wf.add_matrix_form(jacobian);
+  wf.add_vector_form(residual);
+  bool is_linear = false;
+  DiscreteProblem *dp = new DiscreteProblem(&wf, space, is_linear);
+
+  double *coeff_vec = new double[ndof];
+  get_coeff_vector(space, coeff_vec);
+
+  SparseMatrix* matrix = create_matrix(matrix_solver);
+  Vector* rhs = create_vector(matrix_solver);
+  Solver* solver = create_linear_solver(matrix_solver, matrix, rhs);
+
+  // The problem is linear, one Newton step solves it.
+  dp->assemble(coeff_vec, matrix, rhs);
+  for(int i=0; i<ndof; i++) rhs->set(i, -rhs->get(i));
+  if (!solver->solve()) error ("Matrix solver failed.\n");
+  for (int i = 0; i < ndof; i++) coeff_vec[i] += solver->get_solution()[i];
+  set_coeff_vector(coeff_vec, space);
+
+  double err = calc_err_exact(NORM, space, exact_sol, NEQ, A, B);
+  info("Relative error (exact) = %g", err);
+
+  delete solver;
+  delete matrix;
+  delete rhs;
+  delete dp;
+  delete [] coeff_vec;
+  delete space;
+  return err;
+}
+
+// Solves a band system with zero diagonal entries and its transpose, both with the exact
+// solution x_i = i + 1, returns the largest error of the solutions.
+double solve_pivoting_problem()
+{
+  // the matrix has one subdiagonal and two superdiagonals
+  const int n = 6;
+  double mat[n][n] = {
+    { 0, 2, 1, 0, 0, 0 },
+    { 1, 0, 3, 1, 0, 0 },
+    { 0, 4, 0, 2, 1, 0 },
+    { 0, 0, 1, 1, 0, 2 },
+    { 0, 0, 0, 3, 0, 1 },
+    { 0, 0, 0, 0, 2, 0 }
+  };
+
+  SparseMatrix* matrix = create_matrix(matrix_solver);
+  Vector* rhs = create_vector(matrix_solver);
+  matrix->prealloc(n);
+  for (int i = 0; i < n; i++)
+    for (int j = std::max(0, i - 1); j <= std::min(n - 1, i + 2); j++)
+      matrix->pre_add_ij(i, j);
+  matrix->alloc();
+  rhs->alloc(n);
+  for (int i = 0; i < n; i++)
+  {
+    double b = 0;
+    for (int j = 0; j < n; j++)
+    {
+      if (mat[i][j] != 0) matrix->add(i, j, mat[i][j]);
+      b += mat[i][j] * (j + 1);
+    }
+    rhs->set(i, b);
+  }
+
+  Solver* solver = create_linear_solver(matrix_solver, matrix, rhs);
+  double err = 1e10;
+  if (solver->solve())
+  {
+    err = 0;
+    for (int i = 0; i < n; i++)
+      err = std::max(err, fabs(solver->get_solution()[i] - (i + 1)));
+  }
+  info("Pivoting: max. error = %g", err);
+
+  // the transposed system, with the factorization of the first one
+  Vector* rhs_t = create_vector(matrix_solver);
+  rhs_t->alloc(n);
+  for (int j = 0; j < n; j++)
+  {
+    double b = 0;
+    for (int i = 0; i < n; i++)
+      b += mat[i][j] * (i + 1);
+    rhs_t->set(j, b);
+  }
+  double err_t = 1e10;
+  if (solver->solve_transposed(rhs_t))
+  {
+    err_t = 0;
+    for (int i = 0; i < n; i++)
+      err_t = std::max(err_t, fabs(solver->get_solution()[i] - (i + 1)));
+  }
+  info("Pivoting, transposed: max. error = %g", err_t);
+  err = std::max(err, err_t);
+  delete rhs_t;
+
+  delete solver;
+  delete matrix;
+  delete rhs;
+  return err;
+}
+
+int main()
+{
+  bool success = true;
+  if (!(solve_fe_problem() < TOL)) success = false;
+  if (!(solve_pivoting_problem() < 1e-12)) success = false;
+
+  if (success)
+  {
+    info("Success!");
+    return ERROR_SUCCESS;
+  }
+  else
+  {
+    info("Failure!");
+    return ERROR_FAILURE;
+  }
+}
@@ -548,35 +548,11 @@ Ord   linear_form_order(int n, double *wt, Func<Ord> *ue[], Func<Ord> *v, Geom<O
 // the correct element of the vector.
 double linear_form_interface(int element, int n, double *wt, Func<double> *ue[], Func<double> *v, Geom<double> *e, ExtData<double> *ext)
 {
+  // The four components share the flux of the edge, it is calculated only for the first of them.
+  double** flux = num_flux.get_edge_flux(n, ext, e);
   double result = 0;
-  double w01, w02, w11, w12, w21, w22, w31, w32;
-  double w_l[4], w_r[4];
-  for (int i = 0; i < n; i++) 
-  {
-    w01 = ext->fn[0]->get_val_central(i);
-    w02 = ext->fn[0]->get_val_neighbor(i);
-    
-    w11 = ext->fn[1]->get_val_central(i);
-    w12 = ext->fn[1]->get_val_neighbor(i);
-
-    w21 = ext->fn[2]->get_val_central(i);
-    w22 = ext->fn[2]->get_val_neighbor(i);
-
-    w31 = ext->fn[3]->get_val_central(i);
-    w32 = ext->fn[3]->get_val_neighbor(i);
-
-    w_l[0] = w01;
-    w_l[1] = w11;
-    w_l[2] = w21;
-    w_l[3] = w31;
-
-    w_r[0] = w02;
-    w_r[1] = w12;
-    w_r[2] = w22;
-    w_r[3] = w32;
-
-    result -= wt[i] * v->val[i] * num_flux.numerical_flux_i(element, w_l, w_r, e->nx[i], e->ny[i]);
-  }
+  for (int i = 0; i < n; i++)
+    result -= wt[i] * v->val[i] * flux[element][i];
   return result * TAU;
 }
 
@@ -548,25 +548,11 @@ Ord linear_form_order(int n, double *wt, Func<Ord> *ue[], Func<Ord> *v, Geom<Ord
 // the correct element of the vector.
 double linear_form_interface(int element, int n, double *wt, Func<double> *ue[], Func<double> *v, Geom<double> *e, ExtData<double> *ext)
 {
+  // The four components share the flux of the edge, it is calculated only for the first of them.
+  double** flux = num_flux.get_edge_flux(n, ext, e);
   double result = 0;
-  double w_l[4], w_r[4];
-  for (int i = 0; i < n; i++) 
-  {
-    w_l[0] = ext->fn[0]->get_val_central(i);
-    w_r[0] = ext->fn[0]->get_val_neighbor(i);
-    
-    w_l[1] = ext->fn[1]->get_val_central(i);
-    w_r[1] = ext->fn[1]->get_val_neighbor(i);
-
-    w_l[2] = ext->fn[2]->get_val_central(i);
-    w_r[2] = ext->fn[2]->get_val_neighbor(i);
-
-    w_l[3] = ext->fn[3]->get_val_central(i);
-    w_r[3] = ext->fn[3]->get_val_neighbor(i);
-
-
-    result -= wt[i] * v->val[i] * num_flux.numerical_flux_i(element,w_l,w_r,e->nx[i], e->ny[i]);
-  }
+  for (int i = 0; i < n; i++)
+    result -= wt[i] * v->val[i] * flux[element][i];
   return result * TAU;
 }
 
@@ -44,7 +44,9 @@ const int P_INIT_PRESSURE = 1;           // Initial polynomial degree for pressu
                                          // P_INIT_PRESSURE because of the inf-sup condition
 
 // Adaptivity
-const int UNREF_FREQ = 1;        // Every UNREF_FREQth time step the mesh is unrefined.
+const int UNREF_FREQ = 1;        // Every UNREF_FREQth time step the mesh is coarsened.
+const double COARSEN_THRESHOLD = 0.05;  // Sons of an element are merged if the sum of their errors is below
+                                        // COARSEN_THRESHOLD times the maximum element error, see Adapt::coarsen().
 const double THRESHOLD = 0.3;    // This is a quantitative parameter of the adapt(...) function and
                                  // it has different meanings for various adaptive strategies (see below).
 const int STRATEGY = 1;          // Adaptive strategy:
@@ -232,18 +234,10 @@ int main(int argc, char* argv[])
 
     info("---- Time step %d:", ts);
 
-    // Periodic global derefinements.
-    if (ts > 1 && ts % UNREF_FREQ == 0) {
-      info("Global mesh derefinement.");
-      mesh.copy(&basemesh);
-      xvel_space->set_uniform_order(P_INIT_VEL);
-      yvel_space->set_uniform_order(P_INIT_VEL);
-      p_space->set_uniform_order(P_INIT_PRESSURE);
-    }
-
     // Adaptivity loop:
     bool done = false; int as = 1;
     double err_est;
+    Adapt* adaptivity = NULL;
     do {
       info("Time step %d, adaptivity step %d:", ts, as);
 
@@ -261,8 +255,8 @@ int main(int argc, char* argv[])
 
       // Calculate initial coefficient vector for Newton on the fine mesh.
       if (as == 1) {
-        info("Projecting coarse mesh solution to obtain coefficient vector on new fine mesh.");
-        OGProjection::project_global(*ref_spaces, Tuple<MeshFunction *>(&xvel_sln, &yvel_sln, &p_sln), 
+        info("Projecting previous time level solution to obtain coefficient vector on new fine mesh.");
+        OGProjection::project_global(*ref_spaces, Tuple<MeshFunction *>(&xvel_prev_time, &yvel_prev_time, &p_prev_time), 
                       coeff_vec, matrix_solver, Tuple<ProjNormType>(vel_proj_norm, vel_proj_norm, p_proj_norm));
       }
       else {
@@ -292,10 +286,10 @@ int main(int argc, char* argv[])
 
       // Calculate element errors and total error estimate.
       info("Calculating error estimate.");
-      Adapt* adaptivity = new Adapt(Tuple<Space *>(xvel_space, yvel_space, p_space), 
+      adaptivity = new Adapt(Tuple<Space *>(xvel_space, yvel_space, p_space), 
                           Tuple<ProjNormType>(vel_proj_norm, vel_proj_norm, p_proj_norm));
       bool solutions_for_adapt = true;
-      double err_est_rel_total = adaptivity->calc_err_est(Tuple<Solution *>(&xvel_sln, &yvel_sln, &p_sln), 
+      double err_est_rel_total = err_est = adaptivity->calc_err_est(Tuple<Solution *>(&xvel_sln, &yvel_sln, &p_sln), 
              Tuple<Solution *>(&xvel_ref_sln, &yvel_ref_sln, &p_ref_sln), solutions_for_adapt, 
              HERMES_TOTAL_ERROR_REL | HERMES_ELEMENT_ERROR_REL) * 100.;
 
@@ -323,7 +317,7 @@ int main(int argc, char* argv[])
       delete solver;
       delete matrix;
       delete rhs;
-      delete adaptivity;
+      if (!done) delete adaptivity;
       delete ref_spaces;
       delete [] coeff_vec;
     }
@@ -341,6 +335,16 @@ int main(int argc, char* argv[])
     sprintf(title, "Pressure, time %g", TIME);
     pview.set_title(title);
     pview.show(&p_prev_time);
+
+    // Periodic coarsening where the solution does not need the refinements anymore.
+    // The element errors of the last adaptivity step are used unless it changed the mesh.
+    if (ts % UNREF_FREQ == 0 && err_est < ERR_STOP)
+    {
+      info("Coarsening the mesh.");
+      adaptivity->coarsen(Tuple<RefinementSelectors::Selector *>(&selector, &selector, &selector), 
+                          COARSEN_THRESHOLD, Tuple<Mesh *>(&basemesh, &basemesh, &basemesh));
+    }
+    delete adaptivity;
   }
 
   ndof = Space::get_num_dofs(Tuple<Space *>(xvel_space, yvel_space, p_space));
@@ -88,6 +88,7 @@ bool Adapt::adapt(Tuple<RefinementSelectors::Selector *> refinement_selectors, d
   error_if(!have_errors, "element errors have to be calculated first, call Adapt::calc_err_est().");
   error_if(refinement_selectors == Tuple<RefinementSelectors::Selector *>(), "selector not provided");
   if (spaces.size() != refinement_selectors.size()) error("Wrong number of refinement selectors.");
+  HERMES_PERF_SCOPE("adapt");
   TimePeriod cpu_time;
 
   //get meshes
@@ -363,12 +364,14 @@ void Adapt::apply_refinement(const ElementToRefine& elem_ref) {
   else if (elem_ref.split == H2D_REFINEMENT_H) {
     if (e->active)
       mesh->refine_element(elem_ref.id);
+    e = mesh->get_element(elem_ref.id); // the refinement may have unshared the mesh
     for (int j = 0; j < 4; j++)
       space->set_element_order_internal(e->sons[j]->id, elem_ref.p[j]);
   }
   else {
     if (e->active)
       mesh->refine_element(elem_ref.id, elem_ref.split);
+    e = mesh->get_element(elem_ref.id);
     for (int j = 0; j < 2; j++)
       space->set_element_order_internal(e->sons[ (elem_ref.split == 1) ? j : j+2 ]->id, elem_ref.p[j]);
   }
@@ -484,6 +487,164 @@ void Adapt::unrefine(double thr)
   have_errors = false;
 }
 
+int Adapt::coarsen(Tuple<RefinementSelectors::Selector *> refinement_selectors, double thr, Tuple<Mesh *> base_meshes)
+{
+  error_if(!have_errors, "element errors have to be calculated first, call Adapt::calc_err_est().");
+  if (spaces.size() != refinement_selectors.size()) error("Wrong number of refinement selectors.");
+  if (base_meshes.size() != 0 && base_meshes.size() != this->num) error("Wrong number of base meshes.");
+  HERMES_PERF_SCOPE("coarsen");
+
+  Mesh* meshes[H2D_MAX_COMPONENTS];
+  for (int j = 0; j < this->num; j++)
+    meshes[j] = this->spaces[j]->get_mesh();
+  double err_max_squared = errors[regular_queue[0].comp][regular_queue[0].id];
+
+  vector<ElementToRefine> elems_to_coarsen;
+  vector<int> merged[H2D_MAX_COMPONENTS]; // ids of merged elements
+  int num_merged = 0;
+  for (int i = 0; i < this->num; i++)
+  {
+    // each mesh once, for all components that share it
+    bool first = true;
+    for (int j = 0; j < i; j++)
+      if (meshes[j] == meshes[i]) first = false;
+    if (!first) continue;
+
+    // merge sons with small errors, level by level, the error of a merged element is the sum of errors of its sons
+    Mesh* base = (base_meshes.size() != 0) ? base_meshes[i] : NULL;
+    vector<int> parents;
+    do
+    {
+      parents.clear();
+      Element* e;
+      for_all_inactive_elements(e, meshes[i])
+      {
+        if (base != NULL && e->id < base->get_max_element_id())
+        {
+          Element* be = base->get_element_fast(e->id);
+          if (be->used && !be->active) continue; // refined in the base mesh
+        }
+
+        // without a base mesh, the initial refinements are kept as in Mesh::unrefine_all_elements()
+        bool found = true;
+        for (int k = 0; k < H2D_MAX_ELEMENT_SONS; k++)
+          if (e->sons[k] != NULL && ((!e->sons[k]->active) || (e->sons[k]->is_curved())
+              || (base == NULL && e->sons[k]->id < meshes[i]->get_num_initial_elements())))
+            { found = false; break; }
+
+        for (int j = i; j < this->num && found; j++)
+          if (meshes[j] == meshes[i])
+          {
+            double sum_squared = 0.0;
+            for (int k = 0; k < H2D_MAX_ELEMENT_SONS; k++)
+              if (e->sons[k] != NULL)
+                sum_squared += errors[j][e->sons[k]->id];
+            if (sum_squared >= thr * err_max_squared) found = false;
+          }
+
+        if (found) parents.push_back(e->id);
+      }
+
+      // select orders of the merged elements, merge the sons and apply the orders
+      for (unsigned int m = 0; m < parents.size(); m++)
+      {
+        e = meshes[i]->get_element(parents[m]);
+        int first_ref = (int)elems_to_coarsen.size();
+        for (int j = i; j < this->num; j++)
+          if (meshes[j] == meshes[i])
+          {
+            int son_orders[H2D_MAX_ELEMENT_SONS];
+            double sum_squared = 0.0;
+            for (int k = 0; k < H2D_MAX_ELEMENT_SONS; k++)
+            {
+              son_orders[k] = 0;
+              if (e->sons[k] != NULL)
+              {
+                son_orders[k] = this->spaces[j]->get_element_order(e->sons[k]->id);
+                sum_squared += errors[j][e->sons[k]->id];
+              }
+            }
+            ElementToRefine elem_ref(e->id, j);
+            elem_ref.split = H2D_REFINEMENT_P;
+            elem_ref.p[0] = elem_ref.q[0] = refinement_selectors[j]->select_coarsening_order(e, son_orders);
+            elems_to_coarsen.push_back(elem_ref);
+            errors[j][e->id] = sum_squared;
+            merged[j].push_back(e->id);
+          }
+        meshes[i]->unrefine_element(parents[m]);
+        for (unsigned int r = first_ref; r < elems_to_coarsen.size(); r++)
+          apply_refinement(elems_to_coarsen[r]);
+        num_merged++;
+      }
+    } while (!parents.empty());
+  }
+
+  // lower orders of the other elements with small errors
+  vector<ElementToRefine> elems_to_lower;
+  for (int i = 0; i < this->num; i++)
+  {
+    // each mesh once, the components that share it are lowered together
+    bool first = true;
+    for (int j = 0; j < i; j++)
+      if (meshes[j] == meshes[i]) first = false;
+    if (!first) continue;
+
+    std::sort(merged[i].begin(), merged[i].end());
+    Element* e;
+    for_all_active_elements(e, meshes[i])
+    {
+      if (std::binary_search(merged[i].begin(), merged[i].end(), e->id)) continue;
+
+      // a direction is lowered only if it can be in all components, which keeps the
+      // differences of their orders (e.g. of a velocity and a pressure)
+      bool small = true, lower_h = true, lower_v = e->is_quad();
+      for (int j = i; j < this->num; j++)
+        if (meshes[j] == meshes[i])
+        {
+          int current = this->spaces[j]->get_element_order(e->id);
+          if (errors[j][e->id] >= thr/4 * err_max_squared) small = false;
+          if (H2D_GET_H_ORDER(current) <= 1) lower_h = false;
+          if (H2D_GET_V_ORDER(current) <= 1) lower_v = false;
+        }
+      if (!small || (!lower_h && !lower_v)) continue;
+
+      for (int j = i; j < this->num; j++)
+        if (meshes[j] == meshes[i])
+        {
+          int current = this->spaces[j]->get_element_order(e->id);
+          int order_h = H2D_GET_H_ORDER(current) - (lower_h ? 1 : 0);
+          int order_v = H2D_GET_V_ORDER(current) - (lower_v ? 1 : 0);
+          ElementToRefine elem_ref(e->id, j);
+          elem_ref.split = H2D_REFINEMENT_P;
+          elem_ref.p[0] = elem_ref.q[0] = e->is_triangle() ? order_h : H2D_MAKE_QUAD_ORDER(order_h, order_v);
+          elems_to_lower.push_back(elem_ref);
+        }
+    }
+  }
+  int num_lowered = (int)elems_to_lower.size();
+
+  // the orders are not made the same across shared meshes as in adapt(), the components keep
+  // the differences of their orders
+  apply_refinements(elems_to_lower);
+
+  verbose("Merged elements: %d", num_merged);
+  verbose("Elements with lowered orders: %d", num_lowered);
+
+  //store for the user to retrieve, without the elements merged further
+  last_refinements.clear();
+  for (unsigned int r = 0; r < elems_to_coarsen.size(); r++)
+  {
+    Element* e = meshes[elems_to_coarsen[r].comp]->get_element(elems_to_coarsen[r].id);
+    if (e->used && e->active) last_refinements.push_back(elems_to_coarsen[r]);
+  }
+  last_refinements.insert(last_refinements.end(), elems_to_lower.begin(), elems_to_lower.end());
+
+  have_errors = false;
+  Space::assign_dofs(this->spaces);
+
+  return num_merged + num_lowered;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 void Adapt::set_error_form(int i, int j, matrix_form_val_t bi_form, matrix_form_ord_t bi_ord)
@@ -507,6 +668,16 @@ void Adapt::set_error_form(matrix_form_val_t bi_form, matrix_form_ord_t bi_ord)
 double Adapt::eval_error(matrix_form_val_t bi_fn, matrix_form_ord_t bi_ord,
                                  MeshFunction *sln1, MeshFunction *sln2, MeshFunction *rsln1, MeshFunction *rsln2)
 {
+  return std::abs(eval_error_product(bi_fn, bi_ord, sln1, rsln1, sln2, rsln2));
+}
+
+scalar Adapt::eval_error_product(matrix_form_val_t bi_fn, matrix_form_ord_t bi_ord,
+                                 MeshFunction *sln1, MeshFunction *rsln1, MeshFunction *sln2, MeshFunction *rsln2)
+{
+  // all temporary data are taken from the arena of the thread and released on return
+  ScratchArena* arena = ScratchArena::get_thread_arena();
+  ScratchScope scratch(arena);
+
   RefMap *rv1 = sln1->get_refmap();
   RefMap *rv2 = sln1->get_refmap();
   RefMap *rrv1 = rsln1->get_refmap();
@@ -514,11 +685,11 @@ double Adapt::eval_error(matrix_form_val_t bi_fn, matrix_form_ord_t bi_ord,
 
   // determine the integration order
   int inc = (rsln1->get_num_components() == 2) ? 1 : 0;
-  Func<Ord>* ou = init_fn_ord(rsln1->get_fn_order() + inc);
-  Func<Ord>* ov = init_fn_ord(rsln2->get_fn_order() + inc);
+  Func<Ord>* ou = init_fn_ord(rsln1->get_fn_order() + inc, arena);
+  Func<Ord>* ov = init_fn_ord(rsln2->get_fn_order() + inc, arena);
 
   double fake_wt = 1.0;
-  Geom<Ord>* fake_e = init_geom_ord();
+  Geom<Ord>* fake_e = init_geom_ord(arena);
   Ord o = bi_ord(1, &fake_wt, NULL, ou, ov, fake_e, NULL);
   int order = rrv1->get_inv_ref_order();
   order += o.get_order();
@@ -532,57 +703,47 @@ double Adapt::eval_error(matrix_form_val_t bi_fn, matrix_form_ord_t bi_ord,
   else  
     limit_order(order);
 
-  ou->free_ord(); delete ou;
-  ov->free_ord(); delete ov;
-  delete fake_e;
-
   // eval the form
   Quad2D* quad = sln1->get_quad_2d();
   double3* pt = quad->get_points(order);
   int np = quad->get_num_points(order);
 
   // init geometry and jacobian*weights
-  Geom<double>* e = init_geom_vol(rrv1, order);
+  Geom<double>* e = init_geom_vol(rrv1, order, arena);
   double* jac = rrv1->get_jacobian(order);
-  double* jwt = new double[np];
+  double* jwt = new (arena) double[np];
   for(int i = 0; i < np; i++)
     jwt[i] = pt[i][2] * jac[i];
 
   // function values and values of external functions
-  Func<scalar>* err1 = init_fn(sln1, rv1, order);
-  Func<scalar>* err2 = init_fn(sln2, rv2, order);
-  Func<scalar>* v1 = init_fn(rsln1, rrv1, order);
-  Func<scalar>* v2 = init_fn(rsln2, rrv2, order);
+  Func<scalar>* err1 = init_fn(sln1, rv1, order, arena);
+  Func<scalar>* err2 = init_fn(sln2, rv2, order, arena);
+  Func<scalar>* v1 = init_fn(rsln1, rrv1, order, arena);
+  Func<scalar>* v2 = init_fn(rsln2, rrv2, order, arena);
 
   err1->subtract(*v1);
   err2->subtract(*v2);
 
-  scalar res = bi_fn(np, jwt, NULL, err1, err2, e, NULL);
-
-  e->free(); delete e;
-  delete [] jwt;
-  err1->free_fn(); delete err1;
-  err2->free_fn(); delete err2;
-  v1->free_fn(); delete v1;
-  v2->free_fn(); delete v2;
-
-  return std::abs(res);
+  return bi_fn(np, jwt, NULL, err1, err2, e, NULL);
 }
 
 
 double Adapt::eval_norm(matrix_form_val_t bi_fn, matrix_form_ord_t bi_ord,
                                 MeshFunction *rsln1, MeshFunction *rsln2)
 {
+  ScratchArena* arena = ScratchArena::get_thread_arena();
+  ScratchScope scratch(arena);
+
   RefMap *rrv1 = rsln1->get_refmap();
   RefMap *rrv2 = rsln1->get_refmap();
 
   // determine the integration order
   int inc = (rsln1->get_num_components() == 2) ? 1 : 0;
-  Func<Ord>* ou = init_fn_ord(rsln1->get_fn_order() + inc);
-  Func<Ord>* ov = init_fn_ord(rsln2->get_fn_order() + inc);
+  Func<Ord>* ou = init_fn_ord(rsln1->get_fn_order() + inc, arena);
+  Func<Ord>* ov = init_fn_ord(rsln2->get_fn_order() + inc, arena);
 
   double fake_wt = 1.0;
-  Geom<Ord>* fake_e = init_geom_ord();
+  Geom<Ord>* fake_e = init_geom_ord(arena);
   Ord o = bi_ord(1, &fake_wt, NULL, ou, ov, fake_e, NULL);
   int order = rrv1->get_inv_ref_order();
   order += o.get_order();
@@ -596,33 +757,24 @@ double Adapt::eval_norm(matrix_form_val_t bi_fn, matrix_form_ord_t bi_ord,
   else  
     limit_order(order);
 
-  ou->free_ord(); delete ou;
-  ov->free_ord(); delete ov;
-  delete fake_e;
-
   // eval the form
   Quad2D* quad = rsln1->get_quad_2d();
   double3* pt = quad->get_points(order);
   int np = quad->get_num_points(order);
 
   // init geometry and jacobian*weights
-  Geom<double>* e = init_geom_vol(rrv1, order);
+  Geom<double>* e = init_geom_vol(rrv1, order, arena);
   double* jac = rrv1->get_jacobian(order);
-  double* jwt = new double[np];
+  double* jwt = new (arena) double[np];
   for(int i = 0; i < np; i++)
     jwt[i] = pt[i][2] * jac[i];
 
   // function values
-  Func<scalar>* v1 = init_fn(rsln1, rrv1, order);
-  Func<scalar>* v2 = init_fn(rsln2, rrv2, order);
+  Func<scalar>* v1 = init_fn(rsln1, rrv1, order, arena);
+  Func<scalar>* v2 = init_fn(rsln2, rrv2, order, arena);
 
   scalar res = bi_fn(np, jwt, NULL, v1, v2, e, NULL);
 
-  e->free(); delete e;
-  delete [] jwt;
-  v1->free_fn(); delete v1;
-  v2->free_fn(); delete v2;
-
   return std::abs(res);
 }
 
@@ -630,6 +782,7 @@ double Adapt::eval_norm(matrix_form_val_t bi_fn, matrix_form_ord_t bi_ord,
 double Adapt::calc_err_internal(Tuple<Solution *> slns, Tuple<Solution *> rslns, unsigned int error_flags, Tuple<double>* component_errors, bool solutions_for_adapt)
 {
   _F_
+  HERMES_PERF_SCOPE("error_estimation");
   int i, j, k;
 
   int n = slns.size();
@@ -773,6 +926,109 @@ double Adapt::calc_err_internal(Tuple<Solution *> slns, Tuple<Solution *> rslns,
   }
 }
 
+double Adapt::calc_err_dwr(Tuple<Solution *> slns, Tuple<Solution *> rslns,
+                           Tuple<Solution *> dual_slns, Tuple<Solution *> dual_rslns, bool solutions_for_adapt)
+{
+  _F_
+  HERMES_PERF_SCOPE("error_estimation");
+  int i, j;
+
+  int n = slns.size();
+  if (n != this->num || rslns.size() != n || dual_slns.size() != n || dual_rslns.size() != n)
+    EXIT("Wrong number of solutions.");
+
+  TimePeriod tmr;
+
+  Solution* rslns_original[H2D_MAX_COMPONENTS];
+  Solution* slns_original[H2D_MAX_COMPONENTS];
+  for (i = 0; i < n; i++) {
+    slns_original[i] = this->sln[i];
+    rslns_original[i] = this->rsln[i];
+    this->sln[i] = slns[i];
+    this->rsln[i] = rslns[i];
+    sln[i]->set_quad_2d(&g_quad_2d_std);
+    rsln[i]->set_quad_2d(&g_quad_2d_std);
+    dual_slns[i]->set_quad_2d(&g_quad_2d_std);
+    dual_rslns[i]->set_quad_2d(&g_quad_2d_std);
+  }
+
+  have_coarse_solutions = true;
+  have_reference_solutions = true;
+
+  // Prepare multi-mesh traversal of the primal and the dual solutions.
+  Mesh **meshes = new Mesh *[4 * num];
+  Transformable **tr = new Transformable *[4 * num];
+  scalar* indicators[H2D_MAX_COMPONENTS];
+  Traverse trav;
+  num_act_elems = 0;
+  for (i = 0; i < num; i++) {
+    meshes[i] = sln[i]->get_mesh();
+    meshes[i + num] = rsln[i]->get_mesh();
+    meshes[i + 2*num] = dual_slns[i]->get_mesh();
+    meshes[i + 3*num] = dual_rslns[i]->get_mesh();
+    tr[i] = sln[i];
+    tr[i + num] = rsln[i];
+    tr[i + 2*num] = dual_slns[i];
+    tr[i + 3*num] = dual_rslns[i];
+
+    num_act_elems += sln[i]->get_mesh()->get_num_active_elements();
+
+    int max = meshes[i]->get_max_element_id();
+    indicators[i] = new scalar[max];
+    memset(indicators[i], 0, sizeof(scalar) * max);
+  }
+
+  // The form a_ij(u_j, v_i) weights the error of the primal component j by the error
+  // of the dual component i. The indicator belongs to the element of the primal component.
+  scalar total = 0.0;
+  Element **ee;
+  trav.begin(4 * num, meshes, tr);
+  while ((ee = trav.get_next_state(NULL, NULL)) != NULL) {
+    for (i = 0; i < num; i++) {
+      for (j = 0; j < num; j++) {
+        if (form[i][j] != NULL) {
+          scalar err = eval_error_product(form[i][j], ord[i][j], sln[j], rsln[j], dual_slns[i], dual_rslns[i]);
+          indicators[j][ee[j]->id] += err;
+          total += err;
+        }
+      }
+    }
+  }
+  trav.finish();
+
+  tmr.tick();
+  error_time = tmr.accumulated();
+
+  // The element errors are the absolute values of the indicators.
+  if (solutions_for_adapt) {
+    this->errors_squared_sum = 0.0;
+    for (i = 0; i < num; i++) {
+      int max = meshes[i]->get_max_element_id();
+      if (errors[i] != NULL) delete [] errors[i];
+      errors[i] = new double[max];
+      for (j = 0; j < max; j++) {
+        errors[i][j] = std::abs(indicators[i][j]);
+        this->errors_squared_sum += errors[i][j];
+      }
+    }
+    fill_regular_queue(meshes);
+    have_errors = true;
+  }
+  else {
+    for (i = 0; i < n; i++) {
+      this->sln[i] = slns_original[i];
+      this->rsln[i] = rslns_original[i];
+    }
+  }
+
+  for (i = 0; i < num; i++)
+    delete [] indicators[i];
+  delete [] meshes;
+  delete [] tr;
+
+  return std::abs(total);
+}
+
 void Adapt::fill_regular_queue(Mesh** meshes) {
   assert_msg(num_act_elems > 0, "Number of active elements (%d) is invalid.", num_act_elems);
 
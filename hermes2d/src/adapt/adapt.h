@@ -48,6 +48,7 @@
 
 HERMES_API_USED_TEMPLATE(Tuple<Space*>); ///< Instantiated template. It is used to create a clean Windows DLL interface.
 HERMES_API_USED_TEMPLATE(Tuple<Solution*>); ///< Instantiated template. It is used to create a clean Windows DLL interface.
+HERMES_API_USED_TEMPLATE(Tuple<Mesh*>); ///< Instantiated template. It is used to create a clean Windows DLL interface.
 
 // Constant used by Adapt::calc_eror().
 #define HERMES_TOTAL_ERROR_REL  0x00  ///< A flag which defines interpretation of the total error. \ingroup g_adapt
@@ -177,6 +178,28 @@ public:
     return calc_err_internal(slns, rslns, error_flags, component_errors, solutions_for_adapt);
   }
 
+  /// Type-safe version of calc_err_dwr() for one solution.
+  double calc_err_dwr(Solution *sln, Solution *rsln, Solution *dual_sln, Solution *dual_rsln, bool solutions_for_adapt = true)
+  {
+    if (num != 1) EXIT("Wrong number of solutions.");
+    return calc_err_dwr(Tuple<Solution *> (sln), Tuple<Solution *> (rsln), Tuple<Solution *> (dual_sln),
+                        Tuple<Solution *> (dual_rsln), solutions_for_adapt);
+  }
+
+  /// Calculates goal-oriented (dual-weighted residual) error indicators.
+  /** The error of a goal functional J is estimated as J(u_ref) - J(u) = a(u_ref - u, z_ref - z),
+   *  where u, u_ref are the coarse and reference solutions and z, z_ref are the coarse and reference
+   *  solutions of the dual problem a(v, z) = J(v), see solve_dual(). The error forms (set_error_form())
+   *  have to be the bilinear forms a_ij of the problem. The indicator of an element is the absolute value
+   *  of its part of a(u_ref - u, z_ref - z), so adapt() refines where the error matters for the goal.
+   *  Since the indicators are not squares, the threshold of the strategy 0 applies to their sum.
+   *  \param[in] slns, rslns Coarse and reference solutions.
+   *  \param[in] dual_slns, dual_rslns Coarse and reference solutions of the dual problem.
+   *  \param[in] solutions_for_adapt True if the indicators are used by adapt().
+   *  \return The estimate of |J(u_ref) - J(u)|. */
+  double calc_err_dwr(Tuple<Solution *> slns, Tuple<Solution *> rslns,
+                      Tuple<Solution *> dual_slns, Tuple<Solution *> dual_rslns, bool solutions_for_adapt = true);
+
   /// Refines elements based on results from calc_err_est().
   /** The behavior of adaptivity can be controlled through methods should_ignore_element()
    *  and can_refine_element() which are inteteded to be overriden if neccessary.
@@ -195,6 +218,25 @@ public:
    *  \param[in] thr A stop condition relative error threshold. */
   void unrefine(double thr);
 
+  /// Coarsens the meshes and lowers orders where the error is small.
+  /** Intended for time-dependent problems: the adapted meshes are kept between time steps and only
+   *  the refinements which are not needed anymore are taken back, instead of starting each time step
+   *  from the base mesh. Sons of an element (all of them active) are merged if the sum of their errors
+   *  is below \a thr times the largest element error, in all components that share the mesh. The sum is
+   *  taken as the error of the merged element, so several levels of refinements can be taken back at once.
+   *  The order of the merged element is selected by Selector::select_coarsening_order(). Orders of the other
+   *  elements whose error is below \a thr/4 times the largest element error, in all components that share
+   *  the mesh, are lowered by one in all of them, in the directions where all of them are above one. Unlike
+   *  in adapt(), the orders of the components that share a mesh are not made the same, so differences
+   *  such as those of a velocity and a pressure are kept.
+   *  The changes are available through get_last_refinements() as P-refinements of the merged or lowered elements.
+   *  \param[in] refinement_selectors Selectors, one for each component.
+   *  \param[in] thr A threshold relative to the largest element error.
+   *  \param[in] base_meshes Meshes which are never coarsened below, e.g., the initial meshes the meshes were copied from. If empty, the refinements of the initial elements (see Mesh::get_num_initial_elements()) are kept.
+   *  \return The number of elements that were merged or whose orders were lowered. */
+  int coarsen(Tuple<RefinementSelectors::Selector *> refinement_selectors, double thr,
+              Tuple<Mesh *> base_meshes = Tuple<Mesh *>());
+
   /// A reference to an element.
   struct ElementReference {
     int id; ///< An element ID. Invalid if below 0.
@@ -311,6 +353,12 @@ protected: //forms and error evaluation
   virtual double eval_error(matrix_form_val_t bi_fn, matrix_form_ord_t bi_ord,
                     MeshFunction *sln1, MeshFunction *sln2, MeshFunction *rsln1, MeshFunction *rsln2);
 
+  /// Evaluates the bilinear form on an active element with the differences (sln1 - rsln1) and (sln2 - rsln2).
+  /** Used by eval_error() and by calc_err_dwr(), where the second pair are the dual solutions.
+   *  \return The value of the form, with its sign. */
+  scalar eval_error_product(matrix_form_val_t bi_fn, matrix_form_ord_t bi_ord,
+                            MeshFunction *sln1, MeshFunction *rsln1, MeshFunction *sln2, MeshFunction *rsln2);
+
   /// Evaluates a square of a norm of an active element in the reference solution among a given pair of components.
   /** The method uses a bilinear forms to calculate the norm. This is done by supplying a v1 and v2 at integration points to the bilinear form,
    *  where v1 and v2 are values of reference solutions of the first and the second component respectively.
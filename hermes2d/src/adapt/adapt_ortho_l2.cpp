@@ -571,11 +571,13 @@ void L2OrthoHP::adapt(double thr, int strat, bool h_only, bool iso_only, double
     }
     else if (split == 0) {
       mesh[comp]->refine_element(id);
+      e = mesh[comp]->get_element(id); // the refinement may have unshared the mesh
       for (j = 0; j < 4; j++)
         spaces[comp]->set_element_order_internal(e->sons[j]->id, p[j]);
     }
     else {
       mesh[comp]->refine_element(id, split);
+      e = mesh[comp]->get_element(id);
       for (j = 0; j < 2; j++)
         spaces[comp]->set_element_order_internal(e->sons[ (split == 1) ? j : j+2 ]->id, p[j]);
     }
@@ -73,6 +73,28 @@ public:
     }
   }
 
+  /// Makes this array use the pages of another one, without copying them. The
+  /// pages must then be freed by only one of the arrays, the others must call
+  /// release() instead of free(). Used by Mesh::copy().
+  void share(const Array& array)
+  {
+    free();
+
+    pages = array.pages;
+    unused = array.unused;
+    size = array.size;
+    nitems = array.nitems;
+    append_only = array.append_only;
+  }
+
+  /// Forgets all pages without freeing them, because another array still uses them.
+  void release()
+  {
+    pages.clear();
+    unused.clear();
+    size = nitems = 0;
+  }
+
   /// Removes all elements from the array.
   void free()
   {
@@ -136,6 +158,13 @@ public:
     nitems--;
   }
 
+  /// Preallocates the page table for 'n' items, so that adding them
+  /// does not reallocate it.
+  void reserve(int n)
+  {
+    pages.reserve((n + H2D_PAGE_MASK) >> H2D_PAGE_BITS);
+  }
+
   /// Cleans the array and reserves space for up to 'size' items.
   /// This is a special-purpose function, used for loading the array
   /// from file.
@@ -0,0 +1,206 @@
+// This file is part of Hermes2D.
+//
+// Hermes2D is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Hermes2D is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Hermes2D.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "h2d_common.h"
+#include "checkpoint.h"
+#include "mesh.h"
+#include "space/space.h"
+#include "solution.h"
+
+// Record tags. The data of the records are:
+//   MESH: the mesh in the format of Mesh::save_raw()
+//   SPCE: ndof, DOF ordering, interleaving, max. element id, order of each element (-1 if inactive)
+//   VECT: sizeof(scalar), ndof, coefficients
+static const char* H2D_CHECKPOINT_MAGIC = "H2DC";
+static const char* H2D_TAG_MESH = "MESH";
+static const char* H2D_TAG_SPACE = "SPCE";
+static const char* H2D_TAG_VECTOR = "VECT";
+
+
+Checkpoint::Checkpoint()
+{
+}
+
+
+Checkpoint::~Checkpoint()
+{
+  close();
+}
+
+
+void Checkpoint::create(const char* filename, bool append)
+{
+  _F_
+  file.create(filename, H2D_CHECKPOINT_MAGIC, append);
+}
+
+
+void Checkpoint::open(const char* filename)
+{
+  _F_
+  file.open(filename, H2D_CHECKPOINT_MAGIC);
+}
+
+
+void Checkpoint::close()
+{
+  _F_
+  file.close();
+}
+
+
+int Checkpoint::find(const char* tag, int step, int index, bool exact)
+{
+  int rec = file.find_record(tag, step, index, exact);
+  if (rec < 0)
+    error("Checkpoint: no %.4s record (step %d, index %d).", tag, step, index);
+  return rec;
+}
+
+
+//// saving ////////////////////////////////////////////////////////////////////////////////////////
+
+void Checkpoint::save_mesh(Mesh* mesh, int step, int index)
+{
+  _F_
+  FILE* f = file.begin_record(H2D_TAG_MESH, step, index);
+  mesh->save_raw(f);
+  file.end_record();
+}
+
+
+void Checkpoint::save_space(Space* space, int step, int index)
+{
+  _F_
+  Mesh* mesh = space->get_mesh();
+  int n = mesh->get_max_element_id();
+  int hdr[4] = { space->get_num_dofs(), space->get_dof_ordering(), space->get_dof_interleaving(), n };
+
+  int* orders = new int[n];
+  for (int i = 0; i < n; i++)
+    orders[i] = -1;
+  Element* e;
+  for_all_active_elements(e, mesh)
+    orders[e->id] = space->get_element_order(e->id);
+
+  FILE* f = file.begin_record(H2D_TAG_SPACE, step, index);
+  hermes_fwrite(hdr, sizeof(int), 4, f);
+  hermes_fwrite(orders, sizeof(int), n, f);
+  file.end_record();
+  delete [] orders;
+}
+
+
+void Checkpoint::save_vector(scalar* vec, int ndof, int step, int index)
+{
+  _F_
+  int hdr[2] = { sizeof(scalar), ndof };
+  FILE* f = file.begin_record(H2D_TAG_VECTOR, step, index);
+  hermes_fwrite(hdr, sizeof(int), 2, f);
+  hermes_fwrite(vec, sizeof(scalar), ndof, f);
+  file.end_record();
+}
+
+
+void Checkpoint::save(Tuple<Space*> spaces, scalar* vec, int step)
+{
+  _F_
+  for (int i = 0; i < spaces.size(); i++)
+  {
+    // a mesh shared by several spaces is saved with the index of the first one
+    bool saved = false;
+    for (int j = 0; j < i; j++)
+      if (spaces[j]->get_mesh() == spaces[i]->get_mesh()) saved = true;
+    if (!saved) save_mesh(spaces[i]->get_mesh(), step, i);
+    save_space(spaces[i], step, i);
+  }
+  save_vector(vec, Space::get_num_dofs(spaces), step);
+}
+
+
+//// loading ///////////////////////////////////////////////////////////////////////////////////////
+
+void Checkpoint::load_mesh(Mesh* mesh, int step, int index)
+{
+  _F_
+  FILE* f = file.seek_record(find(H2D_TAG_MESH, step, index, false));
+  mesh->load_raw(f);
+}
+
+
+void Checkpoint::load_space(Space* space, int step, int index)
+{
+  _F_
+  FILE* f = file.seek_record(find(H2D_TAG_SPACE, step, index, false));
+  int hdr[4];
+  hermes_fread(hdr, sizeof(int), 4, f);
+  int n = hdr[3];
+
+  // a reloaded mesh may have a larger element array, only the active elements have to match
+  Mesh* mesh = space->get_mesh();
+  int* orders = new int[n];
+  hermes_fread(orders, sizeof(int), n, f);
+
+  Element* e;
+  for_all_active_elements(e, mesh)
+  {
+    if (e->id >= n || orders[e->id] < 0) error("Checkpoint: the space does not match the mesh.");
+    space->set_element_order_internal(e->id, orders[e->id]);
+  }
+  delete [] orders;
+
+  // enumerates the basis functions
+  space->set_dof_ordering((DofOrdering) hdr[1], hdr[2] != 0);
+  if (space->get_num_dofs() != hdr[0])
+    warn("Checkpoint: the space has %d DOFs, %d were saved.", space->get_num_dofs(), hdr[0]);
+}
+
+
+scalar* Checkpoint::load_vector(int step, int index, int* ndof)
+{
+  _F_
+  FILE* f = file.seek_record(find(H2D_TAG_VECTOR, step, index, true));
+  int hdr[2];
+  hermes_fread(hdr, sizeof(int), 2, f);
+  if (hdr[0] != sizeof(scalar))
+    error("Checkpoint: the vector was saved with a different scalar type.");
+
+  scalar* vec = new scalar[hdr[1]];
+  hermes_fread(vec, sizeof(scalar), hdr[1], f);
+  if (ndof != NULL) *ndof = hdr[1];
+  return vec;
+}
+
+
+void Checkpoint::load_solutions(Tuple<Space*> spaces, Tuple<Solution*> solutions, int step)
+{
+  _F_
+  // the interleaved DOF orderings span all the spaces
+  Space::assign_dofs(spaces);
+
+  int ndof;
+  scalar* vec = load_vector(step, 0, &ndof);
+  if (ndof != Space::get_num_dofs(spaces))
+    error("Checkpoint: the spaces have %d DOFs, the vector has %d.", Space::get_num_dofs(spaces), ndof);
+  Solution::vector_to_solutions(vec, spaces, solutions);
+  delete [] vec;
+}
+
+
+long Checkpoint::get_vector_offset(int step, int index)
+{
+  _F_
+  return file.get_record_offset(find(H2D_TAG_VECTOR, step, index, true)) + 2 * sizeof(int);
+}
@@ -0,0 +1,98 @@
+// This file is part of Hermes2D.
+//
+// Hermes2D is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Hermes2D is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Hermes2D.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef __H2D_CHECKPOINT_H
+#define __H2D_CHECKPOINT_H
+
+#include "h2d_common.h"
+#include "../../hermes_common/record_file.h"
+
+class Mesh;
+class Space;
+class Solution;
+
+/// \brief Binary checkpoint file ("H2DC") for restarting computations.
+///
+/// A checkpoint stores meshes (including the refinement trees), the element orders
+/// and DOF orderings of spaces and the coefficient vectors, each tagged with a time
+/// step. Records can be appended to an existing checkpoint at every time step; when
+/// a checkpoint is opened, only the record headers are read and the data are loaded
+/// on demand. The data are stored uncompressed in the native byte order, aligned to
+/// 8 bytes, so a coefficient vector can also be memory-mapped directly (see
+/// get_vector_offset()).
+///
+/// Typical restart:
+/// \code
+///   Checkpoint cp;
+///   cp.open("run.h2dc");
+///   Mesh mesh;
+///   cp.load_mesh(&mesh);
+///   H1Space space(&mesh, bc_types, essential_bc_values, P_INIT);
+///   cp.load_space(&space);
+///   Solution sln;
+///   cp.load_solutions(&space, &sln);
+/// \endcode
+///
+class HERMES_API Checkpoint
+{
+public:
+  Checkpoint();
+  ~Checkpoint();
+
+  /// Creates a new checkpoint file. With 'append' = true, an existing file is kept
+  /// and the new records are added after the ones already stored in it.
+  void create(const char* filename, bool append = false);
+  /// Opens a checkpoint file for reading.
+  void open(const char* filename);
+  void close();
+
+  /// Saves the mesh, including its refinement tree. Curved elements are not
+  /// supported yet (see Mesh::save_raw()).
+  void save_mesh(Mesh* mesh, int step, int index = 0);
+  /// Saves the element orders and the DOF ordering of the space.
+  void save_space(Space* space, int step, int index = 0);
+  /// Saves a coefficient vector of length 'ndof'.
+  void save_vector(scalar* vec, int ndof, int step, int index = 0);
+  /// Saves the meshes (each one only once), the spaces and the coefficient vector
+  /// of the whole system.
+  void save(Tuple<Space*> spaces, scalar* vec, int step);
+
+  /// Returns the last time step stored in the checkpoint.
+  int get_last_step() const { return file.get_last_step(); }
+
+  /// Loads the mesh saved at the time step 'step' or, if the mesh was not saved at that
+  /// step, the last one saved before it. With 'step' = -1, the last mesh is loaded.
+  void load_mesh(Mesh* mesh, int step = -1, int index = 0);
+  /// Sets the element orders and the DOF ordering saved in the checkpoint (the rules
+  /// for 'step' are the same as in load_mesh()) and assigns the DOFs. The space must
+  /// be defined on the mesh obtained by load_mesh().
+  void load_space(Space* space, int step = -1, int index = 0);
+  /// Returns a copy of the coefficient vector saved at the time step 'step' (-1 for the
+  /// last one), allocated by new[]. Its length is returned in 'ndof'.
+  scalar* load_vector(int step = -1, int index = 0, int* ndof = NULL);
+  /// Loads the coefficient vector saved by save() and converts it to solutions. The spaces
+  /// must be restored by load_space() first.
+  void load_solutions(Tuple<Space*> spaces, Tuple<Solution*> solutions, int step = -1);
+
+  /// Returns the offset of the coefficients of a saved vector in the file, e.g. for mmap().
+  long get_vector_offset(int step = -1, int index = 0);
+
+protected:
+  RecordFile file;
+
+  int find(const char* tag, int step, int index, bool exact);
+};
+
+#endif
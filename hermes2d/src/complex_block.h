@@ -0,0 +1,245 @@
+// This file is part of Hermes2D.
+//
+// Hermes2D is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Hermes2D is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Hermes2D.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef __H2D_COMPLEX_BLOCK_H
+#define __H2D_COMPLEX_BLOCK_H
+
+#include "forms.h"
+#include "weakform.h"
+#include "../../hermes_common/scratch_arena.h"
+
+/// \file complex_block.h
+/// Complex problems solved by the real version of the library.
+///
+/// A complex equation a(u, v) = l(v) for u = u_re + i u_im is equivalent to the real system
+/// \code
+///   | Re a  -Im a | | u_re |   | Re l |
+///   | Im a   Re a | | u_im | = | Im l |
+/// \endcode
+/// ComplexBlockForm assembles complex forms into this 2x2 block form: the k-th complex
+/// equation becomes the real equations 2k (real part) and 2k + 1 (imaginary part), each
+/// with its own real space. The forms are the same templates as for hermes2d-cplx, they
+/// are instantiated with Scalar = cplx. The shape functions, the geometry and the matrix
+/// stay real, so all real solvers and preconditioners can be used, and real and complex
+/// problems can be solved by one program.
+///
+/// \code
+///   ComplexBlockForm wf;
+///   wf.add_matrix_form(0, 0, complex_callback(bilinear_form), HERMES_SYM);
+///   wf.add_vector_form(0, complex_callback(linear_form));
+///
+///   H1Space space_re(&mesh, bc_types, bc_values_re, P_INIT);
+///   H1Space space_im(&mesh, bc_types, bc_values_im, P_INIT);
+///   // the real and imaginary part of each DOF next to each other (2x2 blocks)
+///   space_re.set_dof_ordering(HERMES_DOF_NATURAL, true);
+///   space_im.set_dof_ordering(HERMES_DOF_NATURAL, true);
+///   DiscreteProblem dp(&wf, Tuple<Space *>(&space_re, &space_im), true);
+///   ...
+///   Solution::vector_to_solutions(coeff_vec, Tuple<Space *>(&space_re, &space_im),
+///                                 Tuple<Solution *>(&sln_re, &sln_im));
+///   MagFilter mag(Tuple<MeshFunction *>(&sln_re, &sln_im));   // |u|
+/// \endcode
+///
+/// Complex constants in the forms must have the type cplx (not scalar, which is real
+/// here). External functions are passed to the forms as complex functions with zero
+/// imaginary part. Only linear problems are supported (u_ext is NULL).
+///
+
+#ifndef H2D_COMPLEX
+
+// Orders of the forms with complex constants.
+inline Ord operator*(const cplx &a, const Ord &b) { return b; }
+inline Ord operator*(const Ord &a, const cplx &b) { return a; }
+inline Ord operator+(const cplx &a, const Ord &b) { return b; }
+inline Ord operator+(const Ord &a, const cplx &b) { return a; }
+inline Ord operator-(const cplx &a, const Ord &b) { return b; }
+inline Ord operator-(const Ord &a, const cplx &b) { return a; }
+inline Ord operator/(const cplx &a, const Ord &b) { return Ord(b.get_max_order()); }
+inline Ord operator/(const Ord &a, const cplx &b) { return a; }
+
+/// Which parts of a complex form can be nonzero.
+enum ComplexFormKind
+{
+  HERMES_CPLX_GENERAL,  ///< Both parts, all four blocks are assembled.
+  HERMES_CPLX_REAL,     ///< The form is real, only the diagonal blocks are assembled.
+  HERMES_CPLX_IMAG      ///< The form is imaginary, only the off-diagonal blocks are assembled.
+};
+
+typedef cplx (*complex_matrix_form_t)(int n, double *wt, Func<cplx> *u_ext[], Func<double> *u, Func<double> *v,
+                                      Geom<double> *e, ExtData<cplx> *ext);
+typedef cplx (*complex_vector_form_t)(int n, double *wt, Func<cplx> *u_ext[], Func<double> *v,
+                                      Geom<double> *e, ExtData<cplx> *ext);
+
+/// Copies the values of a real function into a complex one allocated from the arena.
+inline cplx* complex_block_copy(double* src, int n, ScratchArena* arena)
+{
+  if (src == NULL) return NULL;
+  cplx* dst = new (arena) cplx[n];
+  for (int i = 0; i < n; i++) dst[i] = src[i];
+  return dst;
+}
+
+inline ExtData<cplx>* complex_block_ext(ExtData<double>* ext, ScratchArena* arena)
+{
+  if (ext == NULL) return NULL;
+  ExtData<cplx>* cext = new (arena) ExtData<cplx>;
+  cext->nf = ext->nf;
+  cext->fn = new (arena) Func<cplx>*[ext->nf];
+  for (int k = 0; k < ext->nf; k++)
+  {
+    Func<double>* fn = ext->fn[k];
+    int n = fn->num_gip;
+    Func<cplx>* cfn = new (arena) Func<cplx>(n, fn->nc);
+    cfn->val = complex_block_copy(fn->val, n, arena);
+    cfn->dx = complex_block_copy(fn->dx, n, arena);
+    cfn->dy = complex_block_copy(fn->dy, n, arena);
+    cfn->val0 = complex_block_copy(fn->val0, n, arena);
+    cfn->val1 = complex_block_copy(fn->val1, n, arena);
+    cfn->dx0 = complex_block_copy(fn->dx0, n, arena);
+    cfn->dx1 = complex_block_copy(fn->dx1, n, arena);
+    cfn->dy0 = complex_block_copy(fn->dy0, n, arena);
+    cfn->dy1 = complex_block_copy(fn->dy1, n, arena);
+    cfn->curl = complex_block_copy(fn->curl, n, arena);
+    cext->fn[k] = cfn;
+  }
+  return cext;
+}
+
+/// Part of a complex value stored in a block.
+enum { H2D_CPLX_RE, H2D_CPLX_IM, H2D_CPLX_NEG_IM };
+
+inline double complex_block_part(const cplx& val, int part)
+{
+  return (part == H2D_CPLX_RE) ? val.real() : (part == H2D_CPLX_IM) ? val.imag() : -val.imag();
+}
+
+/// Real forms evaluating one part of the complex matrix form F.
+template<complex_matrix_form_t F>
+struct ComplexMatrixForm
+{
+  template<int PART>
+  static scalar value(int n, double *wt, Func<scalar> *u_ext[], Func<double> *u, Func<double> *v,
+                      Geom<double> *e, ExtData<scalar> *ext)
+  {
+    ScratchArena* arena = ScratchArena::get_thread_arena();
+    ScratchScope scope(arena);
+    return complex_block_part(F(n, wt, NULL, u, v, e, complex_block_ext(ext, arena)), PART);
+  }
+};
+
+/// Real forms evaluating one part of the complex vector form F.
+template<complex_vector_form_t F>
+struct ComplexVectorForm
+{
+  template<int PART>
+  static scalar value(int n, double *wt, Func<scalar> *u_ext[], Func<double> *v,
+                      Geom<double> *e, ExtData<scalar> *ext)
+  {
+    ScratchArena* arena = ScratchArena::get_thread_arena();
+    ScratchScope scope(arena);
+    return complex_block_part(F(n, wt, NULL, v, e, complex_block_ext(ext, arena)), PART);
+  }
+};
+
+template<complex_matrix_form_t F>
+ComplexMatrixForm<F> complex_form() { return ComplexMatrixForm<F>(); }
+
+template<complex_vector_form_t F>
+ComplexVectorForm<F> complex_form() { return ComplexVectorForm<F>(); }
+
+/// Counterpart of callback() for complex forms added to a ComplexBlockForm.
+#define complex_callback(a)  complex_form< a<double, cplx> >(), a<Ord, Ord>
+
+/// \brief Weak form of a complex problem in the real 2x2 block form.
+///
+/// The indices of equations passed to the add_*() methods with a complex form are the
+/// indices of the complex equations.
+///
+class HERMES_API ComplexBlockForm : public WeakForm
+{
+public:
+  /// 'neq' is the number of complex equations.
+  ComplexBlockForm(int neq = 1) : WeakForm(2 * neq) { }
+
+  using WeakForm::add_matrix_form;
+  using WeakForm::add_matrix_form_surf;
+  using WeakForm::add_vector_form;
+  using WeakForm::add_vector_form_surf;
+
+  /// A symmetric complex form (HERMES_SYM) gives symmetric real blocks and an antisymmetric
+  /// pair of imaginary blocks, so for i == j the imaginary part is evaluated only once.
+  template<complex_matrix_form_t F>
+  void add_matrix_form(int i, int j, ComplexMatrixForm<F> form, matrix_form_ord_t ord, SymFlag sym = HERMES_UNSYM,
+                       ComplexFormKind kind = HERMES_CPLX_GENERAL, int area = HERMES_ANY,
+                       Tuple<MeshFunction*> ext = Tuple<MeshFunction*>())
+  {
+    if (kind != HERMES_CPLX_IMAG)
+    {
+      add_matrix_form(2*i, 2*j, ComplexMatrixForm<F>::template value<H2D_CPLX_RE>, ord, sym, area, ext);
+      add_matrix_form(2*i + 1, 2*j + 1, ComplexMatrixForm<F>::template value<H2D_CPLX_RE>, ord, sym, area, ext);
+    }
+    if (kind != HERMES_CPLX_REAL)
+    {
+      // the imaginary part changes its sign when transposed into the upper block
+      SymFlag sym_im = (SymFlag) -sym;
+      add_matrix_form(2*i + 1, 2*j, ComplexMatrixForm<F>::template value<H2D_CPLX_IM>, ord, sym_im, area, ext);
+      if (sym == HERMES_UNSYM || i != j)
+        add_matrix_form(2*i, 2*j + 1, ComplexMatrixForm<F>::template value<H2D_CPLX_NEG_IM>, ord, sym_im, area, ext);
+    }
+  }
+
+  template<complex_matrix_form_t F>
+  void add_matrix_form_surf(int i, int j, ComplexMatrixForm<F> form, matrix_form_ord_t ord,
+                            ComplexFormKind kind = HERMES_CPLX_GENERAL, int area = HERMES_ANY,
+                            Tuple<MeshFunction*> ext = Tuple<MeshFunction*>())
+  {
+    if (kind != HERMES_CPLX_IMAG)
+    {
+      add_matrix_form_surf(2*i, 2*j, ComplexMatrixForm<F>::template value<H2D_CPLX_RE>, ord, area, ext);
+      add_matrix_form_surf(2*i + 1, 2*j + 1, ComplexMatrixForm<F>::template value<H2D_CPLX_RE>, ord, area, ext);
+    }
+    if (kind != HERMES_CPLX_REAL)
+    {
+      add_matrix_form_surf(2*i + 1, 2*j, ComplexMatrixForm<F>::template value<H2D_CPLX_IM>, ord, area, ext);
+      add_matrix_form_surf(2*i, 2*j + 1, ComplexMatrixForm<F>::template value<H2D_CPLX_NEG_IM>, ord, area, ext);
+    }
+  }
+
+  template<complex_vector_form_t F>
+  void add_vector_form(int i, ComplexVectorForm<F> form, vector_form_ord_t ord,
+                       ComplexFormKind kind = HERMES_CPLX_GENERAL, int area = HERMES_ANY,
+                       Tuple<MeshFunction*> ext = Tuple<MeshFunction*>())
+  {
+    if (kind != HERMES_CPLX_IMAG)
+      add_vector_form(2*i, ComplexVectorForm<F>::template value<H2D_CPLX_RE>, ord, area, ext);
+    if (kind != HERMES_CPLX_REAL)
+      add_vector_form(2*i + 1, ComplexVectorForm<F>::template value<H2D_CPLX_IM>, ord, area, ext);
+  }
+
+  template<complex_vector_form_t F>
+  void add_vector_form_surf(int i, ComplexVectorForm<F> form, vector_form_ord_t ord,
+                            ComplexFormKind kind = HERMES_CPLX_GENERAL, int area = HERMES_ANY,
+                            Tuple<MeshFunction*> ext = Tuple<MeshFunction*>())
+  {
+    if (kind != HERMES_CPLX_IMAG)
+      add_vector_form_surf(2*i, ComplexVectorForm<F>::template value<H2D_CPLX_RE>, ord, area, ext);
+    if (kind != HERMES_CPLX_REAL)
+      add_vector_form_surf(2*i + 1, ComplexVectorForm<F>::template value<H2D_CPLX_IM>, ord, area, ext);
+  }
+};
+
+#endif
+
+#endif
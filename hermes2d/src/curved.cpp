@@ -21,6 +21,7 @@
 #include "mesh.h"
 #include "quad_all.h"
 #include "../../hermes_common/matrix.h"
+#include <map>
 
 // defined in refmap.cpp
 extern H1ShapesetJacobi ref_map_shapeset;
@@ -39,31 +40,78 @@ static Quad2DStd quad2d; // fixme: g_quad_2d_std
 
 static Trf ctm;
 
-//// NURBS //////////////////////////////////////////////////////////////////////////////////////////
 
-// recursive calculation of the basis function N_i,k
-double nurbs_basis_fn(int i, int k, double t, double* knot)
+/// Projections of the curved geometry of one base element. The edge and bubble
+/// coefficients of a son depend only on the base element, the refinement path
+/// leading to the son and the order, so they are calculated once and reused when
+/// the son is created again (unrefinement and refinement during adaptivity,
+/// reference meshes created as copies of the coarse mesh). The vertices of the
+/// base element are stored to detect meshes whose geometry has been changed.
+struct CurvMapCache
 {
-  _F_
-  if (k == 0)
+  CurvMapCache() { ref = 1; nvert = 0; }
+  ~CurvMapCache() { clear(); }
+
+  void clear()
   {
-    return (t >= knot[i] && t <= knot[i+1] && knot[i] < knot[i+1]) ? 1.0 : 0.0;
+    for (std::map<std::pair<uint64_t, int>, double2*>::iterator it = projs.begin(); it != projs.end(); it++)
+      delete [] it->second;
+    projs.clear();
   }
-  else
-  {
-    double N1 = nurbs_basis_fn(i, k-1, t, knot);
-    double N2 = nurbs_basis_fn(i+1, k-1, t, knot);
 
-    double result = 0.0;
-    if (knot[i+k] != knot[i])
+  // returns false (and empties the cache) if 'e' has other vertices than the
+  // element the projections were calculated for
+  bool check_vertices(Element* e)
+  {
+    bool same = (nvert == e->nvert);
+    for (unsigned int i = 0; same && i < nvert; i++)
+      same = (vert[i][0] == e->vn[i]->x && vert[i][1] == e->vn[i]->y);
+    if (same) return true;
+
+    clear();
+    nvert = e->nvert;
+    for (unsigned int i = 0; i < nvert; i++)
     {
-      result += ((t - knot[i]) / (knot[i+k] - knot[i])) * N1;
+      vert[i][0] = e->vn[i]->x;
+      vert[i][1] = e->vn[i]->y;
     }
-    if (knot[i+k+1] != knot[i+1])
+    return false;
+  }
+
+  int ref;           ///< number of CurvMaps (copies of the base element) sharing the cache
+  unsigned int nvert;
+  double2 vert[4];   ///< vertices of the base element
+  std::map<std::pair<uint64_t, int>, double2*> projs; ///< (part, order) -> edge and bubble coefficients
+};
+
+//// NURBS //////////////////////////////////////////////////////////////////////////////////////////
+
+// calculation of all basis functions N_i,k(t), 0 <= i < np. The recurrence
+// N_i,k = a * N_i,k-1 + b * N_i+1,k-1 is evaluated bottom-up, one degree at a
+// time, so that every N_i,j is calculated only once (the recursive definition
+// evaluates them once per path). 'N' must have space for np + k values.
+static void nurbs_basis_fns(int np, int k, double t, double* knot, double* N)
+{
+  _F_
+  int n = np + k;
+  for (int i = 0; i < n; i++)
+    N[i] = (t >= knot[i] && t <= knot[i+1] && knot[i] < knot[i+1]) ? 1.0 : 0.0;
+
+  for (int d = 1; d <= k; d++)
+  {
+    for (int i = 0; i < n - d; i++)
     {
-      result += ((knot[i+k+1] - t) / (knot[i+k+1] - knot[i+1])) * N2;
+      double result = 0.0;
+      if (knot[i+d] != knot[i])
+      {
+        result += ((t - knot[i]) / (knot[i+d] - knot[i])) * N[i];
+      }
+      if (knot[i+d+1] != knot[i+1])
+      {
+        result += ((knot[i+d+1] - t) / (knot[i+d+1] - knot[i+1])) * N[i+1];
+      }
+      N[i] = result;
     }
-    return result;
   }
 }
 
@@ -87,13 +135,18 @@ void nurbs_edge(Element* e, Nurbs* nurbs, int edge, double t, double& x, double&
     x = y = 0.0;
     double sum = 0.0;  // sum of basis fns and weights
 
+    double local[32];
+    int n = nurbs->np + nurbs->degree;
+    double* basis = (n <= 32) ? local : new double[n];
+    nurbs_basis_fns(nurbs->np, nurbs->degree, t, nurbs->kv, basis);
+
     for (int i = 0; i < nurbs->np; i++)
     {
-      double basis = nurbs_basis_fn(i, nurbs->degree, t, nurbs->kv);
-      sum += cp[i][2] * basis;
-      x   += cp[i][2] * basis * cp[i][0];
-      y   += cp[i][2] * basis * cp[i][1];
+      sum += cp[i][2] * basis[i];
+      x   += cp[i][2] * basis[i] * cp[i][0];
+      y   += cp[i][2] * basis[i] * cp[i][1];
     }
+    if (basis != local) delete [] basis;
 
     sum = 1.0 / sum;
     x *= sum;
@@ -556,6 +609,29 @@ void CurvMap::update_refmap_coeffs(Element* e)
   // WARNING: do not change the format of the array 'coeffs'. If it changes,
   // RefMap::set_active_element() has to be changed too.
 
+  // look up the edge and bubble part in the cache of the base element
+  Element* base = toplevel ? e : parent;
+  CurvMap* base_cm = base->cm;
+  if (base_cm->cache == NULL) base_cm->cache = new CurvMapCache;
+  CurvMapCache* base_cache = base_cm->cache;
+  std::pair<uint64_t, int> key(toplevel ? 0 : part, order);
+
+  if (base_cache->check_vertices(base))
+  {
+    std::map<std::pair<uint64_t, int>, double2*>::iterator it = base_cache->projs.find(key);
+    HERMES_PERF_CACHE_HIT("curved_projections", it != base_cache->projs.end());
+    if (it != base_cache->projs.end())
+    {
+      for (int i = 0; i < nv; i++)
+      {
+        coeffs[i][0] = e->vn[i]->x;
+        coeffs[i][1] = e->vn[i]->y;
+      }
+      memcpy(coeffs + nv, it->second, sizeof(double2) * (nc - nv));
+      return;
+    }
+  }
+
   Nurbs** nurbs;
   if (toplevel == false)
   {
@@ -573,6 +649,10 @@ void CurvMap::update_refmap_coeffs(Element* e)
 
   // calculation of new projection coefficients
   ref_map_projection(e, nurbs, order, coeffs);
+
+  double2* proj = new double2[nc - nv];
+  memcpy(proj, coeffs + nv, sizeof(double2) * (nc - nv));
+  base_cache->projs[key] = proj;
 }
 
 void CurvMap::get_mid_edge_points(Element* e, double2* pt, int n)
@@ -619,9 +699,17 @@ CurvMap::CurvMap(CurvMap* cm)
   memcpy(coeffs, cm->coeffs, sizeof(double2) * nc);
 
   if (toplevel)
+  {
     for (int i = 0; i < 4; i++)
       if (nurbs[i] != NULL)
         nurbs[i]->ref++;
+
+    // the copy has the same geometry, share the projections
+    if (cache != NULL)
+      cache->ref++;
+  }
+  else
+    cache = NULL;
 }
 
 CurvMap::~CurvMap()
@@ -632,7 +720,12 @@ CurvMap::~CurvMap()
     coeffs = NULL;
   }
   if (toplevel)
+  {
     for (int i = 0; i < 4; i++)
       if (nurbs[i] != NULL)
         nurbs[i]->unref();
+
+    if (cache != NULL && !--cache->ref)
+      delete cache;
+  }
 }
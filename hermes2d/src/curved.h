@@ -19,6 +19,7 @@
 #include "h2d_common.h"
 
 struct Element;
+struct CurvMapCache;
 
 
 /// \brief Represents one NURBS curve.
@@ -53,7 +54,7 @@ struct Nurbs
 ///
 struct CurvMap
 {
-  CurvMap() { coeffs = NULL; };
+  CurvMap() { coeffs = NULL; cache = NULL; };
   CurvMap(CurvMap* cm);
   ~CurvMap();
 
@@ -82,11 +83,18 @@ struct CurvMap
   int nc; // number of coefficients (todo: mozna spis polyn. rad zobrazeni)
   double2* coeffs; // array of the coefficients
 
+  // projections of the curved geometry already calculated for this base
+  // element, keyed by the refinement path ('part') and the order; only
+  // used if toplevel=true, shared by the copies of the element
+  CurvMapCache* cache;
+
   // this is called for every curvilinear element when it is created
   // or when it is necessary to re-calculate coefficients for another
   // order: 'e' is a pointer to the element to which this CurvMap
   // belongs to. First, old "coeffs" are removed if they are not NULL,
-  // then new coefficients are projected.
+  // then new coefficients are projected. The edge and bubble coefficients
+  // are taken from the cache of the base element if the same son has been
+  // projected before (in this mesh or in any of its copies).
   void update_refmap_coeffs(Element* e);
 
   void get_mid_edge_points(Element* e, double2* pt, int n);
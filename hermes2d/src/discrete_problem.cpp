@@ -72,6 +72,7 @@ DiscreteProblem::DiscreteProblem(WeakForm* wf, Tuple<Space *> spaces, bool is_li
   matrix_buffer = NULL;
   matrix_buffer_dim = 0;
   have_matrix = false;
+  scratch = NULL;
   values_changed = true;
   struct_changed = true;
 
@@ -162,6 +163,7 @@ bool DiscreteProblem::is_up_to_date()
 void DiscreteProblem::create(SparseMatrix* mat, Vector* rhs, bool rhsonly)
 {
   _F_
+  HERMES_PERF_SCOPE("create_sparse_structure");
 
   if (is_up_to_date())
   {
@@ -340,6 +342,7 @@ void DiscreteProblem::assemble(scalar* coeff_vec, SparseMatrix* mat, Vector* rhs
   /* BEGIN IDENTICAL CODE WITH H3D */
 
 	_F_
+  HERMES_PERF_SCOPE("assemble");
   // Sanity checks.
   if (coeff_vec == NULL && this->is_linear == false) error("coeff_vec is NULL in DiscreteProblem::assemble().");
   if (!have_spaces) error("You have to call DiscreteProblem::set_spaces() before calling assemble().");
@@ -372,6 +375,7 @@ void DiscreteProblem::assemble(scalar* coeff_vec, SparseMatrix* mat, Vector* rhs
   AUTOLA_OR(bool, isempty, wf->get_neq());
   AsmList *am, *an;
   reset_warn_order();
+  scratch = ScratchArena::get_thread_arena();
 
   int marker;
 
@@ -393,8 +397,7 @@ void DiscreteProblem::assemble(scalar* coeff_vec, SparseMatrix* mat, Vector* rhs
   if (mat != NULL) get_matrix_buffer(9);
 
   // obtain a list of assembling stages
-  std::vector<WeakForm::Stage> stages;
-  wf->get_stages(spaces, this->is_linear ? NULL : u_ext, stages, rhsonly);
+  std::vector<WeakForm::Stage>& stages = wf->get_stages(spaces, this->is_linear ? NULL : u_ext, rhsonly);
 
   // Loop through all assembling stages -- the purpose of this is increased performance
   // in multi-mesh calculations, where, e.g., only the right hand side uses two meshes.
@@ -455,17 +458,17 @@ void DiscreteProblem::assemble(scalar* coeff_vec, SparseMatrix* mat, Vector* rhs
       }
       // Boundary marker.
       marker = e0->marker;
+      const WeakForm::Stage::FormList& vol_forms = wf->get_vol_forms(s, marker);
 
       init_cache();     // This is different in H2D.
 
       //// assemble volume matrix forms //////////////////////////////////////
       if (mat != NULL)
       {
-        for (unsigned ww = 0; ww < s->mfvol.size(); ww++)
+        for (unsigned ww = 0; ww < vol_forms.mfvol.size(); ww++)
         {
-          WeakForm::MatrixFormVol* mfv = s->mfvol[ww];
+          WeakForm::MatrixFormVol* mfv = vol_forms.mfvol[ww];
           if (isempty[mfv->i] || isempty[mfv->j]) continue;
-          if (mfv->area != HERMES_ANY && !wf->is_in_area(marker, mfv->area)) continue;
           int m = mfv->i;  
           int n = mfv->j;  
           fu = pss[n]; 
@@ -578,11 +581,10 @@ void DiscreteProblem::assemble(scalar* coeff_vec, SparseMatrix* mat, Vector* rhs
       //// assemble volume vector forms ////////////////////////////////////////
       if (rhs != NULL)
       {
-        for (unsigned int ww = 0; ww < s->vfvol.size(); ww++)
+        for (unsigned int ww = 0; ww < vol_forms.vfvol.size(); ww++)
         {
-          WeakForm::VectorFormVol* vfv = s->vfvol[ww];
+          WeakForm::VectorFormVol* vfv = vol_forms.vfvol[ww];
           if (isempty[vfv->i]) continue;
-          if (vfv->area != HERMES_ANY && !wf->is_in_area(marker, vfv->area)) continue;
           int m = vfv->i;  
           fv = spss[m];    // H3D uses fv = test_fn + m;
           am = &(al[m]);
@@ -631,14 +633,13 @@ void DiscreteProblem::assemble(scalar* coeff_vec, SparseMatrix* mat, Vector* rhs
 
         if(bnd[isurf] == 1)  // Assemble boundary edges:
         {
+          const WeakForm::Stage::FormList& surf_forms = wf->get_surf_forms(s, marker);
           if (mat != NULL)
           {
-            for (unsigned int ww = 0; ww < s->mfsurf.size(); ww++)
+            for (unsigned int ww = 0; ww < surf_forms.mfsurf.size(); ww++)
             {
-              WeakForm::MatrixFormSurf* mfs = s->mfsurf[ww];
+              WeakForm::MatrixFormSurf* mfs = surf_forms.mfsurf[ww];
               if (isempty[mfs->i] || isempty[mfs->j]) continue;
-              if (mfs->area == H2D_DG_INNER_EDGE) continue;
-              if (mfs->area != HERMES_ANY && mfs->area != H2D_DG_BOUNDARY_EDGE && !wf->is_in_area(marker, mfs->area)) continue;
               int m = mfs->i;  
               int n = mfs->j;  
               fu = pss[n];      // This is different in H3D.
@@ -686,12 +687,10 @@ void DiscreteProblem::assemble(scalar* coeff_vec, SparseMatrix* mat, Vector* rhs
           // assemble surface vector forms /////////////////////////////////////
           if (rhs != NULL)
           {
-            for (unsigned int ww = 0; ww < s->vfsurf.size(); ww++)
+            for (unsigned int ww = 0; ww < surf_forms.vfsurf.size(); ww++)
             {
-              WeakForm::VectorFormSurf* vfs = s->vfsurf[ww];
+              WeakForm::VectorFormSurf* vfs = surf_forms.vfsurf[ww];
               if (isempty[vfs->i]) continue;
-              if (vfs->area == H2D_DG_INNER_EDGE) continue;
-              if (vfs->area != HERMES_ANY && vfs->area != H2D_DG_BOUNDARY_EDGE && !wf->is_in_area(marker, vfs->area)) continue;
               int m = vfs->i;  
               fv = spss[m];        // This is different from H3D.  
               am = &(al[m]);
@@ -727,12 +726,11 @@ void DiscreteProblem::assemble(scalar* coeff_vec, SparseMatrix* mat, Vector* rhs
           if (mat != NULL)
           {
             // assemble inner surface bilinear forms ///////////////////////////////////
-            for (unsigned int ww = 0; ww < s->mfsurf.size(); ww++)
+            for (unsigned int ww = 0; ww < s->inner_forms.mfsurf.size(); ww++)
             {        
-              WeakForm::MatrixFormSurf* mfs = s->mfsurf[ww];
+              WeakForm::MatrixFormSurf* mfs = s->inner_forms.mfsurf[ww];
               
               if (isempty[mfs->i] || isempty[mfs->j]) continue;         
-              if (mfs->area != H2D_DG_INNER_EDGE) continue;
               
               int m = mfs->i;    
               int n = mfs->j;
@@ -824,12 +822,11 @@ void DiscreteProblem::assemble(scalar* coeff_vec, SparseMatrix* mat, Vector* rhs
           
           if (rhs != NULL)
           {
-            for (unsigned int ww = 0; ww < s->vfsurf.size(); ww++)
+            for (unsigned int ww = 0; ww < s->inner_forms.vfsurf.size(); ww++)
             {
-              WeakForm::VectorFormSurf* vfs = s->vfsurf[ww];
+              WeakForm::VectorFormSurf* vfs = s->inner_forms.vfsurf[ww];
               
               if (isempty[vfs->i]) continue;
-              if (vfs->area != H2D_DG_INNER_EDGE) continue;
               
               int m = vfs->i;
               am = &(al[m]);
@@ -837,6 +834,7 @@ void DiscreteProblem::assemble(scalar* coeff_vec, SparseMatrix* mat, Vector* rhs
               // Find all neighbors of active element across active edge and partition it into segements
               // shared by the active element and distinct neighbors.
               NeighborSearch::MainKey nbs_key_m(e0->id, isurf);
+              HERMES_PERF_CACHE_HIT("neighbor_search", NeighborSearch::main_cache_m[nbs_key_m] != NULL);
               if (NeighborSearch::main_cache_m[nbs_key_m] == NULL)
               {
                 NeighborSearch::main_cache_m[nbs_key_m] = new NeighborSearch(e0, this->get_space(0)->get_mesh());
@@ -917,11 +915,11 @@ void DiscreteProblem::assemble(scalar* coeff_vec, SparseMatrix* mat, Vector* rhs
 ExtData<Ord>* DiscreteProblem::init_ext_fns_ord(std::vector<MeshFunction *> &ext)
 {
   _F_
-  ExtData<Ord>* fake_ext = new ExtData<Ord>;
+  ExtData<Ord>* fake_ext = new (scratch) ExtData<Ord>;
   fake_ext->nf = ext.size();
-  Func<Ord>** fake_ext_fn = new Func<Ord>*[fake_ext->nf];
+  Func<Ord>** fake_ext_fn = new (scratch) Func<Ord>*[fake_ext->nf];
   for (int i = 0; i < fake_ext->nf; i++)
-    fake_ext_fn[i] = init_fn_ord(ext[i]->get_fn_order());
+    fake_ext_fn[i] = init_fn_ord(ext[i]->get_fn_order(), scratch);
   fake_ext->fn = fake_ext_fn;
 
   return fake_ext;
@@ -931,10 +929,10 @@ ExtData<Ord>* DiscreteProblem::init_ext_fns_ord(std::vector<MeshFunction *> &ext
 ExtData<scalar>* DiscreteProblem::init_ext_fns(std::vector<MeshFunction *> &ext, RefMap *rm, const int order)
 {
   _F_
-  ExtData<scalar>* ext_data = new ExtData<scalar>;
-  Func<scalar>** ext_fn = new Func<scalar>*[ext.size()];
+  ExtData<scalar>* ext_data = new (scratch) ExtData<scalar>;
+  Func<scalar>** ext_fn = new (scratch) Func<scalar>*[ext.size()];
   for (unsigned i = 0; i < ext.size(); i++) {
-    if (ext[i] != NULL) ext_fn[i] = init_fn(ext[i], rm, order);
+    if (ext[i] != NULL) ext_fn[i] = init_fn(ext[i], rm, order, scratch);
     else ext_fn[i] = NULL;
   }
   ext_data->nf = ext.size();
@@ -948,11 +946,11 @@ ExtData<scalar>* DiscreteProblem::init_ext_fns(std::vector<MeshFunction *> &ext,
 ExtData<Ord>* DiscreteProblem::init_ext_fns_ord(std::vector<MeshFunction *> &ext, int edge)
 {
   _F_
-  ExtData<Ord>* fake_ext = new ExtData<Ord>;
+  ExtData<Ord>* fake_ext = new (scratch) ExtData<Ord>;
   fake_ext->nf = ext.size();
-  Func<Ord>** fake_ext_fn = new Func<Ord>*[fake_ext->nf];
+  Func<Ord>** fake_ext_fn = new (scratch) Func<Ord>*[fake_ext->nf];
   for (int i = 0; i < fake_ext->nf; i++)
-    fake_ext_fn[i] = init_fn_ord(ext[i]->get_edge_fn_order(edge));
+    fake_ext_fn[i] = init_fn_ord(ext[i]->get_edge_fn_order(edge), scratch);
   fake_ext->fn = fake_ext_fn;
   
   return fake_ext;
@@ -962,11 +960,11 @@ ExtData<Ord>* DiscreteProblem::init_ext_fns_ord(std::vector<MeshFunction *> &ext
 // supplied NeighborSearch's active edge).
 ExtData<scalar>* DiscreteProblem::init_ext_fns(std::vector<MeshFunction *> &ext, NeighborSearch* nbs)
 {  
-  Func<scalar>** ext_fns = new Func<scalar>*[ext.size()];
+  Func<scalar>** ext_fns = new (scratch) Func<scalar>*[ext.size()];
   for(int j = 0; j < ext.size(); j++)
-    ext_fns[j] = nbs->init_ext_fn(ext[j]);
+    ext_fns[j] = nbs->init_ext_fn(ext[j], scratch);
   
-  ExtData<scalar>* ext_data = new ExtData<scalar>;
+  ExtData<scalar>* ext_data = new (scratch) ExtData<scalar>;
   ext_data->fn = ext_fns;
   ext_data->nf = ext.size();
   
@@ -976,11 +974,11 @@ ExtData<scalar>* DiscreteProblem::init_ext_fns(std::vector<MeshFunction *> &ext,
 // Initialize integration order for discontinuous external functions.
 ExtData<Ord>* DiscreteProblem::init_ext_fns_ord(std::vector<MeshFunction *> &ext, NeighborSearch* nbs)
 { 
-  Func<Ord>** fake_ext_fns = new Func<Ord>*[ext.size()];
+  Func<Ord>** fake_ext_fns = new (scratch) Func<Ord>*[ext.size()];
   for (int j = 0; j < ext.size(); j++)
-    fake_ext_fns[j] = nbs->init_ext_fn_ord(ext[j]);
+    fake_ext_fns[j] = nbs->init_ext_fn_ord(ext[j], scratch);
   
-  ExtData<Ord>* fake_ext = new ExtData<Ord>;
+  ExtData<Ord>* fake_ext = new (scratch) ExtData<Ord>;
   fake_ext->fn = fake_ext_fns;
   fake_ext->nf = ext.size();
   
@@ -993,7 +991,7 @@ Func<double>* DiscreteProblem::get_fn(PrecalcShapeset *fu, RefMap *rm, const int
   _F_
   PrecalcShapeset::Key key(256 - fu->get_active_shape(), order, fu->get_transform(), fu->get_shapeset()->get_id());
   if (cache_fn[key] == NULL)
-    cache_fn[key] = init_fn(fu, rm, order);
+    cache_fn[key] = init_fn(fu, rm, order, &cache_arena);
 
   return cache_fn[key];
 }
@@ -1012,19 +1010,9 @@ void DiscreteProblem::init_cache()
 void DiscreteProblem::delete_cache()
 {
   _F_
-  for (int i = 0; i < g_max_quad + 1 + 4 * g_max_quad + 4; i++)
-  {
-    if (cache_e[i] != NULL)
-    {
-      cache_e[i]->free(); delete cache_e[i];
-      delete [] cache_jwt[i];
-    }
-  }
-  for (std::map<PrecalcShapeset::Key, Func<double>*, PrecalcShapeset::Compare>::const_iterator it = cache_fn.begin(); it != cache_fn.end(); it++)
-  {
-    (it->second)->free_fn(); delete (it->second);
-  }
+  // the cached values are allocated from cache_arena
   cache_fn.clear();
+  cache_arena.reset();
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1034,6 +1022,8 @@ scalar DiscreteProblem::eval_form(WeakForm::MatrixFormVol *mfv, Tuple<Solution *
                         PrecalcShapeset *fu, PrecalcShapeset *fv, RefMap *ru, RefMap *rv)
 {
   _F_
+  HERMES_PERF_SCOPE("eval_form");
+  ScratchScope scratch_scope(scratch);
   // Determine the integration order.
   int order;
   if(this->is_fvm)
@@ -1045,24 +1035,24 @@ scalar DiscreteProblem::eval_form(WeakForm::MatrixFormVol *mfv, Tuple<Solution *
     AUTOLA_OR(Func<Ord>*, oi, wf->get_neq());
     if (u_ext != Tuple<Solution *>()) {
       for (int i = 0; i < wf->get_neq(); i++) {
-        if (u_ext[i] != NULL) oi[i] = init_fn_ord(u_ext[i]->get_fn_order() + inc);
-        else oi[i] = init_fn_ord(0);
+        if (u_ext[i] != NULL) oi[i] = init_fn_ord(u_ext[i]->get_fn_order() + inc, scratch);
+        else oi[i] = init_fn_ord(0, scratch);
       }
     }
     else {
-      for (int i = 0; i < wf->get_neq(); i++) oi[i] = init_fn_ord(0);
+      for (int i = 0; i < wf->get_neq(); i++) oi[i] = init_fn_ord(0, scratch);
     }
     
     // Order of shape functions.
-    Func<Ord>* ou = init_fn_ord(fu->get_fn_order() + inc);
-    Func<Ord>* ov = init_fn_ord(fv->get_fn_order() + inc);
+    Func<Ord>* ou = init_fn_ord(fu->get_fn_order() + inc, scratch);
+    Func<Ord>* ov = init_fn_ord(fv->get_fn_order() + inc, scratch);
     
     // Order of additional external functions.
     ExtData<Ord>* fake_ext = init_ext_fns_ord(mfv->ext);
     
     // Order of geometric attributes (eg. for multiplication of a solution with coordinates, normals, etc.).
     double fake_wt = 1.0;
-    Geom<Ord>* fake_e = init_geom_ord();
+    Geom<Ord>* fake_e = init_geom_ord(scratch);
     
     // Total order of the matrix form.
     Ord o = mfv->ord(1, &fake_wt, oi, ou, ov, fake_e, fake_ext);
@@ -1071,19 +1061,6 @@ scalar DiscreteProblem::eval_form(WeakForm::MatrixFormVol *mfv, Tuple<Solution *
     order = ru->get_inv_ref_order();
     order += o.get_order();
     limit_order_nowarn(order);
-    
-    // Clean up.
-    for (int i = 0; i < wf->get_neq(); i++) {  
-      if (oi[i] != NULL) { oi[i]->free_ord(); delete oi[i]; }
-    }
-    if (ou != NULL) {
-      ou->free_ord(); delete ou;
-    }
-    if (ov != NULL) {
-      ov->free_ord(); delete ov;
-    }
-    if (fake_e != NULL) delete fake_e;
-    if (fake_ext != NULL) {fake_ext->free_ord(); delete fake_ext;}
   }
 
   // Evaluate the form using the quadrature of the just calculated order.
@@ -1094,9 +1071,9 @@ scalar DiscreteProblem::eval_form(WeakForm::MatrixFormVol *mfv, Tuple<Solution *
   // Init geometry and jacobian*weights.
   if (cache_e[order] == NULL)
   {
-    cache_e[order] = init_geom_vol(ru, order);
+    cache_e[order] = init_geom_vol(ru, order, &cache_arena);
     double* jac = ru->get_jacobian(order);
-    cache_jwt[order] = new double[np];
+    cache_jwt[order] = new (&cache_arena) double[np];
     for(int i = 0; i < np; i++)
       cache_jwt[order][i] = pt[i][2] * jac[i];
   }
@@ -1108,7 +1085,7 @@ scalar DiscreteProblem::eval_form(WeakForm::MatrixFormVol *mfv, Tuple<Solution *
   //for (int i = 0; i < wf->get_neq(); i++) prev[i]  = init_fn(u_ext[i], rv, order);
   if (u_ext != Tuple<Solution *>()) {
     for (int i = 0; i < wf->get_neq(); i++) {
-      if (u_ext[i] != NULL) prev[i] = init_fn(u_ext[i], rv, order);
+      if (u_ext[i] != NULL) prev[i] = init_fn(u_ext[i], rv, order, scratch);
       else prev[i] = NULL;
     }
   }
@@ -1121,12 +1098,6 @@ scalar DiscreteProblem::eval_form(WeakForm::MatrixFormVol *mfv, Tuple<Solution *
   ExtData<scalar>* ext = init_ext_fns(mfv->ext, rv, order);
   
   scalar res = mfv->fn(np, jwt, prev, u, v, e, ext);
-  
-  // Clean up.
-  for (int i = 0; i < wf->get_neq(); i++) {  
-    if (prev[i] != NULL) prev[i]->free_fn(); delete prev[i]; 
-  }
-  if (ext != NULL) {ext->free(); delete ext;}
 
   return res;
 }
@@ -1135,6 +1106,8 @@ scalar DiscreteProblem::eval_form(WeakForm::MatrixFormVol *mfv, Tuple<Solution *
 scalar DiscreteProblem::eval_form(WeakForm::VectorFormVol *vfv, Tuple<Solution *> u_ext, PrecalcShapeset *fv, RefMap *rv)
 {
   _F_
+  HERMES_PERF_SCOPE("eval_form");
+  ScratchScope scratch_scope(scratch);
   // Determine the integration order.
   int order;
   if(this->is_fvm)
@@ -1147,23 +1120,23 @@ scalar DiscreteProblem::eval_form(WeakForm::VectorFormVol *vfv, Tuple<Solution *
     //for (int i = 0; i < wf->get_neq(); i++) oi[i] = init_fn_ord(u_ext[i]->get_fn_order() + inc);
     if (u_ext != Tuple<Solution *>()) {
       for (int i = 0; i < wf->get_neq(); i++) {
-        if (u_ext[i] != NULL) oi[i] = init_fn_ord(u_ext[i]->get_fn_order() + inc);
-        else oi[i] = init_fn_ord(0);
+        if (u_ext[i] != NULL) oi[i] = init_fn_ord(u_ext[i]->get_fn_order() + inc, scratch);
+        else oi[i] = init_fn_ord(0, scratch);
       }
     }
     else {
-      for (int i = 0; i < wf->get_neq(); i++) oi[i] = init_fn_ord(0);
+      for (int i = 0; i < wf->get_neq(); i++) oi[i] = init_fn_ord(0, scratch);
     }
     
     // Order of the shape function.
-    Func<Ord>* ov = init_fn_ord(fv->get_fn_order() + inc);
+    Func<Ord>* ov = init_fn_ord(fv->get_fn_order() + inc, scratch);
     
     // Order of additional external functions.
     ExtData<Ord>* fake_ext = init_ext_fns_ord(vfv->ext);
     
     // Order of geometric attributes (eg. for multiplication of a solution with coordinates, normals, etc.).
     double fake_wt = 1.0;
-    Geom<Ord>* fake_e = init_geom_ord();
+    Geom<Ord>* fake_e = init_geom_ord(scratch);
     
     // Total order of the vector form.
     Ord o = vfv->ord(1, &fake_wt, oi, ov, fake_e, fake_ext);
@@ -1172,16 +1145,6 @@ scalar DiscreteProblem::eval_form(WeakForm::VectorFormVol *vfv, Tuple<Solution *
     order = rv->get_inv_ref_order();
     order += o.get_order();
     limit_order_nowarn(order);
-
-    // Clean up.
-    for (int i = 0; i < wf->get_neq(); i++) { 
-      if (oi[i] != NULL) {
-        oi[i]->free_ord(); delete oi[i]; 
-      }
-    }
-    if (ov != NULL) {ov->free_ord(); delete ov;}
-    if (fake_e != NULL) delete fake_e;
-    if (fake_ext != NULL) {fake_ext->free_ord(); delete fake_ext;}
   }
 
   // Evaluate the form using the quadrature of the just calculated order.
@@ -1192,9 +1155,9 @@ scalar DiscreteProblem::eval_form(WeakForm::VectorFormVol *vfv, Tuple<Solution *
   // Init geometry and jacobian*weights.
   if (cache_e[order] == NULL)
   {
-    cache_e[order] = init_geom_vol(rv, order);
+    cache_e[order] = init_geom_vol(rv, order, &cache_arena);
     double* jac = rv->get_jacobian(order);
-    cache_jwt[order] = new double[np];
+    cache_jwt[order] = new (&cache_arena) double[np];
     for(int i = 0; i < np; i++)
       cache_jwt[order][i] = pt[i][2] * jac[i];
   }
@@ -1206,7 +1169,7 @@ scalar DiscreteProblem::eval_form(WeakForm::VectorFormVol *vfv, Tuple<Solution *
   //for (int i = 0; i < wf->get_neq(); i++) prev[i]  = init_fn(u_ext[i], rv, order);
   if (u_ext != Tuple<Solution *>()) {
     for (int i = 0; i < wf->get_neq(); i++) {
-      if (u_ext[i] != NULL) prev[i]  = init_fn(u_ext[i], rv, order);
+      if (u_ext[i] != NULL) prev[i]  = init_fn(u_ext[i], rv, order, scratch);
       else prev[i] = NULL;
     }
   }
@@ -1219,14 +1182,6 @@ scalar DiscreteProblem::eval_form(WeakForm::VectorFormVol *vfv, Tuple<Solution *
 
   scalar res = vfv->fn(np, jwt, prev, v, e, ext);
 
-  // Clean up.
-  for (int i = 0; i < wf->get_neq(); i++) { 
-    if (prev[i] != NULL) {
-      prev[i]->free_fn(); delete prev[i]; 
-    }
-  }
-  if (ext != NULL) {ext->free(); delete ext;}
-  
   return res;
 }
 
@@ -1235,6 +1190,8 @@ scalar DiscreteProblem::eval_form(WeakForm::MatrixFormSurf *mfs, Tuple<Solution
                         PrecalcShapeset *fu, PrecalcShapeset *fv, RefMap *ru, RefMap *rv, SurfPos* surf_pos)
 {
   _F_
+  HERMES_PERF_SCOPE("eval_form");
+  ScratchScope scratch_scope(scratch);
   // Determine the integration order.
   int order;
   if(this->is_fvm)
@@ -1247,24 +1204,24 @@ scalar DiscreteProblem::eval_form(WeakForm::MatrixFormSurf *mfs, Tuple<Solution
     //for (int i = 0; i < wf->get_neq(); i++) oi[i] = init_fn_ord(u_ext[i]->get_fn_order() + inc);
     if (u_ext != Tuple<Solution *>()) {
       for (int i = 0; i < wf->get_neq(); i++) {
-        if (u_ext[i] != NULL) oi[i] = init_fn_ord(u_ext[i]->get_edge_fn_order(surf_pos->surf_num) + inc);
-        else oi[i] = init_fn_ord(0);
+        if (u_ext[i] != NULL) oi[i] = init_fn_ord(u_ext[i]->get_edge_fn_order(surf_pos->surf_num) + inc, scratch);
+        else oi[i] = init_fn_ord(0, scratch);
       }
     }
     else {
-      for (int i = 0; i < wf->get_neq(); i++) oi[i] = init_fn_ord(0);
+      for (int i = 0; i < wf->get_neq(); i++) oi[i] = init_fn_ord(0, scratch);
     }
     
     // Order of shape functions.
-    Func<Ord>* ou = init_fn_ord(fu->get_edge_fn_order(surf_pos->surf_num) + inc);
-    Func<Ord>* ov = init_fn_ord(fv->get_edge_fn_order(surf_pos->surf_num) + inc);
+    Func<Ord>* ou = init_fn_ord(fu->get_edge_fn_order(surf_pos->surf_num) + inc, scratch);
+    Func<Ord>* ov = init_fn_ord(fv->get_edge_fn_order(surf_pos->surf_num) + inc, scratch);
     
     // Order of additional external functions.
     ExtData<Ord>* fake_ext = init_ext_fns_ord(mfs->ext, surf_pos->surf_num);
     
     // Order of geometric attributes (eg. for multiplication of a solution with coordinates, normals, etc.).
     double fake_wt = 1.0;
-    Geom<Ord>* fake_e = init_geom_ord();
+    Geom<Ord>* fake_e = init_geom_ord(scratch);
     
     // Total order of the matrix form.
     Ord o = mfs->ord(1, &fake_wt, oi, ou, ov, fake_e, fake_ext);
@@ -1274,19 +1231,6 @@ scalar DiscreteProblem::eval_form(WeakForm::MatrixFormSurf *mfs, Tuple<Solution
     
     order += o.get_order();
     limit_order_nowarn(order);
-    
-    // Clean up.
-    for (int i = 0; i < wf->get_neq(); i++) {  
-      if (oi[i] != NULL) { oi[i]->free_ord(); delete oi[i]; }
-    }
-    if (ou != NULL) {
-      ou->free_ord(); delete ou;
-    }
-    if (ov != NULL) {
-      ov->free_ord(); delete ov;
-    }
-    if (fake_e != NULL) delete fake_e;
-    if (fake_ext != NULL) {fake_ext->free_ord(); delete fake_ext;}
   }
   
   // Evaluate the form using the quadrature of the just calculated order.
@@ -1299,9 +1243,9 @@ scalar DiscreteProblem::eval_form(WeakForm::MatrixFormSurf *mfs, Tuple<Solution
   // Init geometry and jacobian*weights.
   if (cache_e[eo] == NULL)
   {
-    cache_e[eo] = init_geom_surf(ru, surf_pos, eo);
+    cache_e[eo] = init_geom_surf(ru, surf_pos, eo, &cache_arena);
     double3* tan = ru->get_tangent(surf_pos->surf_num, eo);
-    cache_jwt[eo] = new double[np];
+    cache_jwt[eo] = new (&cache_arena) double[np];
     for(int i = 0; i < np; i++)
       cache_jwt[eo][i] = pt[i][2] * tan[i][2];
   }
@@ -1313,7 +1257,7 @@ scalar DiscreteProblem::eval_form(WeakForm::MatrixFormSurf *mfs, Tuple<Solution
   //for (int i = 0; i < wf->get_neq(); i++) prev[i]  = init_fn(u_ext[i], rv, eo);
   if (u_ext != Tuple<Solution *>()) {
     for (int i = 0; i < wf->get_neq(); i++) {
-      if (u_ext[i] != NULL) prev[i]  = init_fn(u_ext[i], rv, eo);
+      if (u_ext[i] != NULL) prev[i]  = init_fn(u_ext[i], rv, eo, scratch);
       else prev[i] = NULL;
     }
   }
@@ -1327,14 +1271,6 @@ scalar DiscreteProblem::eval_form(WeakForm::MatrixFormSurf *mfs, Tuple<Solution
 
   scalar res = mfs->fn(np, jwt, prev, u, v, e, ext);
 
-  // Clean up.
-  for (int i = 0; i < wf->get_neq(); i++) { 
-    if (prev[i] != NULL) {
-      prev[i]->free_fn(); delete prev[i]; 
-    }
-  }
-  if (ext != NULL) {ext->free(); delete ext;}
-  
   return 0.5 * res; // Edges are parameterized from 0 to 1 while integration weights
                     // are defined in (-1, 1). Thus multiplying with 0.5 to correct
                     // the weights.
@@ -1345,6 +1281,8 @@ scalar DiscreteProblem::eval_form(WeakForm::VectorFormSurf *vfs, Tuple<Solution
                         PrecalcShapeset *fv, RefMap *rv, SurfPos* surf_pos)
 {
   _F_
+  HERMES_PERF_SCOPE("eval_form");
+  ScratchScope scratch_scope(scratch);
   // Determine the integration order.
   int order;
   if(this->is_fvm)
@@ -1357,23 +1295,23 @@ scalar DiscreteProblem::eval_form(WeakForm::VectorFormSurf *vfs, Tuple<Solution
     //for (int i = 0; i < wf->get_neq(); i++) oi[i] = init_fn_ord(u_ext[i]->get_fn_order() + inc);
     if (u_ext != Tuple<Solution *>()) {
       for (int i = 0; i < wf->get_neq(); i++) {
-        if (u_ext[i] != NULL) oi[i] = init_fn_ord(u_ext[i]->get_edge_fn_order(surf_pos->surf_num) + inc);
-        else oi[i] = init_fn_ord(0);
+        if (u_ext[i] != NULL) oi[i] = init_fn_ord(u_ext[i]->get_edge_fn_order(surf_pos->surf_num) + inc, scratch);
+        else oi[i] = init_fn_ord(0, scratch);
       }
     }
     else {
-      for (int i = 0; i < wf->get_neq(); i++) oi[i] = init_fn_ord(0);
+      for (int i = 0; i < wf->get_neq(); i++) oi[i] = init_fn_ord(0, scratch);
     }
     
     // Order of the shape function.
-    Func<Ord>* ov = init_fn_ord(fv->get_edge_fn_order(surf_pos->surf_num) + inc);
+    Func<Ord>* ov = init_fn_ord(fv->get_edge_fn_order(surf_pos->surf_num) + inc, scratch);
     
     // Order of additional external functions.
     ExtData<Ord>* fake_ext = init_ext_fns_ord(vfs->ext, surf_pos->surf_num);
     
     // Order of geometric attributes (eg. for multiplication of a solution with coordinates, normals, etc.).
     double fake_wt = 1.0;
-    Geom<Ord>* fake_e = init_geom_ord();
+    Geom<Ord>* fake_e = init_geom_ord(scratch);
     
     // Total order of the vector form.
     Ord o = vfs->ord(1, &fake_wt, oi, ov, fake_e, fake_ext);
@@ -1383,16 +1321,6 @@ scalar DiscreteProblem::eval_form(WeakForm::VectorFormSurf *vfs, Tuple<Solution
     
     order += o.get_order();
     limit_order_nowarn(order);
-    
-    // Clean up.
-    for (int i = 0; i < wf->get_neq(); i++) { 
-      if (oi[i] != NULL) {
-        oi[i]->free_ord(); delete oi[i]; 
-      }
-    }
-    if (ov != NULL) {ov->free_ord(); delete ov;}
-    if (fake_e != NULL) delete fake_e;
-    if (fake_ext != NULL) {fake_ext->free_ord(); delete fake_ext;}
   }
   
   // Evaluate the form using the quadrature of the just calculated order.
@@ -1405,9 +1333,9 @@ scalar DiscreteProblem::eval_form(WeakForm::VectorFormSurf *vfs, Tuple<Solution
   // Init geometry and jacobian*weights.
   if (cache_e[eo] == NULL)
   {
-    cache_e[eo] = init_geom_surf(rv, surf_pos, eo);
+    cache_e[eo] = init_geom_surf(rv, surf_pos, eo, &cache_arena);
     double3* tan = rv->get_tangent(surf_pos->surf_num, eo);
-    cache_jwt[eo] = new double[np];
+    cache_jwt[eo] = new (&cache_arena) double[np];
     for(int i = 0; i < np; i++)
       cache_jwt[eo][i] = pt[i][2] * tan[i][2];
   }
@@ -1419,7 +1347,7 @@ scalar DiscreteProblem::eval_form(WeakForm::VectorFormSurf *vfs, Tuple<Solution
   //for (int i = 0; i < wf->get_neq(); i++) prev[i]  = init_fn(u_ext[i], rv, eo);
   if (u_ext != Tuple<Solution *>()) {
     for (int i = 0; i < wf->get_neq(); i++) {
-      if (u_ext[i] != NULL) prev[i]  = init_fn(u_ext[i], rv, eo);
+      if (u_ext[i] != NULL) prev[i]  = init_fn(u_ext[i], rv, eo, scratch);
       else prev[i] = NULL;
     }
   }
@@ -1432,12 +1360,6 @@ scalar DiscreteProblem::eval_form(WeakForm::VectorFormSurf *vfs, Tuple<Solution
 
   scalar res = vfs->fn(np, jwt, prev, v, e, ext);
 
-  for (int i = 0; i < wf->get_neq(); i++) {  
-    if (prev[i] != NULL) {prev[i]->free_fn(); delete prev[i]; }
-  }
-  if (ext != NULL) {ext->free(); delete ext;}
-  
-  // Clean up.
   return 0.5 * res; // Edges are parameterized from 0 to 1 while integration weights
                     // are defined in (-1, 1). Thus multiplying with 0.5 to correct
                     // the weights.
@@ -1448,6 +1370,8 @@ scalar DiscreteProblem::eval_dg_form(WeakForm::MatrixFormSurf* mfs, Tuple<Soluti
                                      ExtendedShapeFnPtr efu, ExtendedShapeFnPtr efv, 
                                      SurfPos* surf_pos)
 { 
+  HERMES_PERF_SCOPE("eval_form");
+  ScratchScope scratch_scope(scratch);
   // FIXME for treating a discontinuous previous Newton iteration.
   int order;
   if(this->is_fvm)
@@ -1459,24 +1383,24 @@ scalar DiscreteProblem::eval_dg_form(WeakForm::MatrixFormSurf* mfs, Tuple<Soluti
     //for (int i = 0; i < wf->get_neq(); i++) oi[i] = init_fn_ord(u_ext[i]->get_fn_order() + inc);
     if (u_ext != Tuple<Solution *>()) {
       for (int i = 0; i < wf->get_neq(); i++) {
-        if (u_ext[i] != NULL) oi[i] = nbs_u->init_ext_fn_ord(u_ext[i]);
-        else oi[i] = init_fn_ord(0);
+        if (u_ext[i] != NULL) oi[i] = nbs_u->init_ext_fn_ord(u_ext[i], scratch);
+        else oi[i] = init_fn_ord(0, scratch);
       }
     }
     else {
-      for (int i = 0; i < wf->get_neq(); i++) oi[i] = init_fn_ord(0);
+      for (int i = 0; i < wf->get_neq(); i++) oi[i] = init_fn_ord(0, scratch);
     }
     
     // Order of shape functions.
-    DiscontinuousFunc<Ord>* ou = efu->get_fn_ord();
-    DiscontinuousFunc<Ord>* ov = efv->get_fn_ord();
+    DiscontinuousFunc<Ord>* ou = efu->get_fn_ord(scratch);
+    DiscontinuousFunc<Ord>* ov = efv->get_fn_ord(scratch);
     
     // Order of additional external functions.
     ExtData<Ord>* fake_ext = init_ext_fns_ord(mfs->ext, nbs_v);  
     
     // Order of geometric attributes (eg. for multiplication of a solution with coordinates, normals, etc.).
     Element *neighb_el = nbs_v->get_current_neighbor_element();
-    Geom<Ord>* fake_e = new InterfaceGeom<Ord>(init_geom_ord(), neighb_el->marker, neighb_el->id, neighb_el->get_diameter());
+    Geom<Ord>* fake_e = new (scratch) InterfaceGeom<Ord>(init_geom_ord(scratch), neighb_el->marker, neighb_el->id, neighb_el->get_diameter());
     double fake_wt = 1.0;
 
     // Total order of the matrix form.
@@ -1488,19 +1412,6 @@ scalar DiscreteProblem::eval_dg_form(WeakForm::MatrixFormSurf* mfs, Tuple<Soluti
                         
     order += o.get_order();
     limit_order(order);
-    
-    // Clean up.
-    for (int i = 0; i < wf->get_neq(); i++) {  
-      if (oi[i] != NULL) { oi[i]->free_ord(); delete oi[i]; }
-    }
-    if (ou != NULL) {
-      ou->free_ord(); delete ou;
-    }
-    if (ov != NULL) {
-      ov->free_ord(); delete ov;
-    }
-    if (fake_e != NULL) delete fake_e;
-    if (fake_ext != NULL) {fake_ext->free_ord(); delete fake_ext;}
   }
   
   // Evaluate the form.
@@ -1508,15 +1419,15 @@ scalar DiscreteProblem::eval_dg_form(WeakForm::MatrixFormSurf* mfs, Tuple<Soluti
   nbs_v->set_quad_order(order);
   
   // Init geometry and jacobian*weights.
-  Geom<double>* e = nbs_u->init_geometry(cache_e, surf_pos);
-  double* jwt = nbs_u->init_jwt(cache_jwt);
+  Geom<double>* e = nbs_u->init_geometry(cache_e, surf_pos, &cache_arena);
+  double* jwt = nbs_u->init_jwt(cache_jwt, &cache_arena);
     
   // Values of the previous Newton iteration, shape functions and external functions in quadrature points.
   AUTOLA_OR(Func<scalar>*, prev, wf->get_neq());
   //for (int i = 0; i < wf->get_neq(); i++) prev[i]  = init_fn(u_ext[i], rv, eo);
   if (u_ext != Tuple<Solution *>()) {
     for (int i = 0; i < wf->get_neq(); i++) {
-      if (u_ext[i] != NULL) prev[i]  = nbs_v->init_ext_fn(u_ext[i]);
+      if (u_ext[i] != NULL) prev[i]  = nbs_v->init_ext_fn(u_ext[i], scratch);
       else prev[i] = NULL;
     }
   }
@@ -1525,26 +1436,12 @@ scalar DiscreteProblem::eval_dg_form(WeakForm::MatrixFormSurf* mfs, Tuple<Soluti
   }
   
   // Values of the previous Newton iteration, shape functions and external functions in quadrature points.
-  DiscontinuousFunc<double>* u = efu->get_fn(cache_fn);
-  DiscontinuousFunc<double>* v = efv->get_fn(cache_fn);
+  DiscontinuousFunc<double>* u = efu->get_fn(cache_fn, &cache_arena, scratch);
+  DiscontinuousFunc<double>* v = efv->get_fn(cache_fn, &cache_arena, scratch);
   ExtData<scalar>* ext = init_ext_fns(mfs->ext, nbs_v);
   
   scalar res = mfs->fn(nbs_v->get_quad_np(), jwt, prev, u, v, e, ext);
-  
-  // Clean up.
-  for (int i = 0; i < wf->get_neq(); i++) { 
-    if (prev[i] != NULL) {
-      prev[i]->free_fn(); delete prev[i]; 
-    }
-  }
-  if (ext != NULL) {ext->free(); delete ext;}
-  
-  // Delete the DiscontinuousFunctions. This does not clear their component functions (DiscontinuousFunc::free_fn()
-  // must be called in order to do that) as they are contained in cache_fn and may be used by another form - they
-  // will be cleared in DiscreteProblem::delete_cache.
-  delete u;
-  delete v;
-  
+
   return 0.5 * res; // Edges are parameterized from 0 to 1 while integration weights
                     // are defined in (-1, 1). Thus multiplying with 0.5 to correct
                     // the weights.
@@ -1557,6 +1454,8 @@ scalar DiscreteProblem::eval_dg_form(WeakForm::VectorFormSurf* vfs, Tuple<Soluti
                                      NeighborSearch* nbs_v, PrecalcShapeset *fv, RefMap *rv,
                                      SurfPos* surf_pos)
 { 
+  HERMES_PERF_SCOPE("eval_form");
+  ScratchScope scratch_scope(scratch);
   // FIXME for treating a discontinuous previous Newton iteration.
   int order;
   if(this->is_fvm)
@@ -1567,25 +1466,25 @@ scalar DiscreteProblem::eval_dg_form(WeakForm::VectorFormSurf* vfs, Tuple<Soluti
     //for (int i = 0; i < wf->get_neq(); i++) oi[i] = init_fn_ord(u_ext[i]->get_fn_order() + inc);
     if (u_ext != Tuple<Solution *>()) {
       for (int i = 0; i < wf->get_neq(); i++) {
-        if (u_ext[i] != NULL) oi[i] = nbs_v->init_ext_fn_ord(u_ext[i]);
-        else oi[i] = init_fn_ord(0);
+        if (u_ext[i] != NULL) oi[i] = nbs_v->init_ext_fn_ord(u_ext[i], scratch);
+        else oi[i] = init_fn_ord(0, scratch);
       }
     }
     else {
-      for (int i = 0; i < wf->get_neq(); i++) oi[i] = init_fn_ord(0);
+      for (int i = 0; i < wf->get_neq(); i++) oi[i] = init_fn_ord(0, scratch);
     }
     
     // Order of the shape function.
     // Determine the integration order.
     int inc = (fv->get_num_components() == 2) ? 1 : 0;
-    Func<Ord>* ov = init_fn_ord(fv->get_edge_fn_order(surf_pos->surf_num) + inc);
+    Func<Ord>* ov = init_fn_ord(fv->get_edge_fn_order(surf_pos->surf_num) + inc, scratch);
     
     // Order of additional external functions.
     ExtData<Ord>* fake_ext = init_ext_fns_ord(vfs->ext, nbs_v);
     
     // Order of geometric attributes (eg. for multiplication of a solution with coordinates, normals, etc.).
     Element *neighb_el = nbs_v->get_current_neighbor_element();
-    Geom<Ord>* fake_e = new InterfaceGeom<Ord>(init_geom_ord(), neighb_el->marker, neighb_el->id, neighb_el->get_diameter());
+    Geom<Ord>* fake_e = new (scratch) InterfaceGeom<Ord>(init_geom_ord(scratch), neighb_el->marker, neighb_el->id, neighb_el->get_diameter());
     double fake_wt = 1.0;
     
     // Total order of the vector form.
@@ -1595,31 +1494,21 @@ scalar DiscreteProblem::eval_dg_form(WeakForm::VectorFormSurf* vfs, Tuple<Soluti
     order = rv->get_inv_ref_order();
     order += o.get_order();
     limit_order(order);
-    
-    // Clean up.
-    for (int i = 0; i < wf->get_neq(); i++) { 
-      if (oi[i] != NULL) {
-        oi[i]->free_ord(); delete oi[i]; 
-      }
-    }
-    if (ov != NULL) {ov->free_ord(); delete ov;}
-    if (fake_e != NULL) delete fake_e;
-    if (fake_ext != NULL) {fake_ext->free_ord(); delete fake_ext;}
   }
   
   // Evaluate the form using the quadrature of the just calculated order.
   nbs_v->set_quad_order(order);
   
   // Init geometry and jacobian*weights.
-  Geom<double>* e = nbs_v->init_geometry(cache_e, surf_pos);
-  double* jwt = nbs_v->init_jwt(cache_jwt);
+  Geom<double>* e = nbs_v->init_geometry(cache_e, surf_pos, &cache_arena);
+  double* jwt = nbs_v->init_jwt(cache_jwt, &cache_arena);
   
   // Values of the previous Newton iteration, shape functions and external functions in quadrature points.
   AUTOLA_OR(Func<scalar>*, prev, wf->get_neq());
   //for (int i = 0; i < wf->get_neq(); i++) prev[i]  = init_fn(u_ext[i], rv, eo);
   if (u_ext != Tuple<Solution *>()) {
     for (int i = 0; i < wf->get_neq(); i++) {
-      if (u_ext[i] != NULL) prev[i]  = nbs_v->init_ext_fn(u_ext[i]);
+      if (u_ext[i] != NULL) prev[i]  = nbs_v->init_ext_fn(u_ext[i], scratch);
       else prev[i] = NULL;
     }
   }
@@ -1631,13 +1520,7 @@ scalar DiscreteProblem::eval_dg_form(WeakForm::VectorFormSurf* vfs, Tuple<Soluti
   ExtData<scalar>* ext = init_ext_fns(vfs->ext, nbs_v);
   
   scalar res = vfs->fn(nbs_v->get_quad_np(), jwt, prev, v, e, ext);
-  
-  for (int i = 0; i < wf->get_neq(); i++) {  
-    if (prev[i] != NULL) {prev[i]->free_fn(); delete prev[i]; }
-  }
-  if (ext != NULL) {ext->free(); delete ext;}
 
-  
   return 0.5 * res; // Edges are parametrized from 0 to 1 while integration weights
                     // are defined in (-1, 1). Thus multiplying with 0.5 to correct
                     // the weights.
@@ -1724,3 +1607,24 @@ bool solve_newton(scalar* coeff_vec, DiscreteProblem* dp, Solver* solver, Sparse
 
   return true;
 }
+
+bool solve_dual(DiscreteProblem* goal, Solver* solver, Vector* rhs, Tuple<Solution *> dual_slns)
+{
+  _F_
+  // J(v) for all basis functions v.
+  goal->assemble((SparseMatrix*) NULL, rhs);
+
+  // A^T z = J with the factorization of the primal problem.
+  if (!solver->solve_transposed(rhs)) return false;
+
+  // The dual problem has homogeneous Dirichlet conditions.
+  Tuple<Space *> spaces;
+  Tuple<bool> add_dir_lift;
+  for (int i = 0; i < dual_slns.size(); i++)
+  {
+    spaces.push_back(goal->get_space(i));
+    add_dir_lift.push_back(false);
+  }
+  Solution::vector_to_solutions(solver->get_solution(), spaces, dual_slns, add_dir_lift);
+  return true;
+}
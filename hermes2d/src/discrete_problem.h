@@ -215,6 +215,12 @@ protected:
   Geom<double>* cache_e[g_max_quad + 1 + 4 * g_max_quad + 4];
   double* cache_jwt[g_max_quad + 1 + 4 * g_max_quad + 4];
 
+  // Memory of the cached values, released at once in delete_cache().
+  ScratchArena cache_arena;
+  // Arena of the assembling thread for the temporary data of eval_form() and
+  // eval_dg_form(), released when they return.
+  ScratchArena* scratch;
+
   void init_cache();
   void delete_cache();
 
@@ -245,4 +251,12 @@ HERMES_API double get_l2_norm(Vector* vec);
 HERMES_API bool solve_newton(scalar* coeff_vec, DiscreteProblem* dp, Solver* solver, SparseMatrix* matrix,
 			     Vector* rhs, double NEWTON_TOL, int NEWTON_MAX_ITER, bool verbose);
 
+// Solve the dual problem a(v, z) = J(v) of goal-oriented adaptivity (see Adapt::calc_err_dwr()).
+// 'goal' is a linear DiscreteProblem on the reference spaces whose weak form has the goal
+// functional J as vector forms. 'solver' last solved the problem on the same spaces; its
+// factorization is reused for the transposed system. The dual solutions get zero Dirichlet
+// values. Returns false if the solver cannot solve transposed systems; the adjoint forms then
+// have to be assembled and solved as usual.
+HERMES_API bool solve_dual(DiscreteProblem* goal, Solver* solver, Vector* rhs, Tuple<Solution *> dual_slns);
+
 #endif
@@ -0,0 +1,209 @@
+// This file is part of Hermes2D.
+//
+// Hermes2D is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Hermes2D is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Hermes2D.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "h2d_common.h"
+#include "ensemble.h"
+#include "solution.h"
+#include "space/space.h"
+#include "../../hermes_common/matrix.h"
+#include "../../hermes_common/solver/solver.h"
+#include "../../hermes_common/perf_counters.h"
+
+Ensemble::Ensemble(WeakForm* wf, Tuple<Space *> spaces, MatrixSolverType matrix_solver)
+  : wf(wf), spaces(spaces), matrix_solver(matrix_solver)
+{
+  _F_
+  bool is_linear = true;
+  dp = new DiscreteProblem(wf, spaces, is_linear);
+  instance_fn = NULL;
+  instance_data = NULL;
+  shared_matrix = false;
+  num_instances = 0;
+  ndof = 0;
+  coeffs = NULL;
+  workers = NULL;
+  num_workers = 0;
+}
+
+Ensemble::~Ensemble()
+{
+  _F_
+  free_workers();
+  delete [] coeffs;
+  delete dp;
+}
+
+void Ensemble::set_instance_callback(instance_callback_t fn, void* data)
+{
+  _F_
+  this->instance_fn = fn;
+  this->instance_data = data;
+}
+
+void Ensemble::set_instance(int instance)
+{
+  _F_
+  if (instance_fn != NULL) instance_fn(instance, instance_data);
+  update_essential_bc_values(spaces);
+}
+
+scalar* Ensemble::get_coeff_vector(int instance)
+{
+  _F_
+  if (instance < 0 || instance >= num_instances) error("Invalid instance %d in Ensemble::get_coeff_vector().", instance);
+  return coeffs + (size_t) instance * ndof;
+}
+
+void Ensemble::get_solutions(int instance, Tuple<Solution *> slns)
+{
+  _F_
+  scalar* coeff_vec = get_coeff_vector(instance);
+  // the Dirichlet lift depends on the instance
+  set_instance(instance);
+  Solution::vector_to_solutions(coeff_vec, spaces, slns);
+}
+
+//// workers ///////////////////////////////////////////////////////////////////////////////////////
+
+void Ensemble::init_worker(Worker* w, FactorizationScheme scheme)
+{
+  _F_
+  w->mat = create_matrix(matrix_solver);
+  w->rhs = create_vector(matrix_solver);
+  w->solver = create_linear_solver(matrix_solver, w->mat, w->rhs);
+  w->solver->set_factorization_scheme(scheme);
+  w->instance = -1;
+  w->running = false;
+  w->ok = true;
+}
+
+void* Ensemble::solve_worker(void* ptr)
+{
+  Worker* w = (Worker*) ptr;
+  w->ok = w->solver->solve();
+  return NULL;
+}
+
+void Ensemble::start_worker(Worker* w, int instance, bool in_thread)
+{
+  _F_
+  w->instance = instance;
+  if (in_thread && pthread_create(&w->thread, NULL, solve_worker, w) == 0)
+    w->running = true;
+  else
+    solve_worker(w);
+}
+
+bool Ensemble::finish_worker(Worker* w)
+{
+  _F_
+  if (w->instance < 0) return true;
+  if (w->running)
+  {
+    pthread_join(w->thread, NULL);
+    w->running = false;
+  }
+
+  scalar* coeff_vec = get_coeff_vector(w->instance);
+  if (w->ok)
+    memcpy(coeff_vec, w->solver->get_solution(), ndof * sizeof(scalar));
+  else
+  {
+    warn("Instance %d of the ensemble could not be solved.", w->instance);
+    memset(coeff_vec, 0, ndof * sizeof(scalar));
+  }
+  w->instance = -1;
+  return w->ok;
+}
+
+void Ensemble::free_workers()
+{
+  _F_
+  for (int i = 0; i < num_workers; i++)
+  {
+    finish_worker(&workers[i]);
+    delete workers[i].solver;
+    delete workers[i].mat;
+    delete workers[i].rhs;
+  }
+  delete [] workers;
+  workers = NULL;
+  num_workers = 0;
+}
+
+//// solution //////////////////////////////////////////////////////////////////////////////////////
+
+bool Ensemble::solve(int num_instances, int num_threads)
+{
+  _F_
+  HERMES_PERF_SCOPE("ensemble");
+  free_workers();
+  delete [] coeffs;
+
+  this->num_instances = num_instances;
+  ndof = Space::get_num_dofs(spaces);
+  coeffs = new scalar[(size_t) num_instances * ndof];
+  MEM_CHECK(coeffs);
+  if (num_instances <= 0) return true;
+
+  if (num_threads > 1 && matrix_solver != SOLVER_UMFPACK && matrix_solver != SOLVER_BANDED)
+  {
+    warn("%s cannot solve several systems at once, the ensemble is solved by one thread.",
+         MatrixSolverNames[matrix_solver].c_str());
+    num_threads = 1;
+  }
+  if (shared_matrix) num_threads = 1;
+  num_workers = std::max(1, std::min(num_threads, num_instances));
+  workers = new Worker[num_workers];
+
+  bool ok = true;
+  if (shared_matrix)
+  {
+    // one factorization, the instances differ in the right-hand side only
+    Worker* w = &workers[0];
+    init_worker(w, HERMES_FACTORIZE_FROM_SCRATCH);
+    for (int i = 0; i < num_instances; i++)
+    {
+      set_instance(i);
+      if (i == 0) dp->invalidate_matrix();
+      dp->assemble(w->mat, w->rhs, i > 0);
+      start_worker(w, i, false);
+      if (!finish_worker(w)) ok = false;
+      if (i == 0) w->solver->set_factorization_scheme(HERMES_REUSE_FACTORIZATION_COMPLETELY);
+    }
+  }
+  else
+  {
+    for (int i = 0; i < num_workers; i++)
+      init_worker(&workers[i], HERMES_REUSE_MATRIX_REORDERING);
+
+    // while a worker is solving, the next instances are assembled for the others
+    for (int i = 0; i < num_instances; i++)
+    {
+      Worker* w = &workers[i % num_workers];
+      if (!finish_worker(w)) ok = false;
+      set_instance(i);
+      // the DiscreteProblem remembers that it has created the structure of a matrix, not
+      // of which one, so the structure is built again for the first instance of a worker
+      if (i < num_workers) dp->invalidate_matrix();
+      dp->assemble(w->mat, w->rhs);
+      start_worker(w, i, num_workers > 1);
+    }
+    for (int i = 0; i < num_workers; i++)
+      if (!finish_worker(&workers[i])) ok = false;
+  }
+
+  return ok;
+}
@@ -0,0 +1,117 @@
+// This file is part of Hermes2D.
+//
+// Hermes2D is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Hermes2D is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Hermes2D.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef __H2D_ENSEMBLE_H
+#define __H2D_ENSEMBLE_H
+
+#include "discrete_problem.h"
+
+class Solution;
+
+/// \brief Solves many instances of one linear problem which differ only in coefficients.
+///
+/// Typical use is a parameter study: the mesh, the spaces and the weak form are the same
+/// for all instances, only the material constants, sources or boundary values change.
+/// The instances share the spaces and one DiscreteProblem, so the DOFs are enumerated
+/// and the form caches are filled only once. Before the i-th instance is assembled, the
+/// instance callback is called to set the coefficients the forms depend on (global
+/// variables, parameters of the forms, external functions) and the essential boundary
+/// conditions are projected again.
+///
+/// The instances are assembled one after another, since the assembling uses caches of
+/// the library shared by all problems. The linear systems are solved by up to
+/// 'num_threads' threads while the next instances are being assembled. Every thread keeps
+/// its matrix and solver, so the sparse structure and the symbolic analysis of the
+/// matrix (HERMES_REUSE_MATRIX_REORDERING) are computed once per thread instead of once
+/// per instance.
+///
+/// If the instances differ in the right-hand side only (set_shared_matrix()), the matrix
+/// is assembled and factorized once and the instances are solved as a batch of
+/// right-hand sides.
+///
+/// \code
+///   Ensemble ens(&wf, &space);
+///   ens.set_instance_callback(set_conductivity);
+///   ens.solve(1000, 4);
+///   ens.get_solution(17, &sln);
+/// \endcode
+///
+class HERMES_API Ensemble
+{
+public:
+  /// Sets the coefficients of the given instance.
+  typedef void (*instance_callback_t)(int instance, void* data);
+
+  Ensemble(WeakForm* wf, Tuple<Space *> spaces, MatrixSolverType matrix_solver = SOLVER_UMFPACK);
+  ~Ensemble();
+
+  void set_instance_callback(instance_callback_t fn, void* data = NULL);
+
+  /// Indicates that all instances have the same matrix.
+  void set_shared_matrix(bool shared = true) { shared_matrix = shared; }
+
+  /// Assembles and solves the instances 0, ..., num_instances - 1. Threads are used only
+  /// with solvers which can run concurrently on different matrices (UMFPACK, band).
+  /// Returns false if some of the systems could not be solved.
+  bool solve(int num_instances, int num_threads = 1);
+
+  int get_num_instances() const { return num_instances; }
+  int get_num_dofs() const { return ndof; }
+
+  /// Returns the coefficient vector of the instance.
+  scalar* get_coeff_vector(int instance);
+
+  /// Stores the solution of the instance (including the Dirichlet lift) into 'slns'.
+  void get_solutions(int instance, Tuple<Solution *> slns);
+  void get_solution(int instance, Solution* sln) { get_solutions(instance, Tuple<Solution *>(sln)); }
+
+protected:
+  struct Worker
+  {
+    SparseMatrix* mat;
+    Vector* rhs;
+    Solver* solver;
+    int instance;    ///< Instance being solved, -1 if none.
+    bool running;    ///< The solver runs in 'thread'.
+    bool ok;
+    pthread_t thread;
+  };
+
+  WeakForm* wf;
+  Tuple<Space *> spaces;
+  MatrixSolverType matrix_solver;
+  DiscreteProblem* dp;
+
+  instance_callback_t instance_fn;
+  void* instance_data;
+  bool shared_matrix;
+
+  int num_instances;
+  int ndof;
+  scalar* coeffs;      ///< Coefficient vectors of all instances, one after another.
+
+  Worker* workers;
+  int num_workers;
+
+  void set_instance(int instance);
+  void init_worker(Worker* w, FactorizationScheme scheme);
+  void start_worker(Worker* w, int instance, bool in_thread);
+  bool finish_worker(Worker* w);
+  void free_workers();
+
+  static void* solve_worker(void* w);
+};
+
+#endif
@@ -337,13 +337,16 @@ void DXDYFilter::precalculate(int order, int mask)
 
 static void magnitude_fn(int n, Tuple<scalar*> values, scalar* result)
 {
+  // one sweep over the points per argument, so that the loops vectorize
+  memset(result, 0, sizeof(scalar) * n);
+  for (unsigned int j = 0; j < values.size(); j++)
+  {
+    scalar* v = values[j];
+    for (int i = 0; i < n; i++)
+      result[i] += sqr(v[i]);
+  }
   for (int i = 0; i < n; i++)
-	{
-		result[i] = 0;
-		for(int j = 0; j < values.size(); j++)
-			result[i] += sqr(values.at(j)[i]);
-		result[i] = sqrt(result[i]);
-	}
+    result[i] = sqrt(result[i]);
 };
 
 MagFilter::MagFilter(Tuple<MeshFunction*> solutions, Tuple<int> items) : SimpleFilter(magnitude_fn, solutions, items)
@@ -360,8 +363,9 @@ MagFilter::MagFilter(MeshFunction* sln1, int item1)
 
 static void difference_fn_2(int n, Tuple<scalar*> values, scalar* result)
 {
+  scalar *v1 = values.at(0), *v2 = values.at(1);
   for (int i = 0; i < n; i++)
-		result[i] = values.at(0)[i] - values.at(1)[i];
+    result[i] = v1[i] - v2[i];
 };
 
 DiffFilter::DiffFilter(Tuple<MeshFunction*> solutions, Tuple<int> items)
@@ -370,9 +374,13 @@ DiffFilter::DiffFilter(Tuple<MeshFunction*> solutions, Tuple<int> items)
 
 static void sum_fn(int n, Tuple<scalar*> values, scalar* result)
 {
-  for (int i = 0; i < n; i++)
-		for (int j = 0; j < values.size(); j++)
-			result[i] += values.at(j)[i];
+  memset(result, 0, sizeof(scalar) * n);
+  for (unsigned int j = 0; j < values.size(); j++)
+  {
+    scalar* v = values[j];
+    for (int i = 0; i < n; i++)
+      result[i] += v[i];
+  }
 };
 
 SumFilter::SumFilter(Tuple<MeshFunction*> solutions, Tuple<int> items) : SimpleFilter(sum_fn, solutions, items) {}
@@ -380,12 +388,13 @@ SumFilter::SumFilter(Tuple<MeshFunction*> solutions, Tuple<int> items) : SimpleF
 
 static void square_fn_1(int n, Tuple<scalar*> v1, scalar* result)
 {
+  scalar* v = v1.at(0);
 #ifdef H2D_COMPLEX
   for (int i = 0; i < n; i++)
-		result[i] = std::norm(v1.at(0)[i]);
+    result[i] = std::norm(v[i]);
 #else
   for (int i = 0; i < n; i++)
-    result[i] = sqr(v1.at(0)[i]);
+    result[i] = sqr(v[i]);
 #endif
 };
 
@@ -435,12 +444,13 @@ ImagFilter::ImagFilter(Tuple<MeshFunction*> solutions, Tuple<int> items)
 
 static void abs_fn_1(int n,  Tuple<scalar*> v1, scalar* result)
 {
+  scalar* v = v1.at(0);
 #ifndef H2D_COMPLEX
   for (int i = 0; i < n; i++)
-    result[i] = fabs(v1.at(0)[i]);
+    result[i] = fabs(v[i]);
 #else
   for (int i = 0; i < n; i++)
-		result[i] = sqrt(sqr(v1.at(0)[i].real()) + sqr(v1.at(0)[i].imag()));
+    result[i] = sqrt(sqr(v[i].real()) + sqr(v[i].imag()));
 #endif
 };
 
@@ -471,6 +481,201 @@ AngleFilter::AngleFilter(Tuple<MeshFunction*> solutions, Tuple<int> items)
 };
 
 
+//// FusedFilter /////////////////////////////////////////////////////////////////////////////////
+
+FusedFilter::FusedFilter() : Filter()
+{
+  num = nsteps = 0;
+  unimesh = false;
+  memset(tables, 0, sizeof(tables));
+  scratch = NULL;
+  scratch_size = 0;
+}
+
+
+FusedFilter::FusedFilter(SimpleFilter* root) : Filter()
+{
+  num = nsteps = 0;
+  unimesh = false;
+  memset(tables, 0, sizeof(tables));
+  scratch = NULL;
+  scratch_size = 0;
+
+  if (root->get_num_components() > 1)
+    error("FusedFilter: vector-valued filters cannot be fused.");
+  std::map<SimpleFilter*, int> done;
+  fuse(root, done);
+  init();
+}
+
+
+FusedFilter::~FusedFilter()
+{
+  delete [] scratch;
+}
+
+
+int FusedFilter::fuse(SimpleFilter* flt, std::map<SimpleFilter*, int>& done)
+{
+  // a filter used by several others is evaluated only once
+  std::map<SimpleFilter*, int>::iterator it = done.find(flt);
+  if (it != done.end()) return it->second;
+
+  Tuple<int> args;
+  for (int i = 0; i < flt->num; i++)
+  {
+    SimpleFilter* src = dynamic_cast<SimpleFilter*>(flt->sln[i]);
+    if (src != NULL && src->get_num_components() == 1)
+    {
+      if (flt->item[i] & (H2D_FN_DX | H2D_FN_DY | H2D_FN_DXX | H2D_FN_DYY | H2D_FN_DXY))
+        error("Filter not defined for derivatives.");
+      args.push_back(fuse(src, done));
+    }
+    else
+      args.push_back(add_input(flt->sln[i], flt->item[i]));
+  }
+  return done[flt] = add_step(flt->filter_fn, args);
+}
+
+
+int FusedFilter::add_input(MeshFunction* fn, int item)
+{
+  if (fn->get_num_components() == 1) item &= H2D_FN_COMPONENT_0;
+  if (!item) error("Value of 'item' is incorrect in filter definition.");
+
+  int f = 0;
+  while (f < num && sln[f] != fn) f++;
+  if (f == num)
+  {
+    if (num >= 10)
+      error("Attempt to create an instance of Filter with more than 10 MeshFunctions.");
+    sln[num++] = fn;
+    fn_mask[f] = 0;
+  }
+
+  for (unsigned int k = 0; k < graph.size(); k++)
+    if (graph[k].filter_fn == NULL && graph[k].fn == f && graph[k].item == item)
+      return k;
+
+  // the first component and value selected by the item, as in SimpleFilter
+  GraphNode node;
+  node.filter_fn = NULL;
+  node.fn = f;
+  node.item = item;
+  node.comp = node.b = 0;
+  int mask = item;
+  if (mask >= 0x40) { node.comp = 1; mask >>= 6; }
+  while (!(mask & 1)) { mask >>= 1; node.b++; }
+
+  fn_mask[f] |= item;
+  graph.push_back(node);
+  return graph.size() - 1;
+}
+
+
+int FusedFilter::add_step(filter_fn_ filter_fn, Tuple<int> args)
+{
+  if (filter_fn == NULL) error("FusedFilter: the filter function is NULL.");
+  for (unsigned int i = 0; i < args.size(); i++)
+    if (args[i] < 0 || args[i] >= (int) graph.size())
+      error("FusedFilter: invalid argument %d of a step.", args[i]);
+
+  GraphNode node;
+  node.filter_fn = filter_fn;
+  node.fn = node.item = node.comp = node.b = -1;
+  node.args = args;
+  graph.push_back(node);
+  nsteps++;
+  return graph.size() - 1;
+}
+
+
+void FusedFilter::init()
+{
+  if (num == 0 || nsteps == 0 || graph.back().filter_fn == NULL)
+    error("FusedFilter: the graph needs at least one input and must end with a step.");
+  slots.resize(graph.size());
+  Filter::init();
+}
+
+
+void FusedFilter::evaluate(int np, scalar** values, scalar* result)
+{
+  if (scratch_size < nsteps * np)
+  {
+    delete [] scratch;
+    scratch_size = nsteps * np;
+    scratch = new scalar[scratch_size];
+  }
+
+  // 'values' holds the tables of the inputs, the results of the steps are added to it
+  scalar* out = scratch;
+  int last = graph.size() - 1;
+  for (int k = 0; k <= last; k++)
+  {
+    GraphNode* node = &graph[k];
+    if (node->filter_fn == NULL) continue;
+
+    Tuple<scalar*> args;
+    args.reserve(node->args.size());
+    for (unsigned int i = 0; i < node->args.size(); i++)
+      args.push_back(values[node->args[i]]);
+
+    values[k] = (k == last) ? result : out;
+    node->filter_fn(np, args, values[k]);
+    out += np;
+  }
+}
+
+
+void FusedFilter::precalculate(int order, int mask)
+{
+  if (mask & (H2D_FN_DX | H2D_FN_DY | H2D_FN_DXX | H2D_FN_DYY | H2D_FN_DXY))
+    error("Filter not defined for derivatives.");
+
+  Quad2D* quad = quads[cur_quad];
+  int np = quad->get_num_points(order);
+  Node* node = new_node(H2D_FN_VAL_0, np);
+
+  // each input function is precalculated once, for all its items
+  for (int i = 0; i < num; i++)
+    sln[i]->set_quad_order(order, fn_mask[i]);
+
+  scalar** values = &slots[0];
+  for (unsigned int k = 0; k < graph.size(); k++)
+    if (graph[k].filter_fn == NULL)
+    {
+      values[k] = sln[graph[k].fn]->get_values(graph[k].comp, graph[k].b);
+      if (values[k] == NULL) error("Value of 'item' is incorrect in filter definition.");
+    }
+
+  evaluate(np, values, node->values[0][0]);
+
+  // remove the old node and attach the new one
+  replace_cur_node(node);
+}
+
+
+scalar FusedFilter::get_pt_value(double x, double y, int it)
+{
+  if (it & (H2D_FN_DX | H2D_FN_DY | H2D_FN_DXX | H2D_FN_DYY | H2D_FN_DXY))
+    error("Filter not defined for derivatives.");
+
+  std::vector<scalar> val(graph.size());
+  scalar** values = &slots[0];
+  for (unsigned int k = 0; k < graph.size(); k++)
+    if (graph[k].filter_fn == NULL)
+    {
+      val[k] = sln[graph[k].fn]->get_pt_value(x, y, graph[k].item);
+      values[k] = &val[k];
+    }
+
+  scalar result;
+  evaluate(1, values, &result);
+  return result;
+}
+
+
 //// VonMisesFilter ////////////////////////////////////////////////////////////////////////////////
 
 #ifndef H2D_COMPLEX
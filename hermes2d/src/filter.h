@@ -99,6 +99,7 @@ protected:
   void init_components();
   virtual void precalculate(int order, int mask);
 
+  friend class FusedFilter;
 };
 
 
@@ -193,6 +194,88 @@ class HERMES_API AngleFilter : public SimpleFilter
 };
 
 
+/// FusedFilter evaluates a whole graph of simple filter functions in one pass. A chain
+/// of SimpleFilters, e.g., a MagFilter of DiffFilters, sets the active element, pushes
+/// the transforms and precalculates tables in every filter of the chain, and each of
+/// them may build its own union mesh. FusedFilter only does that for the functions at
+/// the leaves of the graph (usually Solutions): for each set of quadrature points it
+/// evaluates the leaves once and then applies the filter functions one after another
+/// to whole arrays of values, keeping the intermediate results in a scratch buffer.
+///
+/// The graph is either taken from existing SimpleFilters,
+/// \code
+///   DiffFilter du(Tuple<MeshFunction*>(&u_new, &u_old)), dv(Tuple<MeshFunction*>(&v_new, &v_old));
+///   MagFilter mag(Tuple<MeshFunction*>(&du, &dv));
+///   FusedFilter fused(&mag);   // du, dv and mag are not used anymore
+/// \endcode
+/// or built directly, without creating the intermediate filters at all:
+/// \code
+///   FusedFilter fused;
+///   int a = fused.add_input(&u_new), b = fused.add_input(&u_old);
+///   fused.add_step(my_difference_fn, Tuple<int>(a, b));
+///   fused.init();
+/// \endcode
+/// The result is scalar-valued and, like SimpleFilter, not defined for derivatives.
+///
+class HERMES_API FusedFilter : public Filter
+{
+public:
+
+  typedef void (*filter_fn_)(int n, Tuple<scalar*> values, scalar* result);
+
+  /// Creates an empty graph. Add the inputs and the steps, then call init().
+  FusedFilter();
+
+  /// Fuses the SimpleFilter 'root' with all scalar SimpleFilters it takes its values
+  /// from, recursively. The other functions become the inputs. The filters are only
+  /// read here, so they can be deleted afterwards.
+  FusedFilter(SimpleFilter* root);
+
+  virtual ~FusedFilter();
+
+  /// Adds an input and returns its index for add_step(). 'item' selects the value,
+  /// as in SimpleFilter. Adding the same function and item again returns the same index.
+  int add_input(MeshFunction* fn, int item = H2D_FN_VAL_0);
+
+  /// Adds a step applying 'filter_fn' to the given inputs and results of previous
+  /// steps, and returns the index of its result. The last step is the output.
+  int add_step(filter_fn_ filter_fn, Tuple<int> args);
+
+  /// Finishes the graph (constructs the union mesh of the inputs, if necessary).
+  virtual void init();
+
+  /// Returns the number of steps, i.e., the number of filters fused.
+  int get_num_steps() const { return nsteps; }
+
+  virtual scalar get_pt_value(double x, double y, int item = H2D_FN_VAL_0);
+
+protected:
+
+  /// One node of the graph: an input (a value of sln[fn]) or a step.
+  struct GraphNode
+  {
+    filter_fn_ filter_fn; ///< NULL for an input
+    int fn, item;         ///< the input function (index into sln) and its item
+    int comp, b;          ///< the component and the value (H2D_FN_VAL_0...) of the item
+    Tuple<int> args;      ///< the arguments of a step
+  };
+
+  std::vector<GraphNode> graph;
+  int nsteps;
+  int fn_mask[10];  ///< the union of the items needed from each input function
+
+  std::vector<scalar*> slots; ///< the values of the nodes at the current points
+  scalar* scratch;  ///< intermediate results, one array of points per step
+  int scratch_size;
+
+  int fuse(SimpleFilter* flt, std::map<SimpleFilter*, int>& done);
+  void evaluate(int np, scalar** values, scalar* result);
+
+  virtual void precalculate(int order, int mask);
+
+};
+
+
 /// VonMisesFilter is a postprocessing filter for visualizing elastic stresses in a body.
 /// It calculates the stress tensor and applies the Von Mises equivalent stress formula
 /// to obtain the resulting stress measure.
@@ -0,0 +1,449 @@
+// This file is part of Hermes2D.
+//
+// Hermes2D is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Hermes2D is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Hermes2D.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef __H2D_FORM_EXPR_H
+#define __H2D_FORM_EXPR_H
+
+#include "forms.h"
+#include "weakform.h"
+
+/// \file form_expr.h
+/// Weak forms written as expressions.
+///
+/// Instead of writing a form as a pair of functions (the value and the integration
+/// order, see the callback() macro), the integrand is written once as an expression:
+///
+/// \code
+///   double k = 2.0;
+///   ...
+///   using namespace expr;
+///   wf.add_matrix_form(grad(u) * grad(v) + param<&k>() * u * v, HERMES_SYM);
+///   wf.add_vector_form(coef<Source>() * v);
+/// \endcode
+///
+/// Every expression is a distinct type that holds no data. Both the value and the
+/// order of the form are generated from the type by the compiler: the value kernel
+/// instantiates the expression with double/scalar, the order kernel with Ord, so
+/// the integration order follows the same rules as for the hand-written forms.
+/// After inlining, the loop over the integration points contains no calls and can
+/// be vectorized.
+///
+/// Terminals (in namespace expr):
+///   u, v                 trial and test function, dx(u), dy(u), grad(u) are their derivatives
+///   prev<i>(), ext<i>()  solution from the previous iteration, i-th external function
+///   x, y, nx, ny         coordinates and (on edges) the normal, normal() is the vector (nx, ny)
+///   num<N>()             integer constant
+///   param<&k>()          value of a double 'k' with external linkage, read at assembling
+///   coef<C>()            C::value<Real>(x, y), a coefficient defined by a class C
+///   vec(a, b)            vector (a, b)
+///
+/// Operators +, - (also unary), *, / combine scalar expressions; vector * vector is the
+/// dot product and scalar * vector scales the vector.
+///
+
+/// Data passed to the forms, seen by the expressions.
+template<typename Real, typename Scalar>
+struct FormExprArgs
+{
+  Func<Scalar>** u_ext;
+  Func<Real>* u;
+  Func<Real>* v;
+  Geom<Real>* e;
+  ExtData<Scalar>* ext;
+};
+
+/// Base of all scalar expressions. Every expression E defines
+///   template<typename Real, typename Scalar> static Scalar eval(const FormExprArgs<Real, Scalar>& a, int i)
+/// returning its value in the i-th integration point, and the flags 'uses_u', 'uses_v'.
+template<typename E>
+struct FormExpr { };
+
+/// Base of the vector expressions. A vector expression E defines the types E::X and E::Y
+/// of its components.
+template<typename E>
+struct FormVecExpr { };
+
+/// Compile-time check (the array has a negative size if 'cond' is false).
+#define H2D_FORM_EXPR_CHECK(cond, name) typedef char name[(cond) ? 1 : -1]
+
+namespace expr
+{
+  //// functions ///////////////////////////////////////////////////////////////////////////////////
+
+  // The following classes select the function of a terminal.
+
+  struct TrialFn
+  {
+    enum { uses_u = 1, uses_v = 0 };
+    template<typename Real, typename Scalar>
+    static Func<Real>* get(const FormExprArgs<Real, Scalar>& a) { return a.u; }
+  };
+
+  struct TestFn
+  {
+    enum { uses_u = 0, uses_v = 1 };
+    template<typename Real, typename Scalar>
+    static Func<Real>* get(const FormExprArgs<Real, Scalar>& a) { return a.v; }
+  };
+
+  template<int I>
+  struct PrevFn
+  {
+    enum { uses_u = 0, uses_v = 0 };
+    template<typename Real, typename Scalar>
+    static Func<Scalar>* get(const FormExprArgs<Real, Scalar>& a) { return a.u_ext[I]; }
+  };
+
+  template<int I>
+  struct ExtFn
+  {
+    enum { uses_u = 0, uses_v = 0 };
+    template<typename Real, typename Scalar>
+    static Func<Scalar>* get(const FormExprArgs<Real, Scalar>& a) { return a.ext->fn[I]; }
+  };
+
+  //// terminals ///////////////////////////////////////////////////////////////////////////////////
+
+  template<typename F>
+  struct Val : public FormExpr<Val<F> >
+  {
+    enum { uses_u = F::uses_u, uses_v = F::uses_v };
+    template<typename Real, typename Scalar>
+    static Scalar eval(const FormExprArgs<Real, Scalar>& a, int i) { return F::template get<Real, Scalar>(a)->val[i]; }
+  };
+
+  template<typename F>
+  struct Dx : public FormExpr<Dx<F> >
+  {
+    enum { uses_u = F::uses_u, uses_v = F::uses_v };
+    template<typename Real, typename Scalar>
+    static Scalar eval(const FormExprArgs<Real, Scalar>& a, int i) { return F::template get<Real, Scalar>(a)->dx[i]; }
+  };
+
+  template<typename F>
+  struct Dy : public FormExpr<Dy<F> >
+  {
+    enum { uses_u = F::uses_u, uses_v = F::uses_v };
+    template<typename Real, typename Scalar>
+    static Scalar eval(const FormExprArgs<Real, Scalar>& a, int i) { return F::template get<Real, Scalar>(a)->dy[i]; }
+  };
+
+  struct CoordX : public FormExpr<CoordX>
+  {
+    enum { uses_u = 0, uses_v = 0 };
+    template<typename Real, typename Scalar>
+    static Scalar eval(const FormExprArgs<Real, Scalar>& a, int i) { return a.e->x[i]; }
+  };
+
+  struct CoordY : public FormExpr<CoordY>
+  {
+    enum { uses_u = 0, uses_v = 0 };
+    template<typename Real, typename Scalar>
+    static Scalar eval(const FormExprArgs<Real, Scalar>& a, int i) { return a.e->y[i]; }
+  };
+
+  struct NormalX : public FormExpr<NormalX>
+  {
+    enum { uses_u = 0, uses_v = 0 };
+    template<typename Real, typename Scalar>
+    static Scalar eval(const FormExprArgs<Real, Scalar>& a, int i) { return a.e->nx[i]; }
+  };
+
+  struct NormalY : public FormExpr<NormalY>
+  {
+    enum { uses_u = 0, uses_v = 0 };
+    template<typename Real, typename Scalar>
+    static Scalar eval(const FormExprArgs<Real, Scalar>& a, int i) { return a.e->ny[i]; }
+  };
+
+  template<int N>
+  struct Num : public FormExpr<Num<N> >
+  {
+    enum { uses_u = 0, uses_v = 0 };
+    // NOTE: Ord(int) would be a polynomial of order N, the constant has order 0
+    template<typename Real, typename Scalar>
+    static Scalar eval(const FormExprArgs<Real, Scalar>& a, int i) { return Scalar((double) N); }
+  };
+
+  template<double* P>
+  struct Param : public FormExpr<Param<P> >
+  {
+    enum { uses_u = 0, uses_v = 0 };
+    template<typename Real, typename Scalar>
+    static Scalar eval(const FormExprArgs<Real, Scalar>& a, int i) { return Scalar(*P); }
+  };
+
+  template<typename C>
+  struct Coef : public FormExpr<Coef<C> >
+  {
+    enum { uses_u = 0, uses_v = 0 };
+    template<typename Real, typename Scalar>
+    static Scalar eval(const FormExprArgs<Real, Scalar>& a, int i)
+    {
+      return C::template value<Real>(a.e->x[i], a.e->y[i]);
+    }
+  };
+
+  //// operators ///////////////////////////////////////////////////////////////////////////////////
+
+  template<typename A, typename B>
+  struct Add : public FormExpr<Add<A, B> >
+  {
+    enum { uses_u = A::uses_u || B::uses_u, uses_v = A::uses_v || B::uses_v };
+    template<typename Real, typename Scalar>
+    static Scalar eval(const FormExprArgs<Real, Scalar>& a, int i)
+    {
+      return A::template eval<Real, Scalar>(a, i) + B::template eval<Real, Scalar>(a, i);
+    }
+  };
+
+  template<typename A, typename B>
+  struct Sub : public FormExpr<Sub<A, B> >
+  {
+    enum { uses_u = A::uses_u || B::uses_u, uses_v = A::uses_v || B::uses_v };
+    template<typename Real, typename Scalar>
+    static Scalar eval(const FormExprArgs<Real, Scalar>& a, int i)
+    {
+      return A::template eval<Real, Scalar>(a, i) - B::template eval<Real, Scalar>(a, i);
+    }
+  };
+
+  template<typename A, typename B>
+  struct Mul : public FormExpr<Mul<A, B> >
+  {
+    enum { uses_u = A::uses_u || B::uses_u, uses_v = A::uses_v || B::uses_v };
+    template<typename Real, typename Scalar>
+    static Scalar eval(const FormExprArgs<Real, Scalar>& a, int i)
+    {
+      return A::template eval<Real, Scalar>(a, i) * B::template eval<Real, Scalar>(a, i);
+    }
+  };
+
+  template<typename A, typename B>
+  struct Div : public FormExpr<Div<A, B> >
+  {
+    enum { uses_u = A::uses_u || B::uses_u, uses_v = A::uses_v || B::uses_v };
+    template<typename Real, typename Scalar>
+    static Scalar eval(const FormExprArgs<Real, Scalar>& a, int i)
+    {
+      return A::template eval<Real, Scalar>(a, i) / B::template eval<Real, Scalar>(a, i);
+    }
+  };
+
+  template<typename A>
+  struct Neg : public FormExpr<Neg<A> >
+  {
+    enum { uses_u = A::uses_u, uses_v = A::uses_v };
+    template<typename Real, typename Scalar>
+    static Scalar eval(const FormExprArgs<Real, Scalar>& a, int i) { return -A::template eval<Real, Scalar>(a, i); }
+  };
+
+  /// Vector with the components A and B.
+  template<typename A, typename B>
+  struct Vec : public FormVecExpr<Vec<A, B> >
+  {
+    typedef A X;
+    typedef B Y;
+  };
+
+  template<typename F>
+  struct Grad : public FormVecExpr<Grad<F> >
+  {
+    typedef Dx<F> X;
+    typedef Dy<F> Y;
+  };
+
+  template<typename A, typename B>
+  Add<A, B> operator+(const FormExpr<A>&, const FormExpr<B>&) { return Add<A, B>(); }
+  template<typename A, typename B>
+  Sub<A, B> operator-(const FormExpr<A>&, const FormExpr<B>&) { return Sub<A, B>(); }
+  template<typename A, typename B>
+  Mul<A, B> operator*(const FormExpr<A>&, const FormExpr<B>&) { return Mul<A, B>(); }
+  template<typename A, typename B>
+  Div<A, B> operator/(const FormExpr<A>&, const FormExpr<B>&) { return Div<A, B>(); }
+  template<typename A>
+  Neg<A> operator-(const FormExpr<A>&) { return Neg<A>(); }
+
+  /// Dot product.
+  template<typename A, typename B>
+  Add<Mul<typename A::X, typename B::X>, Mul<typename A::Y, typename B::Y> >
+  operator*(const FormVecExpr<A>&, const FormVecExpr<B>&)
+  {
+    return Add<Mul<typename A::X, typename B::X>, Mul<typename A::Y, typename B::Y> >();
+  }
+
+  template<typename S, typename A>
+  Vec<Mul<S, typename A::X>, Mul<S, typename A::Y> > operator*(const FormExpr<S>&, const FormVecExpr<A>&)
+  {
+    return Vec<Mul<S, typename A::X>, Mul<S, typename A::Y> >();
+  }
+
+  template<typename A, typename B>
+  Vec<Add<typename A::X, typename B::X>, Add<typename A::Y, typename B::Y> >
+  operator+(const FormVecExpr<A>&, const FormVecExpr<B>&)
+  {
+    return Vec<Add<typename A::X, typename B::X>, Add<typename A::Y, typename B::Y> >();
+  }
+
+  //// user interface //////////////////////////////////////////////////////////////////////////////
+
+  static const Val<TrialFn> u = Val<TrialFn>();
+  static const Val<TestFn> v = Val<TestFn>();
+  static const CoordX x = CoordX();
+  static const CoordY y = CoordY();
+  static const NormalX nx = NormalX();
+  static const NormalY ny = NormalY();
+
+  template<typename F> Dx<F> dx(const Val<F>&) { return Dx<F>(); }
+  template<typename F> Dy<F> dy(const Val<F>&) { return Dy<F>(); }
+  template<typename F> Grad<F> grad(const Val<F>&) { return Grad<F>(); }
+
+  template<int I> Val<PrevFn<I> > prev() { return Val<PrevFn<I> >(); }
+  template<int I> Val<ExtFn<I> > ext() { return Val<ExtFn<I> >(); }
+
+  template<int N> Num<N> num() { return Num<N>(); }
+  template<double* P> Param<P> param() { return Param<P>(); }
+  template<typename C> Coef<C> coef() { return Coef<C>(); }
+
+  template<typename A, typename B>
+  Vec<A, B> vec(const FormExpr<A>&, const FormExpr<B>&) { return Vec<A, B>(); }
+  inline Vec<NormalX, NormalY> normal() { return Vec<NormalX, NormalY>(); }
+}
+
+
+/// Kernels generated from the expression E. The functions have the signatures of
+/// WeakForm::matrix_form_val_t, matrix_form_ord_t, vector_form_val_t and vector_form_ord_t.
+template<typename E>
+struct FormExprKernel
+{
+  template<typename Real, typename Scalar>
+  static Scalar matrix_form(int n, double *wt, Func<Scalar> *u_ext[], Func<Real> *u, Func<Real> *v,
+                            Geom<Real> *e, ExtData<Scalar> *ext)
+  {
+    FormExprArgs<Real, Scalar> a = { u_ext, u, v, e, ext };
+    Scalar result = 0;
+    for (int i = 0; i < n; i++)
+      result += wt[i] * E::template eval<Real, Scalar>(a, i);
+    return result;
+  }
+
+  template<typename Real, typename Scalar>
+  static Scalar vector_form(int n, double *wt, Func<Scalar> *u_ext[], Func<Real> *v,
+                            Geom<Real> *e, ExtData<Scalar> *ext)
+  {
+    FormExprArgs<Real, Scalar> a = { u_ext, NULL, v, e, ext };
+    Scalar result = 0;
+    for (int i = 0; i < n; i++)
+      result += wt[i] * E::template eval<Real, Scalar>(a, i);
+    return result;
+  }
+
+  /// Evaluates the form for all pairs of 'nu' basis and 'nv' test functions of a local
+  /// block at once: block[j][k] = form(u[j], v[k]). The arguments common to the whole
+  /// block are set up only once.
+  static void matrix_block(int n, double *wt, Func<scalar> *u_ext[], Func<double> **u, int nu,
+                           Func<double> **v, int nv, Geom<double> *e, ExtData<scalar> *ext, scalar **block)
+  {
+    FormExprArgs<double, scalar> a = { u_ext, NULL, NULL, e, ext };
+    for (int j = 0; j < nu; j++)
+    {
+      a.u = u[j];
+      for (int k = 0; k < nv; k++)
+      {
+        a.v = v[k];
+        scalar result = 0;
+        for (int i = 0; i < n; i++)
+          result += wt[i] * E::template eval<double, scalar>(a, i);
+        block[j][k] = result;
+      }
+    }
+  }
+
+  /// Evaluates the vector form for 'nv' test functions at once: block[k] = form(v[k]).
+  static void vector_block(int n, double *wt, Func<scalar> *u_ext[], Func<double> **v, int nv,
+                           Geom<double> *e, ExtData<scalar> *ext, scalar *block)
+  {
+    FormExprArgs<double, scalar> a = { u_ext, NULL, NULL, e, ext };
+    for (int k = 0; k < nv; k++)
+    {
+      a.v = v[k];
+      scalar result = 0;
+      for (int i = 0; i < n; i++)
+        result += wt[i] * E::template eval<double, scalar>(a, i);
+      block[k] = result;
+    }
+  }
+};
+
+
+//// registration of the forms /////////////////////////////////////////////////////////////////////
+
+template<typename E>
+void WeakForm::add_matrix_form(int i, int j, const FormExpr<E>& form, SymFlag sym, int area, Tuple<MeshFunction*> ext)
+{
+  H2D_FORM_EXPR_CHECK(E::uses_u && E::uses_v, matrix_form_must_use_u_and_v);
+  add_matrix_form(i, j, FormExprKernel<E>::template matrix_form<double, scalar>,
+                  FormExprKernel<E>::template matrix_form<Ord, Ord>, sym, area, ext);
+}
+
+template<typename E>
+void WeakForm::add_matrix_form(const FormExpr<E>& form, SymFlag sym, int area, Tuple<MeshFunction*> ext)
+{
+  add_matrix_form(0, 0, form, sym, area, ext);
+}
+
+template<typename E>
+void WeakForm::add_matrix_form_surf(int i, int j, const FormExpr<E>& form, int area, Tuple<MeshFunction*> ext)
+{
+  H2D_FORM_EXPR_CHECK(E::uses_u && E::uses_v, matrix_form_must_use_u_and_v);
+  add_matrix_form_surf(i, j, FormExprKernel<E>::template matrix_form<double, scalar>,
+                       FormExprKernel<E>::template matrix_form<Ord, Ord>, area, ext);
+}
+
+template<typename E>
+void WeakForm::add_matrix_form_surf(const FormExpr<E>& form, int area, Tuple<MeshFunction*> ext)
+{
+  add_matrix_form_surf(0, 0, form, area, ext);
+}
+
+template<typename E>
+void WeakForm::add_vector_form(int i, const FormExpr<E>& form, int area, Tuple<MeshFunction*> ext)
+{
+  H2D_FORM_EXPR_CHECK(!E::uses_u && E::uses_v, vector_form_must_use_only_v);
+  add_vector_form(i, FormExprKernel<E>::template vector_form<double, scalar>,
+                  FormExprKernel<E>::template vector_form<Ord, Ord>, area, ext);
+}
+
+template<typename E>
+void WeakForm::add_vector_form(const FormExpr<E>& form, int area, Tuple<MeshFunction*> ext)
+{
+  add_vector_form(0, form, area, ext);
+}
+
+template<typename E>
+void WeakForm::add_vector_form_surf(int i, const FormExpr<E>& form, int area, Tuple<MeshFunction*> ext)
+{
+  H2D_FORM_EXPR_CHECK(!E::uses_u && E::uses_v, vector_form_must_use_only_v);
+  add_vector_form_surf(i, FormExprKernel<E>::template vector_form<double, scalar>,
+                       FormExprKernel<E>::template vector_form<Ord, Ord>, area, ext);
+}
+
+template<typename E>
+void WeakForm::add_vector_form_surf(const FormExpr<E>& form, int area, Tuple<MeshFunction*> ext)
+{
+  add_vector_form_surf(0, form, area, ext);
+}
+
+#endif
@@ -27,9 +27,9 @@ template<> double DiscontinuousFunc<double>::zero = 0.0;
 #endif
 
 // Integration order for coordinates, normals and tangents is one
-Geom<Ord>* init_geom_ord()
+Geom<Ord>* init_geom_ord(ScratchArena* arena)
 {
-	Geom<Ord>* e = new Geom<Ord>;
+	Geom<Ord>* e = new (arena) Geom<Ord>;
 	static Ord x[] = { Ord(1) };
 	static Ord y[] = { Ord(1) };
 
@@ -50,9 +50,9 @@ Geom<Ord>* init_geom_ord()
 }
 
 // Initialize element marker and coordinates
-Geom<double>* init_geom_vol(RefMap *rm, const int order)
+Geom<double>* init_geom_vol(RefMap *rm, const int order, ScratchArena* arena)
 {
-    Geom<double>* e = new Geom<double>;
+    Geom<double>* e = new (arena) Geom<double>;
     //e->element = rm->get_active_element();
     e->diam = rm->get_active_element()->get_diameter();
     e->id = rm->get_active_element()->id;
@@ -63,9 +63,9 @@ Geom<double>* init_geom_vol(RefMap *rm, const int order)
 }
 
 // Initialize edge marker, coordinates, tangent and normals
-Geom<double>* init_geom_surf(RefMap *rm, SurfPos* surf_pos, const int order)
+Geom<double>* init_geom_surf(RefMap *rm, SurfPos* surf_pos, const int order, ScratchArena* arena)
 {
-	Geom<double>* e = new Geom<double>;
+	Geom<double>* e = new (arena) Geom<double>;
   e->marker = surf_pos->marker;
   e->diam = rm->get_active_element()->get_diameter();
   e->id = rm->get_active_element()->en[surf_pos->surf_num]->id;
@@ -76,10 +76,10 @@ Geom<double>* init_geom_surf(RefMap *rm, SurfPos* surf_pos, const int order)
 
   Quad2D* quad = rm->get_quad_2d();
   int np = quad->get_num_points(order);
-  e->tx = new double [np];
-  e->ty = new double [np];
-  e->nx = new double [np];
-  e->ny = new double [np];
+  e->tx = new (arena) double [np];
+  e->ty = new (arena) double [np];
+  e->nx = new (arena) double [np];
+  e->ny = new (arena) double [np];
   for (int i = 0; i < np; i++)
   {
     e->tx[i] = tan[i][0];  e->ty[i] =   tan[i][1];
@@ -90,11 +90,11 @@ Geom<double>* init_geom_surf(RefMap *rm, SurfPos* surf_pos, const int order)
 }
 
 // Initialize integration order for function values and derivatives
-Func<Ord>* init_fn_ord(const int order)
+Func<Ord>* init_fn_ord(const int order, ScratchArena* arena)
 {
-  Ord *d = new Ord(order);
+  Ord *d = new (arena) Ord(order);
 
-	Func<Ord>* f = new Func<Ord>(1, 2);
+	Func<Ord>* f = new (arena) Func<Ord>(1, 2);
 	f->val = d;
 	f->dx = f->dy = d;
 #ifdef H2D_SECOND_DERIVATIVES_ENABLED
@@ -108,7 +108,7 @@ Func<Ord>* init_fn_ord(const int order)
 }
 
 // Transformation of shape functions using reference mapping
-Func<double>* init_fn(PrecalcShapeset *fu, RefMap *rm, const int order)
+Func<double>* init_fn(PrecalcShapeset *fu, RefMap *rm, const int order, ScratchArena* arena)
 {
 	int nc = fu->get_num_components();
   int space_type = fu->get_type();
@@ -117,16 +117,16 @@ Func<double>* init_fn(PrecalcShapeset *fu, RefMap *rm, const int order)
   else fu->set_quad_order(order);
   double3* pt = quad->get_points(order);
   int np = quad->get_num_points(order);
-  Func<double>* u = new Func<double>(np, nc);
+  Func<double>* u = new (arena) Func<double>(np, nc);
 
   // H1 or L2 space.
   if (space_type == 0 || space_type == 3)
   {
-		u->val = new double [np];
-		u->dx  = new double [np];
-		u->dy  = new double [np];
+		u->val = new (arena) double [np];
+		u->dx  = new (arena) double [np];
+		u->dy  = new (arena) double [np];
 #ifdef H2D_SECOND_DERIVATIVES_ENABLED
-                u->laplace = new double [np];
+                u->laplace = new (arena) double [np];
 #endif
 		double *fn = fu->get_fn_values();
 		double *dx = fu->get_dx_values();
@@ -164,9 +164,9 @@ Func<double>* init_fn(PrecalcShapeset *fu, RefMap *rm, const int order)
   // Hcurl space.
 	else if (space_type == 1)
   {
-    u->val0 = new double [np];
-    u->val1 = new double [np];
-    u->curl = new double [np];
+    u->val0 = new (arena) double [np];
+    u->val1 = new (arena) double [np];
+    u->curl = new (arena) double [np];
 
     double *fn0 = fu->get_fn_values(0);
     double *fn1 = fu->get_fn_values(1);
@@ -183,8 +183,8 @@ Func<double>* init_fn(PrecalcShapeset *fu, RefMap *rm, const int order)
   // Hdiv space.
   else if (space_type == 2)
   {
-    u->val0 = new double [np];
-    u->val1 = new double [np];
+    u->val0 = new (arena) double [np];
+    u->val1 = new (arena) double [np];
 
     double *fn0 = fu->get_fn_values(0);
     double *fn1 = fu->get_fn_values(1);
@@ -202,7 +202,7 @@ Func<double>* init_fn(PrecalcShapeset *fu, RefMap *rm, const int order)
 }
 
 // Preparation of mesh-functions
-Func<scalar>* init_fn(MeshFunction *fu, RefMap *rm, const int order)
+Func<scalar>* init_fn(MeshFunction *fu, RefMap *rm, const int order, ScratchArena* arena)
 {
   // sanity checks
   if (fu == NULL) error("NULL MeshFunction in Func<scalar>*::init_fn().");
@@ -213,13 +213,13 @@ Func<scalar>* init_fn(MeshFunction *fu, RefMap *rm, const int order)
   fu->set_quad_order(order);
   double3* pt = quad->get_points(order);
   int np = quad->get_num_points(order);
-  Func<scalar>* u = new Func<scalar>(np, nc);
+  Func<scalar>* u = new (arena) Func<scalar>(np, nc);
 
   if (u->nc == 1)
   {
-    u->val = new scalar [np];
-    u->dx  = new scalar [np];
-    u->dy  = new scalar [np];
+    u->val = new (arena) scalar [np];
+    u->dx  = new (arena) scalar [np];
+    u->dy  = new (arena) scalar [np];
 
 		memcpy(u->val, fu->get_fn_values(), np * sizeof(scalar));
 		memcpy(u->dx, fu->get_dx_values(), np * sizeof(scalar));
@@ -227,9 +227,9 @@ Func<scalar>* init_fn(MeshFunction *fu, RefMap *rm, const int order)
 	}
 	else if (u->nc == 2)
   {
-    u->val0 = new scalar [np];
-    u->val1 = new scalar [np];
-    u->curl = new scalar [np];
+    u->val0 = new (arena) scalar [np];
+    u->val1 = new (arena) scalar [np];
+    u->curl = new (arena) scalar [np];
 
     memcpy(u->val0, fu->get_fn_values(0), np * sizeof(scalar));
     memcpy(u->val1, fu->get_fn_values(1), np * sizeof(scalar));
@@ -22,6 +22,7 @@
 #include "function.h"
 #include "solution.h"
 #include "refmap.h"
+#include "../../hermes_common/scratch_arena.h"
 
 #define callback(a)	a<double, scalar>, a<Ord, Ord>
 
@@ -370,20 +371,24 @@ public:
   virtual T   get_neighbor_diam()   const { return neighb_diam; }
 };
 
+// The following functions allocate the objects (including their arrays) from 'arena'
+// if it is given. Such objects must not be freed by free(), free_fn(), free_ord() or
+// delete, they are released together with the arena (see ScratchArena).
+
 /// Init element geometry for calculating the integration order.
-Geom<Ord>* init_geom_ord();
+Geom<Ord>* init_geom_ord(ScratchArena* arena = NULL);
 /// Init element geometry for volumetric integrals.
-Geom<double>* init_geom_vol(RefMap *rm, const int order);
+Geom<double>* init_geom_vol(RefMap *rm, const int order, ScratchArena* arena = NULL);
 /// Init element geometry for surface integrals.
-Geom<double>* init_geom_surf(RefMap *rm, SurfPos* surf_pos, const int order);
+Geom<double>* init_geom_surf(RefMap *rm, SurfPos* surf_pos, const int order, ScratchArena* arena = NULL);
 
 
 /// Init the function for calculation the integration order.
-Func<Ord>* init_fn_ord(const int order);
+Func<Ord>* init_fn_ord(const int order, ScratchArena* arena = NULL);
 /// Init the shape function for the evaluation of the volumetric/surface integral (transformation of values).
-Func<double>* init_fn(PrecalcShapeset *fu, RefMap *rm, const int order);
+Func<double>* init_fn(PrecalcShapeset *fu, RefMap *rm, const int order, ScratchArena* arena = NULL);
 /// Init the mesh-function for the evaluation of the volumetric/surface integral.
-Func<scalar>* init_fn(MeshFunction *fu, RefMap *rm, const int order);
+Func<scalar>* init_fn(MeshFunction *fu, RefMap *rm, const int order, ScratchArena* arena = NULL);
 
 
 
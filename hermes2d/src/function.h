@@ -129,7 +129,9 @@ public:
     // another reason may be a bug in Judy array usage in Hermes2D (this needs to be fixed)
     // -- as a workaround, you may for the time being use more than one pss for problems
     // where the basis and test functions can be on different meshes (i.e., multi-mesh).
-    if (cur_node == NULL || (cur_node->mask & mask) != mask) precalculate(order, mask);
+    bool cached = (cur_node != NULL && (cur_node->mask & mask) == mask);
+    HERMES_PERF_CACHE_HIT("function_tables", cached);
+    if (!cached) precalculate(order, mask);
   }
 
   /// \brief Returns function values.
@@ -0,0 +1,237 @@
+// This file is part of Hermes2D.
+//
+// Hermes2D is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// Hermes2D is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Hermes2D; if not, see <http://www.gnu.prg/licenses/>.
+
+#include "h2d_common.h"
+#include "mesh.h"
+#include "h2d_binary_reader.h"
+
+extern unsigned g_mesh_seq;
+
+// File layout (version 1):
+//   "H2DB", version
+//   int nv, ne, nm, nc, nr
+//   double2 vertices[nv]
+//   int5 elements[ne]        { v0, v1, v2, v3 (-1 for triangles), marker }, v0 = -1 for unused slots
+//   int3 boundaries[nm]      { v1, v2, marker }
+//   nc x curve               int { p1, p2, arc, degree, np, nk }, double angle, double3 pt[np], double kv[nk]
+//   int2 refinements[nr]     { element id, refinement type }
+
+H2DBinaryReader::H2DBinaryReader()
+{
+}
+
+H2DBinaryReader::~H2DBinaryReader()
+{
+}
+
+//// load //////////////////////////////////////////////////////////////////////////////////////////
+
+bool H2DBinaryReader::load(const char *filename, Mesh *mesh)
+{
+  FILE* f = fopen(filename, "rb");
+  if (f == NULL) error("Could not open the mesh file %s.", filename);
+  load_stream(f, mesh);
+  fclose(f);
+  return true;
+}
+
+
+void H2DBinaryReader::load_stream(FILE *f, Mesh *mesh)
+{
+  int i;
+
+  struct { char magic[4]; int ver; } hdr;
+  hermes_fread(&hdr, sizeof(hdr), 1, f);
+  if (hdr.magic[0] != 'H' || hdr.magic[1] != '2' || hdr.magic[2] != 'D' || hdr.magic[3] != 'B')
+    error("Not a Hermes2D binary mesh file.");
+  if (hdr.ver > 1)
+    error("Unsupported file version.");
+
+  int cnt[5];
+  hermes_fread(cnt, sizeof(int), 5, f);
+  int nv = cnt[0], ne = cnt[1], nm = cnt[2], nc = cnt[3], nr = cnt[4];
+  if (nv < 2 || ne < 1 || nm < 0 || nc < 0 || nr < 0) error("Corrupt mesh file.");
+
+  // vertices, elements and boundaries are read in bulk and the mesh is created at once
+  double2* verts = new double2[nv];
+  int5* elems = new int5[ne];
+  int3* mark = new int3[nm];
+  hermes_fread(verts, sizeof(double2), nv, f);
+  hermes_fread(elems, sizeof(int5), ne, f);
+  if (nm > 0) hermes_fread(mark, sizeof(int3), nm, f);
+  mesh->create(nv, verts, ne, elems, nm, mark);
+  delete [] mark;
+  delete [] elems;
+  delete [] verts;
+
+  // curves
+  for (i = 0; i < nc; i++)
+  {
+    int ch[6];
+    hermes_fread(ch, sizeof(int), 6, f);
+    Node* en = mesh->peek_edge_node(ch[0], ch[1]);
+    if (en == NULL) error("Curve #%d: edge %d-%d does not exist.", i, ch[0], ch[1]);
+    if (ch[4] < 2 || ch[5] < 2) error("Curve #%d: corrupt data.", i);
+
+    Nurbs* nurbs = new Nurbs;
+    nurbs->arc = (ch[2] != 0);
+    nurbs->degree = ch[3];
+    nurbs->np = ch[4];
+    nurbs->nk = ch[5];
+    hermes_fread(&nurbs->angle, sizeof(double), 1, f);
+    nurbs->pt = new double3[nurbs->np];
+    nurbs->kv = new double[nurbs->nk];
+    hermes_fread(nurbs->pt, sizeof(double3), nurbs->np, f);
+    hermes_fread(nurbs->kv, sizeof(double), nurbs->nk, f);
+    mesh->assign_nurbs(en, ch[0], nurbs);
+  }
+
+  // update refmap coeffs of curvilinear elements
+  Element* e;
+  if (nc > 0)
+    for_all_elements(e, mesh)
+      if (e->cm != NULL)
+        e->cm->update_refmap_coeffs(e);
+
+  // refinements
+  if (nr > 0)
+  {
+    int2* refs = new int2[nr];
+    hermes_fread(refs, sizeof(int2), nr, f);
+    for (i = 0; i < nr; i++)
+      mesh->refine_element(refs[i][0], refs[i][1]);
+    delete [] refs;
+  }
+  mesh->ninitial = mesh->elements.get_num_items();
+  mesh->seq = g_mesh_seq++;
+}
+
+//// save //////////////////////////////////////////////////////////////////////////////////////////
+
+// Collects the refinements of the element 'e' in the order in which they have to be
+// applied. 'id' is the id the element gets when the refinements are replayed on the
+// base mesh, 'next' is the id of the next element to be created.
+static void collect_refinements(Element* e, int id, int& next, std::vector<int>& refs)
+{
+  if (e->active) return;
+  if (e->bsplit())
+  {
+    refs.push_back(id); refs.push_back(0);
+    int sid = next; next += 4;
+    for (int i = 0; i < 4; i++)
+      collect_refinements(e->sons[i], sid+i, next, refs);
+  }
+  else if (e->hsplit())
+  {
+    refs.push_back(id); refs.push_back(1);
+    int sid = next; next += 2;
+    collect_refinements(e->sons[0], sid, next, refs);
+    collect_refinements(e->sons[1], sid+1, next, refs);
+  }
+  else
+  {
+    refs.push_back(id); refs.push_back(2);
+    int sid = next; next += 2;
+    collect_refinements(e->sons[2], sid, next, refs);
+    collect_refinements(e->sons[3], sid+1, next, refs);
+  }
+}
+
+
+bool H2DBinaryReader::save(const char *filename, Mesh *mesh)
+{
+  FILE* f = fopen(filename, "wb");
+  if (f == NULL) error("Could not create mesh file.");
+  save_stream(f, mesh);
+  fclose(f);
+  return true;
+}
+
+
+void H2DBinaryReader::save_stream(FILE *f, Mesh *mesh)
+{
+  int i, mrk;
+  Element* e;
+
+  // vertices
+  int nv = mesh->ntopvert;
+  double2* verts = new double2[nv];
+  for (i = 0; i < nv; i++)
+  {
+    verts[i][0] = mesh->nodes[i].x;
+    verts[i][1] = mesh->nodes[i].y;
+  }
+
+  // elements
+  int ne = mesh->get_num_base_elements();
+  int5* elems = new int5[ne];
+  for (i = 0; i < ne; i++)
+  {
+    e = mesh->get_element_fast(i);
+    for (int j = 0; j < 4; j++)
+      elems[i][j] = (e->used && j < (int) e->nvert) ? e->vn[j]->id : -1;
+    elems[i][4] = e->used ? e->marker : 0;
+  }
+
+  // boundary markers
+  std::vector<int> mark;
+  for_all_base_elements(e, mesh)
+    for (unsigned int k = 0; k < e->nvert; k++)
+      if ((mrk = mesh->get_base_edge_node(e, k)->marker))
+      {
+        mark.push_back(e->vn[k]->id);
+        mark.push_back(e->vn[e->next_vert(k)]->id);
+        mark.push_back(mrk);
+      }
+
+  // curved edges (on internal edges, only one of the two twin curves is saved)
+  std::vector<Nurbs*> curves;
+  std::vector<int> curve_pts;
+  for_all_base_elements(e, mesh)
+    if (e->is_curved())
+      for (unsigned int k = 0; k < e->nvert; k++)
+        if (e->cm->nurbs[k] != NULL && !(e->cm->nurbs[k]->twin && e->en[k]->ref == 2))
+        {
+          curves.push_back(e->cm->nurbs[k]);
+          curve_pts.push_back(e->vn[k]->id);
+          curve_pts.push_back(e->vn[e->next_vert(k)]->id);
+        }
+
+  // refinements
+  std::vector<int> refs;
+  int next = ne;
+  for_all_base_elements(e, mesh)
+    collect_refinements(e, e->id, next, refs);
+
+  hermes_fwrite("H2DB\001\000\000\000", 1, 8, f);
+  int cnt[5] = { nv, ne, (int) mark.size() / 3, (int) curves.size(), (int) refs.size() / 2 };
+  hermes_fwrite(cnt, sizeof(int), 5, f);
+  hermes_fwrite(verts, sizeof(double2), nv, f);
+  hermes_fwrite(elems, sizeof(int5), ne, f);
+  if (!mark.empty()) hermes_fwrite(&mark[0], sizeof(int), mark.size(), f);
+  for (i = 0; i < (int) curves.size(); i++)
+  {
+    Nurbs* nurbs = curves[i];
+    int ch[6] = { curve_pts[2*i], curve_pts[2*i+1], nurbs->arc, nurbs->degree, nurbs->np, nurbs->nk };
+    hermes_fwrite(ch, sizeof(int), 6, f);
+    hermes_fwrite(&nurbs->angle, sizeof(double), 1, f);
+    hermes_fwrite(nurbs->pt, sizeof(double3), nurbs->np, f);
+    hermes_fwrite(nurbs->kv, sizeof(double), nurbs->nk, f);
+  }
+  if (!refs.empty()) hermes_fwrite(&refs[0], sizeof(int), refs.size(), f);
+
+  delete [] elems;
+  delete [] verts;
+}
@@ -0,0 +1,45 @@
+// This file is part of Hermes2D.
+//
+// Hermes2D is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// Hermes2D is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Hermes2D; if not, see <http://www.gnu.prg/licenses/>.
+
+#ifndef _H2D_BINARY_READER_H_
+#define _H2D_BINARY_READER_H_
+
+#include "mesh_loader.h"
+
+/// Mesh loader for the binary Hermes2D format ("H2DB").
+///
+/// The file holds the same information as the text format (vertices, elements,
+/// boundary markers, curves and refinements) as plain arrays. They are read with
+/// a single fread() each, without building a parse tree, and the mesh is created
+/// by Mesh::create() with the hash table sized in advance. A text mesh can be
+/// converted once by loading it with H2DReader and saving it with H2DBinaryReader::save().
+///
+/// @ingroup meshloaders
+class HERMES_API H2DBinaryReader : public MeshLoader
+{
+public:
+  H2DBinaryReader();
+  virtual ~H2DBinaryReader();
+
+  virtual bool load(const char *file_name, Mesh *mesh);
+  virtual bool save(const char *file_name, Mesh *mesh);
+
+  /// Reads the mesh from an open stream, which is left positioned after the mesh data.
+  void load_stream(FILE *f, Mesh *mesh);
+  /// Writes the mesh to an open stream.
+  void save_stream(FILE *f, Mesh *mesh);
+};
+
+#endif
@@ -17,6 +17,7 @@
 #define __H2D_COMMON_H_
 
 #include "../../hermes_common/common.h"
+#include "../../hermes_common/perf_counters.h"
 
 // H2D-specific includes.
 #include <Judy.h>
@@ -202,7 +202,6 @@ void H2DReader::load_stream(FILE *f, Mesh *mesh)
     node->type = H2D_TYPE_VERTEX;
     node->bnd = 0;
     node->p1 = node->p2 = -1;
-    node->next_hash = NULL;
 
     if ((line = get_line(f)) == NULL) eof_error;
     if (sscanf(line, "%lf %lf", &node->x, &node->y) != 2) error("Error reading vertex data");
@@ -485,7 +484,7 @@ bool H2DReader::load(const char *filename, Mesh *mesh)
 
 bool H2DReader::load_internal(FILE *f, Mesh *mesh, const char *filename)
 {
-  int i, j, k, n;
+  int i, j, n;
   Node* en;
   bool debug = false;
 
@@ -519,7 +518,6 @@ bool H2DReader::load_internal(FILE *f, Mesh *mesh, const char *filename)
     node->type = H2D_TYPE_VERTEX;
     node->bnd = 0;
     node->p1 = node->p2 = -1;
-    node->next_hash = NULL;
 
     if (!mesh_parser_get_doubles(pair, 2, &node->x, &node->y))
       error("File %s: invalid vertex #%d.", filename, i);
@@ -618,39 +616,7 @@ bool H2DReader::load_internal(FILE *f, Mesh *mesh, const char *filename)
       Node* en;
       int p1, p2;
       Nurbs* nurbs = load_nurbs(mesh, curve, i, &en, p1, p2);
-
-      // assign the nurbs to the elements sharing the edge node
-      for (k = 0; k < 2; k++)
-      {
-        Element* e = en->elem[k];
-        if (e == NULL) continue;
-
-        if (e->cm == NULL)
-        {
-          e->cm = new CurvMap;
-          memset(e->cm, 0, sizeof(CurvMap));
-          e->cm->toplevel = 1;
-          e->cm->order = 4;
-        }
-
-        int idx = -1;
-        for (j = 0; j < e->nvert; j++)
-          if (e->en[j] == en) { idx = j; break; }
-        assert(idx >= 0);
-
-        if (e->vn[idx]->id == p1)
-        {
-          e->cm->nurbs[idx] = nurbs;
-          nurbs->ref++;
-        }
-        else
-        {
-          Nurbs* nurbs_rev = mesh->reverse_nurbs(nurbs);
-          e->cm->nurbs[idx] = nurbs_rev;
-          nurbs_rev->ref++;
-        }
-      }
-      if (!nurbs->ref) delete nurbs;
+      mesh->assign_nurbs(en, p1, nurbs);
     }
   }
 
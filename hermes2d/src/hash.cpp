@@ -20,39 +20,41 @@
 
 HashTable::HashTable()
 {
-  v_table = NULL; e_table = NULL;
-  nqueries = ncollisions = 0;
+  memset(&v_table, 0, sizeof(Table));
+  memset(&e_table, 0, sizeof(Table));
+  nqueries = nprobes = 0;
 }
 
 
-void HashTable::init(int size)
+void HashTable::init_table(Table* t, int size)
 {
-  v_table = e_table = NULL;
-  nqueries = ncollisions = 0;
+  t->slots = new HashSlot[size];
+  memset(t->slots, 0xff, size * sizeof(HashSlot));
+  t->mask = size-1;
+  t->count = 0;
+  t->min_size = size;
+}
 
-  mask = size-1;
-  if (size & mask) error("Parameter 'size' must be a power of two.");
 
-  // allocate and initialize the hash tables
-  v_table = new Node*[size];
-  e_table = new Node*[size];
+void HashTable::init(int size)
+{
+  if (size & (size-1)) error("Parameter 'size' must be a power of two.");
+  size = std::max(size, 16);
 
-  memset(v_table, 0, size * sizeof(Node*));
-  memset(e_table, 0, size * sizeof(Node*));
+  free_table(&v_table);
+  free_table(&e_table);
+  init_table(&v_table, size);
+  init_table(&e_table, size);
 
-  nqueries = ncollisions = 0;
+  nqueries = nprobes = 0;
 }
 
 
-void HashTable::copy_list(Node** ptr, Node* node)
+void HashTable::copy_table(Table* t, const Table* src)
 {
-  while (node != NULL)
-  {
-    *ptr = &nodes[node->id];
-    ptr = &((*ptr)->next_hash);
-    node = node->next_hash;
-  }
-  *ptr = NULL;
+  *t = *src;
+  t->slots = new HashSlot[t->mask+1];
+  memcpy(t->slots, src->slots, (t->mask+1) * sizeof(HashSlot));
 }
 
 
@@ -60,78 +62,173 @@ void HashTable::copy(const HashTable* ht)
 {
   free();
   nodes.copy(ht->nodes);
-  mask = ht->mask;
 
-  v_table = new Node*[mask+1];
-  e_table = new Node*[mask+1];
-  for (int i = 0; i <= mask; i++)
-  {
-    copy_list(v_table + i, ht->v_table[i]);
-    copy_list(e_table + i, ht->e_table[i]);
-  }
+  // the node ids are the same, so the slots can be copied as they are
+  copy_table(&v_table, &ht->v_table);
+  copy_table(&e_table, &ht->e_table);
+}
+
+
+void HashTable::share(const HashTable* ht)
+{
+  free();
+  nodes.share(ht->nodes);
+  copy_table(&v_table, &ht->v_table);
+  copy_table(&e_table, &ht->e_table);
 }
 
 
 void HashTable::rebuild()
 {
-  memset(v_table, 0, (mask+1) * sizeof(Node*));
-  memset(e_table, 0, (mask+1) * sizeof(Node*));
+  memset(v_table.slots, 0xff, (v_table.mask+1) * sizeof(HashSlot));
+  memset(e_table.slots, 0xff, (e_table.mask+1) * sizeof(HashSlot));
+  v_table.count = e_table.count = 0;
 
   Node* node;
   for_all_nodes(node, this)
-  {
-    int p1 = node->p1, p2 = node->p2;
-    if (p1 > p2) std::swap(p1, p2);
-    int idx = hash(p1, p2);
+    if (node->p1 >= 0)
+      insert_slot(node->type == H2D_TYPE_VERTEX ? &v_table : &e_table, node);
+}
 
-    if (node->type == H2D_TYPE_VERTEX)
-    {
-      node->next_hash = v_table[idx];
-      v_table[idx] = node;
-    }
-    else
+
+void HashTable::free_table(Table* t)
+{
+  if (t->slots != NULL)
+    delete [] t->slots;
+  memset(t, 0, sizeof(Table));
+}
+
+
+void HashTable::free()
+{
+  nodes.free();
+  dump_hash_stat();
+  free_table(&v_table);
+  free_table(&e_table);
+}
+
+
+void HashTable::release()
+{
+  nodes.release();
+  free_table(&v_table);
+  free_table(&e_table);
+}
+
+
+void HashTable::get_probe_lengths(double& mean, int& max) const
+{
+  long sum = 0;
+  int n = 0;
+  max = 0;
+  const Table* tables[2] = { &v_table, &e_table };
+  for (int k = 0; k < 2; k++)
+  {
+    const Table* t = tables[k];
+    if (t->slots == NULL) continue;
+    for (int i = 0; i <= t->mask; i++)
     {
-      node->next_hash = e_table[idx];
-      e_table[idx] = node;
+      HashSlot* s = t->slots + i;
+      if (s->id < 0) continue;
+      int len = ((i - hash(s->p1, s->p2, t->mask)) & t->mask) + 1;
+      sum += len;
+      max = std::max(max, len);
+      n++;
     }
   }
+  mean = n ? (double) sum / n : 0.0;
 }
 
 
-void HashTable::free()
+void HashTable::dump_hash_stat()
 {
-  nodes.free();
-  if (v_table != NULL)
+  if (nqueries > 0 && nprobes > 4*nqueries)
+    warn("Hashtable: nqueries=%d nprobes=%d", nqueries, nprobes);
+}
+
+
+void HashTable::resize_table(Table* t, int size)
+{
+  HashSlot* old = t->slots;
+  int old_size = t->mask+1;
+
+  t->slots = new HashSlot[size];
+  memset(t->slots, 0xff, size * sizeof(HashSlot));
+  t->mask = size-1;
+
+  for (int i = 0; i < old_size; i++)
   {
-    delete [] v_table;
-    v_table = NULL;
+    if (old[i].id < 0) continue;
+    int j = hash(old[i].p1, old[i].p2, t->mask);
+    while (t->slots[j].id >= 0)
+      j = (j+1) & t->mask;
+    t->slots[j] = old[i];
   }
-  if (e_table != NULL)
+  delete [] old;
+}
+
+
+inline int HashTable::find_slot(Table* t, int p1, int p2)
+{
+  nqueries++;
+  int i = hash(p1, p2, t->mask);
+  while (1)
   {
-    delete [] e_table;
-    e_table = NULL;
+    nprobes++;
+    HashSlot* s = t->slots + i;
+    if (s->id < 0 || (s->p1 == p1 && s->p2 == p2)) return i;
+    i = (i+1) & t->mask;
   }
-  dump_hash_stat();
 }
 
 
-void HashTable::dump_hash_stat()
+void HashTable::insert_slot(Table* t, Node* node)
 {
-  if (ncollisions > 2*nqueries)
-    warn("Hashtable: nqueries=%d ncollisions=%d", nqueries, ncollisions);
+  // keep the table at most half full
+  if (2*(t->count+1) > t->mask+1)
+    resize_table(t, 2*(t->mask+1));
+
+  int p1 = node->p1, p2 = node->p2;
+  if (p1 > p2) std::swap(p1, p2);
+  int i = hash(p1, p2, t->mask);
+  while (t->slots[i].id >= 0)
+    i = (i+1) & t->mask;
+
+  t->slots[i].p1 = p1;
+  t->slots[i].p2 = p2;
+  t->slots[i].id = node->id;
+  t->count++;
 }
 
 
-inline Node* HashTable::search_list(Node* node, int p1, int p2)
+void HashTable::remove_slot(Table* t, int id)
 {
-  nqueries++;
-  while (node != NULL)
+  int p1 = nodes[id].p1, p2 = nodes[id].p2;
+  if (p1 > p2) std::swap(p1, p2);
+  int i = find_slot(t, p1, p2);
+  if (t->slots[i].id != id) return;
+
+  // backward shift deletion: move the following nodes of the probe sequence back,
+  // so that no search stops at the new empty slot too early
+  int j = i;
+  while (1)
   {
-    if (node->p1 == p1 && node->p2 == p2) return node;
-    node = node->next_hash;
-    ncollisions++;
+    j = (j+1) & t->mask;
+    HashSlot* sl = t->slots + j;
+    if (sl->id < 0) break;
+    // the node can fill the hole unless its home slot is between the hole and 'j'
+    int home = hash(sl->p1, sl->p2, t->mask);
+    if (((j - home) & t->mask) >= ((j - i) & t->mask))
+    {
+      t->slots[i] = *sl;
+      i = j;
+    }
   }
-  return NULL;
+  t->slots[i].id = -1;
+
+  // shrink the table when it is almost empty
+  if (--t->count < (t->mask+1) / 8 && t->mask+1 > t->min_size)
+    resize_table(t, (t->mask+1) / 2);
 }
 
 
@@ -139,9 +236,8 @@ Node* HashTable::get_vertex_node(int p1, int p2)
 {
   // search for the node in the vertex hashtable
   if (p1 > p2) std::swap(p1, p2);
-  int i = hash(p1, p2);
-  Node* node = search_list(v_table[i], p1, p2);
-  if (node != NULL) return node;
+  int i = find_slot(&v_table, p1, p2);
+  if (v_table.slots[i].id >= 0) return &nodes[v_table.slots[i].id];
 
   // not found - create a new one
   Node* newnode = nodes.add();
@@ -155,8 +251,7 @@ Node* HashTable::get_vertex_node(int p1, int p2)
   newnode->y = (nodes[p1].y + nodes[p2].y) * 0.5;
 
   // insert into hashtable
-  newnode->next_hash = v_table[i];
-  v_table[i] = newnode;
+  insert_slot(&v_table, newnode);
 
   return newnode;
 }
@@ -166,9 +261,8 @@ Node* HashTable::get_edge_node(int p1, int p2)
 {
   // search for the node in the edge hashtable
   if (p1 > p2) std::swap(p1, p2);
-  int i = hash(p1, p2);
-  Node* node = search_list(e_table[i], p1, p2);
-  if (node != NULL) return node;
+  int i = find_slot(&e_table, p1, p2);
+  if (e_table.slots[i].id >= 0) return &nodes[e_table.slots[i].id];
 
   // not found - create a new one
   Node* newnode = nodes.add();
@@ -181,8 +275,7 @@ Node* HashTable::get_edge_node(int p1, int p2)
   newnode->elem[0] = newnode->elem[1] = NULL;
 
   // insert into hashtable
-  newnode->next_hash = e_table[i];
-  e_table[i] = newnode;
+  insert_slot(&e_table, newnode);
 
   return newnode;
 }
@@ -191,33 +284,23 @@ Node* HashTable::get_edge_node(int p1, int p2)
 Node* HashTable::peek_vertex_node(int p1, int p2)
 {
   if (p1 > p2) std::swap(p1, p2);
-  return search_list(v_table[hash(p1, p2)], p1, p2);
+  int i = find_slot(&v_table, p1, p2);
+  return (v_table.slots[i].id >= 0) ? &nodes[v_table.slots[i].id] : NULL;
 }
 
 
 Node* HashTable::peek_edge_node(int p1, int p2)
 {
   if (p1 > p2) std::swap(p1, p2);
-  return search_list(e_table[hash(p1, p2)], p1, p2);
+  int i = find_slot(&e_table, p1, p2);
+  return (e_table.slots[i].id >= 0) ? &nodes[e_table.slots[i].id] : NULL;
 }
 
 
 void HashTable::remove_vertex_node(int id)
 {
   // remove the node from the hash table
-  int i = hash(nodes[id].p1, nodes[id].p2);
-  Node** ptr = v_table + i;
-  Node* node = *ptr;
-  while (node != NULL)
-  {
-    if (node->id == id)
-    {
-      *ptr = node->next_hash;
-      break;
-    }
-    ptr = &node->next_hash;
-    node = *ptr;
-  }
+  remove_slot(&v_table, id);
 
   // remove node from the array
   nodes.remove(id);
@@ -227,19 +310,7 @@ void HashTable::remove_vertex_node(int id)
 void HashTable::remove_edge_node(int id)
 {
   // remove the node from the hash table
-  int i = hash(nodes[id].p1, nodes[id].p2);
-  Node** ptr = e_table + i;
-  Node* node = *ptr;
-  while (node != NULL)
-  {
-    if (node->id == id)
-    {
-      *ptr = node->next_hash;
-      break;
-    }
-    ptr = &node->next_hash;
-    node = *ptr;
-  }
+  remove_slot(&e_table, id);
 
   // remove node from the array
   nodes.remove(id);
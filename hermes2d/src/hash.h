@@ -21,12 +21,25 @@
 struct Node;
 
 
+/// One slot of the node hash tables: the parent ids of a node and its id (-1 for an empty slot).
+struct HashSlot
+{
+  int p1, p2;
+  int id;
+};
+
 
 /// \brief Stores and searches node tables.
 ///
 /// HashTable is a base class for Mesh. It serves as a container for all nodes
 /// of a mesh. Moreover, it has node searching functions based on hash tables.
 ///
+/// The vertex and edge nodes are found by their parent ids in two open-addressing
+/// hash tables with linear probing. The slots hold the parent ids, so a search does
+/// not touch the nodes until it finds one. A table doubles when it gets half full
+/// and halves when it is less than 1/8 full, so the probe sequences stay short for
+/// any number of nodes.
+///
 class HERMES_API HashTable
 {
 public:
@@ -49,6 +62,13 @@ public:
   /// Returns an edge node with parent id's p1 and p2 if it exists, NULL otherwise.
   Node* peek_edge_node(int p1, int p2);
 
+  /// Warns if the searches needed too many probes on average.
+  void dump_hash_stat();
+
+  /// Returns the mean and the maximum probe length of the stored nodes, i.e., the
+  /// number of slots a successful search examines.
+  void get_probe_lengths(double& mean, int& max) const;
+
 
 // The following functions are used by the derived class Mesh:
 protected:
@@ -56,23 +76,27 @@ protected:
   HERMES_API_USED_TEMPLATE(Array<Node>);
   Array<Node> nodes; ///< Array storing all nodes
 
-  static const int H2D_DEFAULT_HASH_SIZE = 0x20000; // 128K entries
+  static const int H2D_DEFAULT_HASH_SIZE = 0x1000; // 4K slots, the tables grow as needed
 
   /// Initializes the hash table.
-  /// \param size [in] Hash table size; must be a power of two.
+  /// \param size [in] Initial size of the tables; must be a power of two.
   void init(int size = H2D_DEFAULT_HASH_SIZE);
 
   /// Copies another hash table contents
   void copy(const HashTable* ht);
 
+  /// Makes this table use the nodes of another one (see Array::share()). Only the
+  /// hash tables are copied.
+  void share(const HashTable* ht);
+
   /// Reconstructs the hashtable, after, e.g., the nodes have been loaded from a file.
   void rebuild();
 
   /// Frees all memory used by the instance.
   void free();
 
-  /// Prints hash table statistics for debugging purposes.
-  void dump_hash_stat();
+  /// Frees the hash tables, but not the nodes shared with another table.
+  void release();
 
   /// The central function: obtains a vertex node pointer given the id
   /// numbers of its parents. If the vertex node does not exist, it is
@@ -94,20 +118,37 @@ protected:
 // Internal members
 private:
 
-  Node** v_table; ///< Vertex node hash table
-  Node** e_table; ///< Edge node hash table
-
-  int mask;
-  int nqueries, ncollisions;
-
-  int hash(int p1, int p2) { return (984120265*p1 + 125965121*p2) & mask; }
-
-  /// Searches a list of hash synonyms given the first list item.
-  /// Returns the node matching the parent ids p1 and p2.
-  Node* search_list(Node* node, int p1, int p2);
-
-  /// Creates a copy of a hash synonym list.
-  void copy_list(Node** ptr, Node* node);
+  struct Table
+  {
+    HashSlot* slots;
+    int mask;  ///< number of slots minus one
+    int count; ///< number of nodes stored
+    int min_size;
+  };
+
+  Table v_table; ///< Vertex node hash table
+  Table e_table; ///< Edge node hash table
+
+  int nqueries, nprobes;
+
+  static int hash(int p1, int p2, int mask)
+  {
+    uint64_t key = ((uint64_t) (unsigned) p1 << 32) | (unsigned) p2;
+    return (int) ((key * 0x9E3779B97F4A7C15ULL) >> 32) & mask;
+  }
+
+  void init_table(Table* t, int size);
+  void copy_table(Table* t, const Table* src);
+  void free_table(Table* t);
+  void resize_table(Table* t, int size);
+
+  /// Returns the slot holding the node with the parents p1 < p2, or the empty slot
+  /// where the node would be inserted.
+  int find_slot(Table* t, int p1, int p2);
+
+  /// Inserts the node, the caller makes sure that it is not in the table.
+  void insert_slot(Table* t, Node* node);
+  void remove_slot(Table* t, int id);
 
   friend struct Node;
   friend class H2DReader;
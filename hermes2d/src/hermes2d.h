@@ -27,6 +27,7 @@
 #include "mesh.h"
 #include "mesh_loader.h"
 #include "h2d_reader.h"
+#include "h2d_binary_reader.h"
 #include "exodusii.h"
 
 #include "space/space_h1.h"
@@ -67,8 +68,11 @@
 #include "integrals_h1.h"
 #include "integrals_hcurl.h"
 #include "integrals_hdiv.h"
+#include "form_expr.h"
+#include "complex_block.h"
 
 #include "solution.h"
+#include "checkpoint.h"
 #include "filter.h"
 
 #include "norm.h"
@@ -96,6 +100,7 @@
 #include "adapt/adapt.h"
 #include "neighbor.h"
 #include "ogprojection.h"
+#include "ensemble.h"
 
 #include "numerical_flux.h"
 /**
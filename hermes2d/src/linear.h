@@ -24,6 +24,12 @@ const double HERMES_EPS_LOW    = 0.0014;
 const double HERMES_EPS_NORMAL = 0.0008;
 const double HERMES_EPS_HIGH   = 0.0003;
 
+// maximum subdivision level (2^N)
+const int LIN_MAX_LEVEL = 6;
+
+// number of points of the interior linearization table of a quad
+const int LIN_MAX_PTS = 21;
+
 
 /// Linearizer is a utility class which converts a higher-order FEM solution defined on
 /// a curvilinear, irregular mesh to a linear FEM solution defined on a straight-edged,
@@ -33,6 +39,18 @@ const double HERMES_EPS_HIGH   = 0.0003;
 /// solution (e.g., gradients or in Hcurl) by inserting double vertices where necessary.
 /// Linearizer also serves as a container for the resulting linearized mesh.
 ///
+/// The elements can be processed by several threads (set_num_threads()). Every thread
+/// subdivides a contiguous range of elements into its own vertex and triangle buffers,
+/// evaluating the solution through a SolutionEvaluator. The buffers are then merged
+/// element by element in the order of the mesh, so the vertices are shared in the same
+/// way and the triangulation is the same as the one produced by a single thread (only
+/// the numbering of the vertices differs). When the maximum of the solution is
+/// determined automatically, every thread starts from the maximum of the vertex values
+/// instead of the maximum of all elements processed so far, which can change the
+/// refinement of elements whose error is close to the threshold. Only solutions of class
+/// Solution without displacement are processed in parallel, other functions (filters)
+/// are always processed by one thread. The regularization runs in one thread.
+///
 class HERMES_API Linearizer // (implemented in linear1.cpp)
 {
 public:
@@ -45,6 +63,10 @@ public:
                         MeshFunction* xdisp = NULL, MeshFunction* ydisp = NULL,
                         double dmult = 1.0);
 
+  /// Sets the number of threads used by process_solution() (default is one).
+  void set_num_threads(int num_threads) { this->num_threads = std::max(1, num_threads); }
+  int get_num_threads() const { return num_threads; }
+
   void lock_data() const { pthread_mutex_lock(&data_mutex); }
   void unlock_data() const { pthread_mutex_unlock(&data_mutex); }
 
@@ -91,6 +113,28 @@ protected:
   bool curved, disp;
   double min_val, max_val;
 
+  int num_threads;
+
+  /// Results of one element processed by a worker of the parallel linearization.
+  struct ElemRecord
+  {
+    Element* e;
+    int iv[4];   ///< top-level vertices of the element
+    int nv, nt;  ///< numbers of vertices and triangles of the worker after the element
+  };
+
+  // the state of a worker of the parallel linearization (NULL evaluator in the master);
+  // the values are kept for every other level, see process_triangle()
+  SolutionEvaluator* ev;
+  ElemRecord* recs;
+  int num_recs;
+  int* id2id;       ///< top-level vertices of the vertex nodes
+  double* top_val;  ///< values of the solution in the vertices of the elements of the worker
+  scalar ev_val[2][LIN_MAX_LEVEL/2][LIN_MAX_PTS];
+  double ev_phx[LIN_MAX_LEVEL/2][LIN_MAX_PTS];
+  double ev_phy[LIN_MAX_LEVEL/2][LIN_MAX_PTS];
+  pthread_t thread;
+
   int get_vertex(int p1, int p2, double x, double y, double value);
   int get_top_vertex(int id, double value);
   int peek_vertex(int p1, int p2);
@@ -142,6 +186,36 @@ protected:
   void find_min_max();
   void print_hash_stats();
 
+  void push_transform(int son)
+  {
+    if (ev != NULL) ev->push_transform(son);
+    else sln->push_transform(son);
+  }
+
+  void pop_transform()
+  {
+    if (ev != NULL) ev->pop_transform();
+    else sln->pop_transform();
+  }
+
+  /// Evaluates 'item' of the evaluator at the points of the linearization table 'order'
+  /// (0 = vertices, 1 = interior points) of the current sub-element.
+  static void get_lin_values(SolutionEvaluator* ev, int order, int item, scalar* val);
+  /// Returns the physical coordinates of the same points.
+  static void get_lin_phys(SolutionEvaluator* ev, int order, double* phx, double* phy);
+
+  /// Returns the number of threads to use for 'num' elements, or one if 'fn' cannot be
+  /// evaluated by a SolutionEvaluator.
+  int get_parallel_threads(MeshFunction* fn, int item, int num);
+  /// Processes the elements by 'nt' threads and merges the results, see the class description.
+  void process_parallel(int nt, Element** elems, int num, int* id2id, double* top_val);
+  /// Copies the vertex 'v' of the worker into this linearizer, 'map' gives the indices of
+  /// the preceding vertices of the worker.
+  int merge_vertex(Linearizer* w, int v, int* map);
+  /// Processes the elements of a worker.
+  void process_range();
+  static void* process_range_worker(void* data);
+
   mutable pthread_mutex_t data_mutex;
 
   static void calc_aabb(double* x, double* y, int stride, int num, double* min_x, double* max_x, double* min_y, double* max_y); ///< Calculates AABB from an array of X-axis and Y-axis coordinates. The distance between values in the array is stride bytes.
@@ -176,13 +250,21 @@ protected:
   char** ltext;
   double2* lbox;
 
+  Space* space;
+
+  void process_element(Element* e, double* x, double* y);
+  void process_parallel(int nt);
+  void process_range();
+  static void* process_range_worker(void* data);
+
 };
 
 
 /// "Vectorizer" is a Linearizer for vector solutions. The only difference is
 /// that linearized vertices are vector-valued. Also, regularization of the
 /// resulting mesh is not attempted. The class can handle different meshes in
-/// both X and Y components.
+/// both X and Y components. The elements are processed by several threads as in the
+/// Linearizer if both components are solutions defined on the same mesh.
 ///
 class HERMES_API Vectorizer : public Linearizer // (implemented in linear3.cpp)
 {
@@ -218,6 +300,8 @@ protected:
   int2* dashes;
   int nd, ed, cd;
 
+  SolutionEvaluator* yev; ///< evaluator of the Y component in a worker (may be the same as 'ev')
+
   int get_vertex(int p1, int p2, double x, double y, double xvalue, double yvalue);
   int create_vertex(double x, double y, double xvalue, double yvalue);
   void process_dash(int iv1, int iv2);
@@ -243,12 +327,24 @@ protected:
 
   void push_transform(int son)
   {
+    if (ev != NULL)
+    {
+      ev->push_transform(son);
+      if (yev != ev) yev->push_transform(son);
+      return;
+    }
     xsln->push_transform(son);
     if (ysln != xsln) ysln->push_transform(son);
   }
 
   void pop_transform()
   {
+    if (ev != NULL)
+    {
+      ev->pop_transform();
+      if (yev != ev) yev->pop_transform();
+      return;
+    }
     xsln->pop_transform();
     if (ysln != xsln) ysln->pop_transform();
   }
@@ -261,11 +357,11 @@ protected:
 
   void find_min_max();
 
-};
-
+  void process_parallel(int nt, Element** elems, int num);
+  void process_range();
+  static void* process_range_worker(void* data);
 
-// maximum subdivision level (2^N)
-const int LIN_MAX_LEVEL = 6;
+};
 
 
 #define lin_init_array(array, type, c, e) \
@@ -132,6 +132,12 @@ Linearizer::Linearizer()
   verts = NULL;
   tris = NULL;
   edges = NULL;
+  info = NULL;
+  hash_table = NULL;
+  num_threads = 1;
+  ev = NULL;
+  recs = NULL;
+  num_recs = 0;
 
   pthread_mutexattr_t attr;
   pthread_mutexattr_init(&attr);
@@ -173,7 +179,8 @@ int Linearizer::get_vertex(int p1, int p2, double x, double y, double value)
 int Linearizer::get_top_vertex(int id, double value)
 {
   if (fabs(value - verts[id][2]) < max*1e-24) return id;
-  return get_vertex(-rand(), -rand(), verts[id][0], verts[id][1], value);
+  // a copy of the vertex for a discontinuous solution, the parents are unique
+  return get_vertex(-1 - nv, -1 - nv, verts[id][0], verts[id][1], value);
 }
 
 
@@ -253,16 +260,25 @@ void Linearizer::process_triangle(int iv0, int iv1, int iv2, int level,
     if (!(level & 1))
     {
       // obtain solution values
-      sln->set_quad_order(1, item);
-      val = sln->get_values(ia, ib);
-      if (auto_max)
-        for (i = 0; i < lin_np_tri[1]; i++) {
-          double v = getval(i);
-          if (finite(v) && fabs(v) > max) max = fabs(v);
-        }
+      if (ev != NULL)
+      {
+        val = ev_val[0][level / 2];
+        get_lin_values(ev, 1, item, val);
+      }
+      else
+      {
+        sln->set_quad_order(1, item);
+        val = sln->get_values(ia, ib);
+      }
 
       // obtain physical element coordinates
-      if (curved || disp)
+      if (ev != NULL && curved)
+      {
+        phx = ev_phx[level / 2];
+        phy = ev_phy[level / 2];
+        get_lin_phys(ev, 1, phx, phy);
+      }
+      else if (curved || disp)
       {
         RefMap* refmap = sln->get_refmap();
         phx = refmap->get_phys_x(1);
@@ -348,10 +364,10 @@ void Linearizer::process_triangle(int iv0, int iv1, int iv2, int level,
       int mid2 = get_vertex(iv2, iv0, midval[0][2], midval[1][2], getval(idx[2]));
 
       // recur to sub-elements
-      sln->push_transform(0);  process_triangle(iv0, mid0, mid2,  level+1, val, phx, phy, tri_indices[1]);  sln->pop_transform();
-      sln->push_transform(1);  process_triangle(mid0, iv1, mid1,  level+1, val, phx, phy, tri_indices[2]);  sln->pop_transform();
-      sln->push_transform(2);  process_triangle(mid2, mid1, iv2,  level+1, val, phx, phy, tri_indices[3]);  sln->pop_transform();
-      sln->push_transform(3);  process_triangle(mid1, mid2, mid0, level+1, val, phx, phy, tri_indices[4]);  sln->pop_transform();
+      push_transform(0);  process_triangle(iv0, mid0, mid2,  level+1, val, phx, phy, tri_indices[1]);  pop_transform();
+      push_transform(1);  process_triangle(mid0, iv1, mid1,  level+1, val, phx, phy, tri_indices[2]);  pop_transform();
+      push_transform(2);  process_triangle(mid2, mid1, iv2,  level+1, val, phx, phy, tri_indices[3]);  pop_transform();
+      push_transform(3);  process_triangle(mid1, mid2, mid0, level+1, val, phx, phy, tri_indices[4]);  pop_transform();
       return;
     }
   }
@@ -378,16 +394,25 @@ void Linearizer::process_quad(int iv0, int iv1, int iv2, int iv3, int level,
     if (!(level & 1)) // this is an optimization: do the following only every other time
     {
       // obtain solution values
-      sln->set_quad_order(1, item);
-      val = sln->get_values(ia, ib);
-      if (auto_max)
-        for (i = 0; i < lin_np_quad[1]; i++) {
-          double v = getval(i);
-          if (finite(v) && fabs(v) > max) max = fabs(v);
-        }
+      if (ev != NULL)
+      {
+        val = ev_val[0][level / 2];
+        get_lin_values(ev, 1, item, val);
+      }
+      else
+      {
+        sln->set_quad_order(1, item);
+        val = sln->get_values(ia, ib);
+      }
 
       // obtain physical element coordinates
-      if (curved || disp)
+      if (ev != NULL && curved)
+      {
+        phx = ev_phx[level / 2];
+        phy = ev_phy[level / 2];
+        get_lin_phys(ev, 1, phx, phy);
+      }
+      else if (curved || disp)
       {
         RefMap* refmap = sln->get_refmap();
         phx = refmap->get_phys_x(1);
@@ -499,20 +524,20 @@ void Linearizer::process_quad(int iv0, int iv1, int iv2, int iv3, int level,
       // recur to sub-elements
       if (split == 3)
       {
-        sln->push_transform(0);  process_quad(iv0, mid0, mid4, mid3, level+1, val, phx, phy, quad_indices[1]);  sln->pop_transform();
-        sln->push_transform(1);  process_quad(mid0, iv1, mid1, mid4, level+1, val, phx, phy, quad_indices[2]);  sln->pop_transform();
-        sln->push_transform(2);  process_quad(mid4, mid1, iv2, mid2, level+1, val, phx, phy, quad_indices[3]);  sln->pop_transform();
-        sln->push_transform(3);  process_quad(mid3, mid4, mid2, iv3, level+1, val, phx, phy, quad_indices[4]);  sln->pop_transform();
+        push_transform(0);  process_quad(iv0, mid0, mid4, mid3, level+1, val, phx, phy, quad_indices[1]);  pop_transform();
+        push_transform(1);  process_quad(mid0, iv1, mid1, mid4, level+1, val, phx, phy, quad_indices[2]);  pop_transform();
+        push_transform(2);  process_quad(mid4, mid1, iv2, mid2, level+1, val, phx, phy, quad_indices[3]);  pop_transform();
+        push_transform(3);  process_quad(mid3, mid4, mid2, iv3, level+1, val, phx, phy, quad_indices[4]);  pop_transform();
       }
       else if (split == 1) // h-split
       {
-        sln->push_transform(4);  process_quad(iv0, iv1, mid1, mid3, level+1, val, phx, phy, quad_indices[5]);  sln->pop_transform();
-        sln->push_transform(5);  process_quad(mid3, mid1, iv2, iv3, level+1, val, phx, phy, quad_indices[6]);  sln->pop_transform();
+        push_transform(4);  process_quad(iv0, iv1, mid1, mid3, level+1, val, phx, phy, quad_indices[5]);  pop_transform();
+        push_transform(5);  process_quad(mid3, mid1, iv2, iv3, level+1, val, phx, phy, quad_indices[6]);  pop_transform();
       }
       else // v-split
       {
-        sln->push_transform(6);  process_quad(iv0, mid0, mid2, iv3, level+1, val, phx, phy, quad_indices[7]);  sln->pop_transform();
-        sln->push_transform(7);  process_quad(mid0, iv1, iv2, mid2, level+1, val, phx, phy, quad_indices[8]);  sln->pop_transform();
+        push_transform(6);  process_quad(iv0, mid0, mid2, iv3, level+1, val, phx, phy, quad_indices[7]);  pop_transform();
+        push_transform(7);  process_quad(mid0, iv1, iv2, mid2, level+1, val, phx, phy, quad_indices[8]);  pop_transform();
       }
       return;
     }
@@ -545,6 +570,165 @@ void Linearizer::process_edge(int iv1, int iv2, int marker)
 }
 
 
+//// parallel linearization //////////////////////////////////////////////////////////////////////
+
+void Linearizer::get_lin_values(SolutionEvaluator* ev, int order, int item, scalar* val)
+{
+  int mode = ev->get_active_element()->get_mode();
+  double3* pt = lin_tables[mode][order];
+  for (int i = 0; i < lin_np[mode][order]; i++)
+    val[i] = ev->get_ref_value(pt[i][0], pt[i][1], item);
+}
+
+
+void Linearizer::get_lin_phys(SolutionEvaluator* ev, int order, double* phx, double* phy)
+{
+  int mode = ev->get_active_element()->get_mode();
+  double3* pt = lin_tables[mode][order];
+  for (int i = 0; i < lin_np[mode][order]; i++)
+    ev->get_phys_point(pt[i][0], pt[i][1], phx[i], phy[i]);
+}
+
+
+int Linearizer::get_parallel_threads(MeshFunction* fn, int item, int num)
+{
+  if (num_threads <= 1) return 1;
+
+  // the evaluator handles solutions only, up to the first derivatives
+  Solution* s = dynamic_cast<Solution*>(fn);
+  if (s == NULL || s->get_type() == Solution::HERMES_UNDEF) return 1;
+  int a, b;
+  get_gv_a_b(item, a, b);
+  if (b > 2) return 1;
+
+  return std::max(1, std::min(num_threads, num));
+}
+
+
+int Linearizer::merge_vertex(Linearizer* w, int v, int* map)
+{
+  int p1 = w->info[v][0], p2 = w->info[v][1];
+  double* vert = w->verts[v];
+
+  // copies of top-level vertices get new unique parents, see get_top_vertex()
+  if (p1 < 0) return get_vertex(-1 - nv, -1 - nv, vert[0], vert[1], vert[2]);
+  return get_vertex(map[p1], map[p2], vert[0], vert[1], vert[2]);
+}
+
+
+void Linearizer::process_range()
+{
+  for (int r = 0; r < num_recs; r++)
+  {
+    ElemRecord* rec = recs + r;
+    Element* e = rec->e;
+    ev->set_active_element(e);
+
+    for (unsigned int i = 0; i < e->nvert; i++)
+      rec->iv[i] = get_top_vertex(id2id[e->vn[i]->id], top_val[4*r + i]);
+
+    curved = e->is_curved();
+    cmax = e->get_diameter();
+
+    if (e->is_triangle())
+      process_triangle(rec->iv[0], rec->iv[1], rec->iv[2], 0, NULL, NULL, NULL, NULL);
+    else
+      process_quad(rec->iv[0], rec->iv[1], rec->iv[2], rec->iv[3], 0, NULL, NULL, NULL, NULL);
+
+    rec->nv = nv;
+    rec->nt = nt;
+  }
+}
+
+
+void* Linearizer::process_range_worker(void* data)
+{
+  ((Linearizer*) data)->process_range();
+  return NULL;
+}
+
+
+void Linearizer::process_parallel(int nthreads, Element** elems, int num, int* id2id, double* top_val)
+{
+  // every worker starts with a copy of the top-level vertices and of the hash table
+  int ntop = nv;
+  Linearizer** workers = new Linearizer*[nthreads];
+  for (int t = 0; t < nthreads; t++)
+  {
+    int first = (int) ((long) num * t / nthreads), last = (int) ((long) num * (t+1) / nthreads);
+    Linearizer* w = workers[t] = new Linearizer();
+    w->ev = new SolutionEvaluator((Solution*) sln);
+    w->item = item;
+    w->eps = eps;
+    w->max = max;
+    w->auto_max = auto_max;
+    w->disp = false;
+    w->id2id = id2id;
+    w->top_val = top_val + 4*first;
+    w->num_recs = last - first;
+    w->recs = new ElemRecord[w->num_recs];
+    for (int r = 0; r < w->num_recs; r++)
+      w->recs[r].e = elems[first + r];
+
+    w->cv = ntop + cv / nthreads;
+    w->verts = (double3*) malloc(sizeof(double3) * w->cv);
+    w->info = (int4*) malloc(sizeof(int4) * w->cv);
+    memcpy(w->verts, verts, sizeof(double3) * ntop);
+    memcpy(w->info, info, sizeof(int4) * ntop);
+    w->nv = ntop;
+    w->mask = mask;
+    w->hash_table = (int*) malloc(sizeof(int) * (mask+1));
+    memcpy(w->hash_table, hash_table, sizeof(int) * (mask+1));
+    w->ct = ct / nthreads + 1;
+    w->tris = (int3*) malloc(sizeof(int3) * w->ct);
+    w->nt = 0;
+    w->del_slot = -1;
+  }
+
+  // the calling thread processes the first range
+  bool* started = new bool[nthreads];
+  for (int t = 1; t < nthreads; t++)
+    started[t] = (pthread_create(&workers[t]->thread, NULL, process_range_worker, workers[t]) == 0);
+  process_range_worker(workers[0]);
+  for (int t = 1; t < nthreads; t++)
+    if (started[t]) pthread_join(workers[t]->thread, NULL);
+    else process_range_worker(workers[t]);
+  delete [] started;
+
+  // merge the vertices and triangles element by element, in the order of the mesh, so
+  // that the vertices are shared and the edges are split as in the serial linearization
+  for (int t = 0; t < nthreads; t++)
+  {
+    Linearizer* w = workers[t];
+    int* map = new int[w->nv];
+    for (int i = 0; i < ntop; i++)
+      map[i] = i;
+
+    int v = ntop, j = 0;
+    for (int r = 0; r < w->num_recs; r++)
+    {
+      ElemRecord* rec = w->recs + r;
+      for ( ; v < rec->nv; v++)
+        map[v] = merge_vertex(w, v, map);
+      for ( ; j < rec->nt; j++)
+        add_triangle(map[w->tris[j][0]], map[w->tris[j][1]], map[w->tris[j][2]]);
+
+      Element* e = rec->e;
+      for (unsigned int i = 0; i < e->nvert; i++)
+        process_edge(map[rec->iv[i]], map[rec->iv[e->next_vert(i)]], e->en[i]->marker);
+    }
+
+    delete [] map;
+    delete w->ev;
+    delete [] w->recs;
+    ::free(w->info);
+    ::free(w->hash_table);
+    delete w;
+  }
+  delete [] workers;
+}
+
+
 //// regularization ////////////////////////////////////////////////////////////////////////////////
 
 void Linearizer::regularize_triangle(int iv0, int iv1, int iv2, int mid0, int mid1, int mid2)
@@ -632,6 +816,7 @@ void Linearizer::process_solution(MeshFunction* sln, int item, double eps, doubl
 {
   // sanity check
   if (sln == NULL) error("Solution is NULL in Linearizer:process_solution().");
+  HERMES_PERF_SCOPE("linearize");
 
   lock_data();
   TimePeriod time_period;
@@ -724,8 +909,20 @@ void Linearizer::process_solution(MeshFunction* sln, int item, double eps, doubl
   auto_max = (max_abs < 0.0);
   max = auto_max ? 0.0 : max_abs;
 
+  // the values in the vertices of the elements are kept for the threads
+  int nel = mesh->get_num_active_elements();
+  int nthreads = disp ? 1 : get_parallel_threads(sln, item, nel);
+  Element** elems = NULL;
+  double* top_val = NULL;
+  if (nthreads > 1)
+  {
+    elems = new Element*[nel];
+    top_val = new double[4 * nel];
+  }
+
   // obtain the solution in vertices, estimate the maximum solution value
   Element* e;
+  int k = 0;
   for_all_active_elements(e, mesh)
   {
     sln->set_active_element(e);
@@ -750,6 +947,7 @@ void Linearizer::process_solution(MeshFunction* sln, int item, double eps, doubl
       if (auto_max && finite(f) && fabs(f) > max) max = fabs(f);
       int id = id2id[e->vn[i]->id];
       verts[id][2] = f;
+      if (top_val != NULL) top_val[4*k + i] = f;
 
       if (disp)
       {
@@ -757,36 +955,63 @@ void Linearizer::process_solution(MeshFunction* sln, int item, double eps, doubl
         verts[id][1] = e->vn[i]->y + dmult*realpart(dy[i]);
       }
     }
+
+    // with automatic max, the maximum is also taken in the first linearization points,
+    // before any element is refined, so that the refinement does not depend on the order
+    // in which the elements are processed (nor on the number of threads)
+    if (auto_max)
+    {
+      sln->set_quad_order(1, item);
+      val = sln->get_values(ia, ib);
+      int np = e->is_triangle() ? lin_np_tri[1] : lin_np_quad[1];
+      for (int i = 0; i < np; i++)
+      {
+        double f = getval(i);
+        if (finite(f) && fabs(f) > max) max = fabs(f);
+      }
+    }
+
+    if (elems != NULL) elems[k] = e;
+    k++;
   }
 
   // process all elements of the mesh
-  for_all_active_elements(e, mesh)
+  if (nthreads > 1)
   {
-    sln->set_active_element(e);
-    sln->set_quad_order(0, item);
-    scalar* val = sln->get_values(ia, ib);
-    if (disp)
+    process_parallel(nthreads, elems, nel, id2id, top_val);
+    delete [] elems;
+    delete [] top_val;
+  }
+  else
+  {
+    for_all_active_elements(e, mesh)
     {
-      xdisp->set_active_element(e);
-      ydisp->set_active_element(e);
-    }
+      sln->set_active_element(e);
+      sln->set_quad_order(0, item);
+      scalar* val = sln->get_values(ia, ib);
+      if (disp)
+      {
+        xdisp->set_active_element(e);
+        ydisp->set_active_element(e);
+      }
 
-    int iv[4];
-    for (unsigned int i = 0; i < e->nvert; i++)
-      iv[i] = get_top_vertex(id2id[e->vn[i]->id], getval(i));
+      int iv[4];
+      for (unsigned int i = 0; i < e->nvert; i++)
+        iv[i] = get_top_vertex(id2id[e->vn[i]->id], getval(i));
 
-    // we won't bother calculating physical coordinates from the refmap if this is not a curved element
-    curved = e->is_curved();
-    cmax = e->get_diameter();
+      // we won't bother calculating physical coordinates from the refmap if this is not a curved element
+      curved = e->is_curved();
+      cmax = e->get_diameter();
 
-    // recur to sub-elements
-    if (e->is_triangle())
-      process_triangle(iv[0], iv[1], iv[2], 0, NULL, NULL, NULL, NULL);
-    else
-      process_quad(iv[0], iv[1], iv[2], iv[3], 0, NULL, NULL, NULL, NULL);
+      // recur to sub-elements
+      if (e->is_triangle())
+        process_triangle(iv[0], iv[1], iv[2], 0, NULL, NULL, NULL, NULL);
+      else
+        process_quad(iv[0], iv[1], iv[2], iv[3], 0, NULL, NULL, NULL, NULL);
 
-    for (unsigned int i = 0; i < e->nvert; i++)
-      process_edge(iv[i], iv[e->next_vert(i)], e->en[i]->marker);
+      for (unsigned int i = 0; i < e->nvert; i++)
+        process_edge(iv[i], iv[e->next_vert(i)], e->en[i]->marker);
+    }
   }
 
   delete [] id2id;
@@ -67,6 +67,7 @@ Orderizer::Orderizer()
   lbox = NULL;
 
   nl = cl1 = cl2 = cl3 = 0;
+  space = NULL;
 
   for (int i = 0, p = 0; i <= 10; i++)
   {
@@ -114,75 +115,189 @@ void Orderizer::process_solution(Space* space)
   lin_init_array(lbox, double2, cl3, el);
   info = NULL;
 
-  int oo, o[6];
+  // make a mesh illustrating the distribution of polynomial orders over the space
+  this->space = space;
+  int nthreads = std::max(1, std::min(num_threads, nn));
+  if (nthreads > 1)
+  {
+    process_parallel(nthreads);
+    return;
+  }
 
   RefMap refmap;
   refmap.set_quad_2d(&quad_ord);
 
-  // make a mesh illustrating the distribution of polynomial orders over the space
   Element* e;
   for_all_active_elements(e, mesh)
   {
-    oo = o[4] = o[5] = space->get_element_order(e->id);
-    for (unsigned int k = 0; k < e->nvert; k++)
-      o[k] = space->get_edge_order(e, k);
-
     refmap.set_active_element(e);
-    double* x = refmap.get_phys_x(type);
-    double* y = refmap.get_phys_y(type);
+    process_element(e, refmap.get_phys_x(type), refmap.get_phys_y(type));
+  }
 
-    double3* pt = quad_ord.get_points(type);
-    int np = quad_ord.get_num_points(type);
-    int id[80];
-    assert(np <= 80);
+  refmap.set_quad_2d(&g_quad_2d_std);
+}
 
-    #define make_vert(index, x, y, val) \
-      { (index) = add_vertex(); \
-      verts[index][0] = (x); \
-      verts[index][1] = (y); \
-      verts[index][2] = (val); }
 
-    int mode = e->get_mode();
-    if (e->is_quad())
+void Orderizer::process_element(Element* e, double* x, double* y)
+{
+  const int type = 1;
+  int oo, o[6];
+
+  oo = o[4] = o[5] = space->get_element_order(e->id);
+  for (unsigned int k = 0; k < e->nvert; k++)
+    o[k] = space->get_edge_order(e, k);
+
+  int mode = e->get_mode();
+  double3* pt = ord_tables[mode][type];
+  int np = ord_np[mode][type];
+  int id[80];
+  assert(np <= 80);
+
+  #define make_vert(index, x, y, val) \
+    { (index) = add_vertex(); \
+    verts[index][0] = (x); \
+    verts[index][1] = (y); \
+    verts[index][2] = (val); }
+
+  if (e->is_quad())
+  {
+    o[4] = H2D_GET_H_ORDER(oo);
+    o[5] = H2D_GET_V_ORDER(oo);
+  }
+  make_vert(lvert[nl], x[0], y[0], o[4]);
+
+  for (int i = 1; i < np; i++)
+    make_vert(id[i-1], x[i], y[i], o[(int) pt[i][2]]);
+
+  for (int i = 0; i < num_elem[mode][type]; i++)
+    add_triangle(id[ord_elem[mode][type][i][0]], id[ord_elem[mode][type][i][1]], id[ord_elem[mode][type][i][2]]);
+
+  for (int i = 0; i < num_edge[mode][type]; i++)
+  {
+    if (e->en[ord_edge[mode][type][i][2]]->bnd || (y[ord_edge[mode][type][i][0] + 1] < y[ord_edge[mode][type][i][1] + 1]) ||
+        ((y[ord_edge[mode][type][i][0] + 1] == y[ord_edge[mode][type][i][1] + 1]) &&
+         (x[ord_edge[mode][type][i][0] + 1] <  x[ord_edge[mode][type][i][1] + 1])))
     {
-      o[4] = H2D_GET_H_ORDER(oo);
-      o[5] = H2D_GET_V_ORDER(oo);
+      add_edge(id[ord_edge[mode][type][i][0]], id[ord_edge[mode][type][i][1]], 0);
     }
-    make_vert(lvert[nl], x[0], y[0], o[4]);
+  }
+
+  double xmin = 1e100, ymin = 1e100, xmax = -1e100, ymax = -1e100;
+  for (unsigned int k = 0; k < e->nvert; k++)
+  {
+    if (e->vn[k]->x < xmin) xmin = e->vn[k]->x;
+    if (e->vn[k]->x > xmax) xmax = e->vn[k]->x;
+    if (e->vn[k]->y < ymin) ymin = e->vn[k]->y;
+    if (e->vn[k]->y > ymax) ymax = e->vn[k]->y;
+  }
+  lbox[nl][0] = xmax - xmin;
+  lbox[nl][1] = ymax - ymin;
+  ltext[nl++] = labels[o[4]][o[5]];
+}
+
+
+void Orderizer::process_range()
+{
+  // a private reference map instead of RefMap, which uses global tables
+  PointRefMap refmap;
+  double x[80], y[80];
+  for (int r = 0; r < num_recs; r++)
+  {
+    Element* e = recs[r].e;
+    refmap.set_active_element(e);
+
+    int mode = e->get_mode();
+    double3* pt = ord_tables[mode][1];
+    for (int i = 0; i < ord_np[mode][1]; i++)
+      refmap.get_phys_point(pt[i][0], pt[i][1], x[i], y[i]);
+    process_element(e, x, y);
+  }
+}
+
+
+void* Orderizer::process_range_worker(void* data)
+{
+  ((Orderizer*) data)->process_range();
+  return NULL;
+}
 
-    for (int i = 1; i < np; i++)
-      make_vert(id[i-1], x[i], y[i], o[(int) pt[i][2]]);
 
-    for (int i = 0; i < num_elem[mode][type]; i++)
-      add_triangle(id[ord_elem[mode][type][i][0]], id[ord_elem[mode][type][i][1]], id[ord_elem[mode][type][i][2]]);
+void Orderizer::process_parallel(int nthreads)
+{
+  Mesh* mesh = space->get_mesh();
+  int num = mesh->get_num_active_elements();
+  Element** elems = new Element*[num];
+  Element* e;
+  int k = 0;
+  for_all_active_elements(e, mesh)
+    elems[k++] = e;
+  num = k;
 
-    for (int i = 0; i < num_edge[mode][type]; i++)
+  Orderizer** workers = new Orderizer*[nthreads];
+  for (int t = 0; t < nthreads; t++)
+  {
+    int first = (int) ((long) num * t / nthreads), last = (int) ((long) num * (t+1) / nthreads);
+    Orderizer* w = workers[t] = new Orderizer();
+    w->space = space;
+    w->info = NULL;
+    w->nv = w->nt = w->ne = w->nl = 0;
+    w->del_slot = -1;
+    memcpy(w->labels, labels, sizeof(labels)); // the labels point to this->buffer
+    w->num_recs = last - first;
+    w->recs = new ElemRecord[w->num_recs];
+    for (int r = 0; r < w->num_recs; r++)
+      w->recs[r].e = elems[first + r];
+
+    int n = w->num_recs + 1;
+    lin_init_array(w->verts, double3, w->cv, 77 * n);
+    lin_init_array(w->tris, int3, w->ct, 64 * n);
+    lin_init_array(w->edges, int3, w->ce, 16 * n);
+    lin_init_array(w->lvert, int, w->cl1, n);
+    lin_init_array(w->ltext, char*, w->cl2, n);
+    lin_init_array(w->lbox, double2, w->cl3, n);
+  }
+  delete [] elems;
+
+  bool* started = new bool[nthreads];
+  for (int t = 1; t < nthreads; t++)
+    started[t] = (pthread_create(&workers[t]->thread, NULL, process_range_worker, workers[t]) == 0);
+  process_range_worker(workers[0]);
+  for (int t = 1; t < nthreads; t++)
+    if (started[t]) pthread_join(workers[t]->thread, NULL);
+    else process_range_worker(workers[t]);
+  delete [] started;
+
+  // the elements do not share vertices, so the results are just concatenated
+  for (int t = 0; t < nthreads; t++)
+  {
+    Orderizer* w = workers[t];
+    int v0 = nv;
+    for (int i = 0; i < w->nv; i++)
     {
-      if (e->en[ord_edge[mode][type][i][2]]->bnd || (y[ord_edge[mode][type][i][0] + 1] < y[ord_edge[mode][type][i][1] + 1]) ||
-          ((y[ord_edge[mode][type][i][0] + 1] == y[ord_edge[mode][type][i][1] + 1]) &&
-           (x[ord_edge[mode][type][i][0] + 1] <  x[ord_edge[mode][type][i][1] + 1])))
-      {
-        add_edge(id[ord_edge[mode][type][i][0]], id[ord_edge[mode][type][i][1]], 0);
-      }
+      int v = add_vertex();
+      memcpy(verts[v], w->verts[i], sizeof(double3));
     }
-
-    double xmin = 1e100, ymin = 1e100, xmax = -1e100, ymax = -1e100;
-    for (unsigned int k = 0; k < e->nvert; k++)
+    for (int i = 0; i < w->nt; i++)
+      add_triangle(w->tris[i][0] + v0, w->tris[i][1] + v0, w->tris[i][2] + v0);
+    for (int i = 0; i < w->ne; i++)
+      add_edge(w->edges[i][0] + v0, w->edges[i][1] + v0, w->edges[i][2]);
+    for (int i = 0; i < w->nl; i++)
     {
-      if (e->vn[k]->x < xmin) xmin = e->vn[k]->x;
-      if (e->vn[k]->x > xmax) xmax = e->vn[k]->x;
-      if (e->vn[k]->y < ymin) ymin = e->vn[k]->y;
-      if (e->vn[k]->y > ymax) ymax = e->vn[k]->y;
+      lvert[nl] = w->lvert[i] + v0;
+      ltext[nl] = w->ltext[i];
+      lbox[nl][0] = w->lbox[i][0];
+      lbox[nl++][1] = w->lbox[i][1];
     }
-    lbox[nl][0] = xmax - xmin;
-    lbox[nl][1] = ymax - ymin;
-    ltext[nl++] = labels[o[4]][o[5]];
-  }
 
-  refmap.set_quad_2d(&g_quad_2d_std);
+    delete [] w->recs;
+    ::free(w->info);
+    delete w;
+  }
+  delete [] workers;
 }
 
 
+
 Orderizer::~Orderizer()
 {
   lin_free_array(lvert, nl, cl1);
@@ -37,6 +37,7 @@ Vectorizer::Vectorizer()
   verts = NULL;
   dashes = NULL;
   cd = 0;
+  yev = NULL;
 }
 
 
@@ -105,16 +106,28 @@ void Vectorizer::process_triangle(int iv0, int iv1, int iv2, int level,
     if (!(level & 1))
     {
       // obtain solution values and physical element coordinates
-      xsln->set_quad_order(1, xitem);
-      ysln->set_quad_order(1, yitem);
-      xval = xsln->get_values(xia, xib);
-      yval = ysln->get_values(yia, yib);
-      for (i = 0; i < lin_np_tri[1]; i++) {
-        double m = getmag(i);
-        if (finite(m) && fabs(m) > max) max = fabs(m);
+      if (ev != NULL)
+      {
+        xval = ev_val[0][level / 2];
+        yval = ev_val[1][level / 2];
+        get_lin_values(ev, 1, xitem, xval);
+        get_lin_values(yev, 1, yitem, yval);
+      }
+      else
+      {
+        xsln->set_quad_order(1, xitem);
+        ysln->set_quad_order(1, yitem);
+        xval = xsln->get_values(xia, xib);
+        yval = ysln->get_values(yia, yib);
       }
 
-      if (curved)
+      if (ev != NULL && curved)
+      {
+        phx = ev_phx[level / 2];
+        phy = ev_phy[level / 2];
+        get_lin_phys(ev, 1, phx, phy);
+      }
+      else if (curved)
       {
         RefMap* refmap = xsln->get_refmap();
         phx = refmap->get_phys_x(1);
@@ -212,16 +225,28 @@ void Vectorizer::process_quad(int iv0, int iv1, int iv2, int iv3, int level,
     if (!(level & 1))
     {
       // obtain solution values and physical element coordinates
-      xsln->set_quad_order(1, xitem);
-      ysln->set_quad_order(1, yitem);
-      xval = xsln->get_values(xia, xib);
-      yval = ysln->get_values(yia, yib);
-      for (i = 0; i < lin_np_quad[1]; i++) {
-        double m = getmag(i);
-        if (finite(m) && fabs(m) > max) max = fabs(m);
+      if (ev != NULL)
+      {
+        xval = ev_val[0][level / 2];
+        yval = ev_val[1][level / 2];
+        get_lin_values(ev, 1, xitem, xval);
+        get_lin_values(yev, 1, yitem, yval);
+      }
+      else
+      {
+        xsln->set_quad_order(1, xitem);
+        ysln->set_quad_order(1, yitem);
+        xval = xsln->get_values(xia, xib);
+        yval = ysln->get_values(yia, yib);
       }
 
-      if (curved)
+      if (ev != NULL && curved)
+      {
+        phx = ev_phx[level / 2];
+        phy = ev_phy[level / 2];
+        get_lin_phys(ev, 1, phx, phy);
+      }
+      else if (curved)
       {
         RefMap* refmap = xsln->get_refmap();
         phx = refmap->get_phys_x(1);
@@ -438,12 +463,41 @@ void Vectorizer::process_solution(MeshFunction* xsln, int xitem, MeshFunction* y
       double fy = getvaly(i);
       if (fabs(sqrt(fx*fx + fy*fy)) > max) max = fabs(sqrt(fx*fx + fy*fy));
     }
+
+    // the first linearization points are included here, so that the maximum does not
+    // depend on the order in which the elements are processed (nor on the number of threads)
+    xsln->set_quad_order(1, xitem);
+    ysln->set_quad_order(1, yitem);
+    xval = xsln->get_values(xia, xib);
+    yval = ysln->get_values(yia, yib);
+    int np = e[0]->is_triangle() ? lin_np_tri[1] : lin_np_quad[1];
+    for (int i = 0; i < np; i++)
+    {
+      double m = getmag(i);
+      if (finite(m) && fabs(m) > max) max = fabs(m);
+    }
   }
   trav.finish();
 
-  trav.begin(2, meshes, fns);
+  // both components on one mesh can be processed by several threads
+  int nel = meshes[0]->get_num_active_elements();
+  int nthreads = 1;
+  if (meshes[0] == meshes[1])
+    nthreads = std::min(get_parallel_threads(xsln, xitem, nel), get_parallel_threads(ysln, yitem, nel));
+  if (nthreads > 1)
+  {
+    Element** elems = new Element*[nel];
+    Element* el;
+    int k = 0;
+    for_all_active_elements(el, meshes[0])
+      elems[k++] = el;
+    process_parallel(nthreads, elems, k);
+    delete [] elems;
+  }
+  else trav.begin(2, meshes, fns);
+
   // process all elements of the mesh
-  while ((e = trav.get_next_state(NULL, NULL)) != NULL)
+  while (nthreads == 1 && (e = trav.get_next_state(NULL, NULL)) != NULL)
   {
     xsln->set_quad_order(0, xitem);
     ysln->set_quad_order(0, yitem);
@@ -503,7 +557,7 @@ void Vectorizer::process_solution(MeshFunction* xsln, int xitem, MeshFunction* y
       }
     }
   }
-  trav.finish();
+  if (nthreads == 1) trav.finish();
 
   find_min_max();
 
@@ -522,6 +576,127 @@ void Vectorizer::process_solution(MeshFunction* xsln, int xitem, MeshFunction* y
 }
 
 
+//// parallel vectorization ///////////////////////////////////////////////////////////////////////
+
+void Vectorizer::process_range()
+{
+  for (int r = 0; r < num_recs; r++)
+  {
+    ElemRecord* rec = recs + r;
+    Element* e = rec->e;
+    ev->set_active_element(e);
+    if (yev != ev) yev->set_active_element(e);
+
+    // the vertices of the elements are not shared
+    scalar* xval = ev_val[0][0];
+    scalar* yval = ev_val[1][0];
+    get_lin_values(ev, 0, xitem, xval);
+    get_lin_values(yev, 0, yitem, yval);
+    for (unsigned int i = 0; i < e->nvert; i++)
+      rec->iv[i] = create_vertex(e->vn[i]->x, e->vn[i]->y, getvalx(i), getvaly(i));
+
+    curved = (e->cm != NULL);
+
+    if (e->is_triangle())
+      process_triangle(rec->iv[0], rec->iv[1], rec->iv[2], 0, NULL, NULL, NULL, NULL, NULL);
+    else
+      process_quad(rec->iv[0], rec->iv[1], rec->iv[2], rec->iv[3], 0, NULL, NULL, NULL, NULL, NULL);
+
+    rec->nv = nv;
+    rec->nt = nt;
+  }
+}
+
+
+void* Vectorizer::process_range_worker(void* data)
+{
+  ((Vectorizer*) data)->process_range();
+  return NULL;
+}
+
+
+void Vectorizer::process_parallel(int nthreads, Element** elems, int num)
+{
+  Vectorizer** workers = new Vectorizer*[nthreads];
+  for (int t = 0; t < nthreads; t++)
+  {
+    int first = (int) ((long) num * t / nthreads), last = (int) ((long) num * (t+1) / nthreads);
+    Vectorizer* w = workers[t] = new Vectorizer();
+    w->ev = new SolutionEvaluator((Solution*) xsln);
+    w->yev = (ysln == xsln) ? w->ev : new SolutionEvaluator((Solution*) ysln);
+    w->xitem = xitem;
+    w->yitem = yitem;
+    w->eps = eps;
+    w->max = max;
+    w->num_recs = last - first;
+    w->recs = new ElemRecord[w->num_recs];
+    for (int r = 0; r < w->num_recs; r++)
+      w->recs[r].e = elems[first + r];
+
+    w->cv = cv / nthreads + 1;
+    w->verts = (double4*) malloc(sizeof(double4) * w->cv);
+    w->info = (int4*) malloc(sizeof(int4) * w->cv);
+    w->nv = 0;
+    w->mask = mask;
+    w->hash_table = (int*) malloc(sizeof(int) * (mask+1));
+    memset(w->hash_table, 0xff, sizeof(int) * (mask+1));
+    w->ct = ct / nthreads + 1;
+    w->tris = (int3*) malloc(sizeof(int3) * w->ct);
+    w->nt = 0;
+    w->del_slot = -1;
+  }
+
+  bool* started = new bool[nthreads];
+  for (int t = 1; t < nthreads; t++)
+    started[t] = (pthread_create(&workers[t]->thread, NULL, process_range_worker, workers[t]) == 0);
+  process_range_worker(workers[0]);
+  for (int t = 1; t < nthreads; t++)
+    if (started[t]) pthread_join(workers[t]->thread, NULL);
+    else process_range_worker(workers[t]);
+  delete [] started;
+
+  // merge the results in the order of the elements; the first vertices of an element are
+  // its corners, the other ones have parents
+  for (int t = 0; t < nthreads; t++)
+  {
+    Vectorizer* w = workers[t];
+    int* map = new int[w->nv];
+    int v = 0, j = 0;
+    for (int r = 0; r < w->num_recs; r++)
+    {
+      ElemRecord* rec = w->recs + r;
+      Element* e = rec->e;
+      for (unsigned int i = 0; i < e->nvert; i++, v++)
+        map[v] = create_vertex(w->verts[v][0], w->verts[v][1], w->verts[v][2], w->verts[v][3]);
+      for ( ; v < rec->nv; v++)
+        map[v] = get_vertex(map[w->info[v][0]], map[w->info[v][1]], w->verts[v][0], w->verts[v][1],
+                            w->verts[v][2], w->verts[v][3]);
+      for ( ; j < rec->nt; j++)
+        add_triangle(map[w->tris[j][0]], map[w->tris[j][1]], map[w->tris[j][2]]);
+
+      // both components are on the same mesh, so all edges are bold (see process_solution())
+      int* iv = rec->iv;
+      for (unsigned int i = 0; i < e->nvert; i++)
+      {
+        int a = map[iv[i]], b = map[iv[e->next_vert(i)]];
+        if (e->en[i]->bnd || (verts[a][1] < verts[b][1]) ||
+            (verts[a][1] == verts[b][1] && verts[a][0] < verts[b][0]))
+          process_edge(a, b, e->en[i]->marker);
+      }
+    }
+
+    delete [] map;
+    if (w->yev != w->ev) delete w->yev;
+    delete w->ev;
+    delete [] w->recs;
+    ::free(w->info);
+    ::free(w->hash_table);
+    delete w;
+  }
+  delete [] workers;
+}
+
+
 //// save & load ///////////////////////////////////////////////////////////////////////////////////
 
 void Vectorizer::save_data(const char* filename)
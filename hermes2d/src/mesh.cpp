@@ -16,6 +16,7 @@
 #include "h2d_common.h"
 #include "mesh.h"
 #include "h2d_reader.h"
+#include "traverse.h"
 
 
 //// nodes, element ////////////////////////////////////////////////////////////////////////////////
@@ -130,6 +131,10 @@ Mesh::Mesh() : HashTable()
 {
   nbase = nactive = ntopvert = ninitial = 0;
   seq = g_mesh_seq++;
+  ordering = HERMES_SFC_NONE;
+  base_order = NULL;
+  base_order_size = 0;
+  shared = NULL;
 }
 
 
@@ -590,6 +595,7 @@ void Mesh::unrefine_element_internal(Element* e)
 
 void Mesh::refine_element(int id, int refinement)
 {
+  unshare();
   Element* e = get_element(id);
   if (!e->used) error("Invalid element id number.");
   if (!e->active) error("Attempt to refine element #%d which has been refined already.", e->id);
@@ -606,6 +612,7 @@ void Mesh::refine_element(int id, int refinement)
 void Mesh::refine_all_elements(int refinement)
 {
   Element* e;
+  unshare();
   elements.set_append_only(true);
   for_all_active_elements(e, this)
     refine_element(e->id, refinement);
@@ -616,6 +623,7 @@ void Mesh::refine_all_elements(int refinement)
 void Mesh::refine_by_criterion(int (*criterion)(Element*), int depth)
 {
   Element* e;
+  unshare();
   elements.set_append_only(true);
   for (int r, i = 0; i < depth; i++)
     for_all_active_elements(e, this)
@@ -694,6 +702,7 @@ void Mesh::refine_towards_boundary(int marker, int depth, bool aniso)
 
 void Mesh::unrefine_element(int id)
 {
+  unshare();
   Element* e = get_element(id);
   if (!e->used) error("Invalid element id number.");
   if (e->active) return;
@@ -712,6 +721,7 @@ void Mesh::unrefine_all_elements(bool keep_initial_refinements)
   // find inactive elements with active sons
   std::vector<int> list;
   Element* e;
+  unshare();
   for_all_inactive_elements(e, this)
   {
     bool found = true;
@@ -757,6 +767,43 @@ Nurbs* Mesh::reverse_nurbs(Nurbs* nurbs)
   return rev;
 }
 
+
+void Mesh::assign_nurbs(Node* en, int p1, Nurbs* nurbs)
+{
+  // assign the nurbs to the elements sharing the edge node
+  for (int k = 0; k < 2; k++)
+  {
+    Element* e = en->elem[k];
+    if (e == NULL) continue;
+
+    if (e->cm == NULL)
+    {
+      e->cm = new CurvMap;
+      memset(e->cm, 0, sizeof(CurvMap));
+      e->cm->toplevel = 1;
+      e->cm->order = 4;
+    }
+
+    int idx = -1;
+    for (unsigned int j = 0; j < e->nvert; j++)
+      if (e->en[j] == en) { idx = j; break; }
+    assert(idx >= 0);
+
+    if (e->vn[idx]->id == p1)
+    {
+      e->cm->nurbs[idx] = nurbs;
+      nurbs->ref++;
+    }
+    else
+    {
+      Nurbs* nurbs_rev = reverse_nurbs(nurbs);
+      e->cm->nurbs[idx] = nurbs_rev;
+      nurbs_rev->ref++;
+    }
+  }
+  if (!nurbs->ref) delete nurbs;
+}
+
 // computing vector length
 double vector_length(double a_1, double a_2)
 {
@@ -870,7 +917,6 @@ void Mesh::create(int nv, double2* verts, int nt, int4* tris,
     node->type = H2D_TYPE_VERTEX;
     node->bnd = 0;
     node->p1 = node->p2 = -1;
-    node->next_hash = NULL;
     node->x = verts[i][0];
     node->y = verts[i][1];
   }
@@ -903,15 +949,120 @@ void Mesh::create(int nv, double2* verts, int nt, int4* tris,
   seq = g_mesh_seq++;
 }
 
+
+void Mesh::create(int nv, double2* verts, int ne, int5* elems, int nm, int3* mark)
+{
+  free();
+
+  // the number of edges is about nv + ne, the hash table is sized for all nodes
+  int size = H2D_DEFAULT_HASH_SIZE;
+  while (size < 2*(nv + ne)) size *= 2;
+  HashTable::init(size);
+  nodes.reserve(2*nv + ne);
+  elements.reserve(ne);
+
+  // create vertex nodes
+  for (int i = 0; i < nv; i++)
+  {
+    Node* node = nodes.add();
+    assert(node->id == i);
+    node->ref = TOP_LEVEL_REF;
+    node->type = H2D_TYPE_VERTEX;
+    node->bnd = 0;
+    node->p1 = node->p2 = -1;
+    node->x = verts[i][0];
+    node->y = verts[i][1];
+  }
+  ntopvert = nv;
+
+  // create elements
+  nactive = 0;
+  for (int i = 0; i < ne; i++)
+  {
+    int* idx = elems[i];
+    if (idx[0] < 0) { elements.skip_slot(); continue; }
+    int n = (idx[3] < 0) ? 3 : 4;
+    for (int j = 0; j < n; j++)
+      if (idx[j] < 0 || idx[j] >= nv)
+        error("Error creating element #%d: vertex #%d does not exist.", i, idx[j]);
+
+    if (n == 3)
+      create_triangle(idx[4], &nodes[idx[0]], &nodes[idx[1]], &nodes[idx[2]], NULL);
+    else
+      create_quad(idx[4], &nodes[idx[0]], &nodes[idx[1]], &nodes[idx[2]], &nodes[idx[3]], NULL);
+    nactive++;
+  }
+  nbase = ninitial = ne;
+
+  // set boundary markers
+  for (int i = 0; i < nm; i++)
+  {
+    Node* en = peek_edge_node(mark[i][0], mark[i][1]);
+    if (en == NULL) error("Boundary data error (edge %d-%d does not exist).", mark[i][0], mark[i][1]);
+    en->marker = mark[i][2];
+
+    if (en->marker > 0)
+    {
+      nodes[mark[i][0]].bnd = 1;
+      nodes[mark[i][1]].bnd = 1;
+      en->bnd = 1;
+    }
+  }
+
+  seq = g_mesh_seq++;
+}
+
 //// mesh copy /////////////////////////////////////////////////////////////////////////////////////
 
 void Mesh::copy(const Mesh* mesh)
 {
-  int i;
+  if (mesh == this) return;
 
   //printf("Calling Mesh::free() in Mesh::copy().\n");
   free();
 
+  // share the nodes and elements until one of the meshes is modified
+  if (mesh->shared == NULL)
+    const_cast<Mesh*>(mesh)->shared = new int(1);
+  shared = mesh->shared;
+  (*shared)++;
+
+  HashTable::share(mesh);
+  elements.share(mesh->elements);
+
+  nbase = mesh->nbase;
+  nactive = mesh->nactive;
+  ntopvert = mesh->ntopvert;
+  ninitial = mesh->ninitial;
+  seq = mesh->seq;
+  copy_element_ordering(mesh);
+}
+
+
+void Mesh::unshare()
+{
+  if (shared == NULL) return;
+  if (*shared == 1)
+  {
+    // the other meshes have been freed meanwhile
+    delete shared;
+    shared = NULL;
+    return;
+  }
+
+  // 'tmp' keeps the shared nodes and elements while this mesh copies them
+  Mesh tmp;
+  tmp.copy(this);
+  deep_copy(&tmp);
+}
+
+
+void Mesh::deep_copy(const Mesh* mesh)
+{
+  int i;
+
+  free();
+
   // copy nodes and elements
   HashTable::copy(mesh);
   elements.copy(mesh->elements);
@@ -962,6 +1113,7 @@ void Mesh::copy(const Mesh* mesh)
   ntopvert = mesh->ntopvert;
   ninitial = mesh->ninitial;
   seq = mesh->seq;
+  copy_element_ordering(mesh);
 }
 
 
@@ -1021,24 +1173,130 @@ void Mesh::copy_base(Mesh* mesh)
   nbase = nactive = ninitial = mesh->nbase;
   ntopvert = mesh->ntopvert;
   seq = g_mesh_seq++;
+  copy_element_ordering(mesh);
 }
 
 
-//// free //////////////////////////////////////////////////////////////////////////////////////////
+//// element ordering ////////////////////////////////////////////////////////////////////////////
 
-void Mesh::free()
+struct SfcKey
 {
-  //printf("Inside Mesh::free().\n");
+  unsigned long long key;
+  int id;
+  bool operator<(const SfcKey& other) const { return key < other.key; }
+};
+
+void Mesh::set_element_ordering(SpaceFillingCurve curve)
+{
+  Traverse::release_plans(this);
+  ordering = curve;
+  delete [] base_order;
+  base_order = NULL;
+  base_order_size = 0;
+  if (ordering != HERMES_SFC_NONE)
+    calc_base_element_order();
+}
+
+
+const int* Mesh::get_base_element_order()
+{
+  if (ordering == HERMES_SFC_NONE) return NULL;
+  if (base_order == NULL || base_order_size != nbase)
+    calc_base_element_order();
+  return base_order;
+}
+
+
+void Mesh::calc_base_element_order()
+{
+  // bounding box of the base mesh
+  double lo[2] = {  1e300,  1e300 };
+  double hi[2] = { -1e300, -1e300 };
   Element* e;
-  for_all_elements(e, this)
-    if (e->cm != NULL)
+  for_all_base_elements(e, this)
+    for (unsigned int i = 0; i < e->nvert; i++)
+    {
+      lo[0] = std::min(lo[0], e->vn[i]->x);  hi[0] = std::max(hi[0], e->vn[i]->x);
+      lo[1] = std::min(lo[1], e->vn[i]->y);  hi[1] = std::max(hi[1], e->vn[i]->y);
+    }
+
+  // sort the base elements by the curve index of their centroids, the unused
+  // ones go last (Traverse skips them)
+  SfcKey* keys = new SfcKey[nbase];
+  for (int id = 0; id < nbase; id++)
+  {
+    e = get_element_fast(id);
+    keys[id].id = id;
+    keys[id].key = (unsigned long long) -1;
+    if (!e->used) continue;
+
+    double c[2] = { 0.0, 0.0 };
+    for (unsigned int i = 0; i < e->nvert; i++)
     {
-      delete e->cm;
-      e->cm = NULL; // fixme!!!
+      c[0] += e->vn[i]->x / e->nvert;
+      c[1] += e->vn[i]->y / e->nvert;
     }
+    keys[id].key = sfc_index(ordering, c, lo, hi, 2);
+  }
+  std::stable_sort(keys, keys + nbase);
+
+  delete [] base_order;
+  base_order = new int[nbase];
+  for (int i = 0; i < nbase; i++)
+    base_order[i] = keys[i].id;
+  base_order_size = nbase;
+  delete [] keys;
+}
+
+
+void Mesh::copy_element_ordering(const Mesh* mesh)
+{
+  ordering = mesh->ordering;
+  delete [] base_order;
+  base_order = NULL;
+  base_order_size = 0;
+  if (mesh->base_order != NULL && mesh->base_order_size == nbase)
+  {
+    base_order = new int[nbase];
+    memcpy(base_order, mesh->base_order, sizeof(int) * nbase);
+    base_order_size = nbase;
+  }
+}
+
+
+//// free //////////////////////////////////////////////////////////////////////////////////////////
+
+void Mesh::free()
+{
+  //printf("Inside Mesh::free().\n");
+  Traverse::release_plans(this);
+
+  if (shared != NULL && --(*shared) > 0)
+  {
+    // the nodes, elements and curved maps are still used by a copy
+    elements.release();
+    HashTable::release();
+  }
+  else
+  {
+    Element* e;
+    for_all_elements(e, this)
+      if (e->cm != NULL)
+      {
+        delete e->cm;
+        e->cm = NULL; // fixme!!!
+      }
+
+    elements.free();
+    HashTable::free();
+    delete shared;
+  }
+  shared = NULL;
 
-  elements.free();
-  HashTable::free();
+  delete [] base_order;
+  base_order = NULL;
+  base_order_size = 0;
+  ordering = HERMES_SFC_NONE;
 }
 
 void Mesh::copy_converted(Mesh* mesh)
@@ -1134,6 +1392,7 @@ void Mesh::convert_triangles_to_quads()
   Element* e;
   Mesh tmp;
 
+  unshare();
   elements.set_append_only(true);
   for_all_active_elements(e, this)
     refine_element_to_quads(e->id);
@@ -1163,6 +1422,7 @@ void Mesh::convert_quads_to_triangles()
   Element* e;
   Mesh tmp;
 
+  unshare();
   elements.set_append_only(true);
   for_all_active_elements(e, this)
     refine_element_to_triangles(e->id);
@@ -18,6 +18,7 @@
 
 #include "h2d_common.h"
 #include "curved.h"
+#include "../../hermes_common/sfc.h"
 
 struct Element;
 class HashTable;
@@ -56,7 +57,6 @@ struct HERMES_API Node
   };
 
   int p1, p2; ///< parent id numbers
-  Node* next_hash; ///< next node in hash synonym list
 
   bool is_constrained_vertex() const { assert(type == H2D_TYPE_VERTEX); return ref <= 3 && !bnd; }
 
@@ -161,7 +161,11 @@ public:
     free(); 
     dump_hash_stat(); 
   }
-  /// Creates a copy of another mesh.
+  /// Creates a copy of another mesh. The copy shares the nodes and elements with the
+  /// other mesh until one of them is modified: the mesh being refined, unrefined,
+  /// regularized or converted first makes its own copy of them (see unshare()), so
+  /// copies which are never modified (reference meshes before their refinement,
+  /// solutions of previous time levels) cost almost no memory.
   void copy(const Mesh* mesh);
   /// Copies the coarsest elements of another mesh.
   void copy_base(Mesh* mesh);
@@ -189,6 +193,13 @@ public:
   void create(int nv, double2* verts, int nt, int4* tris,
               int nq, int5* quads, int nm, int3* mark);
 
+  /// Creates the mesh from the given vertex, element and marker arrays in one pass.
+  /// Unlike the above function, the element ids are the indices into 'elems':
+  /// elems[i] = { v0, v1, v2, v3, marker }, where v3 = -1 for triangles and v0 = -1
+  /// for an unused element slot. The hash table is sized for the final number of
+  /// nodes beforehand, so it is never rebuilt.
+  void create(int nv, double2* verts, int ne, int5* elems, int nm, int3* mark);
+
   /// Retrieves an element by its id number.
   Element* get_element(int id) const;
 
@@ -202,6 +213,9 @@ public:
     if (this == NULL) error("this == NULL in Mesh::get_num_base_elements()."); 
     return nbase; 
   }
+  /// Returns the number of elements of the mesh as it was loaded, including the refinements
+  /// from the mesh file. The elements with lower ids are the initial elements.
+  int get_num_initial_elements() const { return ninitial; }
   /// Returns the current number of active elements in the mesh.
   int get_num_active_elements() const { 
     if (this == NULL) error("this == NULL in Mesh::get_num_active_elements()."); 
@@ -272,6 +286,13 @@ public:
   /// Saves the entire internal state to a (binary) file. DEPRECATED
   void save_raw(FILE* f);
 
+  /// Makes the mesh own its nodes and elements if it shares them with a copy.
+  /// This is done by all functions modifying the mesh. Pointers to the elements and
+  /// nodes obtained before still point to the shared ones, which are not modified.
+  void unshare();
+  /// Returns true if the mesh shares its nodes and elements with a copy.
+  bool is_shared() const { return shared != NULL && *shared > 1; }
+
   /// For internal use.
   int get_edge_sons(Element* e, int edge, int& son1, int& son2);
   /// For internal use.
@@ -285,6 +306,14 @@ public:
   /// Note: this function creates a base mesh -- it can only be 
   /// used before any other mesh refinement function is called.
   void convert_triangles_to_quads();
+  /// Sets the order in which Traverse visits the base elements. With HERMES_SFC_MORTON
+  /// or HERMES_SFC_HILBERT, the base elements are sorted along the curve through their
+  /// centroids, so that consecutive elements (and their refinements) are close in space.
+  /// HERMES_SFC_NONE restores the default order by element id.
+  void set_element_ordering(SpaceFillingCurve curve);
+  /// Returns the base element ids in the traversal order, or NULL if the base
+  /// elements are traversed by their ids.
+  const int* get_base_element_order();
   /// Refines all quad elements to triangles.
   /// It refines a quadrilateral element into two triangles.
   /// Note: this function creates a base mesh -- it can only be 
@@ -297,6 +326,15 @@ protected:
   int nbase, ntopvert;
   int nactive, ninitial;
   unsigned seq;
+  int* shared; ///< number of meshes sharing the nodes and elements, NULL if not shared
+
+  void deep_copy(const Mesh* mesh);
+
+  SpaceFillingCurve ordering;
+  int* base_order;      ///< base element ids sorted along the curve, see set_element_ordering()
+  int base_order_size;  ///< number of base elements when 'base_order' was calculated
+  void calc_base_element_order();
+  void copy_element_ordering(const Mesh* mesh);
 
   Element* create_triangle(int marker, Node* v0, Node* v1, Node* v2, CurvMap* cm);
   Element* create_quad(int marker, Node* v0, Node* v1, Node* v2, Node* v3, CurvMap* cm);
@@ -306,6 +344,9 @@ protected:
   void unrefine_element_internal(Element* e);
 
   Nurbs* reverse_nurbs(Nurbs* nurbs);
+  /// Assigns the curve 'nurbs' going from the vertex 'p1' to the elements sharing the
+  /// base edge node 'en'.
+  void assign_nurbs(Node* en, int p1, Nurbs* nurbs);
   Node*  get_base_edge_node(Element* base, int edge);
 
   int* parents;
@@ -324,6 +365,7 @@ protected:
   void refine_element_to_triangles(int id);
 
   friend class H2DReader;
+  friend class H2DBinaryReader;
 };
 
 
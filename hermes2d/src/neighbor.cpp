@@ -560,7 +560,7 @@ int NeighborSearch::get_quad_np()
 }
 
 
-Geom<double>* NeighborSearch::init_geometry(Geom<double>** ext_cache_e, SurfPos *ep)
+Geom<double>* NeighborSearch::init_geometry(Geom<double>** ext_cache_e, SurfPos *ep, ScratchArena* arena)
 {
   ensure_central_pss_rm(this);
   ensure_active_segment(this);
@@ -570,8 +570,9 @@ Geom<double>* NeighborSearch::init_geometry(Geom<double>** ext_cache_e, SurfPos
   if (n_neighbors == 1) // go-up or no-transf neighborhood
   {
     // Do the same as if assembling standard (non-DG) surface forms.
+    HERMES_PERF_CACHE_HIT("neighbor_geometry", ext_cache_e[eo] != NULL);
     if (ext_cache_e[eo] == NULL)
-      ext_cache_e[eo] = new InterfaceGeom<double> (init_geom_surf(central_rm, ep, eo), 
+      ext_cache_e[eo] = new (arena) InterfaceGeom<double> (init_geom_surf(central_rm, ep, eo, arena), 
                                                    neighb_el->marker, neighb_el->id, neighb_el->get_diameter());
     return ext_cache_e[eo];
   } 
@@ -579,6 +580,7 @@ Geom<double>* NeighborSearch::init_geometry(Geom<double>** ext_cache_e, SurfPos
   {
     // Also take into account the transformations of the central element.
     Key key(eo, active_segment);
+    HERMES_PERF_CACHE_HIT("neighbor_geometry", cache_e[key] != NULL);
     if (cache_e[key] == NULL)
       cache_e[key] = new InterfaceGeom<double> (init_geom_surf(central_rm, ep, eo), 
                                                 neighb_el->marker, neighb_el->id, neighb_el->get_diameter());
@@ -586,7 +588,7 @@ Geom<double>* NeighborSearch::init_geometry(Geom<double>** ext_cache_e, SurfPos
   }    
 }
 
-double* NeighborSearch::init_jwt(double** ext_cache_jwt)
+double* NeighborSearch::init_jwt(double** ext_cache_jwt, ScratchArena* arena)
 {
   ensure_central_pss_rm(this);
   ensure_active_segment(this);
@@ -601,7 +603,7 @@ double* NeighborSearch::init_jwt(double** ext_cache_jwt)
       double3* pt = get_quad_pt();
       double3* tan = central_rm->get_tangent(active_edge, eo);
       
-      ext_cache_jwt[eo] = new double[np];
+      ext_cache_jwt[eo] = new (arena) double[np];
       for(int i = 0; i < np; i++)
         ext_cache_jwt[eo][i] = pt[i][2] * tan[i][2];
     }
@@ -624,24 +626,24 @@ double* NeighborSearch::init_jwt(double** ext_cache_jwt)
   }
 }
 
-DiscontinuousFunc<Ord>* NeighborSearch::init_ext_fn_ord(MeshFunction* fu)
+DiscontinuousFunc<Ord>* NeighborSearch::init_ext_fn_ord(MeshFunction* fu, ScratchArena* arena)
 {
   ensure_active_segment(this);
-  Func<Ord>* fo1 = init_fn_ord(fu->get_edge_fn_order(active_edge));
-  Func<Ord>* fo2 = init_fn_ord(fu->get_edge_fn_order(active_edge));
-  return new DiscontinuousFunc<Ord>(fo1, fo2);
+  Func<Ord>* fo1 = init_fn_ord(fu->get_edge_fn_order(active_edge), arena);
+  Func<Ord>* fo2 = init_fn_ord(fu->get_edge_fn_order(active_edge), arena);
+  return new (arena) DiscontinuousFunc<Ord>(fo1, fo2);
 }
 
-DiscontinuousFunc<Ord>* NeighborSearch::init_ext_fn_ord(Solution* fu)
+DiscontinuousFunc<Ord>* NeighborSearch::init_ext_fn_ord(Solution* fu, ScratchArena* arena)
 {   
   ensure_active_segment(this);
   int inc = (fu->get_num_components() == 2) ? 1 : 0;
   int central_order = fu->get_edge_fn_order(active_edge) + inc;
   int neighbor_order = fu->get_edge_fn_order(neighbor_edge) + inc;
-  return new DiscontinuousFunc<Ord>(init_fn_ord(central_order), init_fn_ord(neighbor_order));
+  return new (arena) DiscontinuousFunc<Ord>(init_fn_ord(central_order, arena), init_fn_ord(neighbor_order, arena));
 }
 
-DiscontinuousFunc<scalar>* NeighborSearch::init_ext_fn(MeshFunction* fu)
+DiscontinuousFunc<scalar>* NeighborSearch::init_ext_fn(MeshFunction* fu, ScratchArena* arena)
 {
   ensure_active_segment(this);
   ensure_set_quad_order(central_quad);
@@ -659,7 +661,7 @@ DiscontinuousFunc<scalar>* NeighborSearch::init_ext_fn(MeshFunction* fu)
     for(int i = 0; i < n_trans[active_segment]; i++)
       fu->push_transform(transformations[active_segment][i]);
   
-  Func<scalar>* fn_central = init_fn(fu, fu->get_refmap(), get_quad_eo(false));
+  Func<scalar>* fn_central = init_fn(fu, fu->get_refmap(), get_quad_eo(false), arena);
 
   // Change the active element of the function. Note that this also resets the transformations on the function.
   fu->set_active_element(neighb_el);  
@@ -669,13 +671,13 @@ DiscontinuousFunc<scalar>* NeighborSearch::init_ext_fn(MeshFunction* fu)
     for(int i = 0; i < n_trans[active_segment]; i++)        
       fu->push_transform(transformations[active_segment][i]);
     
-  Func<scalar>* fn_neighbor = init_fn(fu, fu->get_refmap(), get_quad_eo(true));  
+  Func<scalar>* fn_neighbor = init_fn(fu, fu->get_refmap(), get_quad_eo(true), arena);  
   
   // Restore the original function.
   fu->set_active_element(central_el);
   fu->set_transform(original_central_el_transform);
 
-  return new DiscontinuousFunc<scalar>(fn_central, fn_neighbor, (neighbor_edges[active_segment].orientation == 1));
+  return new (arena) DiscontinuousFunc<scalar>(fn_central, fn_neighbor, (neighbor_edges[active_segment].orientation == 1));
   
   //NOTE: This function is not very efficient, since it sets the active elements and possibly pushes transformations
   // for each mesh function in each cycle of the innermost assembly loop. This is neccessary because only in
@@ -773,7 +775,8 @@ void NeighborSearch::ExtendedShapeset::ExtendedShapeFunction::activate(int index
 DiscontinuousFunc<double>* 
 NeighborSearch::ExtendedShapeset::ExtendedShapeFunction::get_fn(  std::map< PrecalcShapeset::Key,
                                                                             Func< double >*, 
-                                                                            PrecalcShapeset::Compare >& ext_cache_fn  )
+                                                                            PrecalcShapeset::Compare >& ext_cache_fn,
+                                                                  ScratchArena* cache_arena, ScratchArena* arena  )
 {
   int eo = neibhood->get_quad_eo(support_on_neighbor);
   PrecalcShapeset::Key key( 256 - active_pss->get_active_shape(),
@@ -782,7 +785,7 @@ NeighborSearch::ExtendedShapeset::ExtendedShapeFunction::get_fn(  std::map< Prec
                             active_pss->get_shapeset()->get_id()  );
   
   if (ext_cache_fn[key] == NULL)
-    ext_cache_fn[key] = init_fn(active_pss, active_rm, eo);
+    ext_cache_fn[key] = init_fn(active_pss, active_rm, eo, cache_arena);
   
-  return extend_by_zero( ext_cache_fn[key] );
+  return extend_by_zero( ext_cache_fn[key], arena );
 }
@@ -134,16 +134,17 @@ public:
   /// Assumes that integration order has been set by \c set_quad_order.
   ///
   /// \param[in] fu MeshFunction whose values are requested.
+  /// \param[in] arena If given, the function is allocated from it (see \c init_fn) and must not be freed.
   /// \return Pointer to a discontinuous function allowing to access the values from each side of the active edge.
   ///
-  DiscontinuousFunc<scalar>* init_ext_fn(MeshFunction* fu);
+  DiscontinuousFunc<scalar>* init_ext_fn(MeshFunction* fu, ScratchArena* arena = NULL);
   
   /// Initialize the polynomial orders of the given function at both sides of the active segment of active edge.
   ///
   /// \param[in] fu MeshFunction whose order is requested.
   /// \return Pointer to a discontinuous function allowing to access the order from each side of the active edge.
   ///
-  DiscontinuousFunc<Ord>* init_ext_fn_ord(Solution* fu);
+  DiscontinuousFunc<Ord>* init_ext_fn_ord(Solution* fu, ScratchArena* arena = NULL);
   
   /// Initialize the polynomial orders of the given function at both sides of the active segment of active edge.
   ///
@@ -155,7 +156,7 @@ public:
   /// \param[in] fu Solution whose order is requested.
   /// \return Pointer to a discontinuous function allowing to access the order from each side of the active edge.
   ///
-  DiscontinuousFunc<Ord>* init_ext_fn_ord(MeshFunction* fu);
+  DiscontinuousFunc<Ord>* init_ext_fn_ord(MeshFunction* fu, ScratchArena* arena = NULL);
   
 /*** Methods for working with shape functions. ***/
   
@@ -249,10 +250,11 @@ public:
   ///                               and active segment (which uniquely determines the transformation).
   ///
   /// \param[in] ep Active edge data required by the \c init_geom_surf function.
+  /// \param[in] arena If given, new entries of \c ext_cache_e are allocated from it.
   /// \return Pointer to a structure holding the geometry data as well as diameter, id and marker of elements on both
   ///         sides of the edge.
   ///
-  Geom<double>* init_geometry(Geom< double >** ext_cache_e, SurfPos* ep);
+  Geom<double>* init_geometry(Geom< double >** ext_cache_e, SurfPos* ep, ScratchArena* arena = NULL);
   
   /// Initialize the products of Jacobian and quadrature weights.
   ///
@@ -261,9 +263,10 @@ public:
   /// This function assumes that integration order has been set by \c set_quad_order.
   ///
   /// \param[in,out]  ext_cache_jwt   Cache from the assembling procedure.
+  /// \param[in]      arena           If given, new entries of \c ext_cache_jwt are allocated from it.
   /// \return         The array of Jacobian * weights.
   ///
-  double* init_jwt(double** ext_cache_jwt);
+  double* init_jwt(double** ext_cache_jwt, ScratchArena* arena = NULL);
   
 /*** Methods for retrieving additional information about the neighborhood. ***/
   
@@ -604,15 +607,18 @@ public:
           /// active segment.
           ///
           /// \param[in,out]  ext_cache_fn  Reference to the cache of shape functions obtained from Discrete/FeProblem.
+          /// \param[in]      cache_arena   If given, new entries of \c ext_cache_fn are allocated from it.
+          /// \param[in]      arena         If given, the returned object is allocated from it.
           /// \return         Pointer to a \c DiscontinuousFunc object which may be queried for values on either side 
           ///                 of the active segment.
           ///
-          DiscontinuousFunc<double>* get_fn(std::map< PrecalcShapeset::Key, Func< double >*, PrecalcShapeset::Compare >& ext_cache_fn); 
+          DiscontinuousFunc<double>* get_fn(std::map< PrecalcShapeset::Key, Func< double >*, PrecalcShapeset::Compare >& ext_cache_fn,
+                                            ScratchArena* cache_arena = NULL, ScratchArena* arena = NULL);
           
           /// Get \c DiscontinuousFunc representation of the active shape function's polynomial order.
-          DiscontinuousFunc<Ord>* get_fn_ord() {
+          DiscontinuousFunc<Ord>* get_fn_ord(ScratchArena* arena = NULL) {
             int inc = (active_pss->get_num_components() == 2) ? 1 : 0;
-            return extend_by_zero( init_fn_ord(this->order + inc) );
+            return extend_by_zero( init_fn_ord(this->order + inc, arena), arena );
           }
           
           /// Extend by zero the active shape function to the other element.
@@ -625,13 +631,13 @@ public:
           /// \return     Pointer to a \c DiscontinuousFunc object which may be queried for values on either side 
           ///             of the discontinuity.
           ///
-          DiscontinuousFunc<double>* extend_by_zero(Func<double>* fu) {
-            return new DiscontinuousFunc<double>(fu, support_on_neighbor, reverse_neighbor_side);
+          DiscontinuousFunc<double>* extend_by_zero(Func<double>* fu, ScratchArena* arena = NULL) {
+            return new (arena) DiscontinuousFunc<double>(fu, support_on_neighbor, reverse_neighbor_side);
           }
           
           /// Extend by zero the \c Func representation of the active shape's polynomial order to the other element.
-          DiscontinuousFunc<Ord>* extend_by_zero(Func<Ord>* fu) {
-            return new DiscontinuousFunc<Ord>(fu, support_on_neighbor);
+          DiscontinuousFunc<Ord>* extend_by_zero(Func<Ord>* fu, ScratchArena* arena = NULL) {
+            return new (arena) DiscontinuousFunc<Ord>(fu, support_on_neighbor);
           }
           
           // Only an ExtendedShapeset is allowed to create an ExtendedShapeFunction.
@@ -3,10 +3,34 @@
 
 #include "hermes2d.h"
 
+/// Numerical fluxes of the batched interface of NumericalFlux.
+enum NumericalFluxType
+{
+  HERMES_FLUX_VIJAYASUNDARAM, ///< The flux vector splitting of riemann_solver() (the default).
+  HERMES_FLUX_HLL,            ///< Harten, Lax and van Leer, with the wave speed estimates of Davis.
+  HERMES_FLUX_HLLC,           ///< HLL with the restored contact wave (Toro).
+  HERMES_FLUX_LAX_FRIEDRICHS  ///< Local Lax-Friedrichs (Rusanov).
+};
+
+/// Numerical flux of the compressible Euler equations, w = (rho, rho v_x, rho v_y, E).
+///
+/// The functions working with double[4] calculate the flux at one point. The batched
+/// interface calculates all four components at all points of an edge at once: the
+/// states are stored component by component (w_l[i][k] is the i-th component at the
+/// k-th point) and the fluxes are evaluated in closed form, without the 4x4 matrices,
+/// so that the loops over the points vectorize. get_edge_flux() also remembers the
+/// last edge, so the four component forms of an edge calculate the flux only once.
+/// The cache belongs to the object, so each thread needs its own NumericalFlux.
+///
 class HERMES_API NumericalFlux
 {
 public:
-  NumericalFlux(double kappa) : kappa(kappa) {};
+  NumericalFlux(double kappa, NumericalFluxType type = HERMES_FLUX_VIJAYASUNDARAM);
+  ~NumericalFlux();
+
+  /// Selects the flux used by the batched interface.
+  void set_type(NumericalFluxType type) { this->type = type; cache_n = -1; }
+  NumericalFluxType get_type() const { return type; }
 
   double f_x(int i, double w0, double w1, double w3, double w4);
   double f_z(int i, double w0, double w1, double w3, double w4);
@@ -26,10 +50,30 @@ public:
   double numerical_flux_i(int i, double w_l[4], double w_r[4],
           double nx, double ny);
 
+  /// Calculates all components of the flux in the normals (nx[k], ny[k]) at 'n' points.
+  void numerical_flux(int n, double* result[4], double* w_l[4], double* w_r[4],
+          double* nx, double* ny);
+
+  /// Returns the flux at the 'n' points of an inner edge (result[i][k] is the i-th
+  /// component at the k-th point). The left and right states are the central and
+  /// the neighbor values of ext->fn[0..3], the normals those of 'e'. If they are the
+  /// same as in the previous call, the previous result is returned. The arrays are
+  /// valid until the next call.
+  double** get_edge_flux(int n, ExtData<double>* ext, Geom<double>* e);
+
   double kappa;
 
 protected:
 
+  NumericalFluxType type;
+
+  // get_edge_flux(): the states and normals of the last edge and its flux
+  int cache_n, cache_size;
+  double* cache_in;   ///< w_l, w_r, nx, ny of the last edge
+  double* cache_cur;  ///< w_l, w_r, nx, ny of the current edge
+  double* cache_out;  ///< the flux of the last edge
+  double* cache_flux[4];
+
   void dot(double result[4][4], double A[4][4], double B[4][4]);
   void A_minus(double result[4][4], double w0, double w1, double w3, double w4);
 };
@@ -1,8 +1,12 @@
 #include "hermes2d.h"
+#include <pthread.h>
+
+int OGProjection::num_threads = 1;
 
 void OGProjection::project_internal(Tuple<Space *> spaces, WeakForm* wf, scalar* target_vec, MatrixSolverType matrix_solver)
 {
   _F_
+  HERMES_PERF_SCOPE("projection");
   int n = spaces.size();
 
   // sanity checks
@@ -162,9 +166,589 @@ void OGProjection::project_global(Space *space, ExactFunction source_fn, scalar*
   project_global(space, (MeshFunction*)&source_sln, target_vec, matrix_solver, proj_norm);
 };
 
+//// projection-based interpolation /////////////////////////////////////////////////////////////
+
+// kinds of the items of the element assembly lists
+enum { LP_VERTEX = 0, LP_EDGE = 4, LP_CONSTRAINED = 8, LP_BUBBLE = 9 };
+// kinds of the tasks
+enum { LP_VERTEX_TASK, LP_EDGE_TASK, LP_BUBBLE_TASK };
+
+static double2 lp_ref_vert[2][4] =
+{
+  { { -1.0, -1.0 }, { 1.0, -1.0 }, { -1.0, 1.0 }, {  0.0, 0.0 } },
+  { { -1.0, -1.0 }, { 1.0, -1.0 }, {  1.0, 1.0 }, { -1.0, 1.0 } }
+};
+
+struct LocalProjElem
+{
+  Element* e;
+  int first, cnt; // items of the assembly list in LocalProj::idx, dof, coef, kind
+  int qo;         // order of the 2D quadrature used for the bubbles
+};
+
+struct LocalProjTask
+{
+  int elem, type, k;
+};
+
+// data shared by all threads projecting one component
+struct LocalProj
+{
+  Space* space;
+  Shapeset* ss;
+  MeshFunction* source;
+  Solution* sln;      // the source if it can be evaluated by SolutionEvaluator, otherwise NULL
+  bool same_mesh;     // the source is defined on the mesh of the space
+  bool der;           // the derivatives of the source are needed
+  bool l2_part, h1_part; // terms of the norm used for the bubbles
+  bool l2_edges;      // edges are projected in L2, otherwise in the H1 seminorm
+  scalar* x;          // the target vector
+
+  std::vector<LocalProjElem> elems;
+  std::vector<int> idx, dof;
+  std::vector<scalar> coef;
+  std::vector<char> kind;
+};
+
+struct LocalProjWorker
+{
+  LocalProj* lp;
+  LocalProjTask* tasks;
+  int num;
+  SolutionEvaluator* ev;
+  PointRefMap rm;
+  pthread_t thread;
+};
+
+static inline scalar lp_known_coef(LocalProj* lp, int i)
+{
+  return lp->dof[i] >= 0 ? lp->coef[i] * lp->x[lp->dof[i]] : lp->coef[i];
+}
+
+// value and derivatives of the source at a point of element 'e' of the mesh of the space
+static void lp_eval_source(LocalProjWorker* w, Element* e, double xi1, double xi2, double x, double y,
+                           scalar& val, scalar& dx, scalar& dy)
+{
+  LocalProj* lp = w->lp;
+  dx = dy = 0.0;
+  if (w->ev != NULL && lp->same_mesh)
+  {
+    if (w->ev->get_active_element() != e) w->ev->set_active_element(e);
+    val = w->ev->get_ref_value(xi1, xi2, H2D_FN_VAL_0);
+    if (lp->der)
+    {
+      dx = w->ev->get_ref_value(xi1, xi2, H2D_FN_DX_0);
+      dy = w->ev->get_ref_value(xi1, xi2, H2D_FN_DY_0);
+    }
+  }
+  else if (w->ev != NULL)
+  {
+    val = w->ev->get_pt_value(x, y, H2D_FN_VAL_0);
+    if (lp->der)
+    {
+      dx = w->ev->get_pt_value(x, y, H2D_FN_DX_0);
+      dy = w->ev->get_pt_value(x, y, H2D_FN_DY_0);
+    }
+  }
+  else
+  {
+    val = lp->source->get_pt_value(x, y, H2D_FN_VAL_0);
+    if (lp->der)
+    {
+      dx = lp->source->get_pt_value(x, y, H2D_FN_DX_0);
+      dy = lp->source->get_pt_value(x, y, H2D_FN_DY_0);
+    }
+  }
+}
+
+// solves the (symmetric positive definite) system of the local projection and stores the DOFs
+static void lp_solve(LocalProj* lp, double** mat, scalar* rhs, int* unknowns, int n)
+{
+  double* p = new double[n];
+  choldc(mat, n, p);
+  cholsl(mat, n, p, rhs, rhs);
+  for (int i = 0; i < n; i++)
+    lp->x[lp->dof[unknowns[i]]] = rhs[i] / lp->coef[unknowns[i]];
+  delete [] p;
+}
+
+static void lp_vertex(LocalProjWorker* w, LocalProjElem* le, int k)
+{
+  LocalProj* lp = w->lp;
+  Element* e = le->e;
+  for (int i = le->first; i < le->first + le->cnt; i++)
+  {
+    if (lp->kind[i] != LP_VERTEX + k || lp->dof[i] < 0) continue;
+    scalar val, dx, dy;
+    double2& rv = lp_ref_vert[e->get_mode()][k];
+    lp_eval_source(w, e, rv[0], rv[1], e->vn[k]->x, e->vn[k]->y, val, dx, dy);
+    lp->x[lp->dof[i]] = val;
+    return;
+  }
+}
+
+// 1D projection of the source minus the vertex part on the edge 'k'
+static void lp_edge(LocalProjWorker* w, LocalProjElem* le, int k)
+{
+  LocalProj* lp = w->lp;
+  Element* e = le->e;
+  int mode = e->get_mode();
+  int k2 = e->next_vert(k);
+
+  int n = 0, nk = 0;
+  int* unknowns = new int[2 * le->cnt];
+  int* known = unknowns + le->cnt;
+  for (int i = le->first; i < le->first + le->cnt; i++)
+  {
+    if (lp->kind[i] == LP_EDGE + k && lp->dof[i] >= 0) unknowns[n++] = i;
+    else if (lp->kind[i] == LP_VERTEX + k || lp->kind[i] == LP_VERTEX + k2) known[nk++] = i;
+  }
+  if (n == 0) { delete [] unknowns; return; }
+
+  scalar* kc = new scalar[nk];
+  for (int j = 0; j < nk; j++)
+    kc[j] = lp_known_coef(lp, known[j]);
+
+  // the edge goes from 'a' to 'b' in the reference domain, t = db/ds
+  double2& a = lp_ref_vert[mode][k];
+  double2& b = lp_ref_vert[mode][k2];
+  double t[2] = { (b[0] - a[0]) / 2.0, (b[1] - a[1]) / 2.0 };
+
+  double** mat = new_matrix<double>(n, n);
+  scalar* rhs = new scalar[n];
+  memset(rhs, 0, sizeof(scalar) * n);
+  double* phi = new double[n];
+
+  int qo = std::min(g_quad_1d_std.get_max_order(), 2*n + 8);
+  double2* pt = g_quad_1d_std.get_points(qo);
+  for (int q = 0; q < g_quad_1d_std.get_num_points(qo); q++)
+  {
+    double s = (pt[q][0] + 1.0) / 2.0;
+    double xi1 = a[0] + s * (b[0] - a[0]);
+    double xi2 = a[1] + s * (b[1] - a[1]);
+    double x, y;
+    double2x2 m;
+    w->rm.get_inv_ref_map(xi1, xi2, x, y, m);
+
+    scalar val, dx, dy;
+    lp_eval_source(w, e, xi1, xi2, x, y, val, dx, dy);
+
+    // residual of the source (or of its derivative along the edge) after the vertex part
+    scalar r;
+    if (lp->l2_edges)
+    {
+      r = val;
+      for (int j = 0; j < nk; j++)
+        r -= kc[j] * lp->ss->get_fn_value(lp->idx[known[j]], xi1, xi2, 0);
+    }
+    else
+    {
+      // reference gradient of the source: the inverse of 'm' applied to the physical one
+      double det = m[0][0] * m[1][1] - m[0][1] * m[1][0];
+      scalar rdx = ( m[1][1] * dx - m[0][1] * dy) / det;
+      scalar rdy = (-m[1][0] * dx + m[0][0] * dy) / det;
+      r = rdx * t[0] + rdy * t[1];
+      for (int j = 0; j < nk; j++)
+      {
+        int ix = lp->idx[known[j]];
+        r -= kc[j] * (lp->ss->get_dx_value(ix, xi1, xi2, 0) * t[0] + lp->ss->get_dy_value(ix, xi1, xi2, 0) * t[1]);
+      }
+    }
+
+    for (int i = 0; i < n; i++)
+    {
+      int ix = lp->idx[unknowns[i]];
+      phi[i] = lp->l2_edges ? lp->ss->get_fn_value(ix, xi1, xi2, 0)
+                            : lp->ss->get_dx_value(ix, xi1, xi2, 0) * t[0] + lp->ss->get_dy_value(ix, xi1, xi2, 0) * t[1];
+    }
+    for (int i = 0; i < n; i++)
+    {
+      rhs[i] += pt[q][1] * r * phi[i];
+      for (int j = 0; j < n; j++)
+        mat[i][j] += pt[q][1] * phi[i] * phi[j];
+    }
+  }
+
+  lp_solve(lp, mat, rhs, unknowns, n);
+
+  delete [] phi;
+  delete [] rhs;
+  delete [] mat;
+  delete [] kc;
+  delete [] unknowns;
+}
+
+// projection of the source minus the vertex and edge part to the bubbles of the element
+static void lp_bubble(LocalProjWorker* w, LocalProjElem* le)
+{
+  LocalProj* lp = w->lp;
+  Element* e = le->e;
+  int mode = e->get_mode();
+
+  int n = 0;
+  int* unknowns = new int[le->cnt];
+  for (int i = le->first; i < le->first + le->cnt; i++)
+    if (lp->kind[i] == LP_BUBBLE && lp->dof[i] >= 0) unknowns[n++] = i;
+  if (n == 0) { delete [] unknowns; return; }
+
+  scalar* kc = new scalar[le->cnt];
+  for (int i = 0; i < le->cnt; i++)
+  {
+    int ii = le->first + i;
+    kc[i] = (lp->kind[ii] == LP_BUBBLE && lp->dof[ii] >= 0) ? 0.0 : lp_known_coef(lp, ii);
+  }
+
+  double** mat = new_matrix<double>(n, n);
+  scalar* rhs = new scalar[n];
+  memset(rhs, 0, sizeof(scalar) * n);
+  double* phi = new double[3*n];
+
+  double3* pt = g_quad_2d_std.get_points(le->qo, mode);
+  for (int q = 0; q < g_quad_2d_std.get_num_points(le->qo, mode); q++)
+  {
+    double xi1 = pt[q][0], xi2 = pt[q][1];
+    double x, y;
+    double2x2 m;
+    w->rm.get_inv_ref_map(xi1, xi2, x, y, m);
+    double wt = pt[q][2] / fabs(m[0][0] * m[1][1] - m[0][1] * m[1][0]);
+
+    scalar val, dx, dy;
+    lp_eval_source(w, e, xi1, xi2, x, y, val, dx, dy);
+
+    // residual of the source after the known part
+    for (int i = 0; i < le->cnt; i++)
+    {
+      if (kc[i] == 0.0) continue;
+      int ix = lp->idx[le->first + i];
+      val -= kc[i] * lp->ss->get_fn_value(ix, xi1, xi2, 0);
+      if (lp->h1_part)
+      {
+        double rdx = lp->ss->get_dx_value(ix, xi1, xi2, 0), rdy = lp->ss->get_dy_value(ix, xi1, xi2, 0);
+        dx -= kc[i] * (m[0][0] * rdx + m[0][1] * rdy);
+        dy -= kc[i] * (m[1][0] * rdx + m[1][1] * rdy);
+      }
+    }
+
+    for (int i = 0; i < n; i++)
+    {
+      int ix = lp->idx[unknowns[i]];
+      phi[3*i] = lp->ss->get_fn_value(ix, xi1, xi2, 0);
+      if (lp->h1_part)
+      {
+        double rdx = lp->ss->get_dx_value(ix, xi1, xi2, 0), rdy = lp->ss->get_dy_value(ix, xi1, xi2, 0);
+        phi[3*i+1] = m[0][0] * rdx + m[0][1] * rdy;
+        phi[3*i+2] = m[1][0] * rdx + m[1][1] * rdy;
+      }
+    }
+    for (int i = 0; i < n; i++)
+    {
+      double* pi = phi + 3*i;
+      if (lp->l2_part) rhs[i] += wt * val * pi[0];
+      if (lp->h1_part) rhs[i] += wt * (dx * pi[1] + dy * pi[2]);
+      for (int j = 0; j < n; j++)
+      {
+        double* pj = phi + 3*j;
+        double v = 0.0;
+        if (lp->l2_part) v += pi[0] * pj[0];
+        if (lp->h1_part) v += pi[1] * pj[1] + pi[2] * pj[2];
+        mat[i][j] += wt * v;
+      }
+    }
+  }
+
+  lp_solve(lp, mat, rhs, unknowns, n);
+
+  delete [] phi;
+  delete [] rhs;
+  delete [] mat;
+  delete [] kc;
+  delete [] unknowns;
+}
+
+static void* lp_worker(void* data)
+{
+  LocalProjWorker* w = (LocalProjWorker*) data;
+  for (int i = 0; i < w->num; i++)
+  {
+    LocalProjTask* task = w->tasks + i;
+    LocalProjElem* le = &w->lp->elems[task->elem];
+    w->rm.set_active_element(le->e);
+    if (task->type == LP_VERTEX_TASK) lp_vertex(w, le, task->k);
+    else if (task->type == LP_EDGE_TASK) lp_edge(w, le, task->k);
+    else lp_bubble(w, le);
+  }
+  return NULL;
+}
+
+// runs the tasks, triangles first, as the shapeset of the space is switched to the mode of the elements
+static void lp_run(LocalProj* lp, std::vector<LocalProjTask>& tasks, LocalProjWorker* workers, int nworkers)
+{
+  for (int mode = 0; mode < 2; mode++)
+  {
+    std::vector<LocalProjTask> mt;
+    for (unsigned int i = 0; i < tasks.size(); i++)
+      if (lp->elems[tasks[i].elem].e->get_mode() == mode)
+        mt.push_back(tasks[i]);
+    int num = mt.size();
+    if (num == 0) continue;
+    lp->ss->set_mode(mode);
+
+    int nthreads = std::max(1, std::min(nworkers, num));
+    for (int t = 0; t < nthreads; t++)
+    {
+      int first = (int) ((long) num * t / nthreads), last = (int) ((long) num * (t+1) / nthreads);
+      workers[t].tasks = &mt[first];
+      workers[t].num = last - first;
+    }
+
+    // the calling thread processes the first range
+    bool* started = new bool[nthreads];
+    for (int t = 1; t < nthreads; t++)
+      started[t] = (pthread_create(&workers[t].thread, NULL, lp_worker, workers + t) == 0);
+    lp_worker(workers);
+    for (int t = 1; t < nthreads; t++)
+      if (started[t]) pthread_join(workers[t].thread, NULL);
+      else lp_worker(workers + t);
+    delete [] started;
+  }
+}
+
+static void lp_project(Space* space, MeshFunction* source, ProjNormType norm, scalar* target_vec, int num_threads)
+{
+  _F_
+  LocalProj lp;
+  lp.space = space;
+  lp.ss = space->get_shapeset()->clone(); // its mode is switched by lp_run(), not by other threads
+  lp.source = source;
+  lp.x = target_vec;
+
+  Solution* sln = dynamic_cast<Solution*>(source);
+  lp.sln = (sln != NULL && sln->get_type() != Solution::HERMES_UNDEF) ? sln : NULL;
+  lp.same_mesh = (source->get_mesh() == space->get_mesh());
+
+  bool l2_space = (space->get_type() == 3);
+  if (l2_space && norm == HERMES_H1_SEMINORM) norm = HERMES_H1_NORM; // constants are not bubbles here
+  lp.l2_part = (norm != HERMES_H1_SEMINORM);
+  lp.h1_part = (norm != HERMES_L2_NORM);
+  lp.l2_edges = (norm == HERMES_L2_NORM);
+  lp.der = lp.h1_part;
+
+  // kinds of the shape functions: vertex, edge, bubble
+  int* idx_kind[2];
+  for (int mode = 0; mode < 2; mode++)
+  {
+    lp.ss->set_mode(mode);
+    int ni = lp.ss->get_max_index() + 1;
+    idx_kind[mode] = new int[ni];
+    for (int i = 0; i < ni; i++) idx_kind[mode][i] = LP_BUBBLE;
+    if (l2_space) continue;
+    int nv = (mode == H2D_MODE_TRIANGLE) ? 3 : 4;
+    for (int k = 0; k < nv; k++)
+    {
+      idx_kind[mode][lp.ss->get_vertex_index(k)] = LP_VERTEX + k;
+      for (int o = 2; o <= lp.ss->get_max_order(); o++)
+        for (int ori = 0; ori < 2; ori++)
+          idx_kind[mode][lp.ss->get_edge_index(k, ori, o)] = LP_EDGE + k;
+    }
+  }
+
+  // collect the assembly lists
+  AsmList al;
+  int max_dof = -1;
+  Element* e;
+  for_all_active_elements(e, space->get_mesh())
+  {
+    int mode = e->get_mode();
+    lp.ss->set_mode(mode);
+    space->get_element_assembly_list(e, &al);
+    if (al.cnt == 0) continue;
+
+    LocalProjElem le;
+    le.e = e;
+    le.first = lp.idx.size();
+    le.cnt = al.cnt;
+    int o = space->get_element_order(e->id);
+    int p = (mode == H2D_MODE_QUAD) ? std::max(H2D_GET_H_ORDER(o), H2D_GET_V_ORDER(o)) : o;
+    g_quad_2d_std.set_mode(mode);
+    le.qo = std::min(g_quad_2d_std.get_safe_max_order(), 2*p + (e->is_curved() ? 6 : 4));
+    lp.elems.push_back(le);
+
+    for (int i = 0; i < al.cnt; i++)
+    {
+      int kind = LP_CONSTRAINED;
+      if (al.idx[i] >= 0) kind = idx_kind[mode][al.idx[i]];
+      else lp.ss->get_fn_value(al.idx[i], 0.0, 0.0, 0); // calculates the combination for the threads
+      lp.idx.push_back(al.idx[i]);
+      lp.dof.push_back(al.dof[i]);
+      lp.coef.push_back(al.coef[i]);
+      lp.kind.push_back(kind);
+      if (al.dof[i] > max_dof) max_dof = al.dof[i];
+    }
+  }
+  for (int mode = 0; mode < 2; mode++)
+    delete [] idx_kind[mode];
+
+  // every vertex and edge is projected on the first element where it appears
+  std::vector<char> owned(max_dof + 1, 0), pending(max_dof + 1, 0);
+  std::vector<LocalProjTask> vertex_tasks, edge_tasks, bubble_tasks;
+  for (unsigned int el = 0; el < lp.elems.size(); el++)
+  {
+    LocalProjElem& le = lp.elems[el];
+    bool bubbles = false;
+    for (int i = le.first; i < le.first + le.cnt; i++)
+    {
+      int d = lp.dof[i], kind = lp.kind[i];
+      if (d < 0) continue;
+      if (kind < LP_EDGE && !le.e->vn[kind]->is_constrained_vertex() && !owned[d])
+      {
+        owned[d] = 1;
+        LocalProjTask task = { (int) el, LP_VERTEX_TASK, kind };
+        vertex_tasks.push_back(task);
+      }
+      else if (kind >= LP_EDGE && kind < LP_CONSTRAINED && !owned[d])
+      {
+        for (int j = le.first; j < le.first + le.cnt; j++)
+          if (lp.kind[j] == kind && lp.dof[j] >= 0)
+            owned[lp.dof[j]] = pending[lp.dof[j]] = 1;
+        LocalProjTask task = { (int) el, LP_EDGE_TASK, kind - LP_EDGE };
+        edge_tasks.push_back(task);
+      }
+      else if (kind == LP_BUBBLE)
+        bubbles = true;
+    }
+    if (bubbles)
+    {
+      LocalProjTask task = { (int) el, LP_BUBBLE_TASK, 0 };
+      bubble_tasks.push_back(task);
+    }
+  }
+
+  // other MeshFunctions than solutions are not thread-safe
+  int nworkers = (lp.sln != NULL) ? num_threads : 1;
+  LocalProjWorker* workers = new LocalProjWorker[nworkers];
+  for (int t = 0; t < nworkers; t++)
+  {
+    workers[t].lp = &lp;
+    workers[t].ev = (lp.sln != NULL) ? new SolutionEvaluator(lp.sln) : NULL;
+  }
+
+  lp_run(&lp, vertex_tasks, workers, nworkers);
+
+  // an edge can be projected when the values in its vertices are known; a constrained
+  // vertex depends on the edge constraining it, so the edges go in waves (large first)
+  while (!edge_tasks.empty())
+  {
+    std::vector<LocalProjTask> ready, rest;
+    for (unsigned int i = 0; i < edge_tasks.size(); i++)
+    {
+      LocalProjTask& task = edge_tasks[i];
+      LocalProjElem& le = lp.elems[task.elem];
+      int k2 = le.e->next_vert(task.k);
+      bool ok = true;
+      for (int j = le.first; ok && j < le.first + le.cnt; j++)
+        if ((lp.kind[j] == LP_VERTEX + task.k || lp.kind[j] == LP_VERTEX + k2) && lp.dof[j] >= 0 && pending[lp.dof[j]])
+          ok = false;
+      (ok ? ready : rest).push_back(task);
+    }
+    if (ready.empty()) error("Cyclic constraints in project_local().");
+
+    lp_run(&lp, ready, workers, nworkers);
+    for (unsigned int i = 0; i < ready.size(); i++)
+    {
+      LocalProjElem& le = lp.elems[ready[i].elem];
+      for (int j = le.first; j < le.first + le.cnt; j++)
+        if (lp.kind[j] == LP_EDGE + ready[i].k && lp.dof[j] >= 0)
+          pending[lp.dof[j]] = 0;
+    }
+    edge_tasks.swap(rest);
+  }
+
+  lp_run(&lp, bubble_tasks, workers, nworkers);
+
+  for (int t = 0; t < nworkers; t++)
+    delete workers[t].ev;
+  delete [] workers;
+  delete lp.ss;
+}
+
+bool OGProjection::can_project_local(Tuple<Space *> spaces)
+{
+  _F_
+  for (int i = 0; i < spaces.size(); i++)
+  {
+    int type = spaces[i]->get_type();
+    if (type != 0 && type != 3) return false; // H1 and L2 only
+  }
+  return true;
+}
+
+void OGProjection::project_local(Tuple<Space *> spaces, Tuple<MeshFunction *> source_meshfns,
+                                 scalar* target_vec, Tuple<ProjNormType> proj_norms)
+{
+  _F_
+  HERMES_PERF_SCOPE("projection_local");
+  int n = spaces.size();
+
+  // sanity checks
+  if (n <= 0 || n > 10) error("Wrong number of projected functions in project_local().");
+  for (int i = 0; i < n; i++) if(spaces[i] == NULL) error("this->spaces[%d] == NULL in project_local().", i);
+  if (source_meshfns.size() != n) error("Number of spaces must match number of projected functions in project_local().");
+  if (!can_project_local(spaces)) error("project_local() supports only H1 and L2 spaces.");
+
+  // this is needed since spaces may have their DOFs enumerated only locally.
+  Space::assign_dofs(spaces);
+
+  for (int i = 0; i < n; i++)
+  {
+    ProjNormType norm = (proj_norms == Tuple<ProjNormType>()) ? HERMES_DEFAULT_PROJ_NORM : proj_norms[i];
+    if (norm != HERMES_L2_NORM && norm != HERMES_H1_NORM && norm != HERMES_H1_SEMINORM)
+      error("Wrong projection norm in project_local().");
+    lp_project(spaces[i], source_meshfns[i], norm, target_vec, num_threads);
+  }
+}
+
+void OGProjection::project_local(Tuple<Space *> spaces, Tuple<Solution*> sols_src, Tuple<Solution*> sols_dest,
+                                 Tuple<ProjNormType> proj_norms)
+{
+  _F_
+  scalar* target_vec = new scalar[Space::get_num_dofs(spaces)];
+  Tuple<MeshFunction *> src_mf;
+  for (int i = 0; i < sols_src.size(); i++)
+    src_mf.push_back(static_cast<MeshFunction*>(sols_src[i]));
+
+  project_local(spaces, src_mf, target_vec, proj_norms);
+
+  Solution::vector_to_solutions(target_vec, spaces, sols_dest);
+
+  delete [] target_vec;
+}
+
 void OGProjection::project_local(Space *space, int proj_norm, ExactFunction source_fn, Mesh* mesh,
                    scalar* target_vec)
 {
   _F_
-  /// TODO
+  if (mesh != NULL && mesh != space->get_mesh()) error("The mesh has to be the mesh of the space in project_local().");
+  Solution source_sln;
+  source_sln.set_exact(space->get_mesh(), source_fn);
+  project_local(space, (MeshFunction*)&source_sln, target_vec, (ProjNormType) proj_norm);
+}
+
+void OGProjection::project(Tuple<Space *> spaces, Tuple<MeshFunction *> source_meshfns, scalar* target_vec,
+                           MatrixSolverType matrix_solver, Tuple<ProjNormType> proj_norms, bool allow_interpolation)
+{
+  _F_
+  if (allow_interpolation && can_project_local(spaces))
+    project_local(spaces, source_meshfns, target_vec, proj_norms);
+  else
+    project_global(spaces, source_meshfns, target_vec, matrix_solver, proj_norms);
+}
+
+void OGProjection::project(Tuple<Space *> spaces, Tuple<Solution*> sols_src, Tuple<Solution*> sols_dest,
+                           MatrixSolverType matrix_solver, Tuple<ProjNormType> proj_norms, bool allow_interpolation)
+{
+  _F_
+  if (allow_interpolation && can_project_local(spaces))
+    project_local(spaces, sols_src, sols_dest, proj_norms);
+  else
+    project_global(spaces, sols_src, sols_dest, matrix_solver, proj_norms);
 }
@@ -45,11 +45,48 @@ public:
   /// Global orthogonal projection of one scalar-valued ExactFunction.
   static void project_global(Space *space, ExactFunction source_fn, scalar* target_vec, MatrixSolverType matrix_solver = SOLVER_UMFPACK);
 
-  /// Projection-based interpolation of an exact function. This is faster than the
-  /// global projection since no global matrix problem is solved.
+  /// \brief Projection-based interpolation (local projection).
+  ///
+  /// No global matrix problem is solved. The DOFs are computed node by node:
+  /// - the vertex DOFs are the values of the source at the vertices;
+  /// - the edge DOFs come from a 1D projection on each edge (H1 seminorm along the edge,
+  ///   or L2 for HERMES_L2_NORM) of the source minus the vertex part;
+  /// - the bubble DOFs come from a small dense projection on each element.
+  ///
+  /// The cost is linear in the number of elements, and the elements are processed by
+  /// set_num_threads() threads. The result is an interpolant: it converges at the same
+  /// rate as the global projection, but it is not the best approximation in the given
+  /// norm. Only H1 and L2 spaces are supported (see can_project_local()). The source
+  /// can be any MeshFunction on any mesh. Solutions are evaluated in parallel, and
+  /// other functions by one thread.
+  static void project_local(Tuple<Space *> spaces, Tuple<MeshFunction *> source_meshfns,
+                            scalar* target_vec, Tuple<ProjNormType> proj_norms = Tuple<ProjNormType>());
+
+  static void project_local(Tuple<Space *> spaces, Tuple<Solution*> sols_src, Tuple<Solution*> sols_dest,
+                            Tuple<ProjNormType> proj_norms = Tuple<ProjNormType>());
+
+  /// Projection-based interpolation of an exact function. 'mesh' has to be the mesh of
+  /// the space or NULL.
   static void project_local(Space *space, int proj_norm, ExactFunction source_fn, Mesh* mesh,
                    scalar* target_vec);
 
+  /// Returns true if project_local() can project to the spaces.
+  static bool can_project_local(Tuple<Space *> spaces);
+
+  /// Projects with project_local() if 'allow_interpolation' is true and the spaces
+  /// support it. Otherwise it uses project_global().
+  static void project(Tuple<Space *> spaces, Tuple<MeshFunction *> source_meshfns, scalar* target_vec,
+                      MatrixSolverType matrix_solver = SOLVER_UMFPACK, Tuple<ProjNormType> proj_norms = Tuple<ProjNormType>(),
+                      bool allow_interpolation = false);
+
+  static void project(Tuple<Space *> spaces, Tuple<Solution*> sols_src, Tuple<Solution*> sols_dest,
+                      MatrixSolverType matrix_solver = SOLVER_UMFPACK, Tuple<ProjNormType> proj_norms = Tuple<ProjNormType>(),
+                      bool allow_interpolation = false);
+
+  /// Sets the number of threads used by project_local().
+  static void set_num_threads(int num_threads) { OGProjection::num_threads = std::max(1, num_threads); }
+  static int get_num_threads() { return num_threads; }
+
   // Underlying function for global orthogonal projection.
   // Not intended for the user. NOTE: the weak form here must be 
   // a special projection weak form, which is different from 
@@ -58,6 +95,8 @@ public:
 protected:
   static void project_internal(Tuple<Space *> spaces, WeakForm *proj_wf, scalar* target_vec, MatrixSolverType matrix_solver = SOLVER_UMFPACK);
 
+  static int num_threads;
+
   // The projection functionality below is identical in H2D and H3D.
   template<typename Real, typename Scalar>
   static Scalar H1projection_biform(int n, double *wt, Func<Scalar> *u_ext[], Func<Real> *u, Func<Real> *v, Geom<Real> *e, ExtData<Scalar> *ext)
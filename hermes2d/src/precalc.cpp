@@ -121,6 +121,7 @@ void PrecalcShapeset::set_mode(int mode)  // used in curved.cpp
 
 void PrecalcShapeset::precalculate(int order, int mask)
 {
+  HERMES_PERF_SCOPE("precalculate_shapes");
   int i, j, k;
 
   // initialization
@@ -74,6 +74,11 @@ public:
 
   int get_num_points(int order)  const { return np[mode][order]; };
   double3* get_points(int order) const { assert(order < num_tables[mode]); return tables[mode][order]; }
+
+  /// These do not depend on the current mode and can be used by several threads at once.
+  int get_num_points(int order, int mode)  const { return np[mode][order]; };
+  double3* get_points(int order, int mode) const { assert(order < num_tables[mode]); return tables[mode][order]; }
+  int get_num_tables(int mode) const { return num_tables[mode]; }
   int get_edge_points(int edge)  const { return max_order[mode]+1 + (3*(1-mode) + 4*mode)*max_order[mode] + edge; }
   int get_edge_points(int edge, int order) {return  max_order[mode]+1 + (3*(1-mode) + 4*mode)*order + edge;}
 
@@ -505,6 +505,7 @@ namespace RefinementSelectors {
   }
 
   bool OptimumSelector::select_refinement(Element* element, int quad_order, Solution* rsln, ElementToRefine& refinement) {
+    HERMES_PERF_SCOPE("candidate_selection");
     //make an uniform order in a case of a triangle
     int order_h = H2D_GET_H_ORDER(quad_order), order_v = H2D_GET_V_ORDER(quad_order);
     if (element->is_triangle()) {
@@ -5,6 +5,27 @@
 
 namespace RefinementSelectors {
 
+  int Selector::select_coarsening_order(const Element* element, const int son_quad_orders[H2D_MAX_ELEMENT_SONS]) {
+    //determin max. order
+    int max_allowed_order = max_order;
+    if (max_order == H2DRS_DEFAULT_ORDER)
+      max_allowed_order = H2DRS_MAX_ORDER;
+
+    //the maximum of the sons
+    int order_h = 1, order_v = 1;
+    for(int i = 0; i < H2D_MAX_ELEMENT_SONS; i++) {
+      order_h = std::max(order_h, H2D_GET_H_ORDER(son_quad_orders[i]));
+      order_v = std::max(order_v, H2D_GET_V_ORDER(son_quad_orders[i]));
+    }
+    order_h = std::min(order_h, max_allowed_order);
+    order_v = std::min(order_v, max_allowed_order);
+
+    if (element->is_triangle())
+      return order_h;
+    else
+      return H2D_MAKE_QUAD_ORDER(order_h, order_v);
+  }
+
   bool HOnlySelector::select_refinement(Element* element, int quad_order, Solution* rsln, ElementToRefine& refinement) {
     refinement.split = H2D_REFINEMENT_H;
     refinement.p[0] = refinement.p[1] = refinement.p[2] = refinement.p[3] = quad_order;
@@ -89,6 +89,13 @@ namespace RefinementSelectors {
      *  \param[out] tgt_quad_orders Generated encoded orders.
      *  \param[in] suggested_quad_orders Suggested encoded orders. If not NULL, the method should copy them to the output. If NULL, the method have to calculate orders. */
     virtual void generate_shared_mesh_orders(const Element* element, const int orig_quad_order, const int refinement, int tgt_quad_orders[H2D_MAX_ELEMENT_SONS], const int* suggested_quad_orders) = 0;
+
+    /// Selects an order of an element whose sons are merged by Adapt::coarsen().
+    /** The default implementation uses the maximum of the orders of the sons limited by the maximum order, so the merged element keeps the orders its sons needed.
+     *  \param[in] element An element whose sons are about to be merged.
+     *  \param[in] son_quad_orders Encoded orders of the sons. The order of a missing son is 0.
+     *  \return An encoded order of the merged element. */
+    virtual int select_coarsening_order(const Element* element, const int son_quad_orders[H2D_MAX_ELEMENT_SONS]);
   };
 
   /// A selector that selects H-refinements only. \ingroup g_selectors
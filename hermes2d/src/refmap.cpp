@@ -517,3 +517,82 @@ RefMap::Node** RefMap::handle_overflow()
   overflow = NULL;
   return &overflow;
 }
+
+
+//// PointRefMap ///////////////////////////////////////////////////////////////////////////////////
+
+void PointRefMap::set_active_element(Element* e)
+{
+  element = e;
+  shapeset.set_mode(e->get_mode());
+
+  // the same shapes and coefficients as in RefMap::set_active_element()
+  int k = 0;
+  for (unsigned int i = 0; i < e->nvert; i++)
+    indices[k++] = shapeset.get_vertex_index(i);
+
+  if (e->cm == NULL)
+  {
+    for (unsigned int i = 0; i < e->nvert; i++)
+    {
+      lin_coeffs[i][0] = e->vn[i]->x;
+      lin_coeffs[i][1] = e->vn[i]->y;
+    }
+    coeffs = lin_coeffs;
+    nc = e->nvert;
+  }
+  else
+  {
+    int o = e->cm->order;
+    for (unsigned int i = 0; i < e->nvert; i++)
+      for (int j = 2; j <= o; j++)
+        indices[k++] = shapeset.get_edge_index(i, 0, j);
+
+    if (e->is_quad()) o = H2D_MAKE_QUAD_ORDER(o, o);
+    memcpy(indices + k, shapeset.get_bubble_indices(o),
+           shapeset.get_num_bubbles(o) * sizeof(int));
+
+    coeffs = e->cm->coeffs;
+    nc = e->cm->nc;
+  }
+}
+
+
+void PointRefMap::get_phys_point(double xi1, double xi2, double& x, double& y)
+{
+  x = y = 0;
+  for (int i = 0; i < nc; i++)
+  {
+    double val = shapeset.get_fn_value(indices[i], xi1, xi2, 0);
+    x += coeffs[i][0] * val;
+    y += coeffs[i][1] * val;
+  }
+}
+
+
+void PointRefMap::get_inv_ref_map(double xi1, double xi2, double& x, double& y, double2x2& m)
+{
+  double2x2 tmp;
+  memset(tmp, 0, sizeof(double2x2));
+  x = y = 0;
+  for (int i = 0; i < nc; i++)
+  {
+    double val = shapeset.get_fn_value(indices[i], xi1, xi2, 0);
+    x += coeffs[i][0] * val;
+    y += coeffs[i][1] * val;
+
+    double dx = shapeset.get_dx_value(indices[i], xi1, xi2, 0);
+    double dy = shapeset.get_dy_value(indices[i], xi1, xi2, 0);
+    tmp[0][0] += coeffs[i][0] * dx;
+    tmp[0][1] += coeffs[i][0] * dy;
+    tmp[1][0] += coeffs[i][1] * dx;
+    tmp[1][1] += coeffs[i][1] * dy;
+  }
+
+  // inverse matrix
+  double jac = tmp[0][0] * tmp[1][1] - tmp[0][1] * tmp[1][0];
+  m[0][0] =  tmp[1][1] / jac;
+  m[0][1] = -tmp[1][0] / jac;
+  m[1][0] = -tmp[0][1] / jac;
+  m[1][1] =  tmp[0][0] / jac;
+}
@@ -19,6 +19,7 @@
 #include "h2d_common.h"
 #include "precalc.h"
 #include "quad_all.h"
+#include "shapeset/shapeset_h1_all.h"
 
 struct Element;
 
@@ -227,4 +228,40 @@ protected:
 };
 
 
+/// \brief Reference mapping evaluated at single points, usable from several threads.
+///
+/// RefMap precalculates the mapping in quadrature points using the global reference
+/// map shapeset, so only one thread can use reference maps at a time. PointRefMap
+/// evaluates the mapping of the active element at arbitrary points of the reference
+/// domain using its own shapeset. Different instances can be used concurrently.
+///
+class HERMES_API PointRefMap
+{
+public:
+
+  PointRefMap() { element = NULL; coeffs = NULL; nc = 0; }
+
+  /// Initializes the reference map for the specified element.
+  void set_active_element(Element* e);
+  Element* get_active_element() const { return element; }
+
+  /// Returns the physical coordinates of the reference point (xi1, xi2).
+  void get_phys_point(double xi1, double xi2, double& x, double& y);
+
+  /// Returns the physical coordinates of the reference point (xi1, xi2) and the inverse
+  /// of the reference map at that point.
+  void get_inv_ref_map(double xi1, double xi2, double& x, double& y, double2x2& m);
+
+protected:
+
+  Element* element;
+  H1ShapesetJacobi shapeset;
+  int indices[70];
+  int nc;
+  double2* coeffs;
+  double2  lin_coeffs[4];
+
+};
+
+
 #endif
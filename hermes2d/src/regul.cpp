@@ -298,6 +298,8 @@ int* Mesh::regularize(int n)
     reg = true;
   }
 
+  unshare();
+
   parents_size = 2*get_max_element_id();
   parents = (int*) malloc(sizeof(int) * parents_size);
   for_all_active_elements(e, this)
@@ -199,3 +199,26 @@ double Shapeset::get_constrained_value(int n, int index, double x, double y, int
 
   return sum;
 }
+
+
+/// A copy of a shapeset made by Shapeset::clone(). The tables of the shape functions are
+/// static, so they are shared, but the constrained edge functions are calculated again.
+class ShapesetClone : public Shapeset
+{
+public:
+  ShapesetClone(const Shapeset& ss) : Shapeset(ss), id(ss.get_id())
+  {
+    comb_table = NULL;
+    table_size = 0;
+  }
+  virtual int get_id() const { return id; }
+
+protected:
+  int id;
+};
+
+
+Shapeset* Shapeset::clone() const
+{
+  return new ShapesetClone(*this);
+}
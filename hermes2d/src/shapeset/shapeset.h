@@ -194,6 +194,10 @@ public:
   /// Returns shapeset identifier. Internal.
   virtual int get_id() const = 0;
 
+  /// Returns a new shapeset with the same shape functions, but with its own mode and its own
+  /// constrained edge functions, so it can be used by another thread. Delete it when done.
+  Shapeset* clone() const;
+
 
 protected:
 
@@ -19,6 +19,7 @@
 #include "precalc.h"
 #include "refmap.h"
 #include "auto_local_array.h"
+#include <pthread.h>
 
 //// MeshFunction //////////////////////////////////////////////////////////////////////////////////
 
@@ -75,12 +76,16 @@ static int*      cheb_np[2]  = { cheb_np_tri,  cheb_np_quad  };
 /// points on the reference triangle and quad. It is used for expressing
 /// the solution on an element as a linear combination of monomials.
 ///
+/// The points are calculated by g_quad_2d_cheb. Its copies share them, but they have
+/// their own mode, so they can be used by other threads.
+///
 static class Quad2DCheb : public Quad2D
 {
 public:
 
   Quad2DCheb()
   {
+    own = true;
     mode = H2D_MODE_TRIANGLE;
     max_order[0]  = max_order[1]  = 10;
     num_tables[0] = num_tables[1] = 11;
@@ -109,15 +114,22 @@ public:
     }
   };
 
+  Quad2DCheb(const Quad2DCheb& quad) : Quad2D(quad), own(false) {}
+
   ~Quad2DCheb()
   {
+    if (!own) return;
     for (int mode = 0; mode <= 1; mode++)
-      for (int k = 1; k <= 10; k++)
+      for (int k = 0; k <= 10; k++)
         delete[] tables[mode][k];
   }
 
   virtual void dummy_fn() {}
 
+protected:
+
+  bool own;
+
 } g_quad_2d_cheb;
 
 
@@ -171,6 +183,13 @@ void Solution::init()
   num_coefs = num_elems = 0;
   num_dofs = -1;
 
+  mem_budget = 0;
+  space = NULL;
+  dof_coefs = NULL;
+  lift_coef = 1.0;
+  mono_pss = NULL;
+  mono_bytes = 0;
+
   set_quad_2d(&g_quad_2d_std);
 }
 
@@ -230,6 +249,18 @@ void Solution::assign(Solution* sln)
   num_coefs = sln->num_coefs;          sln->num_coefs = 0;
   num_elems = sln->num_elems;          sln->num_elems = 0;
 
+  space = sln->space;                  sln->space = NULL;
+  dof_coefs = sln->dof_coefs;          sln->dof_coefs = NULL;
+  mono_pss = sln->mono_pss;            sln->mono_pss = NULL;
+  mono_bytes = sln->mono_bytes;        sln->mono_bytes = 0;
+  mono_cache.swap(sln->mono_cache);
+  mono_lru.swap(sln->mono_lru);
+  space_seq = sln->space_seq;
+  first_dof = sln->first_dof;
+  last_dof = sln->last_dof;
+  lift_coef = sln->lift_coef;
+  if (space != NULL) mem_budget = sln->mem_budget;
+
   type = sln->type;
   space_type = sln->space_type;
   num_components = sln->num_components;
@@ -255,7 +286,20 @@ void Solution::copy(const Solution* sln)
   num_components = sln->num_components;
   num_dofs = sln->num_dofs;
 
-  if (sln->type == HERMES_SLN) // standard solution: copy coefficient arrays
+  if (sln->type == HERMES_SLN && sln->space != NULL) // compact solution: make a standard one
+  {
+    space = sln->space;
+    space_seq = sln->space_seq;
+    first_dof = sln->first_dof;
+    last_dof = sln->last_dof;
+    dof_coefs = new scalar[last_dof - first_dof + 1];
+    memcpy(dof_coefs, sln->dof_coefs, sizeof(scalar) * (last_dof - first_dof + 1));
+    lift_coef = sln->lift_coef;
+    expand();
+
+    init_dxdy_buffer();
+  }
+  else if (sln->type == HERMES_SLN) // standard solution: copy coefficient arrays
   {
     num_coefs = sln->num_coefs;
     num_elems = sln->num_elems;
@@ -301,6 +345,11 @@ void Solution::free()
     if (elem_coefs[i] != NULL)
       { delete [] elem_coefs[i];  elem_coefs[i] = NULL; }
 
+  free_mono_cache();
+  if (dof_coefs != NULL) { delete [] dof_coefs;  dof_coefs = NULL; }
+  free_mono_pss();
+  space = NULL;
+
   if (own_mesh == true && mesh != NULL)
   {
     //printf("Deleting mesh in Solution (own_mesh == true).\n");
@@ -347,8 +396,23 @@ public:
 }
 mono_lu;
 
+// The assembly lists switch the mode of the shapeset of the space and the LU matrices above
+// are shared, so both are accessed under this lock. The rest of the calculation of the
+// monomial coefficients of a compact solution uses a private shapeset.
+static pthread_mutex_t mono_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static void get_mono_assembly_list(Space* space, Element* e, AsmList* al)
+{
+  pthread_mutex_lock(&mono_mutex);
+  Shapeset* ss = space->get_shapeset();
+  int mode = ss->get_mode();
+  space->get_element_assembly_list(e, al);
+  ss->set_mode(mode);
+  pthread_mutex_unlock(&mono_mutex);
+}
 
-double** Solution::calc_mono_matrix(int o, int*& perm)
+
+double** Solution::calc_mono_matrix(int mode, int o, int*& perm)
 {
   int i, j, k, l, m, row;
   double x, y, xn, yn;
@@ -435,6 +499,32 @@ void Solution::set_coeff_vector(Space* space, PrecalcShapeset* pss, scalar* coef
   // copy the mesh   TODO: share meshes between solutions // WHAT???
   mesh = space->get_mesh();
 
+  // compact solution: the coefficients of the DOFs of the space only
+  if (mem_budget > 0)
+  {
+    this->space = space;
+    space_seq = space->get_seq();
+    AsmList al;
+    Element* e;
+    first_dof = 0;
+    last_dof = -1;
+    for_all_active_elements(e, mesh)
+    {
+      space->get_element_assembly_list(e, &al);
+      for (int k = 0; k < al.cnt; k++)
+        if (al.dof[k] >= 0)
+        {
+          if (last_dof < 0 || al.dof[k] < first_dof) first_dof = al.dof[k];
+          last_dof = std::max(last_dof, al.dof[k]);
+        }
+    }
+    dof_coefs = new scalar[last_dof - first_dof + 1];
+    memcpy(dof_coefs, coeffs + first_dof, sizeof(scalar) * (last_dof - first_dof + 1));
+    lift_coef = add_dir_lift ? 1.0 : 0.0;
+    init_dxdy_buffer();
+    return;
+  }
+
   // allocate the coefficient arrays
   num_elems = mesh->get_max_element_id();
   if(elem_orders != NULL)
@@ -454,16 +544,7 @@ void Solution::set_coeff_vector(Space* space, PrecalcShapeset* pss, scalar* coef
   for_all_active_elements(e, mesh)
   {
     mode = e->get_mode();
-    o = space->get_element_order(e->id);
-    o = std::max(H2D_GET_H_ORDER(o), H2D_GET_V_ORDER(o));
-    for (unsigned int k = 0; k < e->nvert; k++) {
-      int eo = space->get_edge_order(e, k);
-      if (eo > o) o = eo;
-    }
-
-    // Hcurl: actual order of functions is one higher than element order
-    if ((space->get_shapeset())->get_num_components() == 2) o++;
-
+    o = calc_mono_order(space, e);
     num_coefs += mode ? sqr(o+1) : (o+1)*(o+2)/2;
     elem_orders[e->id] = o;
   }
@@ -473,44 +554,19 @@ void Solution::set_coeff_vector(Space* space, PrecalcShapeset* pss, scalar* coef
   mono_coefs = new scalar[num_coefs];
 
   // express the solution on elements as a linear combination of monomials
-  Quad2D* quad = &g_quad_2d_cheb;
-  pss->set_quad_2d(quad);
+  pss->set_quad_2d(&g_quad_2d_cheb);
   scalar* mono = mono_coefs;
+  AsmList al;
   for_all_active_elements(e, mesh)
   {
-    mode = e->get_mode();
-    quad->set_mode(mode);
     o = elem_orders[e->id];
-    int np = quad->get_num_points(o);
+    int np = e->is_quad() ? sqr(o+1) : (o+1)*(o+2)/2;
 
-    AsmList al;
     space->get_element_assembly_list(e, &al);
-    pss->set_active_element(e);
-
+    calc_mono_coefs(e, o, pss, &al, coeffs, 0, add_dir_lift ? 1.0 : 0.0, mono);
     for (int l = 0; l < num_components; l++)
-    {
-      // obtain solution values for the current element
-      scalar* val = mono;
-      elem_coefs[l][e->id] = (int) (mono - mono_coefs);
-      memset(val, 0, sizeof(scalar)*np);
-      for (int k = 0; k < al.cnt; k++)
-      {
-        pss->set_active_shape(al.idx[k]);
-        pss->set_quad_order(o, H2D_FN_VAL);
-        int dof = al.dof[k];
-        double dir_lift_coeff = add_dir_lift ? 1.0 : 0.0;
-        scalar coef = al.coef[k] * (dof >= 0 ? coeffs[dof] : dir_lift_coeff);
-        double* shape = pss->get_fn_values(l);
-        for (int i = 0; i < np; i++)
-          val[i] += shape[i] * coef;
-      }
-      mono += np;
-
-      // solve for the monomial coefficients
-      if (mono_lu.mat[mode][o] == NULL)
-        mono_lu.mat[mode][o] = calc_mono_matrix(o, mono_lu.perm[mode][o]);
-      lubksb(mono_lu.mat[mode][o], np, mono_lu.perm[mode][o], val);
-    }
+      elem_coefs[l][e->id] = (int) (mono - mono_coefs) + l*np;
+    mono += num_components * np;
   }
 
   if(mesh == NULL) error("mesh == NULL.\n");
@@ -519,6 +575,186 @@ void Solution::set_coeff_vector(Space* space, PrecalcShapeset* pss, scalar* coef
 }
 
 
+int Solution::calc_mono_order(Space* space, Element* e)
+{
+  int o = space->get_element_order(e->id);
+  o = std::max(H2D_GET_H_ORDER(o), H2D_GET_V_ORDER(o));
+  for (unsigned int k = 0; k < e->nvert; k++) {
+    int eo = space->get_edge_order(e, k);
+    if (eo > o) o = eo;
+  }
+
+  // Hcurl: actual order of functions is one higher than element order
+  if ((space->get_shapeset())->get_num_components() == 2) o++;
+  return o;
+}
+
+
+void Solution::calc_mono_coefs(Element* e, int o, PrecalcShapeset* pss, AsmList* al,
+                               scalar* coeffs, int first_dof, scalar lift_coef, scalar* mono)
+{
+  int mode = e->get_mode();
+  Quad2D* quad = pss->get_quad_2d();
+  quad->set_mode(mode);
+  int np = quad->get_num_points(o);
+  pss->set_active_element(e);
+
+  for (int l = 0; l < pss->get_num_components(); l++)
+  {
+    // obtain solution values for the current element
+    scalar* val = mono;
+    memset(val, 0, sizeof(scalar)*np);
+    for (int k = 0; k < al->cnt; k++)
+    {
+      pss->set_active_shape(al->idx[k]);
+      pss->set_quad_order(o, H2D_FN_VAL);
+      int dof = al->dof[k];
+      scalar coef = al->coef[k] * (dof >= 0 ? coeffs[dof - first_dof] : lift_coef);
+      double* shape = pss->get_fn_values(l);
+      for (int i = 0; i < np; i++)
+        val[i] += shape[i] * coef;
+    }
+    mono += np;
+
+    // solve for the monomial coefficients
+    pthread_mutex_lock(&mono_mutex);
+    if (mono_lu.mat[mode][o] == NULL)
+      mono_lu.mat[mode][o] = calc_mono_matrix(mode, o, mono_lu.perm[mode][o]);
+    pthread_mutex_unlock(&mono_mutex);
+    lubksb(mono_lu.mat[mode][o], np, mono_lu.perm[mode][o], val);
+  }
+}
+
+
+scalar* Solution::get_mono_coefs(Element* e)
+{
+  std::map<int, MonoEntry>::iterator it = mono_cache.find(e->id);
+  HERMES_PERF_CACHE_HIT("solution_mono", it != mono_cache.end());
+  if (it != mono_cache.end())
+  {
+    mono_lru.splice(mono_lru.begin(), mono_lru, it->second.lru);
+    return it->second.mono;
+  }
+
+  if (space->get_seq() != space_seq || !space->is_up_to_date() || Space::get_num_dofs(space) != num_dofs)
+    error("The space of a compact solution has changed, use Solution::copy() to keep the solution.");
+
+  // drop the least recently used elements, the new one is kept even if it does not fit
+  int o = calc_mono_order(space, e);
+  size_t bytes = sizeof(scalar) * num_components * (e->is_quad() ? sqr(o+1) : (o+1)*(o+2)/2);
+  while (!mono_lru.empty() && mono_bytes + bytes + total_mem > mem_budget)
+  {
+    std::map<int, MonoEntry>::iterator old = mono_cache.find(mono_lru.back());
+    mono_bytes -= old->second.bytes;
+    delete [] old->second.mono;
+    mono_cache.erase(old);
+    mono_lru.pop_back();
+  }
+
+  if (mono_pss == NULL)
+  {
+    mono_pss = new PrecalcShapeset(space->get_shapeset()->clone());
+    mono_pss->set_quad_2d(&g_quad_2d_cheb);
+  }
+  AsmList al;
+  get_mono_assembly_list(space, e, &al);
+  MonoEntry entry;
+  entry.mono = new scalar[bytes / sizeof(scalar)];
+  entry.bytes = bytes;
+  calc_mono_coefs(e, o, mono_pss, &al, dof_coefs, first_dof, lift_coef, entry.mono);
+
+  mono_lru.push_front(e->id);
+  entry.lru = mono_lru.begin();
+  mono_cache[e->id] = entry;
+  mono_bytes += bytes;
+  return entry.mono;
+}
+
+
+void Solution::free_mono_cache()
+{
+  for (std::map<int, MonoEntry>::iterator it = mono_cache.begin(); it != mono_cache.end(); ++it)
+    delete [] it->second.mono;
+  mono_cache.clear();
+  mono_lru.clear();
+  mono_bytes = 0;
+}
+
+
+void Solution::free_mono_pss()
+{
+  if (mono_pss == NULL) return;
+  Shapeset* ss = mono_pss->get_shapeset();
+  delete mono_pss;
+  delete ss;
+  mono_pss = NULL;
+}
+
+
+void Solution::expand()
+{
+  if (space == NULL) return;
+  if (space->get_seq() != space_seq || !space->is_up_to_date() || Space::get_num_dofs(space) != num_dofs)
+    error("The space of a compact solution has changed.");
+
+  // the arrays made by set_coeff_vector()
+  Mesh* smesh = space->get_mesh();
+  num_elems = smesh->get_max_element_id();
+  elem_orders = new int[num_elems];
+  memset(elem_orders, 0, sizeof(int) * num_elems);
+  for (int l = 0; l < num_components; l++) {
+    elem_coefs[l] = new int[num_elems];
+    memset(elem_coefs[l], 0, sizeof(int) * num_elems);
+  }
+
+  Element* e;
+  num_coefs = 0;
+  for_all_active_elements(e, smesh)
+  {
+    int o = elem_orders[e->id] = calc_mono_order(space, e);
+    num_coefs += e->is_quad() ? sqr(o+1) : (o+1)*(o+2)/2;
+  }
+  num_coefs *= num_components;
+  mono_coefs = new scalar[num_coefs];
+
+  Shapeset* ss = space->get_shapeset()->clone();
+  PrecalcShapeset pss(ss);
+  pss.set_quad_2d(&g_quad_2d_cheb);
+  scalar* mono = mono_coefs;
+  AsmList al;
+  for_all_active_elements(e, smesh)
+  {
+    int o = elem_orders[e->id];
+    int np = e->is_quad() ? sqr(o+1) : (o+1)*(o+2)/2;
+    get_mono_assembly_list(space, e, &al);
+    calc_mono_coefs(e, o, &pss, &al, dof_coefs, first_dof, lift_coef, mono);
+    for (int l = 0; l < num_components; l++)
+      elem_coefs[l][e->id] = (int) (mono - mono_coefs) + l*np;
+    mono += num_components * np;
+  }
+  delete ss;
+
+  free_mono_cache();
+  if (dof_coefs != NULL) { delete [] dof_coefs;  dof_coefs = NULL; }
+  free_mono_pss();
+  space = NULL;
+  free_tables();
+}
+
+
+size_t Solution::get_memory_usage() const
+{
+  size_t mem = sizeof(Solution) + total_mem;
+  if (dxdy_buffer != NULL)
+    mem += sizeof(scalar) * num_components * 5 * sqr(11);
+  if (mono_coefs != NULL)
+    mem += sizeof(scalar) * num_coefs + sizeof(int) * num_elems * (num_components + 1);
+  if (space != NULL)
+    mem += sizeof(scalar) * (last_dof - first_dof + 1) + mono_bytes;
+  return mem;
+}
+
+
 //// set_exact etc. ////////////////////////////////////////////////////////////////////////////////
 
 void Solution::set_exact(Mesh* mesh, ExactFunction exactfn)
@@ -647,7 +883,14 @@ void Solution::enable_transform(bool enable)
 
 void Solution::multiply(scalar coef)
 {
-  if (type == HERMES_SLN)
+  if (type == HERMES_SLN && space != NULL)
+  {
+    for (int i = 0; i <= last_dof - first_dof; i++)
+      dof_coefs[i] *= coef;
+    lift_coef *= coef;
+    free_mono_cache();
+  }
+  else if (type == HERMES_SLN)
   {
     for (int i = 0; i < num_coefs; i++)
       mono_coefs[i] *= coef;
@@ -737,12 +980,27 @@ void Solution::set_active_element(Element* e)
 
   if (type == HERMES_SLN)
   {
-    int o = order = elem_orders[element->id];
+    int o = order = get_elem_order(e);
     int n = mode ? sqr(o+1) : (o+1)*(o+2)/2;
 
+    // a compact solution keeps the precalculated values of the other elements under the budget too
+    scalar* elem_mono = NULL;
+    if (space != NULL)
+    {
+      if (mono_bytes + total_mem > mem_budget)
+        for (int q = 0; q < 4; q++)
+          for (int j = 0; j < 4; j++)
+            if ((q != cur_quad || j != cur_elem) && tables[q][j] != NULL)
+            {
+              free_sub_tables(&(tables[q][j]));
+              elems[q][j] = NULL;
+            }
+      elem_mono = get_mono_coefs(e);
+    }
+
     for (int i = 0, m = 0; i < num_components; i++)
     {
-      scalar* mono = mono_coefs + elem_coefs[i][e->id];
+      scalar* mono = (space != NULL) ? elem_mono + i*n : mono_coefs + elem_coefs[i][e->id];
       dxdy_coefs[i][0] = mono;
 
       make_dx_coefs(mode, o, mono, dxdy_coefs[i][1] = dxdy_buffer+m);  m += n;
@@ -950,7 +1208,7 @@ void Solution::precalculate(int order, int mask)
     }
 
     // obtain the solution values, this is the core of the whole module
-    int o = elem_orders[element->id];
+    int o = get_elem_order(element);
     for (l = 0; l < num_components; l++)
     {
       for (k = 0; k < 6; k++)
@@ -1078,6 +1336,16 @@ void Solution::save(const char* filename, bool compress)
   if (type == HERMES_CONST)  error("Constant solution cannot be saved to a file.");
   if (type == HERMES_UNDEF) error("Cannot save -- uninitialized solution.");
 
+  // a compact solution is saved with the monomial coefficients of all elements
+  if (space != NULL)
+  {
+    Solution sln;
+    sln.copy(this);
+    sln.expand();
+    sln.save(filename, compress);
+    return;
+  }
+
   // open the stream
   std::string fname = filename;
   if (compress) fname += ".gz";
@@ -1229,7 +1497,7 @@ scalar Solution::get_ref_value(Element* e, double xi1, double xi2, int component
 {
   set_active_element(e);
 
-  int o = elem_orders[e->id];
+  int o = get_elem_order(e);
   scalar* mono = dxdy_coefs[component][item];
   scalar result = 0.0;
   int k = 0;
@@ -1373,3 +1641,278 @@ scalar Solution::get_pt_value(double x, double y, int item)
   return NAN;
 }
 
+
+
+//// SolutionEvaluator /////////////////////////////////////////////////////////////////////////////
+
+SolutionEvaluator::SolutionEvaluator(const Solution* sln)
+{
+  if (sln->type == Solution::HERMES_UNDEF)
+    error("Cannot create an evaluator of an uninitialized solution.");
+  this->sln = sln;
+  mode = H2D_MODE_TRIANGLE;
+  order = 0;
+  dxdy_buffer = new scalar[sln->num_components * 5 * sqr(11)];
+  values = NULL;
+  values_size = 0;
+  e_last = NULL;
+
+  pss = NULL;
+  mono_buffer = NULL;
+  if (sln->space != NULL)
+  {
+    // a private shapeset and quadrature, so that several evaluators can run in parallel
+    pss = new PrecalcShapeset(sln->space->get_shapeset()->clone());
+    pss->set_quad_2d(new Quad2DCheb(g_quad_2d_cheb));
+    mono_buffer = new scalar[sln->num_components * sqr(11)];
+  }
+}
+
+
+SolutionEvaluator::~SolutionEvaluator()
+{
+  delete [] dxdy_buffer;
+  if (values != NULL) delete [] values;
+  if (pss != NULL)
+  {
+    Shapeset* ss = pss->get_shapeset();
+    Quad2DCheb* quad = static_cast<Quad2DCheb*>(pss->get_quad_2d());
+    delete pss;
+    delete ss;
+    delete quad;
+  }
+  if (mono_buffer != NULL) delete [] mono_buffer;
+}
+
+
+void SolutionEvaluator::set_active_element(Element* e)
+{
+  if (!e->active) error("Cannot select inactive element. Wrong mesh?");
+  Transformable::set_active_element(e);
+  reset_transform();
+
+  mode = e->get_mode();
+  if (sln->type == Solution::HERMES_SLN)
+  {
+    int o = order = sln->get_elem_order(e);
+    int n = mode ? sqr(o+1) : (o+1)*(o+2)/2;
+
+    if (sln->space != NULL)
+    {
+      AsmList al;
+      get_mono_assembly_list(sln->space, e, &al);
+      Solution::calc_mono_coefs(e, o, pss, &al, sln->dof_coefs, sln->first_dof, sln->lift_coef, mono_buffer);
+    }
+
+    for (int i = 0, m = 0; i < sln->num_components; i++)
+    {
+      scalar* mono = (sln->space != NULL) ? mono_buffer + i*n : sln->mono_coefs + sln->elem_coefs[i][e->id];
+      dxdy_coefs[i][0] = mono;
+
+      make_dx_coefs(mode, o, mono, dxdy_coefs[i][1] = dxdy_buffer+m);  m += n;
+      make_dy_coefs(mode, o, mono, dxdy_coefs[i][2] = dxdy_buffer+m);  m += n;
+      make_dx_coefs(mode, o, dxdy_coefs[i][1], dxdy_coefs[i][3] = dxdy_buffer+m);  m += n;
+      make_dy_coefs(mode, o, dxdy_coefs[i][2], dxdy_coefs[i][4] = dxdy_buffer+m);  m += n;
+      make_dx_coefs(mode, o, dxdy_coefs[i][2], dxdy_coefs[i][5] = dxdy_buffer+m);  m += n;
+    }
+  }
+  else
+    order = (sln->type == Solution::HERMES_EXACT) ? 20 : 0;
+
+  // the reference map is private and the quadrature is accessed without setting its mode,
+  // so other threads are not affected
+  rm.set_active_element(e);
+}
+
+
+void SolutionEvaluator::untransform(double x, double y, double& xi1, double& xi2)
+{
+  // Newton method, exact after one step for affine elements
+  const double TOL = 1e-12;
+  double xi1_old = 0.0, xi2_old = 0.0;
+  double vx, vy;
+  double2x2 m;
+  for (int it = 0; ; it++)
+  {
+    ref_map(xi1_old, xi2_old, vx, vy, m);
+    xi1 = xi1_old - (m[0][0] * (vx - x) + m[1][0] * (vy - y));
+    xi2 = xi2_old - (m[0][1] * (vx - x) + m[1][1] * (vy - y));
+    if (fabs(xi1 - xi1_old) < TOL && fabs(xi2 - xi2_old) < TOL) return;
+    if (it > 1 && (xi1 > 1.5 || xi2 > 1.5 || xi1 < -1.5 || xi2 < -1.5)) return;
+    if (it > 100) { warn("Could not find reference coordinates - Newton method did not converge."); return; }
+    xi1_old = xi1;
+    xi2_old = xi2;
+  }
+}
+
+
+scalar SolutionEvaluator::eval(int a, int b, double xi1, double xi2)
+{
+  if (sln->type == Solution::HERMES_CONST)
+    return b ? 0.0 : sln->cnst[a];
+
+  if (sln->type == Solution::HERMES_EXACT)
+  {
+    double x, y;
+    double2x2 m;
+    ref_map(xi1, xi2, x, y, m);
+    if (b > 2) error("Cannot obtain second derivatives of an exact solution.");
+    if (sln->num_components == 1)
+    {
+      scalar val, dx = 0.0, dy = 0.0;
+      val = sln->exactfn1(x, y, dx, dy);
+      return sln->exact_mult * (b == 0 ? val : b == 1 ? dx : dy);
+    }
+    scalar2 dx = { 0.0, 0.0 }, dy = { 0.0, 0.0 };
+    scalar2& val = sln->exactfn2(x, y, dx, dy);
+    return sln->exact_mult * (b == 0 ? val[a] : b == 1 ? dx[a] : dy[a]);
+  }
+
+  scalar result = eval_mono(a, b, xi1, xi2);
+  if (!sln->transform) return result;
+
+  // transform the gradient or the vector solution as Solution::transform_values() does
+  double x, y;
+  double2x2 m;
+  if (sln->num_components == 1)
+  {
+    if (b == 0) return result;
+    if (b > 2) error("Second derivatives are not supported by SolutionEvaluator.");
+    ref_map(xi1, xi2, x, y, m);
+    scalar dx = (b == 1) ? result : eval_mono(a, 1, xi1, xi2);
+    scalar dy = (b == 2) ? result : eval_mono(a, 2, xi1, xi2);
+    return (b == 1) ? m[0][0]*dx + m[0][1]*dy : m[1][0]*dx + m[1][1]*dy;
+  }
+
+  if (b == 0)
+  {
+    ref_map(xi1, xi2, x, y, m);
+    scalar vx = (a == 0) ? result : eval_mono(0, 0, xi1, xi2);
+    scalar vy = (a == 1) ? result : eval_mono(1, 0, xi1, xi2);
+    if (sln->space_type == 2) // Hdiv
+      return (a == 0) ? m[1][1]*vx - m[1][0]*vy : - m[0][1]*vx + m[0][0]*vy;
+    return (a == 0) ? m[0][0]*vx + m[0][1]*vy : m[1][0]*vx + m[1][1]*vy;
+  }
+  if (sln->space_type == 1 && ((a == 1 && b == 1) || (a == 0 && b == 2))) // Hcurl curl
+  {
+    ref_map(xi1, xi2, x, y, m);
+    scalar e0x = eval_mono(0, 1, xi1, xi2), e0y = eval_mono(0, 2, xi1, xi2);
+    scalar e1x = eval_mono(1, 1, xi1, xi2), e1y = eval_mono(1, 2, xi1, xi2);
+    if (a == 1) return m[0][0]*(m[1][0]*e0x + m[1][1]*e1x) + m[0][1]*(m[1][0]*e0y + m[1][1]*e1y);
+    return m[1][0]*(m[0][0]*e0x + m[0][1]*e1x) + m[1][1]*(m[0][0]*e0y + m[0][1]*e1y);
+  }
+  return result;
+}
+
+
+scalar SolutionEvaluator::eval_mono(int a, int b, double xi1, double xi2)
+{
+  // Horner's scheme in the reference domain
+  const scalar* mono = dxdy_coefs[a][b];
+  scalar result = 0.0;
+  int k = 0;
+  for (int i = 0; i <= order; i++)
+  {
+    scalar row = mono[k++];
+    for (int j = 0; j < (mode ? order : i); j++)
+      row = row * xi1 + mono[k++];
+    result = result * xi2 + row;
+  }
+  return result;
+}
+
+
+// decodes H2D_FN_VAL_0, H2D_FN_DX_0, ... into the component 'a' and the item 'b'
+static void decode_item(int num_components, int item, int& a, int& b)
+{
+  int mask = item;
+  a = b = 0;
+  if (num_components == 1) mask = mask & H2D_FN_COMPONENT_0;
+  if (mask == 0 || (mask & (mask - 1)) != 0) error("'item' is invalid. ");
+  if (mask >= 0x40) { a = 1; mask >>= 6; }
+  while (!(mask & 1)) { mask >>= 1; b++; }
+}
+
+
+scalar* SolutionEvaluator::get_values(int order, int item)
+{
+  if (element == NULL) error("No active element.");
+  Quad2D* quad = &g_quad_2d_std;
+  if (order < 0 || order >= quad->get_num_tables(mode)) error("Invalid quadrature order (%d).", order);
+
+  int a, b;
+  decode_item(sln->num_components, item, a, b);
+
+  int np = quad->get_num_points(order, mode);
+  if (np > values_size)
+  {
+    if (values != NULL) delete [] values;
+    values = new scalar[values_size = np];
+  }
+
+  double3* pt = quad->get_points(order, mode);
+  for (int i = 0; i < np; i++)
+    values[i] = eval(a, b, pt[i][0] * ctm->m[0] + ctm->t[0], pt[i][1] * ctm->m[1] + ctm->t[1]);
+  return values;
+}
+
+
+scalar SolutionEvaluator::get_ref_value(double xi1, double xi2, int item)
+{
+  if (element == NULL) error("No active element.");
+  int a, b;
+  decode_item(sln->num_components, item, a, b);
+  return eval(a, b, xi1 * ctm->m[0] + ctm->t[0], xi2 * ctm->m[1] + ctm->t[1]);
+}
+
+
+void SolutionEvaluator::get_phys_point(double xi1, double xi2, double& x, double& y)
+{
+  if (element == NULL) error("No active element.");
+  rm.get_phys_point(xi1 * ctm->m[0] + ctm->t[0], xi2 * ctm->m[1] + ctm->t[1], x, y);
+}
+
+
+scalar SolutionEvaluator::get_pt_value(double x, double y, int item)
+{
+  int a, b;
+  decode_item(sln->num_components, item, a, b);
+  double xi1, xi2;
+
+  // try the last element found and its neighbours
+  if (e_last != NULL)
+  {
+    Element* elem[5];
+    elem[0] = e_last;
+    for (unsigned int i = 1; i <= e_last->nvert; i++)
+      elem[i] = e_last->get_neighbor(i-1);
+
+    for (unsigned int i = 0; i <= e_last->nvert; i++)
+      if (elem[i] != NULL && elem[i]->active)
+      {
+        set_active_element(elem[i]);
+        untransform(x, y, xi1, xi2);
+        if (is_in_ref_domain(elem[i], xi1, xi2))
+        {
+          e_last = elem[i];
+          return eval(a, b, xi1, xi2);
+        }
+      }
+  }
+
+  // go through all elements
+  Element* e;
+  for_all_active_elements(e, sln->mesh)
+  {
+    set_active_element(e);
+    untransform(x, y, xi1, xi2);
+    if (is_in_ref_domain(e, xi1, xi2))
+    {
+      e_last = e;
+      return eval(a, b, xi1, xi2);
+    }
+  }
+
+  warn("Point (%g, %g) does not lie in any element.", x, y);
+  return NAN;
+}
@@ -19,7 +19,9 @@
 #include "function.h"
 #include "space/space.h"
 #include "refmap.h"
+#include "shapeset/shapeset_h1_all.h"
 #include "../../hermes_common/matrix.h"
+#include <list>
 
 class PrecalcShapeset;
 
@@ -101,6 +103,7 @@ public:
   Solution& operator = (Solution& sln) { assign(&sln); return *this; }
   void copy(const Solution* sln);
 
+  /// Returns the orders of the elements, NULL for a compact solution (see set_memory_budget()).
   int* get_element_orders() { return this->elem_orders;}
 
   void set_exact(Mesh* mesh, ExactFunction exactfn);
@@ -164,6 +167,29 @@ public:
   /// Returns the solution type.
   int get_type() const { return type; };
 
+  /// Makes the solution compact: the following set_coeff_vector() (or vector_to_solution())
+  /// keeps only the coefficients of the DOFs and a pointer to the space, whose assembly lists
+  /// are used instead of the monomial coefficients of all elements. The monomial coefficients
+  /// of an element are calculated when the element is selected. They are kept, together with
+  /// the precalculated values, while they take at most 'bytes' bytes, the least recently used
+  /// elements are dropped first. Zero (the default) stores the monomial coefficients of all
+  /// elements. The space must not be changed or deleted while a compact solution is used
+  /// (copy() makes a standard solution, which does not need the space).
+  ///
+  /// A compact solution saves the difference between the monomial coefficients, (p+1)^2 per
+  /// quad at the highest order of the element and its edges, and the DOFs, about p^2 per quad
+  /// on a fine mesh. That is about 70 % at p = 1 and 60 % at p = 2, but 25-30 % at p = 6..8,
+  /// and less on coarse meshes, where the DOF vector and the budget dominate. Every dropped
+  /// element costs a calculation from the assembly list when it is selected again (a norm
+  /// takes about twice as long at p = 6). The compact mode therefore suits many solutions of
+  /// one space which are seldom evaluated, e.g. the previous time levels, rather than
+  /// a reference solution evaluated in every adaptivity step.
+  void set_memory_budget(size_t bytes) { mem_budget = bytes; }
+
+  /// Returns the number of bytes held by the solution: the coefficients, the element
+  /// tables and the precalculated values (not the mesh or the space).
+  size_t get_memory_usage() const;
+
 
 public:
   /// Internal.
@@ -201,6 +227,35 @@ protected:
   int num_coefs, num_elems;
   int num_dofs;
 
+  // compact solution (see set_memory_budget())
+  size_t mem_budget;
+  Space* space;        ///< the space of a compact solution, NULL if the solution is not compact
+  int space_seq;
+  scalar* dof_coefs;   ///< coefficients of the DOFs first_dof to last_dof
+  int first_dof, last_dof;
+  scalar lift_coef;    ///< multiplier of the Dirichlet lift
+  PrecalcShapeset* mono_pss;  ///< precalculated shapeset on a copy of the shapeset of the space
+  struct MonoEntry
+  {
+    scalar* mono;
+    size_t bytes;
+    std::list<int>::iterator lru;
+  };
+  std::map<int, MonoEntry> mono_cache;  ///< monomial coefficients of the elements, by element id
+  std::list<int> mono_lru;              ///< ids of the elements in mono_cache, the last used first
+  size_t mono_bytes;
+
+  /// Returns the monomial coefficients of all components of a compact solution on 'e',
+  /// calculating them if they are not cached.
+  scalar* get_mono_coefs(Element* e);
+  void free_mono_cache();
+  /// Deletes mono_pss and its copy of the shapeset.
+  void free_mono_pss();
+  /// Replaces the space of a compact solution by the monomial coefficients of all elements.
+  void expand();
+
+  int get_elem_order(Element* e) const { return (space != NULL) ? calc_mono_order(space, e) : elem_orders[e->id]; }
+
   int space_type;
   void transform_values(int order, Node* node, int newmask, int oldmask, int np);
 
@@ -214,12 +269,21 @@ protected:
   scalar* dxdy_coefs[2][6];
   scalar* dxdy_buffer;
 
-  double** calc_mono_matrix(int o, int*& perm);
+  static double** calc_mono_matrix(int mode, int o, int*& perm);
+  /// Returns the order of the monomials on the element: the maximum of the orders of the
+  /// element and its edges (one higher for Hcurl).
+  static int calc_mono_order(Space* space, Element* e);
+  /// Calculates the monomial coefficients of all components on the element 'e' of the order
+  /// 'o' from its assembly list and the coefficients of the DOFs, which are indexed from
+  /// 'first_dof'. The coefficients are stored one component after another.
+  static void calc_mono_coefs(Element* e, int o, PrecalcShapeset* pss, AsmList* al,
+                              scalar* coeffs, int first_dof, scalar lift_coef, scalar* mono);
   void init_dxdy_buffer();
   void free_tables();
 
   Element* e_last; ///< last visited element when getting solution values at specific points
 
+  friend class SolutionEvaluator;
 };
 
 
@@ -252,4 +316,94 @@ public:
 
 
 
+
+/// \brief Read-only evaluation handle for a Solution, usable from several threads.
+///
+/// Solution (like every Function) changes its internal state when it is evaluated: the
+/// active element, the transformation stack, the tables cached for the last four elements,
+/// and also the global reference map and quadrature used by RefMap and PrecalcShapeset.
+/// A single Solution therefore cannot be evaluated by several threads at once.
+///
+/// SolutionEvaluator shares the coefficients of the solution, which are never modified
+/// by the evaluation, and holds its own active element, transformation, reference map
+/// and scratch tables. It does not modify any global tables, so any number of
+/// evaluators of the same Solution can be used concurrently, one per thread. Creating an
+/// evaluator is cheap (no coefficients are copied). The solution and its mesh must not
+/// be changed (e.g. by multiply() or a new coefficient vector) while the evaluators exist.
+/// The evaluators of a compact solution (see Solution::set_memory_budget()) calculate the
+/// monomial coefficients of each element again from the space, with their own copy of the
+/// shapeset and its quadrature, so they can be used concurrently as well.
+///
+/// \code
+///   #pragma omp parallel
+///   {
+///     SolutionEvaluator ev(&sln);
+///     #pragma omp for
+///     for (int i = 0; i < n; i++)
+///       val[i] = ev.get_pt_value(x[i], y[i]);
+///   }
+/// \endcode
+///
+class HERMES_API SolutionEvaluator : public Transformable
+{
+public:
+
+  SolutionEvaluator(const Solution* sln);
+  virtual ~SolutionEvaluator();
+
+  const Solution* get_solution() const { return sln; }
+
+  /// Selects the element on which the solution is evaluated and resets the transformation.
+  virtual void set_active_element(Element* e);
+
+  /// Returns the polynomial degree of the solution on the active element.
+  int get_fn_order() const { return order; }
+
+  /// Returns the values of 'item' (H2D_FN_VAL_0, H2D_FN_DX_0, ...) in the integration
+  /// points of the given order (g_quad_2d_std) on the active element, transformed to the current
+  /// sub-element by push_transform(). The table belongs to the evaluator and is valid
+  /// until the next call.
+  scalar* get_values(int order, int item = H2D_FN_VAL_0);
+
+  /// Returns the value of 'item' at the point (xi1, xi2) of the reference domain of the
+  /// current sub-element.
+  scalar get_ref_value(double xi1, double xi2, int item = H2D_FN_VAL_0);
+
+  /// Returns the value of 'item' at the physical point (x, y). The element containing
+  /// the point is searched for starting with the last one found by this evaluator.
+  scalar get_pt_value(double x, double y, int item = H2D_FN_VAL_0);
+
+  /// Returns the physical coordinates of the point (xi1, xi2) of the reference domain of
+  /// the current sub-element.
+  void get_phys_point(double xi1, double xi2, double& x, double& y);
+
+protected:
+
+  const Solution* sln;
+  int mode, order;
+
+  scalar* dxdy_coefs[2][6];
+  scalar* dxdy_buffer;
+  scalar* values;
+  int values_size;
+
+  PrecalcShapeset* pss;  ///< copy of the shapeset of a compact solution, with its own quadrature
+  scalar* mono_buffer;   ///< monomial coefficients of the active element of a compact solution
+
+  PointRefMap rm; ///< reference map of the active element
+
+  Element* e_last; ///< last element found by get_pt_value()
+
+  /// Evaluates the item 'b' of the component 'a' at a point of the reference domain of the element.
+  scalar eval(int a, int b, double xi1, double xi2);
+  /// Evaluates the polynomial of the item 'b' of the component 'a' without any transformation.
+  scalar eval_mono(int a, int b, double xi1, double xi2);
+  /// Returns the physical point and the inverse of the reference map at a reference point.
+  void ref_map(double xi1, double xi2, double& x, double& y, double2x2& m)
+    { rm.get_inv_ref_map(xi1, xi2, x, y, m); }
+  /// Finds the reference coordinates of the physical point (x, y) in the active element.
+  void untransform(double x, double y, double& xi1, double& xi2);
+};
+
+
 #endif
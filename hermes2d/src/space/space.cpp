@@ -34,6 +34,9 @@ Space::Space(Mesh* mesh, Shapeset* shapeset, BCType (*bc_type_callback)(int),
   this->seq = 0;
   this->was_assigned = false;
   this->ndof = 0;
+  this->dof_ordering = HERMES_DOF_NATURAL;
+  this->interleave_dofs = false;
+  this->dof_perm = NULL;
 
   this->set_bc_types_init(bc_type_callback);
   this->set_essential_bc_values(bc_value_callback_by_coord);
@@ -51,6 +54,7 @@ void Space::free()
 {
   _F_
   free_extra_data();
+  free_dof_ordering();
   if (nsize) { ::free(ndata); ndata=NULL; }
   if (esize) { ::free(edata); edata=NULL; }
 }
@@ -377,6 +381,8 @@ int Space::assign_dofs(int first_dof, int stride)
   was_assigned = true;
   this->ndof = (next_dof - first_dof) / stride;
 
+  calc_dof_ordering();
+
   return this->ndof;
 }
 
@@ -439,6 +445,7 @@ void Space::get_element_assembly_list(Element* e, AsmList* al)
   for (unsigned int i = 0; i < e->nvert; i++)
     get_boundary_assembly_list_internal(e, i, al);
   get_bubble_assembly_list(e, al);
+  apply_dof_ordering(al);
 }
 
 
@@ -450,6 +457,7 @@ void Space::get_boundary_assembly_list(Element* e, int surf_num, AsmList* al)
   get_vertex_assembly_list(e, surf_num, al);
   get_vertex_assembly_list(e, e->next_vert(surf_num), al);
   get_boundary_assembly_list_internal(e, surf_num, al);
+  apply_dof_ordering(al);
 }
 
 
@@ -663,7 +671,7 @@ int Space::get_num_dofs(Tuple<Space *> spaces)
   return ndof;
 }
 
-// This is identical to H3D.
+// This is identical to H3D, except for the interleaved DOF ordering.
 int Space::assign_dofs(Tuple<Space*> spaces) 
 {
   _F_
@@ -674,6 +682,13 @@ int Space::assign_dofs(Tuple<Space*> spaces)
     ndof += spaces[i]->assign_dofs(ndof);
   }
 
+  // merging the fields into one interleaved ordering if all spaces ask for it
+  bool interleave = (n > 1);
+  for (int i = 0; i < n; i++)
+    if (!spaces[i]->interleave_dofs) interleave = false;
+  if (interleave)
+    interleave_dof_ordering(spaces, ndof);
+
   return ndof;
 }
 
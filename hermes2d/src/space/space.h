@@ -33,6 +33,14 @@ enum BCType
                 ///< integrals on this part of the boundary.
 };
 
+// Possible DOF renumbering strategies (see Space::set_dof_ordering()):
+enum DofOrdering
+{
+  HERMES_DOF_NATURAL, ///< Element traversal order, DOFs numbered as encountered (default).
+  HERMES_DOF_RCM,     ///< Reverse Cuthill-McKee, reduces the matrix bandwidth (SpMV, iterative solvers).
+  HERMES_DOF_ND       ///< Nested-dissection-like bisection ordering, reduces fill-in in direct solvers.
+};
+
 
 /// \brief Represents a finite element space over a domain.
 ///
@@ -157,6 +165,21 @@ public:
   /// \return The number of basis functions contained in the space.
   virtual int assign_dofs(int first_dof = 0, int stride = 1);
 
+  /// \brief Sets the DOF renumbering strategy.
+  /// \details The ordering is applied on top of the DOF assignment each time assign_dofs()
+  /// is called; the renumbered DOFs are what get_element_assembly_list() returns, so the
+  /// assembling, Solution::vector_to_solution() and OGProjection see them consistently.
+  /// \param ordering [in] The renumbering strategy for the DOFs of this space.
+  /// \param interleave [in] If true for all spaces passed to assign_dofs(Tuple<Space*>),
+  /// the DOFs of the individual fields are merged into one field-interleaved ordering. The
+  /// natural ordering alternates the fields, the other orderings are calculated on the joint
+  /// DOF graph of all fields with the ordering of the first space.
+  void set_dof_ordering(DofOrdering ordering, bool interleave = false);
+  /// \brief Returns the current DOF renumbering strategy.
+  DofOrdering get_dof_ordering() const { return dof_ordering; }
+  /// \brief Returns true if the DOFs of this space are interleaved with other fields.
+  bool get_dof_interleaving() const { return interleave_dofs; }
+
   /// \brief Returns the number of basis functions contained in the space.
   int get_num_dofs() { return ndof; }
   /// \brief Returns the DOF number of the last basis function.
@@ -212,6 +235,25 @@ protected:
   int seq, mesh_seq;
   bool was_assigned;
 
+  DofOrdering dof_ordering;
+  bool interleave_dofs;
+  int* dof_perm; ///< New DOF numbers indexed by (dof - first_dof) / stride, NULL for the natural ordering.
+
+  /// Calculates 'dof_perm' according to 'dof_ordering'. Called at the end of assign_dofs().
+  void calc_dof_ordering();
+  void free_dof_ordering();
+  /// Merges the DOFs of all spaces into a field-interleaved ordering. Called by assign_dofs(Tuple<Space*>).
+  static void interleave_dof_ordering(Tuple<Space*> spaces, int ndof);
+
+  /// Renumbers the DOFs of the assembly list, starting at the item 'start'.
+  void apply_dof_ordering(AsmList* al, int start = 0) const
+  {
+    if (dof_perm == NULL) return;
+    for (int i = start; i < al->cnt; i++)
+      if (al->dof[i] >= 0)
+        al->dof[i] = dof_perm[(al->dof[i] - first_dof) / stride];
+  }
+
   struct BaseComponent
   {
     int dof;
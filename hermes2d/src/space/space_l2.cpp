@@ -117,6 +117,7 @@ void L2Space::get_element_assembly_list(Element* e, AsmList* al)
   al->clear();
   shapeset->set_mode(e->get_mode());
   get_bubble_assembly_list(e, al);
+  apply_dof_ordering(al);
 }
 
 void L2Space::get_bubble_assembly_list(Element* e, AsmList* al)
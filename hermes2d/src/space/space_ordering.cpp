@@ -0,0 +1,423 @@
+// This file is part of Hermes2D.
+//
+// Hermes2D is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Hermes2D is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Hermes2D.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "../h2d_common.h"
+#include "space.h"
+#include <algorithm>
+#include <vector>
+
+// Renumbering of DOFs. The DOFs are first assigned in the element traversal order
+// by assign_dofs(), then the DOF adjacency graph (two DOFs are adjacent if they share
+// an element) is built from the assembly lists and reordered. The result is stored
+// as a permutation which is applied to every assembly list the space hands out.
+
+/// Subgraphs smaller than this are not bisected any further by the ND ordering.
+static const int H2D_ND_LEAF_SIZE = 64;
+
+
+//// graph algorithms //////////////////////////////////////////////////////////////////////////////
+
+// Breadth-first search from 'root' restricted to the vertices with part[v] == pid.
+// The visited vertices are stored in 'queue' in the BFS order, 'level' receives their
+// distance from the root (it must be -1 for unvisited vertices on entry). If 'sorted'
+// is true, the neighbors are visited by increasing degree (Cuthill-McKee).
+static int bfs_levels(int root, const int* xadj, const int* adj, const int* part, int pid,
+                      int* level, int* queue, bool sorted)
+{
+  int head = 0, tail = 0;
+  level[root] = 0;
+  queue[tail++] = root;
+  while (head < tail)
+  {
+    int v = queue[head++];
+    int first = tail;
+    for (int i = xadj[v]; i < xadj[v+1]; i++)
+    {
+      int w = adj[i];
+      if (part[w] != pid || level[w] >= 0) continue;
+      level[w] = level[v] + 1;
+      queue[tail++] = w;
+    }
+    if (sorted)
+    {
+      // insertion sort by degree, the neighbor lists are short
+      for (int i = first + 1; i < tail; i++)
+      {
+        int w = queue[i], dw = xadj[w+1] - xadj[w], j = i;
+        while (j > first && xadj[queue[j-1]+1] - xadj[queue[j-1]] > dw)
+        {
+          queue[j] = queue[j-1];
+          j--;
+        }
+        queue[j] = w;
+      }
+    }
+  }
+  return tail;
+}
+
+static void reset_levels(int* level, const int* queue, int n)
+{
+  for (int i = 0; i < n; i++)
+    level[queue[i]] = -1;
+}
+
+// Finds a pseudo-peripheral vertex of the component containing 'start' (George & Liu).
+static int pseudo_peripheral_vertex(int start, const int* xadj, const int* adj, const int* part, int pid,
+                                    int* level, int* queue)
+{
+  int root = start, ecc = -1;
+  while (true)
+  {
+    int cnt = bfs_levels(root, xadj, adj, part, pid, level, queue, false);
+    int depth = level[queue[cnt-1]];
+
+    // the last level vertex of the minimum degree
+    int best = queue[cnt-1], best_deg = xadj[best+1] - xadj[best];
+    for (int i = cnt-1; i >= 0 && level[queue[i]] == depth; i--)
+    {
+      int v = queue[i], deg = xadj[v+1] - xadj[v];
+      if (deg < best_deg) { best = v; best_deg = deg; }
+    }
+    reset_levels(level, queue, cnt);
+
+    if (depth <= ecc) return root;
+    ecc = depth;
+    root = best;
+  }
+}
+
+// Appends the reverse Cuthill-McKee ordering of the vertices 'verts[0..n-1]' (all of which
+// have part[v] == pid) to 'order'.
+static void rcm_ordering(const int* verts, int n, const int* xadj, const int* adj, int* part, int pid,
+                         int* level, int* queue, int* order)
+{
+  int pos = 0;
+  for (int i = 0; i < n; i++)
+  {
+    int v = verts[i];
+    if (part[v] != pid) continue; // already numbered (different component)
+    int root = pseudo_peripheral_vertex(v, xadj, adj, part, pid, level, queue);
+    int cnt = bfs_levels(root, xadj, adj, part, pid, level, queue, true);
+    for (int j = 0; j < cnt; j++)
+    {
+      order[pos + j] = queue[j];
+      part[queue[j]] = -1;
+    }
+    reset_levels(level, queue, cnt);
+    pos += cnt;
+  }
+  std::reverse(order, order + n);
+}
+
+// Appends the nested dissection ordering of 'verts[0..n-1]' to 'order'. The subgraph is
+// bisected by the middle BFS level from a pseudo-peripheral vertex; the two halves are
+// numbered recursively and the separator last.
+static void nd_ordering(int* verts, int n, const int* xadj, const int* adj, int* part, int pid, int& next_pid,
+                        int* level, int* queue, int* order)
+{
+  if (n <= H2D_ND_LEAF_SIZE)
+  {
+    rcm_ordering(verts, n, xadj, adj, part, pid, level, queue, order);
+    return;
+  }
+
+  int root = pseudo_peripheral_vertex(verts[0], xadj, adj, part, pid, level, queue);
+  int cnt = bfs_levels(root, xadj, adj, part, pid, level, queue, false);
+  int depth = level[queue[cnt-1]];
+
+  if (cnt < n)
+  {
+    // disconnected subgraph: the components are numbered one after another
+    reset_levels(level, queue, cnt);
+    std::vector<int> comp_verts, comp_size, comp_pid;
+    comp_verts.reserve(n);
+    for (int i = 0; i < n; i++)
+    {
+      int v = verts[i];
+      if (part[v] != pid) continue;
+      int c = bfs_levels(v, xadj, adj, part, pid, level, queue, false);
+      int cpid = next_pid++;
+      for (int j = 0; j < c; j++)
+      {
+        part[queue[j]] = cpid;
+        comp_verts.push_back(queue[j]);
+      }
+      reset_levels(level, queue, c);
+      comp_size.push_back(c);
+      comp_pid.push_back(cpid);
+    }
+    std::copy(comp_verts.begin(), comp_verts.end(), verts);
+    for (unsigned int i = 0, pos = 0; i < comp_size.size(); pos += comp_size[i++])
+      nd_ordering(verts + pos, comp_size[i], xadj, adj, part, comp_pid[i], next_pid, level, queue, order + pos);
+    return;
+  }
+
+  if (depth < 2)
+  {
+    // too dense to be bisected
+    reset_levels(level, queue, cnt);
+    rcm_ordering(verts, n, xadj, adj, part, pid, level, queue, order);
+    return;
+  }
+
+  // split into the levels below the separator, above it and the separator itself
+  int pa = next_pid++, pb = next_pid++;
+  int sep = depth / 2, na = 0, nb = 0, ns = 0;
+  for (int i = 0; i < cnt; i++)
+  {
+    int v = queue[i];
+    if (level[v] < sep) verts[na++] = v;
+  }
+  for (int i = 0; i < cnt; i++)
+  {
+    int v = queue[i];
+    if (level[v] > sep) verts[na + nb++] = v;
+  }
+  for (int i = 0; i < cnt; i++)
+  {
+    int v = queue[i];
+    if (level[v] == sep) verts[na + nb + ns++] = v;
+  }
+  reset_levels(level, queue, cnt);
+
+  for (int i = 0; i < na; i++) part[verts[i]] = pa;
+  for (int i = na; i < na + nb; i++) part[verts[i]] = pb;
+
+  nd_ordering(verts, na, xadj, adj, part, pa, next_pid, level, queue, order);
+  nd_ordering(verts + na, nb, xadj, adj, part, pb, next_pid, level, queue, order + na);
+  for (int i = 0; i < ns; i++)
+  {
+    order[na + nb + i] = verts[na + nb + i];
+    part[verts[na + nb + i]] = -1;
+  }
+}
+
+
+// Orders the vertices of the graph given by the neighbor lists 'nbrs' (which are released)
+// by 'ordering': order[i] receives the vertex placed at the position i.
+static void order_graph(std::vector< std::vector<int> >& nbrs, DofOrdering ordering, int* order)
+{
+  int n = nbrs.size();
+  int* xadj = new int[n + 1];
+  xadj[0] = 0;
+  for (int i = 0; i < n; i++)
+  {
+    std::sort(nbrs[i].begin(), nbrs[i].end());
+    nbrs[i].erase(std::unique(nbrs[i].begin(), nbrs[i].end()), nbrs[i].end());
+    xadj[i+1] = xadj[i] + nbrs[i].size();
+  }
+  int* adj = new int[xadj[n] + 1];
+  for (int i = 0; i < n; i++)
+  {
+    std::copy(nbrs[i].begin(), nbrs[i].end(), adj + xadj[i]);
+    std::vector<int>().swap(nbrs[i]);
+  }
+
+  int* verts = new int[n];
+  int* part  = new int[n];
+  int* level = new int[n];
+  int* queue = new int[n];
+  for (int i = 0; i < n; i++)
+  {
+    verts[i] = i;
+    part[i] = 0;
+    level[i] = -1;
+  }
+
+  if (ordering == HERMES_DOF_RCM)
+    rcm_ordering(verts, n, xadj, adj, part, 0, level, queue, order);
+  else if (ordering == HERMES_DOF_ND)
+  {
+    int next_pid = 1;
+    nd_ordering(verts, n, xadj, adj, part, 0, next_pid, level, queue, order);
+  }
+  else
+    error("Unknown DOF ordering (%d).", ordering);
+
+  delete [] queue;
+  delete [] level;
+  delete [] part;
+  delete [] verts;
+  delete [] adj;
+  delete [] xadj;
+}
+
+// Adds the edges of the clique of the vertices 'v' to the neighbor lists.
+static void add_clique(std::vector< std::vector<int> >& nbrs, const std::vector<int>& v)
+{
+  for (unsigned int i = 0; i < v.size(); i++)
+    for (unsigned int j = 0; j < v.size(); j++)
+      if (v[i] != v[j])
+        nbrs[v[i]].push_back(v[j]);
+}
+
+
+//// Space /////////////////////////////////////////////////////////////////////////////////////////
+
+void Space::set_dof_ordering(DofOrdering ordering, bool interleave)
+{
+  _F_
+  this->dof_ordering = ordering;
+  this->interleave_dofs = interleave;
+  seq++;
+
+  // since space changed, enumerate basis functions
+  this->assign_dofs();
+}
+
+
+void Space::free_dof_ordering()
+{
+  _F_
+  delete [] dof_perm;
+  dof_perm = NULL;
+}
+
+
+void Space::calc_dof_ordering()
+{
+  _F_
+  free_dof_ordering();
+  if (dof_ordering == HERMES_DOF_NATURAL || ndof <= 0) return;
+
+  // build the DOF adjacency graph from the (natural) assembly lists
+  std::vector< std::vector<int> > nbrs(ndof);
+  std::vector<int> v;
+  AsmList al;
+  Element* e;
+  for_all_active_elements(e, mesh)
+  {
+    get_element_assembly_list(e, &al);
+    v.clear();
+    for (int i = 0; i < al.cnt; i++)
+      if (al.dof[i] >= 0)
+        v.push_back((al.dof[i] - first_dof) / stride);
+    add_clique(nbrs, v);
+  }
+
+  int* order = new int[ndof];
+  order_graph(nbrs, dof_ordering, order);
+  dof_perm = new int[ndof];
+  for (int i = 0; i < ndof; i++)
+    dof_perm[order[i]] = first_dof + i * stride;
+  delete [] order;
+}
+
+
+// Interleaving of fields. With the natural ordering, each DOF gets a key equal to its
+// relative position within its own space and the DOFs of all spaces are merged by this
+// key; for spaces of the same dimension this yields u0 v0 u1 v1 ..., otherwise the ratio
+// is kept locally. The other orderings are calculated on the joint graph of the DOFs of
+// all spaces, as they appear in the matrix of the coupled system.
+struct InterleavedDof
+{
+  double key;
+  int space, k;
+  bool operator<(const InterleavedDof& other) const
+  {
+    if (key != other.key) return key < other.key;
+    return space < other.space;
+  }
+};
+
+// Returns the active element of 'mesh' matching the element 'e' of another mesh: the
+// element of the same id, or of the nearest ancestor of 'e' which 'mesh' has, descending
+// to its first active son. The ids match for the copies of one mesh the fields of a system
+// usually live on. Returns NULL if there is no such element.
+static Element* matching_element(Mesh* mesh, Element* e)
+{
+  Element* f = NULL;
+  for (; e != NULL && f == NULL; e = e->parent)
+    if (e->id < mesh->get_max_element_id() && mesh->get_element(e->id)->used)
+      f = mesh->get_element(e->id);
+  while (f != NULL && !f->active)
+  {
+    Element* son = NULL;
+    for (int i = 0; i < 4 && son == NULL; i++)
+      son = f->sons[i];
+    f = son;
+  }
+  return f;
+}
+
+void Space::interleave_dof_ordering(Tuple<Space*> spaces, int ndof)
+{
+  _F_
+  // the DOF k of the space i is the vertex offset[i] + k of the joint numbering
+  int n = spaces.size();
+  std::vector<int> offset(n + 1, 0);
+  for (int i = 0; i < n; i++)
+    offset[i+1] = offset[i] + spaces[i]->ndof;
+  std::vector<int> order(ndof);
+
+  if (spaces[0]->dof_ordering == HERMES_DOF_NATURAL)
+  {
+    std::vector<InterleavedDof> dofs;
+    dofs.reserve(ndof);
+    for (int i = 0; i < n; i++)
+      for (int k = 0; k < spaces[i]->ndof; k++)
+      {
+        InterleavedDof d = { (k + 0.5) / spaces[i]->ndof, i, k };
+        dofs.push_back(d);
+      }
+    std::sort(dofs.begin(), dofs.end());
+    for (int j = 0; j < ndof; j++)
+      order[j] = offset[dofs[j].space] + dofs[j].k;
+  }
+  else
+  {
+    // the DOFs on the elements matching one element of the first mesh are adjacent
+    Mesh* mesh0 = spaces[0]->mesh;
+    std::vector< std::vector<int> > groups(mesh0->get_max_element_id()), nbrs(ndof);
+    std::vector<int> v;
+    AsmList al;
+    Element* e;
+    for (int i = 0; i < n; i++)
+    {
+      Space* s = spaces[i];
+      s->free_dof_ordering();
+      for_all_active_elements(e, s->mesh)
+      {
+        Element* f = (i == 0) ? e : matching_element(mesh0, e);
+        s->get_element_assembly_list(e, &al);
+        v.clear();
+        for (int j = 0; j < al.cnt; j++)
+          if (al.dof[j] >= 0)
+            v.push_back(offset[i] + (al.dof[j] - s->first_dof) / s->stride);
+        if (f != NULL)
+          groups[f->id].insert(groups[f->id].end(), v.begin(), v.end());
+        else
+          add_clique(nbrs, v);
+      }
+    }
+    for (unsigned int id = 0; id < groups.size(); id++)
+    {
+      add_clique(nbrs, groups[id]);
+      std::vector<int>().swap(groups[id]);
+    }
+    order_graph(nbrs, spaces[0]->dof_ordering, &order[0]);
+  }
+
+  for (int i = 0; i < n; i++)
+    if (spaces[i]->dof_perm == NULL && spaces[i]->ndof > 0)
+      spaces[i]->dof_perm = new int[spaces[i]->ndof];
+  for (int j = 0, i = 0; j < ndof; j++)
+  {
+    int g = order[j];
+    for (i = 0; g >= offset[i+1]; i++) ;
+    spaces[i]->dof_perm[g - offset[i]] = j;
+  }
+}
@@ -18,6 +18,8 @@
 #include "transform.h"
 #include "traverse.h"
 #include "auto_local_array.h"
+#include <pthread.h>
+#include <vector>
 
 
 const uint64_t ONE = (uint64_t) 1 << 63;
@@ -195,6 +197,8 @@ void Traverse::set_boundary_info(State* s, bool* bnd, SurfPos* surf_pos)
 
 Element** Traverse::get_next_state(bool* bnd, SurfPos* surf_pos)
 {
+  HERMES_PERF_SCOPE("traverse");
+  if (plan != NULL) return get_next_planned_state(bnd, surf_pos);
   while (1)
   {
     int i, j, son;
@@ -245,11 +249,13 @@ Element** Traverse::get_next_state(bool* bnd, SurfPos* surf_pos)
         if (id >= meshes[0]->get_num_base_elements())
           return NULL;
         int nused = 0;
+        // The base elements may be visited along a space-filling curve.
+        int eid = (order != NULL) ? order[id] : id;
 				// The variable num is the number of meshes in the stage
         for (i = 0; i < num; i++)
         {
 					// Retrieve the Element with this id on the i-th mesh.
-          s->e[i] = meshes[i]->get_element(id);
+          s->e[i] = meshes[i]->get_element(eid);
           if (!s->e[i]->used) 
 					{ 
 						s->e[i] = NULL; 
@@ -485,16 +491,18 @@ Element** Traverse::get_next_state(bool* bnd, SurfPos* surf_pos)
 }
 
 
-void Traverse::begin(int n, Mesh** meshes, Transformable** fn)
+Traverse::Traverse()
 {
-  //if (stack != NULL) finish();
-
-  assert(n > 0);
-  num = n;
+  stack = NULL;
+  entry = plan = NULL;
+  cur = NULL;
+  fresh = NULL;
+  caching = true;
+}
 
-  this->meshes = meshes;
-  this->fn = fn;
 
+void Traverse::begin_recursive()
+{
   top = 0;
   size = 256;
   stack = new State[size];
@@ -503,11 +511,12 @@ void Traverse::begin(int n, Mesh** meshes, Transformable** fn)
   sons = new int4[num];
   subs = new uint64_t[num];
   id = 0;
+  order = meshes[0]->get_base_element_order();
 
 #ifndef H2D_DISABLE_MULTIMESH_TESTS
   // Test whether all master mashes have the same number of elements
   int base_elem_num = meshes[0]->get_num_base_elements();
-  for (int i = 1; i < n; i++)
+  for (int i = 1; i < num; i++)
     if (base_elem_num != meshes[i]->get_num_base_elements())
       error("Meshes not compatible in Traverse::begin().");
 
@@ -528,7 +537,7 @@ void Traverse::begin(int n, Mesh** meshes, Transformable** fn)
   }
   // take one mesh at a time and compare element areas to the areas[] array
   double tolerance = min_elem_area/100.;
-  for (int i = 1; i < n; i++) {
+  for (int i = 1; i < num; i++) {
     counter = 0;
     for_all_base_elements(e, meshes[i]) 
     {
@@ -552,7 +561,7 @@ void free_state(State* state)
 }
 
 
-void Traverse::finish()
+void Traverse::finish_recursive()
 {
   if (stack == NULL) return;
 
@@ -569,6 +578,415 @@ void Traverse::finish()
 
 
 
+//// traversal plans ///////////////////////////////////////////////////////////////////////////////
+
+// boundary flags of one state of a plan; the rest of SurfPos is found from the elements
+struct PlanState
+{
+  Element* base;
+  bool bnd[4];
+  double lo[4], hi[4];
+};
+
+struct TraversePlan
+{
+  int num;
+  std::vector<Mesh*> meshes;
+  std::vector<unsigned> seq;
+
+  int refs;          ///< number of Traverse objects using the plan
+  int uses;          ///< number of traversals of the meshes since the plan was created
+  unsigned last_use;
+  bool cached;       ///< the plan is in the cache (otherwise it is deleted with its last reference)
+  bool recorded;
+
+  std::vector<Element*> e;  ///< 'num' elements per state, NULL for unused elements
+  std::vector<uint64_t> sub; ///< 'num' sub-element transformations per state
+  std::vector<PlanState> states;
+
+  Mesh* unimesh;     ///< union mesh of the meshes, see Traverse::construct_union_mesh()
+  UniData** unidata;
+  int unisize;
+
+  TraversePlan(int n, Mesh** meshes) : num(n), meshes(meshes, meshes + n), seq(n), refs(0), uses(0),
+                                       last_use(0), cached(false), recorded(false),
+                                       unimesh(NULL), unidata(NULL), unisize(0)
+  {
+    for (int i = 0; i < n; i++)
+      seq[i] = meshes[i]->get_seq();
+  }
+
+  ~TraversePlan()
+  {
+    if (unidata != NULL)
+    {
+      for (int i = 0; i < num; i++)
+        ::free(unidata[i]);
+      delete [] unidata;
+    }
+    delete unimesh;
+  }
+
+  bool matches(int n, Mesh** m) const
+  {
+    if (n != num) return false;
+    for (int i = 0; i < n; i++)
+      if (m[i] != meshes[i] || m[i]->get_seq() != seq[i]) return false;
+    return true;
+  }
+
+  bool is_valid() const
+  {
+    for (int i = 0; i < num; i++)
+      if (meshes[i]->get_seq() != seq[i]) return false;
+    return true;
+  }
+};
+
+
+static const int H2D_MAX_PLANS = 16;
+
+// the cache is guarded by plan_mutex; plans are deleted outside of it since deleting
+// a union mesh calls Mesh::free() and thus release_plans()
+static TraversePlan* plans[H2D_MAX_PLANS];
+static unsigned plan_clock = 0;
+static bool plan_caching = true;
+static pthread_mutex_t plan_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+
+static void delete_plans(std::vector<TraversePlan*>& garbage)
+{
+  for (unsigned i = 0; i < garbage.size(); i++)
+    delete garbage[i];
+}
+
+// removes the plan 'k' from the cache, the caller has to lock plan_mutex
+static void uncache_plan(int k, std::vector<TraversePlan*>& garbage)
+{
+  TraversePlan* p = plans[k];
+  plans[k] = NULL;
+  p->cached = false;
+  if (p->refs == 0) garbage.push_back(p);
+}
+
+// returns the cached plan of the meshes, creates one if there is none
+static TraversePlan* acquire_plan(int n, Mesh** meshes)
+{
+  std::vector<TraversePlan*> garbage;
+  pthread_mutex_lock(&plan_mutex);
+
+  TraversePlan* p = NULL;
+  int k, free_slot = -1, lru = -1;
+  for (k = 0; k < H2D_MAX_PLANS; k++)
+  {
+    if (plans[k] != NULL && !plans[k]->is_valid()) uncache_plan(k, garbage);
+    if (plans[k] == NULL) { if (free_slot < 0) free_slot = k; continue; }
+    if (p == NULL && plans[k]->matches(n, meshes)) p = plans[k];
+    else if (lru < 0 || plans[k]->last_use < plans[lru]->last_use) lru = k;
+  }
+
+  if (p == NULL)
+  {
+    if (free_slot < 0) uncache_plan(free_slot = lru, garbage);
+    p = plans[free_slot] = new TraversePlan(n, meshes);
+    p->cached = true;
+  }
+  p->refs++;
+  p->uses++;
+  p->last_use = ++plan_clock;
+
+  pthread_mutex_unlock(&plan_mutex);
+  delete_plans(garbage);
+  return p;
+}
+
+static void release_plan(TraversePlan* p)
+{
+  pthread_mutex_lock(&plan_mutex);
+  bool unused = (--p->refs == 0 && !p->cached);
+  pthread_mutex_unlock(&plan_mutex);
+  if (unused) delete p;
+}
+
+
+void Traverse::set_plan_caching(bool enable)
+{
+  plan_caching = enable;
+  if (!enable) clear_plans();
+}
+
+
+void Traverse::release_plans(Mesh* mesh)
+{
+  std::vector<TraversePlan*> garbage;
+  pthread_mutex_lock(&plan_mutex);
+  for (int k = 0; k < H2D_MAX_PLANS; k++)
+    if (plans[k] != NULL)
+      for (int i = 0; i < plans[k]->num; i++)
+        if (plans[k]->meshes[i] == mesh) { uncache_plan(k, garbage); break; }
+  pthread_mutex_unlock(&plan_mutex);
+  delete_plans(garbage);
+}
+
+
+void Traverse::clear_plans()
+{
+  std::vector<TraversePlan*> garbage;
+  pthread_mutex_lock(&plan_mutex);
+  for (int k = 0; k < H2D_MAX_PLANS; k++)
+    if (plans[k] != NULL)
+      uncache_plan(k, garbage);
+  pthread_mutex_unlock(&plan_mutex);
+  delete_plans(garbage);
+}
+
+
+void Traverse::begin(int n, Mesh** meshes, Transformable** fn)
+{
+  assert(n > 0);
+  num = n;
+
+  this->meshes = meshes;
+  this->fn = fn;
+
+  // the first traversal of the meshes is recursive, the next ones record the plan and use it
+  entry = (caching && plan_caching) ? acquire_plan(n, meshes) : NULL;
+  if (entry != NULL)
+  {
+    HERMES_PERF_CACHE_HIT("traverse_plans", entry->recorded);
+    if (entry->recorded || entry->uses > 1)
+    {
+      use_plan(entry);
+      return;
+    }
+  }
+  begin_recursive();
+}
+
+
+void Traverse::finish()
+{
+  finish_recursive();
+
+  if (plan != NULL && plan != entry) release_plan(plan);
+  if (entry != NULL) release_plan(entry);
+  plan = entry = NULL;
+
+  delete [] cur;
+  delete [] fresh;
+  cur = NULL;
+  fresh = NULL;
+}
+
+
+// records the states of the recursive traversal of the meshes
+void Traverse::record_plan(TraversePlan* p)
+{
+  HERMES_PERF_SCOPE("traverse_record");
+  Traverse trav;
+  trav.caching = false;
+
+  // plain Transformables remember the transformations of the elements
+  Transformable* tr = new Transformable[num];
+  Transformable** ptr = new Transformable*[num];
+  for (int i = 0; i < num; i++)
+    ptr[i] = tr + i;
+
+  std::vector<Element*> e;
+  std::vector<uint64_t> sub;
+  std::vector<PlanState> states;
+
+  bool bnd[4];
+  SurfPos surf_pos[4];
+  Element** ee;
+  trav.begin(num, meshes, ptr);
+  while ((ee = trav.get_next_state(bnd, surf_pos)) != NULL)
+  {
+    PlanState ps;
+    memset(&ps, 0, sizeof(PlanState));
+    ps.base = trav.get_base();
+    for (unsigned int j = 0; j < ps.base->nvert; j++)
+    {
+      if ((ps.bnd[j] = bnd[j]))
+      {
+        ps.lo[j] = surf_pos[j].lo;
+        ps.hi[j] = surf_pos[j].hi;
+      }
+    }
+    states.push_back(ps);
+
+    for (int i = 0; i < num; i++)
+    {
+      e.push_back(ee[i]);
+      sub.push_back(ee[i] != NULL ? tr[i].get_transform() : 0);
+    }
+  }
+  trav.finish();
+
+  delete [] ptr;
+  delete [] tr;
+
+  // another thread may have recorded the plan meanwhile
+  pthread_mutex_lock(&plan_mutex);
+  if (!p->recorded)
+  {
+    p->e.swap(e);
+    p->sub.swap(sub);
+    p->states.swap(states);
+    p->recorded = true;
+  }
+  pthread_mutex_unlock(&plan_mutex);
+}
+
+
+void Traverse::use_plan(TraversePlan* p)
+{
+  if (!p->recorded) record_plan(p);
+  plan = p;
+  pos = 0;
+  end = p->states.size();
+  cur = new Element*[num];
+  fresh = new bool[num];
+  for (int i = 0; i < num; i++)
+    fresh[i] = true;
+}
+
+
+int Traverse::get_num_states()
+{
+  if (plan == NULL)
+  {
+    TraversePlan* p = entry;
+    if (p == NULL)
+    {
+      // a private plan, not shared with other traversals
+      p = new TraversePlan(num, meshes);
+      p->refs++;
+    }
+    finish_recursive();
+    use_plan(p);
+  }
+  return plan->states.size();
+}
+
+
+void Traverse::set_state_range(int first, int last)
+{
+  int n = get_num_states();
+  if (first < 0 || last > n || first > last) error("Invalid range of states in Traverse::set_state_range().");
+  pos = first;
+  end = last;
+}
+
+
+static int get_sub_depth(uint64_t idx)
+{
+  int depth = 0;
+  for ( ; idx > 0; idx = (idx - 1) >> 3)
+    depth++;
+  return depth;
+}
+
+// pushes the transformations of 'idx' that are below the current transformation of 'fn'
+static void push_transforms(Transformable* fn, uint64_t idx, int depth)
+{
+  int son[25];
+  int n = depth - get_sub_depth(fn->get_transform());
+  for (int k = 0; k < n; k++, idx = (idx - 1) >> 3)
+    son[k] = (idx - 1) & 7;
+  for (int k = n-1; k >= 0; k--)
+    fn->push_transform(son[k]);
+}
+
+// moves 'fn' to the sub-element 'idx' of the element 'e', popping and pushing the
+// transformations like the recursive traversal does
+static void move_to_state(Transformable* fn, Element* e, uint64_t idx, bool fresh)
+{
+  int depth = get_sub_depth(idx);
+  if (fresh || fn->get_active_element() != e)
+  {
+    // not all Transformables reset the transformation in set_active_element()
+    fn->set_active_element(e);
+    while (fn->get_transform() != 0)
+      fn->pop_transform();
+    push_transforms(fn, idx, depth);
+    return;
+  }
+
+  // pop until the current sub-element contains the new one
+  uint64_t cur = fn->get_transform();
+  int cur_depth = get_sub_depth(cur);
+  while (1)
+  {
+    uint64_t anc = idx;
+    for (int d = depth; d > cur_depth; d--)
+      anc = (anc - 1) >> 3;
+    if (cur_depth <= depth && anc == cur) break;
+    fn->pop_transform();
+    cur = fn->get_transform();
+    cur_depth--;
+  }
+  push_transforms(fn, idx, depth);
+}
+
+
+Element** Traverse::get_next_planned_state(bool* bnd, SurfPos* surf_pos)
+{
+  if (pos >= end)
+  {
+    // leave the Transformables untransformed, as the recursive traversal does
+    if (fn != NULL)
+      for (int i = 0; i < num; i++)
+        if (!fresh[i])
+        {
+          while (fn[i]->get_transform() != 0)
+            fn[i]->pop_transform();
+          fresh[i] = true;
+        }
+    return NULL;
+  }
+
+  Element** e = &(plan->e[pos * num]);
+  uint64_t* sub = &(plan->sub[pos * num]);
+  PlanState* ps = &(plan->states[pos]);
+  pos++;
+
+  memcpy(cur, e, num * sizeof(Element*));
+  base = ps->base;
+  if (fn != NULL)
+  {
+    for (int i = 0; i < num; i++)
+      if (e[i] != NULL)
+      {
+        move_to_state(fn[i], e[i], sub[i], fresh[i]);
+        fresh[i] = false;
+      }
+  }
+
+  if (bnd != NULL)
+  {
+    Element* ee = NULL;
+    for (int i = 0; i < num; i++)
+      if ((ee = e[i]) != NULL) break;
+
+    for (unsigned int i = 0; i < base->nvert; i++)
+    {
+      if ((bnd[i] = ps->bnd[i]))
+      {
+        surf_pos[i].lo = ps->lo[i];
+        surf_pos[i].hi = ps->hi[i];
+      }
+      int j = base->next_vert(i);
+      surf_pos[i].v1 = base->vn[i]->id;
+      surf_pos[i].v2 = base->vn[j]->id;
+      surf_pos[i].marker = ee->en[i]->marker;
+      surf_pos[i].surf_num = i;
+    }
+  }
+  return cur;
+}
+
+
 //// union mesh ////////////////////////////////////////////////////////////////////////////////////
 
 uint64_t Traverse::init_idx(Rect* cr, Rect* er)
@@ -727,6 +1145,20 @@ void Traverse::union_recurrent(Rect* cr, Element** e, Rect* er, uint64_t* idx, E
 }
 
 
+// copies the union mesh and the transformations of its elements
+static UniData** copy_union_mesh(Mesh* dest, Mesh* src, UniData** unidata, int num, int size)
+{
+  dest->copy(src);
+  UniData** ud = new UniData*[num];
+  for (int i = 0; i < num; i++)
+  {
+    ud[i] = (UniData*) malloc(size * sizeof(UniData));
+    memcpy(ud[i], unidata[i], size * sizeof(UniData));
+  }
+  return ud;
+}
+
+
 UniData** Traverse::construct_union_mesh(Mesh* unimesh)
 {
   int i;
@@ -734,6 +1166,19 @@ UniData** Traverse::construct_union_mesh(Mesh* unimesh)
   AUTOLA_CL(Rect, er, num);
   Rect cr;
 
+  // the union mesh of the same meshes may be cached
+  bool store = false;
+  if (entry != NULL)
+  {
+    pthread_mutex_lock(&plan_mutex);
+    Mesh* cached = entry->unimesh;
+    store = (entry->uses > 1);
+    pthread_mutex_unlock(&plan_mutex);
+    HERMES_PERF_CACHE_HIT("union_meshes", cached != NULL);
+    if (cached != NULL)
+      return copy_union_mesh(unimesh, cached, entry->unidata, num, entry->unisize);
+  }
+
   this->unimesh = unimesh;
   unimesh->copy_base(meshes[0]);
 
@@ -757,5 +1202,28 @@ UniData** Traverse::construct_union_mesh(Mesh* unimesh)
     union_recurrent(&cr, e, er, idx, unimesh->get_element(id));
   }
 
+  // union meshes are stored when the meshes are used repeatedly
+  if (store)
+  {
+    Mesh* copy = new Mesh;
+    UniData** ud = copy_union_mesh(copy, unimesh, unidata, num, udsize);
+    pthread_mutex_lock(&plan_mutex);
+    bool stored = (entry->unimesh == NULL);
+    if (stored)
+    {
+      entry->unidata = ud;
+      entry->unisize = udsize;
+      entry->unimesh = copy;
+    }
+    pthread_mutex_unlock(&plan_mutex);
+    if (!stored)
+    {
+      for (i = 0; i < num; i++)
+        ::free(ud[i]);
+      delete [] ud;
+      delete copy;
+    }
+  }
+
   return unidata;
 }
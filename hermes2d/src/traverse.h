@@ -37,6 +37,7 @@ class Mesh;
 class Transformable;
 struct State;
 struct Rect;
+struct TraversePlan;
 
 
 struct UniData
@@ -50,10 +51,20 @@ struct UniData
 /// same base mesh it walks through all (pseudo-)elements of the union of all
 /// the N meshes.
 ///
+/// When the same meshes are traversed repeatedly (assembling, error estimation,
+/// filters, linearization), the states of the traversal are recorded in a plan:
+/// a flat list of the elements, sub-element transformations and boundary flags
+/// of all states. The following traversals of the same meshes just walk through
+/// the plan. Plans are cached for the meshes and their sequence numbers, so a
+/// refined mesh gets a new plan, and they are dropped by Mesh::free().
+///
 class HERMES_API Traverse
 {
 public:
 
+  Traverse();
+  ~Traverse() { finish(); }
+
   void begin(int n, Mesh** meshes, Transformable** fn = NULL);
   void finish();
 
@@ -62,16 +73,38 @@ public:
 
   UniData** construct_union_mesh(Mesh* unimesh);
 
+  /// Returns the number of states of the traversal started by begin().
+  int get_num_states();
+  /// Restricts the traversal started by begin() to the states [first, last). Several
+  /// threads, each with its own Traverse and Transformables, can split the states of
+  /// one traversal this way.
+  void set_state_range(int first, int last);
+
+  /// Enables or disables the cache of traversal plans and union meshes (enabled by default).
+  static void set_plan_caching(bool enable);
+  /// Drops the cached plans and union meshes of the meshes. For internal use (Mesh::free()).
+  static void release_plans(Mesh* mesh);
+  /// Drops all cached plans and union meshes.
+  static void clear_plans();
+
 private:
 
   int num;
   Mesh** meshes;
   Transformable** fn;
 
+  TraversePlan* entry; ///< cached plan of the meshes (possibly not recorded yet)
+  TraversePlan* plan;  ///< recorded plan being walked through, NULL for the recursive traversal
+  int pos, end;        ///< current and last state of the plan
+  Element** cur;       ///< elements of the current state of the plan
+  bool* fresh;         ///< the Transformables whose active element has to be set again
+  bool caching;
+
   State* stack;
   int top, size;
 
   int id;
+  const int* order; ///< base element order of the first mesh, see Mesh::set_element_ordering()
   bool tri;
   Element* base;
   int4* sons;
@@ -82,6 +115,11 @@ private:
 
   State* push_state();
   void set_boundary_info(State* s, bool* bnd, SurfPos* surf_pos);
+  void begin_recursive();
+  void finish_recursive();
+  void use_plan(TraversePlan* p);
+  void record_plan(TraversePlan* p);
+  Element** get_next_planned_state(bool* bnd, SurfPos* surf_pos);
   void union_recurrent(Rect* cr, Element** e, Rect* er, uint64_t* idx, Element* uni);
   uint64_t init_idx(Rect* cr, Rect* er);
 
@@ -194,13 +194,115 @@ void WeakForm::set_ext_fns(void* fn, Tuple<MeshFunction*>ext)
 
 //// stages ////////////////////////////////////////////////////////////////////////////////////////
 
-/// Constructs a list of assembling stages. Each stage contains a list of forms
+/// Returns the list of assembling stages. Each stage contains a list of forms
 /// that share the same meshes. Each stage is then assembled separately. This
 /// improves the performance of multi-mesh assembling.
-/// This function is identical in H2D and H3D.
+/// The stages are kept until the forms, the meshes of the spaces or the external
+/// functions change, so that repeated assembling (Newton's iterations, time steps)
+/// does not construct them again. Only the solutions u_ext, which are new in each
+/// assembling, are replaced in the stages.
 ///
-void WeakForm::get_stages(Tuple<Space *> spaces, Tuple<Solution *> u_ext, 
-               std::vector<WeakForm::Stage>& stages, bool rhsonly)
+std::vector<WeakForm::Stage>& WeakForm::get_stages(Tuple<Space *> spaces, Tuple<Solution *> u_ext, bool rhsonly)
+{
+  _F_
+  // the forms and all meshes and functions the stages depend on
+  std::vector<size_t> key;
+  key.push_back(seq);
+  for (int i = 0; i < neq; i++)
+  {
+    Mesh* mesh = spaces[i]->get_mesh();
+    key.push_back((size_t) mesh);
+    key.push_back(mesh->get_seq());
+  }
+  for (unsigned i = 0; i < u_ext.size(); i++)
+  {
+    Mesh* mesh = (u_ext[i] != NULL) ? u_ext[i]->get_mesh() : NULL;
+    key.push_back((size_t) mesh);
+    if (mesh != NULL) key.push_back(mesh->get_seq());
+  }
+  #define add_ext_to_key(forms) \
+    for (unsigned i = 0; i < forms.size(); i++) \
+      for (unsigned j = 0; j < forms[i].ext.size(); j++) \
+      { \
+        Mesh* mesh = forms[i].ext[j]->get_mesh(); \
+        key.push_back((size_t) forms[i].ext[j]); \
+        key.push_back((size_t) mesh); \
+        if (mesh != NULL) key.push_back(mesh->get_seq()); \
+      }
+  add_ext_to_key(mfvol);
+  add_ext_to_key(mfsurf);
+  add_ext_to_key(vfvol);
+  add_ext_to_key(vfsurf);
+
+  bool hit = (key == stages_key);
+  HERMES_PERF_CACHE_HIT("weakform_stages", hit);
+  if (!hit)
+  {
+    build_stages(spaces, u_ext);
+    stages_key = key;
+  }
+
+  // put the current solutions u_ext in place of the old ones
+  for (unsigned i = 0; i < stages.size(); i++)
+  {
+    Stage* s = &stages[i];
+    for (unsigned k = 0; k < s->ext.size(); k++)
+      if (s->ext_u[k] >= 0)
+        s->fns[s->idx.size() + k] = s->ext[k] = u_ext[s->ext_u[k]];
+  }
+  return stages;
+}
+
+
+/// Returns the volume forms of the stage assembled on the elements with the given marker.
+/// The lists are made once for each marker, so that the element loop does not check
+/// the areas of all forms.
+///
+const WeakForm::Stage::FormList& WeakForm::get_vol_forms(Stage* s, int marker)
+{
+  std::map<int, Stage::FormList>::iterator it = s->vol_forms.find(marker);
+  if (it != s->vol_forms.end()) return it->second;
+
+  Stage::FormList& list = s->vol_forms[marker];
+  for (unsigned i = 0; i < s->mfvol.size(); i++)
+    if (s->mfvol[i]->area == HERMES_ANY || is_in_area(marker, s->mfvol[i]->area))
+      list.mfvol.push_back(s->mfvol[i]);
+  for (unsigned i = 0; i < s->vfvol.size(); i++)
+    if (s->vfvol[i]->area == HERMES_ANY || is_in_area(marker, s->vfvol[i]->area))
+      list.vfvol.push_back(s->vfvol[i]);
+  return list;
+}
+
+
+/// Returns the surface forms of the stage assembled on the boundary edges with the given marker.
+///
+const WeakForm::Stage::FormList& WeakForm::get_surf_forms(Stage* s, int marker)
+{
+  std::map<int, Stage::FormList>::iterator it = s->surf_forms.find(marker);
+  if (it != s->surf_forms.end()) return it->second;
+
+  Stage::FormList& list = s->surf_forms[marker];
+  for (unsigned i = 0; i < s->mfsurf.size(); i++)
+  {
+    int area = s->mfsurf[i]->area;
+    if (area == H2D_DG_INNER_EDGE) continue;
+    if (area == HERMES_ANY || area == H2D_DG_BOUNDARY_EDGE || is_in_area(marker, area))
+      list.mfsurf.push_back(s->mfsurf[i]);
+  }
+  for (unsigned i = 0; i < s->vfsurf.size(); i++)
+  {
+    int area = s->vfsurf[i]->area;
+    if (area == H2D_DG_INNER_EDGE) continue;
+    if (area == HERMES_ANY || area == H2D_DG_BOUNDARY_EDGE || is_in_area(marker, area))
+      list.vfsurf.push_back(s->vfsurf[i]);
+  }
+  return list;
+}
+
+
+/// Constructs the list of assembling stages for get_stages().
+///
+void WeakForm::build_stages(Tuple<Space *>& spaces, Tuple<Solution *>& u_ext)
 {
   _F_
   unsigned i;
@@ -272,7 +374,18 @@ void WeakForm::get_stages(Tuple<Space *> spaces, Tuple<Solution *> u_ext,
       s->ext.push_back(*it);
       s->meshes.push_back((*it)->get_mesh());
       s->fns.push_back(*it);
+      int k = u_ext.size() - 1;
+      while (k >= 0 && u_ext[k] != *it) k--;
+      s->ext_u.push_back(k);
     }
+
+    // the forms on the inner edges do not depend on the marker
+    for (unsigned k = 0; k < s->mfsurf.size(); k++)
+      if (s->mfsurf[k]->area == H2D_DG_INNER_EDGE)
+        s->inner_forms.mfsurf.push_back(s->mfsurf[k]);
+    for (unsigned k = 0; k < s->vfsurf.size(); k++)
+      if (s->vfsurf[k]->area == H2D_DG_INNER_EDGE)
+        s->inner_forms.vfsurf.push_back(s->vfsurf[k]);
     
     s->idx_set.clear();
     s->seq_set.clear();
@@ -32,6 +32,7 @@ class Shapeset;
 template<typename T> class Func;
 template<typename T> class Geom;
 template<typename T> class ExtData;
+template<typename E> struct FormExpr;
 
 // Bilinear form symmetry flag, see WeakForm::add_matrix_form
 enum SymFlag
@@ -82,6 +83,32 @@ public:
   void add_vector_form_surf(vector_form_val_t fn, vector_form_ord_t ord, 
 			int area = HERMES_ANY, Tuple<MeshFunction*>ext = Tuple<MeshFunction*>()); // single equation case
 
+  // forms written as expressions, e.g. grad(u) * grad(v), see form_expr.h
+  template<typename E>
+  void add_matrix_form(int i, int j, const FormExpr<E>& form,
+                       SymFlag sym = HERMES_UNSYM, int area = HERMES_ANY, Tuple<MeshFunction*>ext = Tuple<MeshFunction*>());
+  template<typename E>
+  void add_matrix_form(const FormExpr<E>& form,
+                       SymFlag sym = HERMES_UNSYM, int area = HERMES_ANY, Tuple<MeshFunction*>ext = Tuple<MeshFunction*>());
+  template<typename E>
+  void add_matrix_form_surf(int i, int j, const FormExpr<E>& form,
+                            int area = HERMES_ANY, Tuple<MeshFunction*>ext = Tuple<MeshFunction*>());
+  template<typename E>
+  void add_matrix_form_surf(const FormExpr<E>& form,
+                            int area = HERMES_ANY, Tuple<MeshFunction*>ext = Tuple<MeshFunction*>());
+  template<typename E>
+  void add_vector_form(int i, const FormExpr<E>& form,
+                       int area = HERMES_ANY, Tuple<MeshFunction*>ext = Tuple<MeshFunction*>());
+  template<typename E>
+  void add_vector_form(const FormExpr<E>& form,
+                       int area = HERMES_ANY, Tuple<MeshFunction*>ext = Tuple<MeshFunction*>());
+  template<typename E>
+  void add_vector_form_surf(int i, const FormExpr<E>& form,
+                            int area = HERMES_ANY, Tuple<MeshFunction*>ext = Tuple<MeshFunction*>());
+  template<typename E>
+  void add_vector_form_surf(const FormExpr<E>& form,
+                            int area = HERMES_ANY, Tuple<MeshFunction*>ext = Tuple<MeshFunction*>());
+
   void set_ext_fns(void* fn, Tuple<MeshFunction*>ext = Tuple<MeshFunction*>());
 
   /// Returns the number of equations
@@ -132,13 +159,30 @@ protected:
     std::vector<VectorFormVol *>  vfvol;
     std::vector<VectorFormSurf *> vfsurf;
 
+    /// For each function in 'ext', its index in u_ext, or -1 for the external functions
+    /// of the forms. The solutions u_ext are new in each assembling, see get_stages().
+    std::vector<int> ext_u;
+
+    /// Forms of the stage that are assembled on one kind of elements or edges.
+    struct FormList
+    {
+      std::vector<MatrixFormVol *>  mfvol;
+      std::vector<MatrixFormSurf *> mfsurf;
+      std::vector<VectorFormVol *>  vfvol;
+      std::vector<VectorFormSurf *> vfsurf;
+    };
+    std::map<int, FormList> vol_forms;   ///< Volume forms by element marker, see get_vol_forms().
+    std::map<int, FormList> surf_forms;  ///< Boundary edge forms by edge marker, see get_surf_forms().
+    FormList inner_forms;                ///< Forms on the inner edges (H2D_DG_INNER_EDGE).
+
     std::set<int> idx_set;
     std::set<unsigned> seq_set;
     std::set<MeshFunction*> ext_set;
   };
 
-  void get_stages(Tuple< Space* > spaces, Tuple< Solution* > u_ext, 
-                  std::vector< WeakForm::Stage >& stages, bool rhsonly);
+  std::vector<Stage>& get_stages(Tuple< Space* > spaces, Tuple< Solution* > u_ext, bool rhsonly);
+  const Stage::FormList& get_vol_forms(Stage* s, int marker);
+  const Stage::FormList& get_surf_forms(Stage* s, int marker);
   bool** get_blocks();
 
   bool is_in_area(int marker, int area) const
@@ -155,6 +199,12 @@ protected:
 
 private:
 
+  /// The stages of the last assembling and the meshes and functions they were made for.
+  std::vector<Stage> stages;
+  std::vector<size_t> stages_key;
+
+  void build_stages(Tuple<Space*>& spaces, Tuple<Solution*>& u_ext);
+
   Stage* find_stage(std::vector<WeakForm::Stage>& stages, int ii, int jj,
                     Mesh* m1, Mesh* m2, 
                     std::vector<MeshFunction*>& ext, std::vector<Solution*>& u_ext);
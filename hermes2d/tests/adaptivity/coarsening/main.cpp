@@ -0,0 +1,220 @@
+#include "hermes2d.h"
+
+using namespace RefinementSelectors;
+
+// This test makes sure that Adapt::coarsen() lets the adapted mesh follow a moving front:
+// a steep front moves across the domain and in each time step the mesh is adapted to it,
+// starting from the base mesh (as the time-dependent examples did), from the mesh of the
+// previous time step, or from the mesh of the previous time step coarsened where the error
+// was small. The coarsened meshes have to need fewer adaptivity steps than the base mesh,
+// fewer DOFs than the meshes which are only refined, and must keep the base mesh. Without
+// a base mesh, the refinements from the mesh file have to be kept, and two components on
+// one mesh have to keep the difference of their orders.
+
+const int P_INIT = 2;                             // Initial polynomial degree of all mesh elements.
+const int INIT_REF_NUM = 2;                       // Number of initial uniform mesh refinements.
+const double THRESHOLD = 0.3;                     // Parameter of the adapt(...) function.
+const int STRATEGY = 0;                           // Adaptive strategy.
+const CandList CAND_LIST = H2D_HP_ISO;            // Predefined list of element refinement candidates.
+const double COARSEN_THRESHOLD = 0.05;            // Parameter of the coarsen(...) function.
+const double ERR_STOP = 3.0;                      // Relative error in percent.
+const int NDOF_STOP = 20000;                      // Stop if the number of DOFs grows over this limit.
+const int NUM_STEPS = 6;                          // Number of time steps.
+const double SLOPE = 30.0;                        // Slope of the front.
+MatrixSolverType matrix_solver = SOLVER_BANDED;   // Possibilities: SOLVER_AMESOS, SOLVER_BANDED, SOLVER_MUMPS,
+                                                  // SOLVER_PARDISO, SOLVER_PETSC, SOLVER_UMFPACK.
+
+enum Mode { RESET, KEEP, COARSEN };
+
+double x0;                                        // Position of the front.
+
+scalar front(double x, double y, scalar& dx, scalar& dy)
+{
+  double t = SLOPE * (x - x0);
+  dx = SLOPE / (1 + t * t);
+  dy = 0;
+  return atan(t);
+}
+
+BCType bc_types(int marker)
+{
+  return BC_NATURAL;
+}
+
+// Adapts the space to the front and coarsens it afterwards if requested. Returns the
+// number of adaptivity steps, 'ndof' is the number of DOFs of the adapted space.
+int adapt_to_front(Mesh* basemesh, H1Space* space, Selector* selector, bool coarsen, int& ndof)
+{
+  Solution exact;
+  exact.set_exact(basemesh, front);
+
+  for (int as = 1; ; as++)
+  {
+    Space* ref_space = construct_refined_space(space);
+    ref_space->set_dof_ordering(HERMES_DOF_RCM);
+    bool done;
+    {
+      Solution sln, ref_sln;
+      OGProjection::project_global(ref_space, &exact, &ref_sln, matrix_solver);
+      OGProjection::project_global(space, &ref_sln, &sln, matrix_solver);
+
+      Adapt adaptivity(space, HERMES_H1_NORM);
+      double err_est_rel = adaptivity.calc_err_est(&sln, &ref_sln) * 100;
+      ndof = Space::get_num_dofs(space);
+      done = err_est_rel < ERR_STOP || ndof >= NDOF_STOP;
+      if (!done)
+        done = adaptivity.adapt(selector, THRESHOLD, STRATEGY);
+      else if (coarsen)
+        adaptivity.coarsen(selector, COARSEN_THRESHOLD, basemesh);
+    }
+    delete ref_space->get_mesh();
+    delete ref_space;
+    if (done) return as;
+  }
+}
+
+// Moves the front across the domain. Returns the total number of adaptivity steps,
+// 'ndof' is the number of DOFs in the last time step.
+int run(Mode mode, int& ndof, bool& base_kept)
+{
+  Mesh basemesh, mesh;
+  H2DReader mloader;
+  mloader.load("square.mesh", &basemesh);
+  for (int i = 0; i < INIT_REF_NUM; i++) basemesh.refine_all_elements();
+  mesh.copy(&basemesh);
+
+  H1Space space(&mesh, bc_types, NULL, P_INIT);
+  space.set_dof_ordering(HERMES_DOF_RCM); // small bandwidth for the band solver
+  H1ProjBasedSelector selector(CAND_LIST, 1.0, H2DRS_DEFAULT_ORDER);
+
+  int steps = 0;
+  for (int ts = 0; ts < NUM_STEPS; ts++)
+  {
+    x0 = 0.2 + 0.6 * ts / (NUM_STEPS - 1);
+    if (mode == RESET && ts > 0)
+    {
+      mesh.copy(&basemesh);
+      space.set_uniform_order(P_INIT);
+    }
+    steps += adapt_to_front(&basemesh, &space, &selector, mode == COARSEN, ndof);
+  }
+
+  // the elements refined in the base mesh stay refined
+  Element* e;
+  for_all_inactive_elements(e, &basemesh)
+    if (mesh.get_element(e->id)->active) base_kept = false;
+
+  return steps;
+}
+
+// Coarsens a refined mesh without a base mesh, with a threshold that lets all sons be merged.
+// Returns true if exactly the refinements from the mesh file are left.
+bool check_initial_kept()
+{
+  Mesh mesh;
+  H2DReader mloader;
+  mloader.load("square-refined.mesh", &mesh);
+  int ninitial = mesh.get_num_initial_elements();
+  int nactive = mesh.get_num_active_elements();
+  std::vector<bool> active(ninitial);
+  for (int id = 0; id < ninitial; id++)
+    active[id] = mesh.get_element(id)->active;
+  mesh.refine_all_elements();
+  mesh.refine_all_elements();
+
+  H1Space space(&mesh, bc_types, NULL, P_INIT);
+  space.set_dof_ordering(HERMES_DOF_RCM);
+  H1ProjBasedSelector selector(CAND_LIST, 1.0, H2DRS_DEFAULT_ORDER);
+  x0 = 0.5;
+  Solution exact;
+  exact.set_exact(&mesh, front);
+  Space* ref_space = construct_refined_space(&space);
+  ref_space->set_dof_ordering(HERMES_DOF_RCM);
+  {
+    Solution sln, ref_sln;
+    OGProjection::project_global(ref_space, &exact, &ref_sln, matrix_solver);
+    OGProjection::project_global(&space, &ref_sln, &sln, matrix_solver);
+    Adapt adaptivity(&space, HERMES_H1_NORM);
+    adaptivity.calc_err_est(&sln, &ref_sln);
+    adaptivity.coarsen(&selector, 1e10);
+  }
+  delete ref_space->get_mesh();
+  delete ref_space;
+
+  bool kept = (mesh.get_num_active_elements() == nactive);
+  for (int id = 0; id < ninitial; id++)
+    if (mesh.get_element(id)->active != active[id]) kept = false;
+  return kept;
+}
+
+// Coarsens two components on one mesh, of the orders P_INIT + 1 and P_INIT, with a threshold
+// that lets all orders be lowered (the refinements from the mesh file cannot be merged).
+// Returns true if both orders were lowered by one and their difference was kept.
+bool check_orders_kept()
+{
+  Mesh mesh;
+  H2DReader mloader;
+  mloader.load("square-refined.mesh", &mesh);
+
+  H1Space u_space(&mesh, bc_types, NULL, P_INIT + 1);
+  H1Space v_space(&mesh, bc_types, NULL, P_INIT);
+  u_space.set_dof_ordering(HERMES_DOF_RCM);
+  v_space.set_dof_ordering(HERMES_DOF_RCM);
+  H1ProjBasedSelector selector(CAND_LIST, 1.0, H2DRS_DEFAULT_ORDER);
+  x0 = 0.5;
+  Solution exact;
+  exact.set_exact(&mesh, front);
+  Tuple<Space *>* ref_spaces = construct_refined_spaces(Tuple<Space *>(&u_space, &v_space));
+  for (int i = 0; i < 2; i++) (*ref_spaces)[i]->set_dof_ordering(HERMES_DOF_RCM);
+  {
+    Solution u_sln, v_sln, u_ref_sln, v_ref_sln;
+    OGProjection::project_global(*ref_spaces, Tuple<Solution *>(&exact, &exact),
+                                 Tuple<Solution *>(&u_ref_sln, &v_ref_sln), matrix_solver);
+    OGProjection::project_global(Tuple<Space *>(&u_space, &v_space), Tuple<Solution *>(&u_ref_sln, &v_ref_sln),
+                                 Tuple<Solution *>(&u_sln, &v_sln), matrix_solver);
+    Adapt adaptivity(Tuple<Space *>(&u_space, &v_space), Tuple<ProjNormType>(HERMES_H1_NORM, HERMES_H1_NORM));
+    adaptivity.calc_err_est(Tuple<Solution *>(&u_sln, &v_sln), Tuple<Solution *>(&u_ref_sln, &v_ref_sln));
+    adaptivity.coarsen(Tuple<Selector *>(&selector, &selector), 1e10);
+  }
+  for (int i = 0; i < 2; i++)
+  {
+    delete (*ref_spaces)[i]->get_mesh();
+    delete (*ref_spaces)[i];
+  }
+  delete ref_spaces;
+
+  bool kept = true;
+  Element* e;
+  for_all_active_elements(e, &mesh)
+    if (u_space.get_element_order(e->id) != H2D_MAKE_QUAD_ORDER(P_INIT, P_INIT)
+        || v_space.get_element_order(e->id) != H2D_MAKE_QUAD_ORDER(P_INIT - 1, P_INIT - 1))
+      kept = false;
+  return kept;
+}
+
+int main(int argc, char* argv[])
+{
+  bool base_kept = true;
+  int ndof_reset, ndof_keep, ndof_coarsen;
+  int steps_reset = run(RESET, ndof_reset, base_kept);
+  int steps_keep = run(KEEP, ndof_keep, base_kept);
+  int steps_coarsen = run(COARSEN, ndof_coarsen, base_kept);
+  printf("base mesh: %d adaptivity steps, %d DOFs\n", steps_reset, ndof_reset);
+  printf("kept mesh: %d adaptivity steps, %d DOFs\n", steps_keep, ndof_keep);
+  printf("coarsened mesh: %d adaptivity steps, %d DOFs\n", steps_coarsen, ndof_coarsen);
+
+  bool initial_kept = check_initial_kept();
+  bool orders_kept = check_orders_kept();
+
+  if (base_kept && initial_kept && orders_kept && steps_coarsen < steps_reset && ndof_coarsen < ndof_keep) {
+    printf("Success!\n");
+    return ERR_SUCCESS;
+  }
+  else {
+    if (!base_kept) printf("The base mesh was coarsened.\n");
+    if (!initial_kept) printf("The refinements from the mesh file were not kept.\n");
+    if (!orders_kept) printf("The differences of the orders of the components were not kept.\n");
+    printf("Failure!\n");
+    return ERR_FAILURE;
+  }
+}
@@ -0,0 +1,208 @@
+#include "hermes2d.h"
+
+using namespace RefinementSelectors;
+
+// This test makes sure that the dual-weighted residual estimate of Adapt::calc_err_dwr()
+// is the error J(u_ref) - J(u) of the goal functional (the coarse and the reference
+// solutions are Galerkin solutions, so the estimate is exact), and that the goal-oriented
+// adaptivity reaches the tolerance in the goal with fewer than NDOF_STOP DOFs, while the
+// adaptivity in the energy norm does not. The problem is -Laplace u = 1 on an L-shaped domain, the goal is the
+// integral of u over a square in the corner opposite to the singularity. The transposed
+// solve of the dual problem is also checked on a nonsymmetric (convection) problem, where
+// it differs from the primal solve.
+
+const int P_INIT = 2;                             // Initial polynomial degree of all mesh elements.
+const int INIT_REF_NUM = 1;                       // Number of initial uniform mesh refinements.
+const double THRESHOLD = 0.3;                     // Parameter of the adapt(...) function.
+const int STRATEGY = 0;                           // Adaptive strategy.
+const CandList CAND_LIST = H2D_H_ISO;             // Only h-refinements.
+const double GOAL_TOL = 1e-4;                     // Relative error in the goal.
+const int NDOF_STOP = 500;                        // Stop if the number of DOFs grows over this limit.
+const int GOAL_MARKER = 2;                        // Element marker of the goal area.
+MatrixSolverType matrix_solver = SOLVER_BANDED;   // The dual problem needs Solver::solve_transposed(),
+                                                  // SOLVER_BANDED and SOLVER_UMFPACK implement it.
+
+BCType bc_types(int marker)
+{
+  return BC_ESSENTIAL;
+}
+
+scalar essential_bc_values(int ess_bdy_marker, double x, double y)
+{
+  return 0;
+}
+
+template<typename Real, typename Scalar>
+Scalar bilinear_form(int n, double *wt, Func<Scalar> *u_ext[], Func<Real> *u, Func<Real> *v, Geom<Real> *e, ExtData<Scalar> *ext)
+{
+  return int_grad_u_grad_v<Real, Scalar>(n, wt, u, v);
+}
+
+template<typename Real, typename Scalar>
+Scalar convection_form(int n, double *wt, Func<Scalar> *u_ext[], Func<Real> *u, Func<Real> *v, Geom<Real> *e, ExtData<Scalar> *ext)
+{
+  return int_grad_u_grad_v<Real, Scalar>(n, wt, u, v) + 10.0 * int_dudx_v<Real, Scalar>(n, wt, u, v);
+}
+
+template<typename Real, typename Scalar>
+Scalar linear_form(int n, double *wt, Func<Scalar> *u_ext[], Func<Real> *v, Geom<Real> *e, ExtData<Scalar> *ext)
+{
+  return int_v<Real, Scalar>(n, wt, v);
+}
+
+template<typename Real, typename Scalar>
+Scalar goal_form(int n, double *wt, Func<Scalar> *u_ext[], Func<Real> *v, Geom<Real> *e, ExtData<Scalar> *ext)
+{
+  return int_v<Real, Scalar>(n, wt, v);
+}
+
+// Solves the problem and the dual problem on the space, returns the goal J(u).
+double solve(WeakForm* wf, WeakForm* wf_goal, Space* space, Solution* sln, Solution* dual_sln)
+{
+  int ndof = Space::get_num_dofs(space);
+  DiscreteProblem dp(wf, space, true);
+  SparseMatrix* matrix = create_matrix(matrix_solver);
+  Vector* rhs = create_vector(matrix_solver);
+  Solver* solver = create_linear_solver(matrix_solver, matrix, rhs);
+  dp.assemble(matrix, rhs);
+  if (!solver->solve()) error ("Matrix solver failed.\n");
+  Solution::vector_to_solution(solver->get_solution(), space, sln);
+  scalar* coeffs = new scalar[ndof];
+  memcpy(coeffs, solver->get_solution(), ndof * sizeof(scalar));
+
+  // the dual problem reuses the factorization
+  DiscreteProblem dp_goal(wf_goal, space, true);
+  Vector* goal = create_vector(matrix_solver);
+  if (!solve_dual(&dp_goal, solver, goal, dual_sln)) error ("The dual problem failed.\n");
+
+  // the Dirichlet lift is zero
+  scalar j = 0.0;
+  for (int i = 0; i < ndof; i++)
+    j += goal->get(i) * coeffs[i];
+
+  delete [] coeffs;
+  delete solver;
+  delete matrix;
+  delete rhs;
+  delete goal;
+  return std::abs(j);
+}
+
+// Solves A u = f and A^T z = J on the space, returns true if J(u) = z^T A u = z^T f.
+bool check_transposed_solve(WeakForm* wf, WeakForm* wf_goal, Space* space)
+{
+  int ndof = Space::get_num_dofs(space);
+  DiscreteProblem dp(wf, space, true);
+  SparseMatrix* matrix = create_matrix(matrix_solver);
+  Vector* rhs = create_vector(matrix_solver);
+  Solver* solver = create_linear_solver(matrix_solver, matrix, rhs);
+  dp.assemble(matrix, rhs);
+  if (!solver->solve()) error ("Matrix solver failed.\n");
+  scalar j = 0.0, zf = 0.0;
+  DiscreteProblem dp_goal(wf_goal, space, true);
+  Vector* goal = create_vector(matrix_solver);
+  dp_goal.assemble((SparseMatrix*) NULL, goal);
+  for (int i = 0; i < ndof; i++)
+    j += goal->get(i) * solver->get_solution()[i];
+  if (!solver->solve_transposed(goal)) error ("The dual problem failed.\n");
+  for (int i = 0; i < ndof; i++)
+    zf += rhs->get(i) * solver->get_solution()[i];
+  printf("transposed solve: J(u) = %.15g, z^T f = %.15g\n", j, zf);
+
+  delete solver;
+  delete matrix;
+  delete rhs;
+  delete goal;
+  return std::abs(j - zf) < 1e-10 * std::abs(j);
+}
+
+// Runs the adaptivity with the goal-oriented or the energy error indicators until the
+// error in the goal is below GOAL_TOL. Returns the number of DOFs of the coarse space.
+int run(bool goal_oriented, bool& exact, bool& reached)
+{
+  Mesh mesh;
+  H2DReader mloader;
+  mloader.load("lshape.mesh", &mesh);
+  for (int i = 0; i < INIT_REF_NUM; i++) mesh.refine_all_elements();
+
+  H1Space space(&mesh, bc_types, essential_bc_values, P_INIT);
+  space.set_dof_ordering(HERMES_DOF_RCM); // small bandwidth for the band solver
+
+  WeakForm wf;
+  wf.add_matrix_form(callback(bilinear_form), HERMES_SYM);
+  wf.add_vector_form(callback(linear_form));
+  WeakForm wf_goal;
+  wf_goal.add_vector_form(callback(goal_form), GOAL_MARKER);
+
+  H1ProjBasedSelector selector(CAND_LIST, 1.0, H2DRS_DEFAULT_ORDER);
+
+  int ndof;
+  bool done = false;
+  for (int as = 1; !done; as++)
+  {
+    Space* ref_space = construct_refined_space(&space);
+    ref_space->set_dof_ordering(HERMES_DOF_RCM);
+    {
+      Solution sln, ref_sln, dual_sln, dual_ref_sln;
+      double j = solve(&wf, &wf_goal, &space, &sln, &dual_sln);
+      double j_ref = solve(&wf, &wf_goal, ref_space, &ref_sln, &dual_ref_sln);
+      double err_goal = std::abs(j_ref - j) / j_ref;
+
+      Adapt adaptivity(&space, HERMES_H1_NORM);
+      if (goal_oriented)
+      {
+        adaptivity.set_error_form(callback(bilinear_form));
+        double est = adaptivity.calc_err_dwr(&sln, &ref_sln, &dual_sln, &dual_ref_sln) / j_ref;
+        if (std::abs(est - err_goal) > 1e-8) exact = false;
+        printf("DWR    step %d: ndof %5d, goal error %g, estimate %g\n", as, Space::get_num_dofs(&space), err_goal, est);
+      }
+      else
+      {
+        adaptivity.calc_err_est(&sln, &ref_sln);
+        printf("energy step %d: ndof %5d, goal error %g\n", as, Space::get_num_dofs(&space), err_goal);
+      }
+
+      ndof = Space::get_num_dofs(&space);
+      reached = err_goal < GOAL_TOL;
+      done = reached || ndof >= NDOF_STOP || adaptivity.adapt(&selector, THRESHOLD, STRATEGY);
+    }
+    delete ref_space->get_mesh();
+    delete ref_space;
+  }
+  return ndof;
+}
+
+int main(int argc, char* argv[])
+{
+  bool exact = true;
+
+  Mesh mesh;
+  H2DReader mloader;
+  mloader.load("lshape.mesh", &mesh);
+  mesh.refine_all_elements();
+  H1Space space(&mesh, bc_types, essential_bc_values, P_INIT);
+  space.set_dof_ordering(HERMES_DOF_RCM);
+  WeakForm wf;
+  wf.add_matrix_form(callback(convection_form));
+  wf.add_vector_form(callback(linear_form));
+  WeakForm wf_goal;
+  wf_goal.add_vector_form(callback(goal_form), GOAL_MARKER);
+  bool transposed = check_transposed_solve(&wf, &wf_goal, &space);
+
+  bool reached_dwr, reached_energy;
+  int ndof_dwr = run(true, exact, reached_dwr);
+  int ndof_energy = run(false, exact, reached_energy);
+  printf("ndof: goal-oriented %d (%s), energy %d (%s)\n", ndof_dwr, reached_dwr ? "reached" : "not reached",
+         ndof_energy, reached_energy ? "reached" : "not reached");
+
+  if (transposed && exact && reached_dwr && !reached_energy) {
+    printf("Success!\n");
+    return ERR_SUCCESS;
+  }
+  else {
+    if (!transposed) printf("The transposed solve is wrong.\n");
+    if (!exact) printf("The estimate differs from the error in the goal.\n");
+    printf("Failure!\n");
+    return ERR_FAILURE;
+  }
+}
@@ -0,0 +1,166 @@
+#include "hermes2d.h"
+
+// This test makes sure that complex forms added to a ComplexBlockForm give the same
+// solution as the real and imaginary parts written by hand as a system of two real
+// equations, both for symmetric and unsymmetric forms.
+//
+// PDE: -Laplace u + c1 u + c2 du/dx = f, u complex
+
+const int P_INIT = 3;                             // Uniform polynomial degree of mesh elements.
+MatrixSolverType matrix_solver = SOLVER_UMFPACK;  // Possibilities: SOLVER_AMESOS, SOLVER_MUMPS, SOLVER_NOX,
+                                                  // SOLVER_PARDISO, SOLVER_PETSC, SOLVER_UMFPACK.
+const double EPS = 1e-10;
+
+const cplx C1 = cplx(2.0, 3.0);
+const cplx C2 = cplx(0.5, -1.0);
+const cplx F = cplx(1.0, 2.0);
+
+BCType bc_types(int marker)
+{
+  return (marker == 3) ? BC_NATURAL : BC_ESSENTIAL;
+}
+
+scalar essential_bc_values(int ess_bdy_marker, double x, double y)
+{
+  return 0;
+}
+
+// Complex forms.
+template<typename Real, typename Scalar>
+Scalar bilinear_form_sym(int n, double *wt, Func<Scalar> *u_ext[], Func<Real> *u,
+                         Func<Real> *v, Geom<Real> *e, ExtData<Scalar> *ext)
+{
+  return int_grad_u_grad_v<Real, Scalar>(n, wt, u, v) + C1 * int_u_v<Real, Scalar>(n, wt, u, v);
+}
+
+template<typename Real, typename Scalar>
+Scalar bilinear_form_unsym(int n, double *wt, Func<Scalar> *u_ext[], Func<Real> *u,
+                           Func<Real> *v, Geom<Real> *e, ExtData<Scalar> *ext)
+{
+  return C2 * int_dudx_v<Real, Scalar>(n, wt, u, v);
+}
+
+template<typename Real, typename Scalar>
+Scalar linear_form(int n, double *wt, Func<Scalar> *u_ext[], Func<Real> *v,
+                   Geom<Real> *e, ExtData<Scalar> *ext)
+{
+  return F * int_v<Real, Scalar>(n, wt, v);
+}
+
+// The same problem split into the real and imaginary parts by hand.
+template<typename Real, typename Scalar>
+Scalar bilinear_form_re(int n, double *wt, Func<Scalar> *u_ext[], Func<Real> *u,
+                        Func<Real> *v, Geom<Real> *e, ExtData<Scalar> *ext)
+{
+  return int_grad_u_grad_v<Real, Scalar>(n, wt, u, v) + C1.real() * int_u_v<Real, Scalar>(n, wt, u, v)
+         + C2.real() * int_dudx_v<Real, Scalar>(n, wt, u, v);
+}
+
+template<typename Real, typename Scalar>
+Scalar bilinear_form_im(int n, double *wt, Func<Scalar> *u_ext[], Func<Real> *u,
+                        Func<Real> *v, Geom<Real> *e, ExtData<Scalar> *ext)
+{
+  return C1.imag() * int_u_v<Real, Scalar>(n, wt, u, v) + C2.imag() * int_dudx_v<Real, Scalar>(n, wt, u, v);
+}
+
+template<typename Real, typename Scalar>
+Scalar bilinear_form_neg_im(int n, double *wt, Func<Scalar> *u_ext[], Func<Real> *u,
+                            Func<Real> *v, Geom<Real> *e, ExtData<Scalar> *ext)
+{
+  return -bilinear_form_im<Real, Scalar>(n, wt, u_ext, u, v, e, ext);
+}
+
+template<typename Real, typename Scalar>
+Scalar linear_form_re(int n, double *wt, Func<Scalar> *u_ext[], Func<Real> *v,
+                      Geom<Real> *e, ExtData<Scalar> *ext)
+{
+  return F.real() * int_v<Real, Scalar>(n, wt, v);
+}
+
+template<typename Real, typename Scalar>
+Scalar linear_form_im(int n, double *wt, Func<Scalar> *u_ext[], Func<Real> *v,
+                      Geom<Real> *e, ExtData<Scalar> *ext)
+{
+  return F.imag() * int_v<Real, Scalar>(n, wt, v);
+}
+
+void solve(WeakForm* wf, Tuple<Space *> spaces, Tuple<Solution *> slns)
+{
+  DiscreteProblem dp(wf, spaces, true);
+  SparseMatrix* matrix = create_matrix(matrix_solver);
+  Vector* rhs = create_vector(matrix_solver);
+  Solver* solver = create_linear_solver(matrix_solver, matrix, rhs);
+  dp.assemble(matrix, rhs);
+  if (!solver->solve()) error ("Matrix solver failed.\n");
+  Solution::vector_to_solutions(solver->get_solution(), spaces, slns);
+
+  delete solver;
+  delete matrix;
+  delete rhs;
+}
+
+int main(int argc, char* argv[])
+{
+  // Load the mesh.
+  Mesh mesh;
+  H2DReader mloader;
+  mloader.load("domain.mesh", &mesh);
+  mesh.refine_all_elements();
+  mesh.refine_all_elements();
+
+  // Complex forms, the real and imaginary parts of the DOFs interleaved.
+  H1Space space_re(&mesh, bc_types, essential_bc_values, P_INIT);
+  H1Space space_im(&mesh, bc_types, essential_bc_values, P_INIT);
+  space_re.set_dof_ordering(HERMES_DOF_NATURAL, true);
+  space_im.set_dof_ordering(HERMES_DOF_NATURAL, true);
+
+  ComplexBlockForm wf;
+  wf.add_matrix_form(0, 0, complex_callback(bilinear_form_sym), HERMES_SYM);
+  wf.add_matrix_form(0, 0, complex_callback(bilinear_form_unsym));
+  wf.add_vector_form(0, complex_callback(linear_form));
+  if (wf.get_neq() != 2) return ERR_FAILURE;
+
+  Solution sln_re, sln_im;
+  solve(&wf, Tuple<Space *>(&space_re, &space_im), Tuple<Solution *>(&sln_re, &sln_im));
+
+  // Hand-written real system.
+  H1Space ref_space_re(&mesh, bc_types, essential_bc_values, P_INIT);
+  H1Space ref_space_im(&mesh, bc_types, essential_bc_values, P_INIT);
+
+  WeakForm ref_wf(2);
+  ref_wf.add_matrix_form(0, 0, callback(bilinear_form_re));
+  ref_wf.add_matrix_form(0, 1, callback(bilinear_form_neg_im));
+  ref_wf.add_matrix_form(1, 0, callback(bilinear_form_im));
+  ref_wf.add_matrix_form(1, 1, callback(bilinear_form_re));
+  ref_wf.add_vector_form(0, callback(linear_form_re));
+  ref_wf.add_vector_form(1, callback(linear_form_im));
+
+  Solution ref_sln_re, ref_sln_im;
+  solve(&ref_wf, Tuple<Space *>(&ref_space_re, &ref_space_im), Tuple<Solution *>(&ref_sln_re, &ref_sln_im));
+
+  bool success = true;
+  double pts[4][2] = { { 0.1, 0.9 }, { -0.5, 0.5 }, { 0.5, -0.5 }, { 0.3, 0.2 } };
+  for (int i = 0; i < 4; i++)
+  {
+    double x = pts[i][0], y = pts[i][1];
+    double d_re = std::abs(sln_re.get_pt_value(x, y) - ref_sln_re.get_pt_value(x, y));
+    double d_im = std::abs(sln_im.get_pt_value(x, y) - ref_sln_im.get_pt_value(x, y));
+    info("u(%g, %g) = %g + %gi, difference %g, %g", x, y, sln_re.get_pt_value(x, y),
+         sln_im.get_pt_value(x, y), d_re, d_im);
+    if (d_re > EPS || d_im > EPS) success = false;
+  }
+
+  // the solution must not be real
+  if (std::abs(sln_im.get_pt_value(0.3, 0.2)) < 1e-6) success = false;
+
+  if (success)
+  {
+    printf("Success!\n");
+    return ERR_SUCCESS;
+  }
+  else
+  {
+    printf("Failure!\n");
+    return ERR_FAILURE;
+  }
+}
@@ -0,0 +1,139 @@
+#include "hermes2d.h"
+
+// This test makes sure that the forms written as expressions (form_expr.h) give
+// the same values and integration orders as the hand-written forms, and that the
+// block kernels agree with the kernels for a single pair of functions.
+
+const int NP = 5;               // Number of integration points.
+const double EPS = 1e-12;
+
+double k = 3.0;                 // Coefficient of the forms, read at assembling.
+
+struct Source
+{
+  template<typename Real>
+  static Real value(Real x, Real y) { return x * y + 1.0; }
+};
+
+template<typename Real>
+Real source(Real x, Real y) { return Source::value<Real>(x, y); }
+
+// Functions with values given in the integration points.
+struct TestFunc
+{
+  double val[NP], dx[NP], dy[NP];
+  Func<double> fn;
+
+  TestFunc(double a, double b) : fn(NP, 1)
+  {
+    for (int i = 0; i < NP; i++)
+    {
+      val[i] = a + b * i;
+      dx[i] = b - 0.5 * i * a;
+      dy[i] = a * b + i;
+    }
+    fn.val = val;
+    fn.dx = dx;
+    fn.dy = dy;
+  }
+};
+
+template<typename E>
+scalar eval_matrix(const FormExpr<E>&, double* wt, Func<double>* u, Func<double>* v, Geom<double>* e)
+{
+  return FormExprKernel<E>::template matrix_form<double, scalar>(NP, wt, NULL, u, v, e, NULL);
+}
+
+template<typename E>
+int order_matrix(const FormExpr<E>&, int ou, int ov)
+{
+  double fake_wt = 1.0;
+  Ord o = FormExprKernel<E>::template matrix_form<Ord, Ord>(1, &fake_wt, NULL, init_fn_ord(ou),
+                                                             init_fn_ord(ov), init_geom_ord(), NULL);
+  return o.get_order();
+}
+
+template<typename E>
+scalar eval_vector(const FormExpr<E>&, double* wt, Func<double>* v, Geom<double>* e)
+{
+  return FormExprKernel<E>::template vector_form<double, scalar>(NP, wt, NULL, v, e, NULL);
+}
+
+template<typename E>
+bool check_block(const FormExpr<E>& form, double* wt, Func<double>** fns, int n, Geom<double>* e)
+{
+  scalar** block = new_matrix<scalar>(n, n);
+  FormExprKernel<E>::matrix_block(NP, wt, NULL, fns, n, fns, n, e, NULL, block);
+  bool ok = true;
+  for (int j = 0; j < n; j++)
+    for (int l = 0; l < n; l++)
+      if (std::abs(block[j][l] - eval_matrix(form, wt, fns[j], fns[l], e)) > EPS) ok = false;
+  delete [] block;
+  return ok;
+}
+
+int main(int argc, char* argv[])
+{
+  using namespace expr;
+
+  double wt[NP], px[NP], py[NP];
+  for (int i = 0; i < NP; i++)
+  {
+    wt[i] = 0.1 * (i + 1);
+    px[i] = 0.25 * i;
+    py[i] = 1.0 - 0.125 * i;
+  }
+  Geom<double> e;
+  e.x = px;
+  e.y = py;
+
+  TestFunc fu(1.0, 2.0), fv(-0.5, 0.75), fw(2.0, -1.0);
+  Func<double>* fns[3] = { &fu.fn, &fv.fn, &fw.fn };
+
+  bool success = true;
+
+  // values
+  scalar val = eval_matrix(grad(u) * grad(v) + param<&k>() * u * v, wt, &fu.fn, &fv.fn, &e);
+  scalar ref = int_grad_u_grad_v<double, scalar>(NP, wt, &fu.fn, &fv.fn)
+               + k * int_u_v<double, scalar>(NP, wt, &fu.fn, &fv.fn);
+  info("matrix form: %g (expected %g)", std::abs(val), std::abs(ref));
+  if (std::abs(val - ref) > EPS) success = false;
+
+  val = eval_matrix(dx(u) * v - num<2>() * u * dy(v), wt, &fu.fn, &fv.fn, &e);
+  ref = int_dudx_v<double, scalar>(NP, wt, &fu.fn, &fv.fn) - 2.0 * int_u_dvdy<double, scalar>(NP, wt, &fu.fn, &fv.fn);
+  info("advection form: %g (expected %g)", std::abs(val), std::abs(ref));
+  if (std::abs(val - ref) > EPS) success = false;
+
+  val = eval_vector(coef<Source>() * v, wt, &fv.fn, &e);
+  ref = int_F_v<double, scalar>(NP, wt, source<double>, &fv.fn, &e);
+  info("vector form: %g (expected %g)", std::abs(val), std::abs(ref));
+  if (std::abs(val - ref) > EPS) success = false;
+
+  // integration orders
+  int o = order_matrix(grad(u) * grad(v) + param<&k>() * u * v, 3, 2);
+  info("order of grad(u) * grad(v) + k * u * v: %d", o);
+  if (o != 5) success = false;
+  o = order_matrix(x * u * v, 3, 2);
+  info("order of x * u * v: %d", o);
+  if (o != 6) success = false;
+
+  // blocks
+  if (!check_block(grad(u) * grad(v) + param<&k>() * u * v, wt, fns, 3, &e)) success = false;
+
+  // registration
+  WeakForm wf;
+  wf.add_matrix_form(grad(u) * grad(v) + param<&k>() * u * v, HERMES_SYM);
+  wf.add_vector_form(coef<Source>() * v);
+  wf.add_vector_form_surf(num<2>() * v, 1);
+
+  if (success)
+  {
+    printf("Success!\n");
+    return ERR_SUCCESS;
+  }
+  else
+  {
+    printf("Failure!\n");
+    return ERR_FAILURE;
+  }
+}
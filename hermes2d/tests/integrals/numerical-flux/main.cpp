@@ -0,0 +1,231 @@
+#include "hermes2d.h"
+#include "numerical_flux.h"
+
+// This test makes sure that the batched numerical fluxes of the Euler equations are
+// consistent and conservative, that the batched Vijayasundaram flux is the same as the
+// one calculated point by point, that HLLC resolves a stationary contact exactly, and
+// that the edge cache is used by the four component forms. It also reports the time
+// of the flux calculation point by point and batched.
+
+const double KAPPA = 1.4;
+const int N = 1000;
+const double EPS = 1e-10;
+
+static unsigned int seed = 12345;
+double rnd(double a, double b)
+{
+  seed = seed * 1103515245 + 12345;
+  return a + (b - a) * ((seed >> 8) & 0xffff) / 65535.0;
+}
+
+// a random subsonic state
+void random_state(double* w[4], int k)
+{
+  double rho = rnd(0.5, 2.0), u = rnd(-0.5, 0.5), v = rnd(-0.5, 0.5), p = rnd(0.5, 2.0);
+  w[0][k] = rho;
+  w[1][k] = rho * u;
+  w[2][k] = rho * v;
+  w[3][k] = p / (KAPPA - 1) + rho * (u*u + v*v) / 2;
+}
+
+// physical flux in the normal
+void normal_flux(double* w[4], int k, double nx, double ny, double f[4])
+{
+  double u = w[1][k] / w[0][k], v = w[2][k] / w[0][k];
+  double p = (KAPPA - 1) * (w[3][k] - w[0][k] * (u*u + v*v) / 2);
+  double un = u * nx + v * ny;
+  f[0] = w[0][k] * un;
+  f[1] = w[1][k] * un + p * nx;
+  f[2] = w[2][k] * un + p * ny;
+  f[3] = (w[3][k] + p) * un;
+}
+
+bool close(double a, double b)
+{
+  return fabs(a - b) <= EPS * std::max(1.0, fabs(a));
+}
+
+int main(int argc, char* argv[])
+{
+  bool success = true;
+
+  double data[16][N];
+  double *w_l[4], *w_r[4], *res[4], *res2[4];
+  for (int i = 0; i < 4; i++)
+  {
+    w_l[i] = data[i];
+    w_r[i] = data[4+i];
+    res[i] = data[8+i];
+    res2[i] = data[12+i];
+  }
+  double nx[N], ny[N], mnx[N], mny[N];
+  for (int k = 0; k < N; k++)
+  {
+    random_state(w_l, k);
+    random_state(w_r, k);
+    double a = rnd(0, 2*M_PI);
+    nx[k] = cos(a);  ny[k] = sin(a);
+    mnx[k] = -nx[k]; mny[k] = -ny[k];
+  }
+
+  NumericalFlux num_flux(KAPPA);
+
+  // the batched Vijayasundaram flux is the flux of numerical_flux()
+  num_flux.numerical_flux(N, res, w_l, w_r, nx, ny);
+  for (int k = 0; k < N; k++)
+  {
+    double wl[4] = { w_l[0][k], w_l[1][k], w_l[2][k], w_l[3][k] };
+    double wr[4] = { w_r[0][k], w_r[1][k], w_r[2][k], w_r[3][k] };
+    double flux[4];
+    num_flux.numerical_flux(flux, wl, wr, nx[k], ny[k]);
+    for (int i = 0; i < 4; i++)
+      if (!close(flux[i], res[i][k]))
+      {
+        printf("Vijayasundaram: point %d, component %d: %g <-> %g\n", k, i, flux[i], res[i][k]);
+        success = false;
+        k = N;
+        break;
+      }
+  }
+
+  const char* names[4] = { "Vijayasundaram", "HLL", "HLLC", "Lax-Friedrichs" };
+  for (int t = HERMES_FLUX_VIJAYASUNDARAM; t <= HERMES_FLUX_LAX_FRIEDRICHS; t++)
+  {
+    num_flux.set_type((NumericalFluxType) t);
+
+    // consistency: F(w, w) is the physical flux
+    num_flux.numerical_flux(N, res, w_l, w_l, nx, ny);
+    for (int k = 0; k < N; k++)
+    {
+      double f[4];
+      normal_flux(w_l, k, nx[k], ny[k], f);
+      for (int i = 0; i < 4; i++)
+        if (!close(f[i], res[i][k]))
+        {
+          printf("%s is not consistent at point %d.\n", names[t], k);
+          success = false;
+          k = N;
+          break;
+        }
+    }
+
+    // conservation: F(w_l, w_r, n) = -F(w_r, w_l, -n)
+    if (t == HERMES_FLUX_VIJAYASUNDARAM) continue;
+    num_flux.numerical_flux(N, res, w_l, w_r, nx, ny);
+    num_flux.numerical_flux(N, res2, w_r, w_l, mnx, mny);
+    for (int k = 0; k < N; k++)
+      for (int i = 0; i < 4; i++)
+        if (!close(res[i][k], -res2[i][k]))
+        {
+          printf("%s is not conservative at point %d.\n", names[t], k);
+          success = false;
+          k = N;
+          break;
+        }
+  }
+
+  // HLLC keeps a stationary contact: the flux is only the pressure
+  num_flux.set_type(HERMES_FLUX_HLLC);
+  for (int k = 0; k < N; k++)
+  {
+    w_l[0][k] = rnd(0.5, 2.0);
+    w_r[0][k] = rnd(0.5, 2.0);
+    w_l[1][k] = w_l[2][k] = w_r[1][k] = w_r[2][k] = 0.0;
+    w_l[3][k] = w_r[3][k] = 1.0 / (KAPPA - 1);
+  }
+  num_flux.numerical_flux(N, res, w_l, w_r, nx, ny);
+  for (int k = 0; k < N; k++)
+    if (!close(res[0][k], 0.0) || !close(res[1][k], nx[k]) || !close(res[2][k], ny[k]) || !close(res[3][k], 0.0))
+    {
+      printf("HLLC does not keep the contact at point %d.\n", k);
+      success = false;
+      break;
+    }
+
+  // the edge cache: the four component forms of an edge get the same flux
+  PerfCounters::enable();
+  num_flux.set_type(HERMES_FLUX_VIJAYASUNDARAM);
+  const int n = 8;
+  for (int k = 0; k < n; k++)
+  {
+    random_state(w_l, k);
+    random_state(w_r, k);
+  }
+  Func<double>* fc[4], * fn[4];
+  ExtData<double> ext;
+  ext.nf = 4;
+  ext.fn = new Func<double>*[4];
+  for (int i = 0; i < 4; i++)
+  {
+    fc[i] = new Func<double>(n, 1);
+    fn[i] = new Func<double>(n, 1);
+    fc[i]->val = w_l[i];
+    fn[i]->val = w_r[i];
+    ext.fn[i] = new DiscontinuousFunc<double>(fc[i], fn[i]);
+  }
+  Geom<double> geom;
+  geom.nx = nx;
+  geom.ny = ny;
+
+  num_flux.numerical_flux(n, res, w_l, w_r, nx, ny);
+  for (int form = 0; form < 4; form++)
+  {
+    double** flux = num_flux.get_edge_flux(n, &ext, &geom);
+    for (int k = 0; k < n; k++)
+      if (flux[form][k] != res[form][k]) success = false;
+  }
+  w_r[3][n-1] *= 1.01;
+  num_flux.get_edge_flux(n, &ext, &geom);
+  if (PerfCounters::get_count("edge_fluxes") != 3 || PerfCounters::get_misses("edge_fluxes") != 2)
+  {
+    printf("Edge cache: %ld hits, %ld misses, 3 and 2 expected.\n",
+           PerfCounters::get_count("edge_fluxes"), PerfCounters::get_misses("edge_fluxes"));
+    success = false;
+  }
+  for (int i = 0; i < 4; i++)
+  {
+    delete ext.fn[i];
+    delete fc[i];
+    delete fn[i];
+  }
+  delete [] ext.fn;
+  PerfCounters::enable(false);
+
+  // the four components point by point (as the component forms did) and batched
+  for (int k = 0; k < N; k++)
+  {
+    random_state(w_l, k);
+    random_state(w_r, k);
+  }
+  TimePeriod timer;
+  double sum = 0.0;
+  for (int rep = 0; rep < 20; rep++)
+    for (int i = 0; i < 4; i++)
+      for (int k = 0; k < N; k++)
+      {
+        double wl[4] = { w_l[0][k], w_l[1][k], w_l[2][k], w_l[3][k] };
+        double wr[4] = { w_r[0][k], w_r[1][k], w_r[2][k], w_r[3][k] };
+        sum += num_flux.numerical_flux_i(i, wl, wr, nx[k], ny[k]);
+      }
+  timer.tick();
+  double t_point = timer.last();
+  for (int rep = 0; rep < 20; rep++)
+  {
+    num_flux.numerical_flux(N, res, w_l, w_r, nx, ny);
+    for (int i = 0; i < 4; i++)
+      for (int k = 0; k < N; k++)
+        sum -= res[i][k];
+  }
+  timer.tick();
+  printf("%d fluxes: point by point %g s, batched %g s\n", 20 * N, t_point, timer.last());
+  if (fabs(sum) > 1e-6) success = false;
+
+  if (success) {
+    printf("Success!\n");
+    return ERR_SUCCESS;
+  }
+  else {
+    printf("Failure!\n");
+    return ERR_FAILURE;
+  }
+}
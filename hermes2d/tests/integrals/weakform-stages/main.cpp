@@ -0,0 +1,227 @@
+#include "hermes2d.h"
+
+// This test makes sure that the assembling stages and the lists of forms by marker
+// kept in the WeakForm give the same matrix and right-hand side as the same forms
+// with the markers checked inside, also in Newton's iterations (where the solutions
+// u_ext are new in each assembling), after a refinement of a mesh and after a form is
+// added. It also reports the time of repeated assembling.
+
+const int P = 2;
+const double EPS = 1e-12;
+
+BCType bc_types(int marker)
+{
+  return BC_NATURAL;
+}
+
+// coefficients of the forms restricted to the element markers 1, 2 and the edge marker 2
+double coef_vol(int marker) { return (marker == 1) ? 1.0 : (marker == 2) ? 2.0 : 0.0; }
+double coef_surf(int marker) { return (marker == 2) ? 1.0 : 0.0; }
+
+template<typename Real, typename Scalar>
+Scalar mass(int n, double *wt, Func<Scalar> *u_ext[], Func<Real> *u, Func<Real> *v, Geom<Real> *e, ExtData<Scalar> *ext)
+{
+  return int_u_v<Real, Scalar>(n, wt, u, v);
+}
+
+template<typename Real, typename Scalar>
+Scalar mass_2(int n, double *wt, Func<Scalar> *u_ext[], Func<Real> *u, Func<Real> *v, Geom<Real> *e, ExtData<Scalar> *ext)
+{
+  return 2.0 * int_u_v<Real, Scalar>(n, wt, u, v);
+}
+
+template<typename Real, typename Scalar>
+Scalar mass_ref(int n, double *wt, Func<Scalar> *u_ext[], Func<Real> *u, Func<Real> *v, Geom<Real> *e, ExtData<Scalar> *ext)
+{
+  return coef_vol(e->marker) * int_u_v<Real, Scalar>(n, wt, u, v);
+}
+
+template<typename Real, typename Scalar>
+Scalar laplace(int n, double *wt, Func<Scalar> *u_ext[], Func<Real> *u, Func<Real> *v, Geom<Real> *e, ExtData<Scalar> *ext)
+{
+  return int_grad_u_grad_v<Real, Scalar>(n, wt, u, v);
+}
+
+template<typename Real, typename Scalar>
+Scalar coupling(int n, double *wt, Func<Scalar> *u_ext[], Func<Real> *u, Func<Real> *v, Geom<Real> *e, ExtData<Scalar> *ext)
+{
+  return -0.5 * int_u_v<Real, Scalar>(n, wt, u, v);
+}
+
+template<typename Real, typename Scalar>
+Scalar source(int n, double *wt, Func<Scalar> *u_ext[], Func<Real> *v, Geom<Real> *e, ExtData<Scalar> *ext)
+{
+  return int_v<Real, Scalar>(n, wt, v);
+}
+
+template<typename Real, typename Scalar>
+Scalar source_ref(int n, double *wt, Func<Scalar> *u_ext[], Func<Real> *v, Geom<Real> *e, ExtData<Scalar> *ext)
+{
+  return coef_vol(e->marker) * int_v<Real, Scalar>(n, wt, v);
+}
+
+template<typename Real, typename Scalar>
+Scalar source_surf_ref(int n, double *wt, Func<Scalar> *u_ext[], Func<Real> *v, Geom<Real> *e, ExtData<Scalar> *ext)
+{
+  return coef_surf(e->marker) * int_v<Real, Scalar>(n, wt, v);
+}
+
+// the previous Newton's iteration and an external function
+template<typename Real, typename Scalar>
+Scalar residual(int n, double *wt, Func<Scalar> *u_ext[], Func<Real> *v, Geom<Real> *e, ExtData<Scalar> *ext)
+{
+  Scalar result = 0;
+  for (int i = 0; i < n; i++)
+    result += wt[i] * (u_ext[0]->val[i] * ext->fn[0]->val[i] * v->val[i]);
+  return result;
+}
+
+// The forms restricted to areas, or the same forms checking the markers.
+void add_forms(WeakForm* wf, bool ref, MeshFunction* ext)
+{
+  if (ref)
+  {
+    wf->add_matrix_form(0, 0, callback(mass_ref));
+    wf->add_vector_form(0, callback(source_ref));
+    wf->add_vector_form_surf(0, callback(source_surf_ref));
+  }
+  else
+  {
+    wf->add_matrix_form(0, 0, callback(mass), HERMES_UNSYM, 1);
+    wf->add_matrix_form(0, 0, callback(mass_2), HERMES_UNSYM, 2);
+    wf->add_vector_form(0, callback(source), 1);
+    wf->add_vector_form(0, callback(source), 2);
+    wf->add_vector_form(0, callback(source), 2);
+    wf->add_vector_form_surf(0, callback(source), 2);
+  }
+  wf->add_matrix_form(0, 0, callback(laplace));
+  wf->add_matrix_form(0, 1, callback(coupling), HERMES_SYM);
+  wf->add_matrix_form(1, 1, callback(mass));
+  wf->add_vector_form(1, callback(residual), HERMES_ANY, Tuple<MeshFunction*>(ext));
+  wf->add_vector_form_surf(1, callback(source), H2D_DG_BOUNDARY_EDGE);
+}
+
+void set_solution(Mesh* mesh, Solution* sln, double seed)
+{
+  H1Space space(mesh, bc_types, NULL, P);
+  int ndof = Space::get_num_dofs(&space);
+  scalar* vec = new scalar[ndof];
+  for (int i = 0; i < ndof; i++)
+    vec[i] = sin(seed * (i + 1));
+  Solution::vector_to_solution(vec, &space, sln);
+  delete [] vec;
+}
+
+// the matrix and right-hand side of 'dp' are kept, so that its sparse structure is reused
+UMFPackMatrix mat;
+UMFPackVector rhs;
+
+bool compare(DiscreteProblem* dp, WeakForm* wf_ref, Tuple<Space*> spaces, double seed)
+{
+  int ndof = Space::get_num_dofs(spaces);
+  scalar* coeff_vec = new scalar[ndof];
+  for (int i = 0; i < ndof; i++)
+    coeff_vec[i] = cos(seed * (i + 1));
+
+  UMFPackMatrix mat_ref;
+  UMFPackVector rhs_ref;
+  dp->assemble(coeff_vec, &mat, &rhs);
+  DiscreteProblem dp_ref(wf_ref, spaces);
+  dp_ref.assemble(coeff_vec, &mat_ref, &rhs_ref);
+  delete [] coeff_vec;
+
+  for (int i = 0; i < ndof; i++)
+  {
+    if (std::abs(rhs.get(i) - rhs_ref.get(i)) > EPS)
+    {
+      printf("Right-hand side differs at %d: %g <-> %g.\n", i, std::abs(rhs.get(i)), std::abs(rhs_ref.get(i)));
+      return false;
+    }
+    for (int j = 0; j < ndof; j++)
+      if (std::abs(mat.get(i, j) - mat_ref.get(i, j)) > EPS)
+      {
+        printf("Matrix differs at (%d, %d).\n", i, j);
+        return false;
+      }
+  }
+  return true;
+}
+
+int main(int argc, char* argv[])
+{
+  bool success = true;
+  PerfCounters::enable();
+
+  // three meshes, so that there are several stages
+  Mesh mesh1, mesh2, mesh3;
+  H2DReader mloader;
+  mloader.load("domain.mesh", &mesh1);
+  mesh1.refine_all_elements();
+  mesh2.copy(&mesh1);
+  mesh3.copy(&mesh1);
+  mesh2.refine_element(4);
+  mesh3.refine_element(9);
+
+  H1Space space1(&mesh1, bc_types, NULL, P);
+  H1Space space2(&mesh2, bc_types, NULL, P + 1);
+  Tuple<Space*> spaces(&space1, &space2);
+  Solution ext;
+  set_solution(&mesh3, &ext, 0.3);
+
+  WeakForm wf(2);
+  add_forms(&wf, false, &ext);
+  DiscreteProblem dp(&wf, spaces);
+
+  // Newton's iterations: the stages are made in the first one only
+  for (int it = 0; it < 3; it++)
+  {
+    WeakForm wf_ref(2);
+    add_forms(&wf_ref, true, &ext);
+    if (!compare(&dp, &wf_ref, spaces, 0.5 + it)) success = false;
+  }
+  long hits = PerfCounters::get_count("weakform_stages");
+  if (hits != 2)
+  {
+    printf("%ld assemblings reused the stages, 2 expected.\n", hits);
+    success = false;
+  }
+
+  // a refinement, a new external function and a new form make new stages
+  mesh1.refine_element(6);
+  space1.set_uniform_order(P);
+  Space::assign_dofs(spaces);
+  for (int k = 0; k < 3; k++)
+  {
+    if (k == 1) set_solution(&mesh1, &ext, 0.9);
+    if (k == 2) wf.add_vector_form(1, callback(source), 3);
+    WeakForm wf_ref(2);
+    add_forms(&wf_ref, true, &ext);
+    if (k == 2) wf_ref.add_vector_form(1, callback(source), 3);
+    if (!compare(&dp, &wf_ref, spaces, 1.7)) success = false;
+  }
+  if (PerfCounters::get_count("weakform_stages") != hits)
+  {
+    printf("Stages reused after a change.\n");
+    success = false;
+  }
+
+  // repeated assembling
+  int ndof = Space::get_num_dofs(spaces);
+  scalar* coeff_vec = new scalar[ndof];
+  memset(coeff_vec, 0, ndof * sizeof(scalar));
+  TimePeriod timer;
+  for (int i = 0; i < 20; i++)
+    dp.assemble(coeff_vec, &mat, &rhs);
+  timer.tick();
+  printf("20 assemblings: %g s\n", timer.last());
+  delete [] coeff_vec;
+
+  if (success) {
+    printf("Success!\n");
+    return ERR_SUCCESS;
+  }
+  else {
+    printf("Failure!\n");
+    return ERR_FAILURE;
+  }
+}
@@ -0,0 +1,117 @@
+#include "hermes2d.h"
+
+// This test makes sure that a mesh saved in the binary format (H2DBinaryReader)
+// is loaded back identical to the mesh loaded from the text format (H2DReader).
+// Both formats store the refinements so that the sons are renumbered depth-first,
+// so the reloaded meshes are compared with each other, not with the original one
+// (which is only compared by the number of elements).
+// It also prints the loading speed of both formats in elements per second.
+
+const int N = 200;   // The mesh is an N x N grid of quads.
+
+// Creates the grid on the unit square by the bulk Mesh::create().
+void create_grid(Mesh* mesh)
+{
+  int nv = (N + 1) * (N + 1), ne = N * N, nm = 4 * N;
+  double2* verts = new double2[nv];
+  int5* elems = new int5[ne];
+  int3* mark = new int3[nm];
+
+  for (int j = 0; j <= N; j++)
+    for (int i = 0; i <= N; i++)
+    {
+      verts[j*(N+1) + i][0] = (double) i / N;
+      verts[j*(N+1) + i][1] = (double) j / N;
+    }
+
+  for (int j = 0; j < N; j++)
+    for (int i = 0; i < N; i++)
+    {
+      int v = j*(N+1) + i;
+      int* e = elems[j*N + i];
+      e[0] = v;  e[1] = v + 1;  e[2] = v + N + 2;  e[3] = v + N + 1;  e[4] = 1;
+    }
+
+  int m = 0;
+  for (int i = 0; i < N; i++)
+  {
+    mark[m][0] = i;                 mark[m][1] = i + 1;                 mark[m++][2] = 1;
+    mark[m][0] = N*(N+1) + i;       mark[m][1] = N*(N+1) + i + 1;       mark[m++][2] = 2;
+    mark[m][0] = i*(N+1);           mark[m][1] = (i+1)*(N+1);           mark[m++][2] = 3;
+    mark[m][0] = i*(N+1) + N;       mark[m][1] = (i+1)*(N+1) + N;       mark[m++][2] = 4;
+  }
+
+  mesh->create(nv, verts, ne, elems, nm, mark);
+  delete [] verts;
+  delete [] elems;
+  delete [] mark;
+}
+
+bool compare(Mesh* a, Mesh* b)
+{
+  if (a->get_max_element_id() != b->get_max_element_id() ||
+      a->get_num_active_elements() != b->get_num_active_elements())
+    return false;
+
+  Element* e;
+  for_all_active_elements(e, a)
+  {
+    Element* f = b->get_element(e->id);
+    if (!f->active || f->nvert != e->nvert || f->marker != e->marker) return false;
+    for (unsigned int i = 0; i < e->nvert; i++)
+    {
+      if (fabs(e->vn[i]->x - f->vn[i]->x) > 1e-12 || fabs(e->vn[i]->y - f->vn[i]->y) > 1e-12)
+        return false;
+      if (e->en[i]->marker != f->en[i]->marker || e->en[i]->bnd != f->en[i]->bnd)
+        return false;
+    }
+  }
+  return true;
+}
+
+int main(int argc, char* argv[])
+{
+  // Create the mesh and refine some of its elements.
+  Mesh mesh;
+  create_grid(&mesh);
+  mesh.refine_element(0);
+  mesh.refine_element(N + 1, 1);
+  mesh.refine_towards_vertex(N * (N + 1) / 2, 2);
+
+  H2DReader text_loader;
+  H2DBinaryReader binary_loader;
+  text_loader.save("grid.mesh", &mesh);
+  binary_loader.save("grid.h2db", &mesh);
+
+  // Load both files.
+  TimePeriod timer;
+  Mesh text_mesh, binary_mesh;
+  text_loader.load("grid.mesh", &text_mesh);
+  double text_time = timer.tick().last();
+  binary_loader.load("grid.h2db", &binary_mesh);
+  double binary_time = timer.tick().last();
+
+  int ne = mesh.get_num_active_elements();
+  printf("text:   %g s (%g elements/s)\n", text_time, ne / std::max(text_time, 1e-9));
+  printf("binary: %g s (%g elements/s)\n", binary_time, ne / std::max(binary_time, 1e-9));
+
+  bool success = mesh.get_num_active_elements() == text_mesh.get_num_active_elements() &&
+                 compare(&text_mesh, &binary_mesh);
+
+  // A mesh reloaded from the text file keeps its numbering in the binary format.
+  Mesh reference;
+  binary_loader.save("grid.h2db", &text_mesh);
+  binary_loader.load("grid.h2db", &reference);
+  if (!compare(&text_mesh, &reference)) success = false;
+  remove("grid.mesh");
+  remove("grid.h2db");
+
+  if (success) {
+    printf("Success!\n");
+    return ERR_SUCCESS;
+  }
+  else {
+    printf("Failure!\n");
+    return ERR_FAILURE;
+  }
+}
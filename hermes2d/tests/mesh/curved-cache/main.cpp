@@ -0,0 +1,128 @@
+#include "hermes2d.h"
+
+// This test makes sure that the cached projections of curved elements are
+// the same as the ones calculated from scratch, and that the NURBS curves
+// are evaluated correctly.
+
+// reference: the recursive definition of the NURBS basis function N_i,k
+double basis_fn(int i, int k, double t, double* knot)
+{
+  if (k == 0)
+    return (t >= knot[i] && t <= knot[i+1] && knot[i] < knot[i+1]) ? 1.0 : 0.0;
+
+  double result = 0.0;
+  if (knot[i+k] != knot[i])
+    result += ((t - knot[i]) / (knot[i+k] - knot[i])) * basis_fn(i, k-1, t, knot);
+  if (knot[i+k+1] != knot[i+1])
+    result += ((knot[i+k+1] - t) / (knot[i+k+1] - knot[i+1])) * basis_fn(i+1, k-1, t, knot);
+  return result;
+}
+
+bool check_nurbs(Mesh* mesh)
+{
+  Element* e;
+  for_all_base_elements(e, mesh)
+  {
+    if (e->cm == NULL) continue;
+    for (unsigned int edge = 0; edge < e->nvert; edge++)
+    {
+      Nurbs* nurbs = e->cm->nurbs[edge];
+      if (nurbs == NULL) continue;
+      for (int k = 0; k <= 20; k++)
+      {
+        double t = -1.0 + k / 10.0;
+        double x, y;
+        nurbs_edge(e, nurbs, edge, t, x, y);
+
+        double s = (t + 1) / 2.0, sum = 0.0, rx = 0.0, ry = 0.0;
+        for (int i = 0; i < nurbs->np; i++)
+        {
+          double b = basis_fn(i, nurbs->degree, s, nurbs->kv) * nurbs->pt[i][2];
+          sum += b;
+          rx += b * nurbs->pt[i][0];
+          ry += b * nurbs->pt[i][1];
+        }
+        if (fabs(x - rx / sum) > 1e-12 || fabs(y - ry / sum) > 1e-12)
+        {
+          printf("element %d, edge %d: NURBS point differs at t = %g\n", e->id, edge, t);
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+bool same_coeffs(Mesh* mesh, Mesh* dup)
+{
+  if (mesh->get_max_element_id() != dup->get_max_element_id()) return false;
+
+  Element* e;
+  for_all_active_elements(e, mesh)
+  {
+    Element* f = dup->get_element(e->id);
+    if (!f->active || (e->cm == NULL) != (f->cm == NULL)) return false;
+    if (e->cm == NULL) continue;
+    if (e->cm->nc != f->cm->nc) return false;
+    for (int i = 0; i < e->cm->nc; i++)
+      if (e->cm->coeffs[i][0] != f->cm->coeffs[i][0] || e->cm->coeffs[i][1] != f->cm->coeffs[i][1])
+      {
+        printf("element %d: coefficient %d differs\n", e->id, i);
+        return false;
+      }
+  }
+  return true;
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc < 2)
+  {
+    printf("please input as this format: curved-cache meshfile.mesh\n");
+    return ERR_FAILURE;
+  }
+
+  Mesh mesh;
+  H2DReader mloader;
+  mloader.load(argv[1], &mesh);
+
+  if (!check_nurbs(&mesh))
+  {
+    printf("Failure!\n");
+    return ERR_FAILURE;
+  }
+
+  // projections calculated from scratch
+  mesh.refine_all_elements();
+  mesh.refine_all_elements();
+
+  // the same refinements of a copy take the projections from the cache
+  PerfCounters::enable();
+  Mesh dup;
+  dup.copy_base(&mesh);
+  dup.refine_all_elements();
+  dup.refine_all_elements();
+  long hits = PerfCounters::get_count("curved_projections");
+  printf("cached projections used: %ld\n", hits);
+
+  if (hits == 0 || !same_coeffs(&mesh, &dup))
+  {
+    printf("Failure!\n");
+    return ERR_FAILURE;
+  }
+
+  // unrefinement followed by refinement (element ids are not reused, so the
+  // same is done with both meshes)
+  mesh.unrefine_all_elements();
+  mesh.refine_all_elements();
+  dup.unrefine_all_elements();
+  dup.refine_all_elements();
+  if (!same_coeffs(&mesh, &dup))
+  {
+    printf("Failure!\n");
+    return ERR_FAILURE;
+  }
+
+  printf("Success!\n");
+  return ERR_SUCCESS;
+}
@@ -0,0 +1,104 @@
+#include "hermes2d.h"
+
+// This test makes sure that Traverse visits every active element exactly once
+// when the base elements are ordered along a space-filling curve
+// (Mesh::set_element_ordering()), and that consecutive base elements
+// of the Hilbert ordering are neighbors.
+
+const int N_BASE = 8;   // The mesh is an N_BASE x N_BASE grid of quads.
+
+bool check_traversal(Mesh* mesh)
+{
+  int n = mesh->get_max_element_id();
+  int* visited = new int[n];
+  memset(visited, 0, n * sizeof(int));
+
+  Traverse trav;
+  trav.begin(1, &mesh);
+  Element** e;
+  int cnt = 0;
+  while ((e = trav.get_next_state(NULL, NULL)) != NULL)
+  {
+    visited[e[0]->id]++;
+    cnt++;
+  }
+  trav.finish();
+
+  bool ok = (cnt == mesh->get_num_active_elements());
+  Element* a;
+  for_all_active_elements(a, mesh)
+    if (visited[a->id] != 1)
+    {
+      printf("Element %d visited %d times.\n", a->id, visited[a->id]);
+      ok = false;
+    }
+  delete [] visited;
+  return ok;
+}
+
+void centroid(Element* e, double* c)
+{
+  c[0] = c[1] = 0.0;
+  for (unsigned int i = 0; i < e->nvert; i++)
+  {
+    c[0] += e->vn[i]->x / e->nvert;
+    c[1] += e->vn[i]->y / e->nvert;
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  // Load the mesh and refine some of its elements.
+  Mesh mesh;
+  H2DReader mloader;
+  mloader.load("domain.mesh", &mesh);
+  mesh.refine_element(0);
+  mesh.refine_element(N_BASE + 1, 1);
+  mesh.refine_towards_vertex(N_BASE * (N_BASE + 1) / 2, 2);
+
+  bool success = true;
+
+  SpaceFillingCurve curves[3] = { HERMES_SFC_NONE, HERMES_SFC_MORTON, HERMES_SFC_HILBERT };
+  const char* names[3] = { "none", "Morton", "Hilbert" };
+  for (int k = 0; k < 3; k++)
+  {
+    mesh.set_element_ordering(curves[k]);
+    const int* order = mesh.get_base_element_order();
+    if ((order == NULL) != (curves[k] == HERMES_SFC_NONE))
+      success = false;
+    if (!check_traversal(&mesh))
+    {
+      printf("Traversal with the %s ordering failed.\n", names[k]);
+      success = false;
+    }
+  }
+
+  // Consecutive elements of the Hilbert curve share an edge.
+  const int* order = mesh.get_base_element_order();
+  for (int i = 1; i < mesh.get_num_base_elements(); i++)
+  {
+    double a[2], b[2];
+    centroid(mesh.get_element(order[i-1]), a);
+    centroid(mesh.get_element(order[i]), b);
+    if (std::abs(a[0] - b[0]) + std::abs(a[1] - b[1]) > 1.0 / N_BASE + 1e-12)
+    {
+      printf("Base elements %d and %d are not neighbors.\n", order[i-1], order[i]);
+      success = false;
+    }
+  }
+
+  // The ordering survives copying.
+  Mesh dup;
+  dup.copy(&mesh);
+  if (!check_traversal(&dup))
+    success = false;
+
+  if (success) {
+    printf("Success!\n");
+    return ERR_SUCCESS;
+  }
+  else {
+    printf("Failure!\n");
+    return ERR_FAILURE;
+  }
+}
@@ -0,0 +1,90 @@
+#include "hermes2d.h"
+
+// This test makes sure that the node hash tables of the mesh find every node
+// by its parents while the tables grow (uniform refinements), shrink (unrefinements)
+// and are copied, and that the probe sequences stay short. It also reports the time
+// of the refinements, which are dominated by the node searches.
+
+const int LEVELS = 7;          // Number of uniform refinements.
+const double MAX_MEAN_PROBE = 2.0;
+
+// every hashed node is found by its parents
+bool check_nodes(Mesh* mesh)
+{
+  Node* node;
+  int n = 0;
+  for_all_nodes(node, mesh)
+  {
+    if (node->p1 < 0) continue; // top-level vertices are not hashed
+    Node* found = (node->type == H2D_TYPE_VERTEX) ? mesh->peek_vertex_node(node->p1, node->p2)
+                                                  : mesh->peek_edge_node(node->p2, node->p1);
+    if (found != node)
+    {
+      printf("Node %d (parents %d, %d) not found.\n", node->id, node->p1, node->p2);
+      return false;
+    }
+    n++;
+  }
+
+  // vertices 0 and 5 are not connected
+  if (mesh->peek_edge_node(0, 5) != NULL || mesh->peek_vertex_node(0, 5) != NULL)
+    return false;
+
+  double mean;
+  int max;
+  mesh->get_probe_lengths(mean, max);
+  printf("%d nodes, %d hashed, probe length mean %g, max %d\n", mesh->get_num_nodes(), n, mean, max);
+  return mean < MAX_MEAN_PROBE;
+}
+
+int main(int argc, char* argv[])
+{
+  bool success = true;
+
+  Mesh mesh;
+  H2DReader mloader;
+  mloader.load("domain.mesh", &mesh);
+  int base_nodes = mesh.get_num_nodes();
+
+  // the refinements make the tables grow
+  TimePeriod timer;
+  for (int i = 0; i < LEVELS; i++)
+    mesh.refine_all_elements();
+  timer.tick();
+  printf("%d refinements: %g s\n", LEVELS, timer.last());
+  if (!check_nodes(&mesh)) success = false;
+
+  // a copy has the same tables
+  Mesh dup;
+  dup.copy(&mesh);
+  if (!check_nodes(&dup)) success = false;
+
+  // the unrefinements remove the nodes and make the tables shrink
+  timer.tick(HERMES_SKIP);
+  for (int i = 0; i < LEVELS; i++)
+  {
+    mesh.unrefine_all_elements();
+    if (i == LEVELS/2 && !check_nodes(&mesh)) success = false;
+  }
+  timer.tick();
+  printf("%d unrefinements: %g s\n", LEVELS, timer.last());
+  if (mesh.get_num_nodes() != base_nodes)
+  {
+    printf("%d nodes left after the unrefinements, %d expected.\n", mesh.get_num_nodes(), base_nodes);
+    success = false;
+  }
+  if (!check_nodes(&mesh)) success = false;
+
+  // the copy is independent of the original
+  dup.refine_element(dup.get_max_element_id() - 1);
+  if (!check_nodes(&dup)) success = false;
+
+  if (success) {
+    printf("Success!\n");
+    return ERR_SUCCESS;
+  }
+  else {
+    printf("Failure!\n");
+    return ERR_FAILURE;
+  }
+}
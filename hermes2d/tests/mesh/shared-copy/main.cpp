@@ -0,0 +1,113 @@
+#include "hermes2d.h"
+
+// This test makes sure that a copy of a mesh shares the nodes and elements with
+// the original until one of them is modified, that the modified mesh gets its own
+// nodes and elements while the other ones stay the same, and that the shared
+// nodes and elements survive the mesh they were copied from.
+
+// the elements and nodes of a mesh as a list of numbers
+std::vector<double> signature(Mesh* mesh)
+{
+  std::vector<double> sig;
+  Element* e;
+  for_all_elements(e, mesh)
+  {
+    sig.push_back(e->id);
+    sig.push_back(e->active);
+    sig.push_back(e->is_curved());
+    for (unsigned int i = 0; i < e->nvert; i++)
+    {
+      sig.push_back(e->vn[i]->x);
+      sig.push_back(e->vn[i]->y);
+    }
+  }
+  Node* node;
+  for_all_nodes(node, mesh)
+  {
+    sig.push_back(node->id);
+    sig.push_back(node->ref);
+    sig.push_back(node->p1);
+    sig.push_back(node->p2);
+  }
+  return sig;
+}
+
+bool check(bool ok, const char* what)
+{
+  if (!ok) printf("%s\n", what);
+  return ok;
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc < 2)
+  {
+    printf("please input as this format: shared-copy meshfile.mesh\n");
+    return ERR_FAILURE;
+  }
+
+  bool success = true;
+
+  Mesh mesh;
+  H2DReader mloader;
+  mloader.load(argv[1], &mesh);
+  mesh.refine_all_elements();
+  mesh.refine_element(mesh.get_max_element_id() - 1);
+  std::vector<double> sig = signature(&mesh);
+
+  // the copies share the elements
+  Mesh a, b;
+  a.copy(&mesh);
+  b.copy(&a);
+  success &= check(mesh.is_shared() && a.is_shared() && b.is_shared(), "The copies are not shared.");
+  success &= check(a.get_element(0) == mesh.get_element(0) && b.get_node(0) == mesh.get_node(0),
+                   "The copies have their own elements.");
+  success &= check(signature(&b) == sig, "The copy differs.");
+
+  // the refined mesh gets its own elements, the copies still share the old ones
+  mesh.refine_all_elements();
+  success &= check(!mesh.is_shared() && a.is_shared() && b.is_shared(), "The refined mesh is still shared.");
+  success &= check(signature(&a) == sig && signature(&b) == sig, "The refinement changed a copy.");
+  success &= check(a.get_seq() != mesh.get_seq(), "The refinement did not change the mesh.");
+
+  // the same with an unrefinement, after which the last copy is not shared anymore
+  a.unrefine_all_elements();
+  success &= check(!a.is_shared() && !b.is_shared(), "The unrefined mesh is still shared.");
+  success &= check(signature(&b) == sig, "The unrefinement changed a copy.");
+
+  // the last copy is refined in place, the same way as the original
+  b.refine_all_elements();
+  success &= check(signature(&b) == signature(&mesh), "The copies are refined differently.");
+
+  // the shared elements survive the mesh they were copied from, in any order
+  Mesh* src = new Mesh;
+  src->copy(&mesh);
+  Mesh* c = new Mesh;
+  c->copy(src);
+  Mesh d;
+  d.copy(c);
+  delete src;
+  delete c;
+  success &= check(signature(&d) == signature(&mesh), "The copy of a freed mesh differs.");
+  d.unrefine_all_elements();
+  mesh.unrefine_all_elements();
+  success &= check(signature(&d) == signature(&mesh), "The copies are unrefined differently.");
+
+  // a copy as cheap as it can be: a snapshot of a large mesh
+  for (int i = 0; i < 4; i++)
+    mesh.refine_all_elements();
+  TimePeriod timer;
+  Mesh snapshot;
+  snapshot.copy(&mesh);
+  timer.tick();
+  printf("copy of %d elements: %g s\n", mesh.get_num_elements(), timer.last());
+
+  if (success) {
+    printf("Success!\n");
+    return ERR_SUCCESS;
+  }
+  else {
+    printf("Failure!\n");
+    return ERR_FAILURE;
+  }
+}
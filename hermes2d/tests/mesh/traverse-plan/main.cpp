@@ -0,0 +1,246 @@
+#include "hermes2d.h"
+
+// This test makes sure that the traversal plans (and cached union meshes) give
+// the same states as the recursive multi-mesh traversal: the same elements,
+// sub-element transformations, boundary flags and function values, also when the
+// states are split into ranges, and that a refined mesh gets a new plan.
+
+const int P = 3;
+
+BCType bc_types(int marker)
+{
+  return (marker == 1) ? BC_ESSENTIAL : BC_NATURAL;
+}
+
+scalar bc_values(int marker, double x, double y)
+{
+  return x + y;
+}
+
+// one state of a traversal
+struct StateInfo
+{
+  int id[2];
+  uint64_t sub[2];
+  bool bnd[4];
+  double lo[4], hi[4];
+  int marker[4];
+};
+
+void get_states(Mesh** meshes, std::vector<StateInfo>& states, int first = 0, int last = -1)
+{
+  Transformable tr[2];
+  Transformable* fns[2] = { tr, tr + 1 };
+  Traverse trav;
+  trav.begin(2, meshes, fns);
+  if (last >= 0) trav.set_state_range(first, last);
+
+  Element** e;
+  bool bnd[4];
+  SurfPos surf_pos[4];
+  while ((e = trav.get_next_state(bnd, surf_pos)) != NULL)
+  {
+    StateInfo si;
+    memset(&si, 0, sizeof(StateInfo));
+    for (int i = 0; i < 2; i++)
+    {
+      si.id[i] = e[i]->id;
+      si.sub[i] = tr[i].get_transform();
+    }
+    for (unsigned int i = 0; i < trav.get_base()->nvert; i++)
+    {
+      if ((si.bnd[i] = bnd[i]))
+      {
+        si.lo[i] = surf_pos[i].lo;
+        si.hi[i] = surf_pos[i].hi;
+      }
+      si.marker[i] = surf_pos[i].marker;
+    }
+    states.push_back(si);
+  }
+  trav.finish();
+
+  // the Transformables are left untransformed
+  if (tr[0].get_transform() != 0 || tr[1].get_transform() != 0)
+    states.clear();
+}
+
+bool same_states(std::vector<StateInfo>& a, std::vector<StateInfo>& b)
+{
+  if (a.size() != b.size() || a.empty())
+  {
+    printf("Different number of states (%d <-> %d).\n", (int) a.size(), (int) b.size());
+    return false;
+  }
+  for (unsigned int k = 0; k < a.size(); k++)
+    if (memcmp(&a[k], &b[k], sizeof(StateInfo)))
+    {
+      printf("State %d differs.\n", k);
+      return false;
+    }
+  return true;
+}
+
+// sum of the products of the values and derivatives of two solutions over the states
+double integrate(Mesh** meshes, Solution* sln1, Solution* sln2)
+{
+  Transformable* fns[2] = { sln1, sln2 };
+  Traverse trav;
+  trav.begin(2, meshes, fns);
+  double result = 0.0;
+  while (trav.get_next_state(NULL, NULL) != NULL)
+  {
+    sln1->set_quad_order(6);
+    sln2->set_quad_order(6);
+    scalar* v1 = sln1->get_fn_values();
+    scalar* v2 = sln2->get_fn_values();
+    scalar* d1 = sln1->get_dx_values();
+    scalar* d2 = sln2->get_dy_values();
+    int np = sln1->get_quad_2d()->get_num_points(6);
+    for (int i = 0; i < np; i++)
+      result += v1[i] * v2[i] + d1[i] * d2[i];
+  }
+  trav.finish();
+  return result;
+}
+
+void set_solution(Mesh* mesh, Solution* sln, double seed)
+{
+  H1Space space(mesh, bc_types, bc_values, P);
+  int ndof = Space::get_num_dofs(&space);
+  scalar* vec = new scalar[ndof];
+  for (int i = 0; i < ndof; i++)
+    vec[i] = sin(seed * (i + 1));
+  Solution::vector_to_solution(vec, &space, sln);
+  delete [] vec;
+}
+
+bool check_meshes(Mesh** meshes)
+{
+  bool ok = true;
+
+  Traverse::set_plan_caching(false);
+  std::vector<StateInfo> ref;
+  get_states(meshes, ref);
+  Solution sln1, sln2;
+  set_solution(meshes[0], &sln1, 0.7);
+  set_solution(meshes[1], &sln2, 1.3);
+  double ref_val = integrate(meshes, &sln1, &sln2);
+
+  // the first traversal is recursive, the next ones use the plan
+  Traverse::set_plan_caching(true);
+  for (int k = 0; k < 3; k++)
+  {
+    std::vector<StateInfo> states;
+    get_states(meshes, states);
+    if (!same_states(ref, states)) ok = false;
+    double val = integrate(meshes, &sln1, &sln2);
+    if (val != ref_val)
+    {
+      printf("Integral differs: %.17g <-> %.17g.\n", val, ref_val);
+      ok = false;
+    }
+  }
+
+  // the states split into three ranges
+  std::vector<StateInfo> split;
+  int n = ref.size();
+  for (int t = 0; t < 3; t++)
+    get_states(meshes, split, n * t / 3, n * (t+1) / 3);
+  if (!same_states(ref, split)) ok = false;
+
+  return ok;
+}
+
+// compares two union meshes and their element transformations
+bool same_union(Mesh* m1, UniData** u1, Mesh* m2, UniData** u2)
+{
+  if (m1->get_num_active_elements() != m2->get_num_active_elements()) return false;
+  Element* e;
+  for_all_active_elements(e, m1)
+  {
+    Element* f = m2->get_element(e->id);
+    if (!f->active || f->vn[0]->x != e->vn[0]->x || f->vn[0]->y != e->vn[0]->y) return false;
+    for (int i = 0; i < 2; i++)
+      if (u1[i][e->id].e != u2[i][e->id].e || u1[i][e->id].idx != u2[i][e->id].idx) return false;
+  }
+  return true;
+}
+
+// the union mesh is constructed without the cache and then three times with it: the
+// second of them stores it in the cache and the third one copies it from there
+bool check_union(Mesh** meshes)
+{
+  Mesh uni[4];
+  UniData** ud[4];
+  for (int k = 0; k < 4; k++)
+  {
+    Traverse::set_plan_caching(k > 0);
+    Traverse trav;
+    trav.begin(2, meshes);
+    ud[k] = trav.construct_union_mesh(uni + k);
+    trav.finish();
+  }
+
+  bool ok = true;
+  for (int k = 1; k < 4; k++)
+    if (!same_union(uni, ud[0], uni + k, ud[k])) ok = false;
+  for (int k = 0; k < 4; k++)
+  {
+    for (int i = 0; i < 2; i++)
+      free(ud[k][i]);
+    delete [] ud[k];
+  }
+  return ok;
+}
+
+int main(int argc, char* argv[])
+{
+  bool success = true;
+  PerfCounters::enable();
+
+  Mesh mesh1, mesh2;
+  H2DReader mloader;
+  mloader.load("domain.mesh", &mesh1);
+  mesh2.copy(&mesh1);
+
+  mesh1.refine_element(0);
+  mesh1.refine_element(3);
+  mesh1.refine_element(5, 1);
+  mesh2.refine_element(0, 2);
+  mesh2.refine_element(1);
+  mesh2.refine_element(2);
+  mesh2.refine_element(9);
+
+  Mesh* meshes[2] = { &mesh1, &mesh2 };
+  if (!check_meshes(meshes)) success = false;
+  if (!check_union(meshes)) success = false;
+
+  // a refinement makes the plan obsolete
+  mesh1.refine_all_elements();
+  if (!check_meshes(meshes)) success = false;
+  if (!check_union(meshes)) success = false;
+
+  // so does a copy
+  Mesh mesh3;
+  mesh3.copy(&mesh2);
+  mesh2.copy(&mesh1);
+  meshes[1] = &mesh3;
+  if (!check_meshes(meshes)) success = false;
+
+  // the plans and union meshes were really used
+  if (PerfCounters::get_count("traverse_plans") <= 0 || PerfCounters::get_count("union_meshes") <= 0)
+  {
+    printf("No plans or union meshes were reused.\n");
+    success = false;
+  }
+
+  if (success) {
+    printf("Success!\n");
+    return ERR_SUCCESS;
+  }
+  else {
+    printf("Failure!\n");
+    return ERR_FAILURE;
+  }
+}
@@ -0,0 +1,145 @@
+#include "hermes2d.h"
+
+// This test makes sure that a mesh, a space and a solution saved into a checkpoint
+// (class Checkpoint) are restored exactly, for two time steps appended to the same
+// file, and that the restored spaces have the same DOFs (including the DOF ordering).
+
+const int P_INIT = 2;                             // Uniform polynomial degree of mesh elements.
+MatrixSolverType matrix_solver = SOLVER_UMFPACK;  // Possibilities: SOLVER_AMESOS, SOLVER_MUMPS, SOLVER_NOX,
+                                                  // SOLVER_PARDISO, SOLVER_PETSC, SOLVER_UMFPACK.
+const char* FILENAME = "checkpoint.h2dc";
+
+// Points where the solutions are compared.
+const int N_PTS = 3;
+double pts[N_PTS][2] = { { 0.3, -0.6 }, { -0.5, 0.5 }, { 0.4, 0.4 } };
+
+BCType bc_types(int marker)
+{
+  return (marker == 3) ? BC_NATURAL : BC_ESSENTIAL;
+}
+
+scalar essential_bc_values(int ess_bdy_marker, double x, double y)
+{
+  return 0;
+}
+
+template<typename Real, typename Scalar>
+Scalar bilinear_form(int n, double *wt, Func<Scalar> *u_ext[], Func<Real> *u,
+                     Func<Real> *v, Geom<Real> *e, ExtData<Scalar> *ext)
+{
+  return int_grad_u_grad_v<Real, Scalar>(n, wt, u, v);
+}
+
+template<typename Real, typename Scalar>
+Scalar linear_form(int n, double *wt, Func<Scalar> *u_ext[], Func<Real> *v,
+                   Geom<Real> *e, ExtData<Scalar> *ext)
+{
+  return int_v<Real, Scalar>(n, wt, v);
+}
+
+// Solves the problem on 'space', stores the solution values at the points 'pts'
+// and saves the result into the checkpoint.
+void solve_and_save(Checkpoint* cp, Space* space, int step, scalar* values)
+{
+  WeakForm wf;
+  wf.add_matrix_form(callback(bilinear_form), HERMES_SYM);
+  wf.add_vector_form(callback(linear_form));
+
+  bool is_linear = true;
+  DiscreteProblem dp(&wf, space, is_linear);
+  SparseMatrix* matrix = create_matrix(matrix_solver);
+  Vector* rhs = create_vector(matrix_solver);
+  Solver* solver = create_linear_solver(matrix_solver, matrix, rhs);
+  dp.assemble(matrix, rhs);
+  if (!solver->solve()) error ("Matrix solver failed.\n");
+
+  Solution sln;
+  Solution::vector_to_solution(solver->get_solution(), space, &sln);
+  for (int j = 0; j < N_PTS; j++)
+    values[j] = sln.get_pt_value(pts[j][0], pts[j][1]);
+
+  cp->save(space, solver->get_solution(), step);
+
+  delete solver;
+  delete matrix;
+  delete rhs;
+}
+
+// Restores the mesh, the space and the solution of the time step 'step' and compares them.
+bool restore_and_compare(Checkpoint* cp, int step, int ndof, scalar* values)
+{
+  Mesh mesh;
+  cp->load_mesh(&mesh, step);
+  H1Space space(&mesh, bc_types, essential_bc_values, 1);
+  cp->load_space(&space, step);
+  if (space.get_num_dofs() != ndof)
+  {
+    printf("Step %d: %d DOFs restored, %d expected.\n", step, space.get_num_dofs(), ndof);
+    return false;
+  }
+
+  Solution sln;
+  cp->load_solutions(&space, &sln, step);
+  for (int j = 0; j < N_PTS; j++)
+  {
+    scalar val = sln.get_pt_value(pts[j][0], pts[j][1]);
+    if (std::abs(val - values[j]) > 1e-12)
+    {
+      printf("Step %d: value %d differs: %g (expected %g).\n", step, j, std::abs(val), std::abs(values[j]));
+      return false;
+    }
+  }
+  return true;
+}
+
+int main(int argc, char* argv[])
+{
+  // Load the mesh.
+  Mesh mesh;
+  H2DReader mloader;
+  mloader.load("domain.mesh", &mesh);
+  mesh.refine_all_elements();
+  mesh.refine_towards_vertex(3, 2);
+
+  // Time step 0: nonuniform orders and a renumbered space.
+  H1Space space(&mesh, bc_types, essential_bc_values, P_INIT);
+  Element* e;
+  for_all_active_elements(e, &mesh)
+    if (e->id % 3 == 0)
+      space.set_element_order_internal(e->id, e->is_triangle() ? P_INIT + 1 : H2D_MAKE_QUAD_ORDER(P_INIT + 1, P_INIT + 1));
+  space.set_dof_ordering(HERMES_DOF_RCM);
+
+  scalar values0[N_PTS], values1[N_PTS];
+  Checkpoint cp;
+  cp.create(FILENAME);
+  solve_and_save(&cp, &space, 0, values0);
+  int ndof0 = space.get_num_dofs();
+  cp.close();
+
+  // Time step 1: a refined mesh, appended to the same file.
+  Mesh mesh1;
+  mesh1.copy(&mesh);
+  mesh1.refine_all_elements();
+  H1Space space1(&mesh1, bc_types, essential_bc_values, P_INIT);
+  cp.create(FILENAME, true);
+  solve_and_save(&cp, &space1, 1, values1);
+  int ndof1 = space1.get_num_dofs();
+  cp.close();
+
+  // Restore both time steps.
+  bool success = true;
+  cp.open(FILENAME);
+  if (cp.get_last_step() != 1) success = false;
+  if (!restore_and_compare(&cp, 0, ndof0, values0)) success = false;
+  if (!restore_and_compare(&cp, 1, ndof1, values1)) success = false;
+  cp.close();
+
+  if (success) {
+    printf("Success!\n");
+    return ERR_SUCCESS;
+  }
+  else {
+    printf("Failure!\n");
+    return ERR_FAILURE;
+  }
+}
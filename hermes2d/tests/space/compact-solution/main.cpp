@@ -0,0 +1,256 @@
+#include "hermes2d.h"
+#include <pthread.h>
+
+// This test makes sure that a compact Solution (which keeps the coefficients of the DOFs
+// and uses the assembly lists of the space to calculate the monomial coefficients of the
+// elements on demand, under a memory budget) has the same values as the standard one:
+// with a Dirichlet lift and hanging nodes, after multiply(), copy(), save() and load(),
+// and through SolutionEvaluators, also in several threads at once. The budget has to be kept
+// and the compact solutions have to take less memory, at least SAVING less on a fine mesh of
+// the order P_FINE (see Solution::set_memory_budget()). It also reports the memory and the
+// time of calculating a norm of both.
+
+const int P = 6;
+const int NUM_SLN = 3;                  // Number of solutions (e.g. time levels) of the space.
+const size_t BUDGET = 16 * 1024;        // Memory for the monomial coefficients of a compact solution.
+const double EPS = 1e-10;
+const int N_THREADS = 4;                // Number of threads evaluating the same compact solution.
+const int N_PTS = 200;                  // Number of points evaluated by each thread.
+const int P_FINE = 2;                   // Order of the fine mesh.
+const int FINE_REF_NUM = 5;             // Number of uniform refinements of the fine mesh.
+const double SAVING = 0.5;              // Memory saved by a compact solution on the fine mesh.
+
+BCType bc_types(int marker)
+{
+  return (marker == 1) ? BC_ESSENTIAL : BC_NATURAL;
+}
+
+scalar essential_bc_values(int ess_bdy_marker, double x, double y)
+{
+  return x * x + 1;
+}
+
+bool compare(Solution* sln, Solution* compact, const char* what)
+{
+  double n1 = calc_norm(sln, HERMES_H1_NORM);
+  double n2 = calc_norm(compact, HERMES_H1_NORM);
+  double err = calc_abs_error(sln, compact, HERMES_H1_NORM);
+  printf("%s: norms %.15g, %.15g, difference %g\n", what, n1, n2, err);
+  if (n1 == 0.0 || err > EPS * n1) return false;
+
+  double pts[3][2] = { { 0.3, 0.2 }, { 1.7, 0.6 }, { 1.1, 1.5 } };
+  for (int i = 0; i < 3; i++)
+    for (int item = 0; item < 3; item++)
+    {
+      int it = (item == 0) ? H2D_FN_VAL_0 : (item == 1) ? H2D_FN_DX_0 : H2D_FN_DY_0;
+      if (std::abs(sln->get_pt_value(pts[i][0], pts[i][1], it) - compact->get_pt_value(pts[i][0], pts[i][1], it)) > EPS)
+      {
+        printf("%s: the values at (%g, %g) differ.\n", what, pts[i][0], pts[i][1]);
+        return false;
+      }
+    }
+  return true;
+}
+
+// Data of a thread evaluating a compact solution.
+struct EvalThread
+{
+  Solution* compact;
+  double* x, * y;
+  scalar* values;
+  bool ok;
+};
+
+void* eval_thread(void* arg)
+{
+  EvalThread* et = (EvalThread*) arg;
+  SolutionEvaluator ev(et->compact);
+  et->ok = true;
+  for (int i = 0; i < N_PTS; i++)
+    if (std::abs(ev.get_pt_value(et->x[i], et->y[i]) - et->values[i]) > EPS)
+      et->ok = false;
+  return NULL;
+}
+
+int main(int argc, char* argv[])
+{
+  bool success = true;
+  PerfCounters::enable();
+
+  Mesh mesh;
+  H2DReader mloader;
+  mloader.load("domain.mesh", &mesh);
+  for (int i = 0; i < 3; i++)
+    mesh.refine_all_elements();
+  mesh.refine_element(100);
+  mesh.refine_element(mesh.get_max_element_id() - 1, 1);
+
+  H1Space space(&mesh, bc_types, essential_bc_values, P);
+  int ndof = Space::get_num_dofs(&space);
+
+  // several solutions of the same space, standard and compact
+  Solution sln[NUM_SLN], compact[NUM_SLN];
+  scalar* vec = new scalar[ndof];
+  for (int k = 0; k < NUM_SLN; k++)
+  {
+    for (int i = 0; i < ndof; i++)
+      vec[i] = sin((k + 1.3) * (i + 1));
+    Solution::vector_to_solution(vec, &space, &sln[k]);
+    compact[k].set_memory_budget(BUDGET);
+    Solution::vector_to_solution(vec, &space, &compact[k]);
+  }
+
+  for (int k = 0; k < NUM_SLN; k++)
+    if (!compare(&sln[k], &compact[k], "solution")) success = false;
+  long misses = PerfCounters::get_misses("solution_mono");
+  if (misses == 0 || PerfCounters::get_count("solution_mono") == 0)
+  {
+    printf("The monomial coefficients were not cached.\n");
+    success = false;
+  }
+
+  // the memory
+  size_t mem = 0, compact_mem = 0;
+  for (int k = 0; k < NUM_SLN; k++)
+  {
+    mem += sln[k].get_memory_usage();
+    compact_mem += compact[k].get_memory_usage();
+  }
+  printf("%d solutions, %d DOFs: standard %g kB, compact %g kB\n",
+         NUM_SLN, ndof, mem / 1024.0, compact_mem / 1024.0);
+  if (compact_mem >= mem)
+  {
+    printf("The compact solutions take too much memory.\n");
+    success = false;
+  }
+
+  // at a low order on a fine mesh the DOFs are much fewer than the monomial coefficients
+  {
+    Mesh fine_mesh;
+    mloader.load("domain.mesh", &fine_mesh);
+    for (int i = 0; i < FINE_REF_NUM; i++)
+      fine_mesh.refine_all_elements();
+    H1Space fine_space(&fine_mesh, bc_types, essential_bc_values, P_FINE);
+    int fine_ndof = Space::get_num_dofs(&fine_space);
+    scalar* fine_vec = new scalar[fine_ndof];
+    for (int i = 0; i < fine_ndof; i++)
+      fine_vec[i] = sin(1.3 * (i + 1));
+    Solution fine_sln, fine_compact;
+    fine_compact.set_memory_budget(BUDGET);
+    Solution::vector_to_solution(fine_vec, &fine_space, &fine_sln);
+    Solution::vector_to_solution(fine_vec, &fine_space, &fine_compact);
+    delete [] fine_vec;
+    size_t fine_mem = fine_sln.get_memory_usage(), fine_compact_mem = fine_compact.get_memory_usage();
+    printf("order %d, %d DOFs: standard %g kB, compact %g kB\n",
+           P_FINE, fine_ndof, fine_mem / 1024.0, fine_compact_mem / 1024.0);
+    if (fine_compact_mem > (1.0 - SAVING) * fine_mem)
+    {
+      printf("The compact solution saves less than %g %% on the fine mesh.\n", SAVING * 100);
+      success = false;
+    }
+  }
+
+  // the budget is kept: the elements are dropped and calculated again, but with a large
+  // budget they are calculated once
+  Solution bare, large;
+  bare.set_memory_budget(BUDGET);
+  large.set_memory_budget(1 << 30);
+  Solution::vector_to_solution(vec, &space, &bare);
+  Solution::vector_to_solution(vec, &space, &large);
+  size_t held = compact[NUM_SLN-1].get_memory_usage() - bare.get_memory_usage();
+  if (held > BUDGET + 256 * 1024)
+  {
+    printf("The budget was exceeded: %g kB held.\n", held / 1024.0);
+    success = false;
+  }
+  calc_norm(&large, HERMES_H1_NORM);
+  misses = PerfCounters::get_misses("solution_mono");
+  calc_norm(&large, HERMES_H1_NORM);
+  if (PerfCounters::get_misses("solution_mono") != misses)
+  {
+    printf("The monomial coefficients were calculated again.\n");
+    success = false;
+  }
+  calc_norm(&bare, HERMES_H1_NORM);
+  misses = PerfCounters::get_misses("solution_mono");
+  calc_norm(&bare, HERMES_H1_NORM);
+  if (PerfCounters::get_misses("solution_mono") == misses)
+  {
+    printf("The monomial coefficients were not dropped.\n");
+    success = false;
+  }
+  delete [] vec;
+
+  // multiply, copy, save and load
+  sln[1].multiply(-2.0);
+  compact[1].multiply(-2.0);
+  if (!compare(&sln[1], &compact[1], "multiplied")) success = false;
+  Solution copy;
+  copy.copy(&compact[1]);
+  if (!compare(&sln[1], &copy, "copied")) success = false;
+  compact[2].save("compact.sln", false);
+  Solution loaded;
+  loaded.load("compact.sln");
+  if (!compare(&sln[2], &loaded, "loaded")) success = false;
+
+  // an evaluator of the compact solution
+  SolutionEvaluator ev(&compact[0]);
+  for (int i = 0; i < 10; i++)
+  {
+    double x = 0.1 + 0.18 * i, y = 0.05 + 0.09 * i;
+    if (std::abs(ev.get_pt_value(x, y) - sln[0].get_pt_value(x, y)) > EPS)
+    {
+      printf("The evaluator differs at (%g, %g).\n", x, y);
+      success = false;
+    }
+  }
+
+  // several threads evaluating the same compact solution, each with its own evaluator
+  double x[N_PTS], y[N_PTS];
+  scalar values[N_PTS];
+  for (int i = 0; i < N_PTS; i++)
+  {
+    x[i] = 0.01 + 1.98 * ((i * 37) % N_PTS) / N_PTS;
+    y[i] = 0.01 + 0.98 * ((i * 53) % N_PTS) / N_PTS;
+    values[i] = sln[0].get_pt_value(x[i], y[i]);
+  }
+  pthread_t threads[N_THREADS];
+  EvalThread et[N_THREADS];
+  for (int t = 0; t < N_THREADS; t++)
+  {
+    et[t].compact = &compact[0];
+    et[t].x = x;
+    et[t].y = y;
+    et[t].values = values;
+    pthread_create(&threads[t], NULL, eval_thread, &et[t]);
+  }
+  for (int t = 0; t < N_THREADS; t++)
+  {
+    pthread_join(threads[t], NULL);
+    if (!et[t].ok)
+    {
+      printf("The evaluator in thread %d differs.\n", t);
+      success = false;
+    }
+  }
+
+  // the norms of both
+  TimePeriod timer;
+  for (int i = 0; i < 10; i++)
+    calc_norm(&sln[0], HERMES_H1_NORM);
+  timer.tick();
+  double t_sln = timer.last();
+  for (int i = 0; i < 10; i++)
+    calc_norm(&compact[0], HERMES_H1_NORM);
+  timer.tick();
+  printf("10 norms: standard %g s, compact %g s\n", t_sln, timer.last());
+
+  if (success) {
+    printf("Success!\n");
+    return ERR_SUCCESS;
+  }
+  else {
+    printf("Failure!\n");
+    return ERR_FAILURE;
+  }
+}
@@ -0,0 +1,250 @@
+#include "hermes2d.h"
+
+// This test makes sure that the DOF renumbering strategies (Space::set_dof_ordering())
+// do not change the solution of a scalar problem and of coupled two-field systems, and
+// that the interleaved RCM ordering of an H1 and an L2 field keeps the bandwidth of the
+// coupled matrix close to the sum of the bandwidths of the fields.
+// It also serves as a benchmark: for every ordering it prints the matrix bandwidth,
+// the time of the sparse matrix-vector product and the time of the solve. The matrix
+// is read through the generic SparseMatrix interface, so any solver can be used.
+
+const int INIT_REF_NUM = 4;                       // Number of initial uniform mesh refinements.
+const int P_INIT = 3;                             // Uniform polynomial degree of mesh elements.
+const int SPMV_REPEAT = 100;                      // Number of repeated matrix-vector products.
+MatrixSolverType matrix_solver = SOLVER_UMFPACK;  // Possibilities: SOLVER_UMFPACK, SOLVER_PETSC,
+                                                  // SOLVER_MUMPS, and more are coming.
+
+// Points where the solutions are compared.
+const int N_PTS = 3;
+double pts[N_PTS][2] = { { 0.3, -0.6 }, { -0.5, 0.5 }, { 0.4, 0.4 } };
+
+BCType bc_types(int marker)
+{
+  return (marker == 3) ? BC_NATURAL : BC_ESSENTIAL;
+}
+
+scalar essential_bc_values(int ess_bdy_marker, double x, double y)
+{
+  return 0;
+}
+
+template<typename Real, typename Scalar>
+Scalar bilinear_form(int n, double *wt, Func<Scalar> *u_ext[], Func<Real> *u,
+                     Func<Real> *v, Geom<Real> *e, ExtData<Scalar> *ext)
+{
+  return int_grad_u_grad_v<Real, Scalar>(n, wt, u, v);
+}
+
+template<typename Real, typename Scalar>
+Scalar bilinear_form_coupling(int n, double *wt, Func<Scalar> *u_ext[], Func<Real> *u,
+                              Func<Real> *v, Geom<Real> *e, ExtData<Scalar> *ext)
+{
+  return -0.5 * int_u_v<Real, Scalar>(n, wt, u, v);
+}
+
+template<typename Real, typename Scalar>
+Scalar mass_form(int n, double *wt, Func<Scalar> *u_ext[], Func<Real> *u,
+                 Func<Real> *v, Geom<Real> *e, ExtData<Scalar> *ext)
+{
+  return int_u_v<Real, Scalar>(n, wt, u, v);
+}
+
+template<typename Real, typename Scalar>
+Scalar linear_form(int n, double *wt, Func<Scalar> *u_ext[], Func<Real> *v,
+                   Geom<Real> *e, ExtData<Scalar> *ext)
+{
+  return int_v<Real, Scalar>(n, wt, v);
+}
+
+// Assembles and solves the problem, prints the benchmark data and stores
+// the solution values at the points 'pts'. Returns the bandwidth of the matrix.
+int solve(WeakForm* wf, Tuple<Space *> spaces, const char* name, scalar* values)
+{
+  bool is_linear = true;
+  DiscreteProblem dp(wf, spaces, is_linear);
+
+  SparseMatrix* matrix = create_matrix(matrix_solver);
+  Vector* rhs = create_vector(matrix_solver);
+  Solver* solver = create_linear_solver(matrix_solver, matrix, rhs);
+  dp.assemble(matrix, rhs);
+  int ndof = Space::get_num_dofs(spaces);
+  if (matrix->get_size() != ndof) error("Wrong matrix size.");
+
+  // The matrix in the compressed row format. Only the entries of DOFs coupled through
+  // an element can be nonzero, they are found from the assembly lists and read by get().
+  std::vector<int>* pattern = new std::vector<int>[ndof];
+  std::vector<int> dofs;
+  AsmList al;
+  Element* e;
+  for_all_active_elements(e, spaces[0]->get_mesh())
+  {
+    dofs.clear();
+    for (int i = 0; i < spaces.size(); i++)
+    {
+      spaces[i]->get_element_assembly_list(e, &al);
+      for (int j = 0; j < al.cnt; j++)
+        if (al.dof[j] >= 0) dofs.push_back(al.dof[j]);
+    }
+    for (unsigned int i = 0; i < dofs.size(); i++)
+      for (unsigned int j = 0; j < dofs.size(); j++)
+        pattern[dofs[i]].push_back(dofs[j]);
+  }
+  std::vector<int> row_ptr(ndof + 1, 0), col_idx;
+  std::vector<scalar> entries;
+  int bandwidth = 0;
+  for (int i = 0; i < ndof; i++)
+  {
+    std::sort(pattern[i].begin(), pattern[i].end());
+    pattern[i].erase(std::unique(pattern[i].begin(), pattern[i].end()), pattern[i].end());
+    for (unsigned int k = 0; k < pattern[i].size(); k++)
+    {
+      int j = pattern[i][k];
+      scalar val = matrix->get(i, j);
+      if (val == 0.0) continue;
+      col_idx.push_back(j);
+      entries.push_back(val);
+      bandwidth = std::max(bandwidth, std::abs(i - j));
+    }
+    row_ptr[i + 1] = (int) col_idx.size();
+  }
+  delete [] pattern;
+
+  // Sparse matrix-vector product.
+  scalar* x = new scalar[ndof];
+  scalar* y = new scalar[ndof];
+  for (int i = 0; i < ndof; i++) x[i] = 1.0;
+  TimePeriod spmv_time;
+  for (int r = 0; r < SPMV_REPEAT; r++)
+    for (int i = 0; i < ndof; i++)
+    {
+      scalar sum = 0.0;
+      for (int k = row_ptr[i]; k < row_ptr[i + 1]; k++)
+        sum += entries[k] * x[col_idx[k]];
+      y[i] = sum;
+    }
+  spmv_time.tick();
+
+  // Factorization and solution.
+  TimePeriod solve_time;
+  if (!solver->solve()) error ("Matrix solver failed.\n");
+  solve_time.tick();
+
+  printf("%-12s ndof = %6d, bandwidth = %6d, spmv = %8.3f ms, solve = %8.3f ms\n", name, ndof,
+         bandwidth, spmv_time.accumulated() * 1000.0 / SPMV_REPEAT,
+         solve_time.accumulated() * 1000.0);
+
+  for (int i = 0; i < spaces.size(); i++)
+  {
+    Solution sln;
+    Solution::vector_to_solution(solver->get_solution(), spaces[i], &sln);
+    for (int j = 0; j < N_PTS; j++)
+      values[i * N_PTS + j] = sln.get_pt_value(pts[j][0], pts[j][1]);
+  }
+
+  delete [] x;
+  delete [] y;
+  delete solver;
+  delete matrix;
+  delete rhs;
+  return bandwidth;
+}
+
+bool compare(scalar* values, scalar* ref, int n)
+{
+  for (int i = 0; i < n; i++)
+    if (std::abs(values[i] - ref[i]) > 1e-10)
+    {
+      printf("Value %d differs: %g (reference %g).\n", i, std::abs(values[i]), std::abs(ref[i]));
+      return false;
+    }
+  return true;
+}
+
+int main(int argc, char* argv[])
+{
+  // Load the mesh.
+  Mesh mesh;
+  H2DReader mloader;
+  mloader.load("domain.mesh", &mesh);
+  for (int i = 0; i < INIT_REF_NUM; i++) mesh.refine_all_elements();
+
+  const int N_ORD = 3;
+  DofOrdering orderings[N_ORD] = { HERMES_DOF_NATURAL, HERMES_DOF_RCM, HERMES_DOF_ND };
+  const char* names[N_ORD] = { "natural", "RCM", "ND" };
+
+  bool success = true;
+
+  // Scalar problem.
+  H1Space space(&mesh, bc_types, essential_bc_values, P_INIT);
+  WeakForm wf;
+  wf.add_matrix_form(callback(bilinear_form), HERMES_SYM);
+  wf.add_vector_form(callback(linear_form));
+
+  scalar ref[N_PTS], values[N_PTS];
+  int bandwidth[N_ORD];
+  for (int k = 0; k < N_ORD; k++)
+  {
+    space.set_dof_ordering(orderings[k]);
+    bandwidth[k] = solve(&wf, &space, names[k], k ? values : ref);
+    if (k && !compare(values, ref, N_PTS)) success = false;
+  }
+
+  // Coupled system, with and without interleaving of the fields.
+  H1Space u_space(&mesh, bc_types, essential_bc_values, P_INIT);
+  H1Space v_space(&mesh, bc_types, essential_bc_values, P_INIT);
+  WeakForm wf2(2);
+  wf2.add_matrix_form(0, 0, callback(bilinear_form), HERMES_SYM);
+  wf2.add_matrix_form(0, 1, callback(bilinear_form_coupling), HERMES_SYM);
+  wf2.add_matrix_form(1, 1, callback(bilinear_form), HERMES_SYM);
+  wf2.add_vector_form(0, callback(linear_form));
+  wf2.add_vector_form(1, callback(linear_form));
+
+  scalar ref2[2*N_PTS], values2[2*N_PTS];
+  char name[32];
+  for (int interleave = 0; interleave < 2; interleave++)
+  {
+    for (int k = 0; k < N_ORD; k++)
+    {
+      u_space.set_dof_ordering(orderings[k], interleave != 0);
+      v_space.set_dof_ordering(orderings[k], interleave != 0);
+      sprintf(name, "%s%s", names[k], interleave ? "+il" : "");
+      bool first = (k == 0 && interleave == 0);
+      solve(&wf2, Tuple<Space *>(&u_space, &v_space), name, first ? ref2 : values2);
+      if (!first && !compare(values2, ref2, 2*N_PTS)) success = false;
+    }
+  }
+
+  // An H1 and an L2 field, as the velocity and the pressure. The L2 DOFs are coupled only
+  // within the elements, their own RCM ordering is not a sweep across the domain.
+  H1Space w_space(&mesh, bc_types, essential_bc_values, P_INIT);
+  L2Space q_space(&mesh, P_INIT - 1);
+  WeakForm wf3(2);
+  wf3.add_matrix_form(0, 0, callback(bilinear_form), HERMES_SYM);
+  wf3.add_matrix_form(0, 1, callback(bilinear_form_coupling), HERMES_SYM);
+  wf3.add_matrix_form(1, 1, callback(mass_form), HERMES_SYM);
+  wf3.add_vector_form(0, callback(linear_form));
+  wf3.add_vector_form(1, callback(linear_form));
+
+  scalar ref3[2*N_PTS], values3[2*N_PTS];
+  solve(&wf3, Tuple<Space *>(&w_space, &q_space), "H1-L2", ref3);
+  w_space.set_dof_ordering(HERMES_DOF_RCM, true);
+  q_space.set_dof_ordering(HERMES_DOF_RCM, true);
+  int bandwidth_il = solve(&wf3, Tuple<Space *>(&w_space, &q_space), "H1-L2 RCM+il", values3);
+  if (!compare(values3, ref3, 2*N_PTS)) success = false;
+  // the L2 DOFs follow the sweep of the H1 field and widen its band by their share of the DOFs
+  int ndof_w = w_space.get_num_dofs(), ndof_q = q_space.get_num_dofs();
+  if (bandwidth_il > 1.1 * bandwidth[1] * (ndof_w + ndof_q) / ndof_w)
+  {
+    printf("The interleaved H1-L2 bandwidth %d is too large.\n", bandwidth_il);
+    success = false;
+  }
+
+  if (success) {
+    printf("Success!\n");
+    return ERR_SUCCESS;
+  }
+  else {
+    printf("Failure!\n");
+    return ERR_FAILURE;
+  }
+}
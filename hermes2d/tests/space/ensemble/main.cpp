@@ -0,0 +1,143 @@
+#include "hermes2d.h"
+
+// This test makes sure that the solutions of an ensemble (class Ensemble), solved
+// by several threads or with a shared matrix, are the same as the solutions of the
+// instances solved one by one.
+
+const int P_INIT = 3;                             // Uniform polynomial degree of mesh elements.
+const int N_INSTANCES = 7;                        // Number of instances of the problem.
+const int N_THREADS = 3;                          // Number of threads solving the ensemble.
+MatrixSolverType matrix_solver = SOLVER_UMFPACK;  // Possibilities: SOLVER_AMESOS, SOLVER_MUMPS, SOLVER_NOX,
+                                                  // SOLVER_PARDISO, SOLVER_PETSC, SOLVER_UMFPACK.
+const double EPS = 1e-10;
+
+// Coefficients of the current instance.
+double conductivity = 1.0;
+double source = 1.0;
+double bc_value = 0.0;
+
+void set_instance(int i, void* data)
+{
+  conductivity = 1.0 + i;
+  source = 2.0 - 0.5 * i;
+  bc_value = 0.1 * i;
+}
+
+// Only the source changes.
+void set_source(int i, void* data)
+{
+  conductivity = 1.0;
+  source = 1.0 + i;
+  bc_value = 0.0;
+}
+
+BCType bc_types(int marker)
+{
+  return (marker == 3) ? BC_NATURAL : BC_ESSENTIAL;
+}
+
+scalar essential_bc_values(int ess_bdy_marker, double x, double y)
+{
+  return bc_value;
+}
+
+template<typename Real, typename Scalar>
+Scalar bilinear_form(int n, double *wt, Func<Scalar> *u_ext[], Func<Real> *u,
+                     Func<Real> *v, Geom<Real> *e, ExtData<Scalar> *ext)
+{
+  return conductivity * int_grad_u_grad_v<Real, Scalar>(n, wt, u, v);
+}
+
+template<typename Real, typename Scalar>
+Scalar linear_form(int n, double *wt, Func<Scalar> *u_ext[], Func<Real> *v,
+                   Geom<Real> *e, ExtData<Scalar> *ext)
+{
+  return source * int_v<Real, Scalar>(n, wt, v);
+}
+
+// Solves the current instance without the ensemble.
+void solve_instance(WeakForm* wf, Space* space, scalar* coeff_vec)
+{
+  update_essential_bc_values(space);
+  DiscreteProblem dp(wf, space, true);
+  SparseMatrix* matrix = create_matrix(matrix_solver);
+  Vector* rhs = create_vector(matrix_solver);
+  Solver* solver = create_linear_solver(matrix_solver, matrix, rhs);
+  dp.assemble(matrix, rhs);
+  if (!solver->solve()) error ("Matrix solver failed.\n");
+  memcpy(coeff_vec, solver->get_solution(), dp.get_num_dofs() * sizeof(scalar));
+
+  delete solver;
+  delete matrix;
+  delete rhs;
+}
+
+bool check(Ensemble* ens, WeakForm* wf, Space* space, Ensemble::instance_callback_t fn)
+{
+  int ndof = Space::get_num_dofs(space);
+  scalar* ref = new scalar[ndof];
+  Solution sln, ref_sln;
+  bool ok = true;
+  for (int i = 0; i < N_INSTANCES; i++)
+  {
+    fn(i, NULL);
+    solve_instance(wf, space, ref);
+    Solution::vector_to_solution(ref, space, &ref_sln);
+
+    double diff = 0.0;
+    scalar* coeff_vec = ens->get_coeff_vector(i);
+    for (int j = 0; j < ndof; j++)
+      diff = std::max(diff, std::abs(coeff_vec[j] - ref[j]));
+
+    // the solution includes the Dirichlet lift of the instance
+    ens->get_solution(i, &sln);
+    double val_diff = std::abs(sln.get_pt_value(0.1, 0.9) - ref_sln.get_pt_value(0.1, 0.9));
+
+    info("instance %d: difference %g, value difference %g", i, diff, val_diff);
+    if (diff > EPS || val_diff > EPS) ok = false;
+  }
+  delete [] ref;
+  return ok;
+}
+
+int main(int argc, char* argv[])
+{
+  // Load the mesh.
+  Mesh mesh;
+  H2DReader mloader;
+  mloader.load("domain.mesh", &mesh);
+  mesh.refine_all_elements();
+  mesh.refine_all_elements();
+  H1Space space(&mesh, bc_types, essential_bc_values, P_INIT);
+
+  WeakForm wf;
+  wf.add_matrix_form(callback(bilinear_form), HERMES_SYM);
+  wf.add_vector_form(callback(linear_form));
+
+  bool success = true;
+
+  // Different matrices, solved by several threads.
+  Ensemble ens(&wf, &space, matrix_solver);
+  ens.set_instance_callback(set_instance);
+  if (!ens.solve(N_INSTANCES, N_THREADS)) success = false;
+  if (ens.get_num_instances() != N_INSTANCES || ens.get_num_dofs() != Space::get_num_dofs(&space)) success = false;
+  if (!check(&ens, &wf, &space, set_instance)) success = false;
+
+  // The same matrix, different right-hand sides.
+  Ensemble ens_rhs(&wf, &space, matrix_solver);
+  ens_rhs.set_instance_callback(set_source);
+  ens_rhs.set_shared_matrix();
+  if (!ens_rhs.solve(N_INSTANCES)) success = false;
+  if (!check(&ens_rhs, &wf, &space, set_source)) success = false;
+
+  if (success)
+  {
+    printf("Success!\n");
+    return ERR_SUCCESS;
+  }
+  else
+  {
+    printf("Failure!\n");
+    return ERR_FAILURE;
+  }
+}
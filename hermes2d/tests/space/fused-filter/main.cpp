@@ -0,0 +1,120 @@
+#include "hermes2d.h"
+
+// This test makes sure that a FusedFilter gives the same values as the chain of
+// SimpleFilters it was made of (also on different meshes and with a filter used
+// twice in the chain), and that a graph built directly works as well. It also
+// reports the time of calculating a norm of both.
+
+const int P = 3;
+const double EPS = 1e-12;
+
+BCType bc_types(int marker)
+{
+  return BC_NATURAL;
+}
+
+void set_solution(Mesh* mesh, Solution* sln, double seed)
+{
+  H1Space space(mesh, bc_types, NULL, P);
+  int ndof = Space::get_num_dofs(&space);
+  scalar* vec = new scalar[ndof];
+  for (int i = 0; i < ndof; i++)
+    vec[i] = sin(seed * (i + 1));
+  Solution::vector_to_solution(vec, &space, sln);
+  delete [] vec;
+}
+
+void product_fn(int n, Tuple<scalar*> values, scalar* result)
+{
+  for (int i = 0; i < n; i++)
+    result[i] = values[0][i] * values[1][i];
+}
+
+bool compare(MeshFunction* f1, MeshFunction* f2, const char* what)
+{
+  double n1 = calc_norm(f1, HERMES_L2_NORM);
+  double n2 = calc_norm(f2, HERMES_L2_NORM);
+  double err = calc_abs_error(f1, f2, HERMES_L2_NORM);
+  printf("%s: norms %.15g, %.15g, difference %g\n", what, n1, n2, err);
+  if (n1 == 0.0 || err > EPS * n1) return false;
+
+  double pts[3][2] = { { 0.3, 0.2 }, { 1.7, 0.6 }, { 1.1, 1.5 } };
+  for (int i = 0; i < 3; i++)
+    if (fabs(f1->get_pt_value(pts[i][0], pts[i][1]) - f2->get_pt_value(pts[i][0], pts[i][1])) > EPS)
+    {
+      printf("%s: the values at (%g, %g) differ.\n", what, pts[i][0], pts[i][1]);
+      return false;
+    }
+  return true;
+}
+
+int main(int argc, char* argv[])
+{
+  bool success = true;
+
+  Mesh mesh1, mesh2;
+  H2DReader mloader;
+  mloader.load("domain.mesh", &mesh1);
+  mesh1.refine_all_elements();
+  mesh2.copy(&mesh1);
+  mesh1.refine_element(4);
+  mesh2.refine_element(7, 1);
+
+  Solution u1, u2, v1, v2;
+  set_solution(&mesh1, &u1, 0.7);
+  set_solution(&mesh1, &u2, 1.3);
+  set_solution(&mesh2, &v1, 2.1);
+  set_solution(&mesh2, &v2, 0.4);
+
+  // |(u1 - u2, v1 - v2)| + (u1 - u2)^2, with 'du' used twice
+  DiffFilter du(Tuple<MeshFunction*>(&u1, &u2));
+  DiffFilter dv(Tuple<MeshFunction*>(&v1, &v2));
+  MagFilter mag(Tuple<MeshFunction*>(&du, &dv));
+  SquareFilter sq((Tuple<MeshFunction*>(&du)));
+  SumFilter sum(Tuple<MeshFunction*>(&mag, &sq));
+
+  FusedFilter fused(&sum);
+  if (fused.get_num_steps() != 5)
+  {
+    printf("%d steps fused, 5 expected.\n", fused.get_num_steps());
+    success = false;
+  }
+  if (!compare(&sum, &fused, "chain")) success = false;
+
+  // derivatives of the inputs
+  MagFilter grad(Tuple<MeshFunction*>(&u1, &u1), Tuple<int>(H2D_FN_DX_0, H2D_FN_DY_0));
+  FusedFilter fused_grad(&grad);
+  if (!compare(&grad, &fused_grad, "gradient")) success = false;
+
+  // a graph without intermediate filters: u1 * v1^2 * u1, which is (u1 * v1)^2
+  FusedFilter direct;
+  int a = direct.add_input(&u1), b = direct.add_input(&v1);
+  if (direct.add_input(&u1) != a) success = false;
+  int c = direct.add_step(product_fn, Tuple<int>(b, b));
+  int d = direct.add_step(product_fn, Tuple<int>(a, c));
+  direct.add_step(product_fn, Tuple<int>(d, a));
+  direct.init();
+  SimpleFilter prod(product_fn, Tuple<MeshFunction*>(&u1, &v1));
+  SquareFilter expected((Tuple<MeshFunction*>(&prod)));
+  if (!compare(&expected, &direct, "direct")) success = false;
+
+  // the norms of the chain and of the fused filter
+  TimePeriod timer;
+  for (int i = 0; i < 10; i++)
+    calc_norm(&sum, HERMES_L2_NORM);
+  timer.tick();
+  double t_chain = timer.last();
+  for (int i = 0; i < 10; i++)
+    calc_norm(&fused, HERMES_L2_NORM);
+  timer.tick();
+  printf("10 norms: chain %g s, fused %g s\n", t_chain, timer.last());
+
+  if (success) {
+    printf("Success!\n");
+    return ERR_SUCCESS;
+  }
+  else {
+    printf("Failure!\n");
+    return ERR_FAILURE;
+  }
+}
@@ -0,0 +1,150 @@
+#include "hermes2d.h"
+
+// This test makes sure that OGProjection::project_local() reproduces polynomials
+// (also with hanging nodes, Dirichlet boundaries, L2 spaces and a source defined on
+// another mesh), gives the same result on several threads, and converges for a
+// smooth function.
+
+const int P = 3;               // Polynomial degree of the elements.
+const double TOL = 1e-10;
+
+// A polynomial of degree P.
+scalar poly(double x, double y, scalar& dx, scalar& dy)
+{
+  dx = 3*x*x - 2*y*y;
+  dy = -4*x*y + 2*y;
+  return x*x*x - 2*x*y*y + y*y - 1;
+}
+
+scalar poly_bc(int marker, double x, double y)
+{
+  scalar dx, dy;
+  return poly(x, y, dx, dy);
+}
+
+scalar smooth(double x, double y, scalar& dx, scalar& dy)
+{
+  dx = cos(x) * exp(y);
+  dy = sin(x) * exp(y);
+  return sin(x) * exp(y);
+}
+
+BCType bc_types(int marker)
+{
+  return (marker == 1) ? BC_ESSENTIAL : BC_NATURAL;
+}
+
+// maximum difference between the solution and the exact function in the quadrature points
+double max_error(Mesh* mesh, Solution* sln, ExactFunction fn)
+{
+  double err = 0.0;
+  Element* e;
+  SolutionEvaluator ev(sln);
+  for_all_active_elements(e, mesh)
+  {
+    ev.set_active_element(e);
+    double3* pt = g_quad_2d_std.get_points(6, e->get_mode());
+    for (int i = 0; i < g_quad_2d_std.get_num_points(6, e->get_mode()); i++)
+    {
+      double x, y;
+      scalar dx, dy;
+      ev.get_phys_point(pt[i][0], pt[i][1], x, y);
+      err = std::max(err, (double) std::abs(ev.get_ref_value(pt[i][0], pt[i][1]) - fn(x, y, dx, dy)));
+    }
+  }
+  return err;
+}
+
+int main(int argc, char* argv[])
+{
+  bool success = true;
+
+  // Mesh with hanging nodes of several levels.
+  Mesh mesh;
+  H2DReader mloader;
+  mloader.load("domain.mesh", &mesh);
+  mesh.refine_element(0);
+  mesh.refine_element(5);
+  mesh.refine_element(2);
+
+  // Polynomials are reproduced exactly.
+  H1Space space(&mesh, bc_types, poly_bc, P);
+  int ndof = Space::get_num_dofs(&space);
+  scalar* vec = new scalar[ndof];
+  OGProjection::project_local(&space, HERMES_H1_NORM, poly, &mesh, vec);
+  Solution sln;
+  Solution::vector_to_solution(vec, &space, &sln);
+  double err = max_error(&mesh, &sln, poly);
+  info("H1 space, H1 norm: error %g", err);
+  if (err > TOL) success = false;
+
+  // The same result on several threads.
+  Solution exact(&mesh, poly);
+  scalar* vec3 = new scalar[ndof];
+  OGProjection::set_num_threads(3);
+  OGProjection::project_local(&space, &exact, vec3, HERMES_L2_NORM);
+  OGProjection::set_num_threads(1);
+  scalar* vec1 = new scalar[ndof];
+  OGProjection::project_local(&space, &exact, vec1, HERMES_L2_NORM);
+  for (int i = 0; i < ndof; i++)
+    if (vec1[i] != vec3[i]) success = false;
+  Solution::vector_to_solution(vec1, &space, &sln);
+  err = max_error(&mesh, &sln, poly);
+  info("H1 space, L2 norm: error %g", err);
+  if (err > TOL) success = false;
+  delete [] vec1;
+  delete [] vec3;
+
+  // Transfer of a solution to another mesh.
+  Solution::vector_to_solution(vec, &space, &sln);
+  Mesh mesh2;
+  mesh2.copy_base(&mesh);
+  mesh2.refine_all_elements();
+  mesh2.refine_element(4);
+  H1Space space2(&mesh2, bc_types, poly_bc, P);
+  Solution sln2;
+  OGProjection::project(&space2, &sln, &sln2, SOLVER_UMFPACK, HERMES_H1_NORM, true);
+  err = max_error(&mesh2, &sln2, poly);
+  info("transfer to another mesh: error %g", err);
+  if (err > TOL) success = false;
+
+  // L2 space.
+  L2Space l2_space(&mesh, P);
+  scalar* l2_vec = new scalar[Space::get_num_dofs(&l2_space)];
+  OGProjection::project_local(&l2_space, &exact, l2_vec, HERMES_L2_NORM);
+  Solution::vector_to_solution(l2_vec, &l2_space, &sln);
+  err = max_error(&mesh, &sln, poly);
+  info("L2 space: error %g", err);
+  if (err > TOL) success = false;
+  delete [] l2_vec;
+
+  // Convergence for a smooth function (the error of a quadratic interpolant is O(h^3)).
+  double prev = 0.0;
+  Mesh smesh;
+  mloader.load("domain.mesh", &smesh);
+  for (int k = 0; k < 3; k++)
+  {
+    smesh.refine_all_elements();
+    H1Space sspace(&smesh, NULL, NULL, 2);
+    scalar* svec = new scalar[Space::get_num_dofs(&sspace)];
+    OGProjection::project_local(&sspace, HERMES_H1_NORM, smooth, &smesh, svec);
+    Solution ssln;
+    Solution::vector_to_solution(svec, &sspace, &ssln);
+    delete [] svec;
+    err = max_error(&smesh, &ssln, smooth);
+    info("smooth function, refinement %d: error %g", k + 1, err);
+    if (k > 0 && err > prev / 6.0) success = false;
+    prev = err;
+  }
+
+  delete [] vec;
+
+  if (success) {
+    printf("Success!\n");
+    return ERR_SUCCESS;
+  }
+  else {
+    printf("Failure!\n");
+    return ERR_FAILURE;
+  }
+}
@@ -0,0 +1,204 @@
+#include "hermes2d.h"
+
+// This test makes sure that the performance counters (class PerfCounters) collect
+// the assembling and solver timers and the cache statistics when enabled, nothing
+// when disabled, that the Chrome trace is saved, that reset() clears the statistics
+// of all threads and that the reports can be made while other threads are recording.
+
+const int P_INIT = 3;                             // Uniform polynomial degree of mesh elements.
+MatrixSolverType matrix_solver = SOLVER_UMFPACK;  // Possibilities: SOLVER_AMESOS, SOLVER_MUMPS, SOLVER_NOX,
+                                                  // SOLVER_PARDISO, SOLVER_PETSC, SOLVER_UMFPACK.
+const char* TRACE_FILENAME = "trace.json";
+const int N_THREADS = 4;                          // Number of recording threads.
+const int N_RECORDS = 20000;                      // Number of scopes recorded by each thread.
+
+BCType bc_types(int marker)
+{
+  return (marker == 3) ? BC_NATURAL : BC_ESSENTIAL;
+}
+
+scalar essential_bc_values(int ess_bdy_marker, double x, double y)
+{
+  return 0;
+}
+
+template<typename Real, typename Scalar>
+Scalar bilinear_form(int n, double *wt, Func<Scalar> *u_ext[], Func<Real> *u,
+                     Func<Real> *v, Geom<Real> *e, ExtData<Scalar> *ext)
+{
+  return int_grad_u_grad_v<Real, Scalar>(n, wt, u, v);
+}
+
+template<typename Real, typename Scalar>
+Scalar linear_form(int n, double *wt, Func<Scalar> *u_ext[], Func<Real> *v,
+                   Geom<Real> *e, ExtData<Scalar> *ext)
+{
+  return int_v<Real, Scalar>(n, wt, v);
+}
+
+void solve(Space* space)
+{
+  WeakForm wf;
+  wf.add_matrix_form(callback(bilinear_form), HERMES_SYM);
+  wf.add_vector_form(callback(linear_form));
+
+  bool is_linear = true;
+  DiscreteProblem dp(&wf, space, is_linear);
+  SparseMatrix* matrix = create_matrix(matrix_solver);
+  Vector* rhs = create_vector(matrix_solver);
+  Solver* solver = create_linear_solver(matrix_solver, matrix, rhs);
+  dp.assemble(matrix, rhs);
+  if (!solver->solve()) error ("Matrix solver failed.\n");
+
+  delete solver;
+  delete matrix;
+  delete rhs;
+}
+
+void* count_in_thread(void*)
+{
+  HERMES_PERF_COUNT("thread_count", 1);
+  return NULL;
+}
+
+void* record_in_thread(void*)
+{
+  for (int i = 0; i < N_RECORDS; i++)
+  {
+    HERMES_PERF_SCOPE("record_scope");
+    HERMES_PERF_COUNT("record_count", 1);
+    HERMES_PERF_CACHE_HIT("record_cache", i % 2 == 0);
+  }
+  return NULL;
+}
+
+int main(int argc, char* argv[])
+{
+  // Load the mesh.
+  Mesh mesh;
+  H2DReader mloader;
+  mloader.load("domain.mesh", &mesh);
+  mesh.refine_all_elements();
+  mesh.refine_all_elements();
+  H1Space space(&mesh, bc_types, essential_bc_values, P_INIT);
+
+  bool success = true;
+
+  // Nothing is collected while the counters are disabled.
+  solve(&space);
+  if (PerfCounters::get_time("assemble") != 0.0 || PerfCounters::get_count("function_tables") != 0)
+  {
+    printf("Statistics collected while disabled.\n");
+    success = false;
+  }
+
+  PerfCounters::enable(true, true);
+  solve(&space);
+  PerfCounters::enable(false);
+  PerfCounters::report();
+
+  const char* timers[] = { "create_sparse_structure", "assemble", "traverse", "eval_form", "matrix_insert", "solve" };
+  for (unsigned int i = 0; i < sizeof(timers) / sizeof(timers[0]); i++)
+    if (!(PerfCounters::get_time(timers[i]) > 0.0))
+    {
+      printf("Timer %s not collected.\n", timers[i]);
+      success = false;
+    }
+  // the tables are precalculated once per element type and order, then reused
+  if (PerfCounters::get_count("function_tables") <= 0 || PerfCounters::get_misses("function_tables") <= 0)
+  {
+    printf("Function table hits/misses not collected.\n");
+    success = false;
+  }
+  // the nested timers are not counted into their parents twice
+  if (PerfCounters::get_time("eval_form") > PerfCounters::get_time("assemble"))
+  {
+    printf("Nested timer exceeds its parent.\n");
+    success = false;
+  }
+
+  if (!PerfCounters::save_trace(TRACE_FILENAME))
+  {
+    printf("Trace not saved.\n");
+    success = false;
+  }
+  else
+  {
+    FILE* f = fopen(TRACE_FILENAME, "r");
+    char buf[32] = "";
+    if (f == NULL || fread(buf, 1, 15, f) != 15 || strncmp(buf, "{\"traceEvents\":", 15))
+    {
+      printf("Invalid trace file.\n");
+      success = false;
+    }
+    if (f != NULL) fclose(f);
+  }
+
+  // the statistics of the other threads are cleared too
+  PerfCounters::enable(true);
+  pthread_t thread;
+  if (pthread_create(&thread, NULL, count_in_thread, NULL) == 0)
+    pthread_join(thread, NULL);
+  else
+    count_in_thread(NULL);
+  if (PerfCounters::get_count("thread_count") != 1)
+  {
+    printf("Counter of another thread not collected.\n");
+    success = false;
+  }
+
+  PerfCounters::reset();
+  if (PerfCounters::get_time("assemble") != 0.0 || PerfCounters::get_count("thread_count") != 0)
+  {
+    printf("Statistics not cleared.\n");
+    success = false;
+  }
+
+  // reports while other threads are recording (and growing their statistics)
+  PerfCounters::enable(true, true);
+  pthread_t threads[N_THREADS];
+  for (int t = 0; t < N_THREADS; t++)
+    pthread_create(&threads[t], NULL, record_in_thread, NULL);
+  FILE* null_file = fopen("/dev/null", "w");
+  for (int r = 0; r < 10000 && PerfCounters::get_count("record_count") < N_THREADS * N_RECORDS; r++)
+  {
+    if (null_file != NULL) PerfCounters::report(null_file);
+    PerfCounters::save_trace("/dev/null");
+    PerfCounters::get_time("record_scope");
+    PerfCounters::get_misses("record_cache");
+  }
+  for (int t = 0; t < N_THREADS; t++)
+    pthread_join(threads[t], NULL);
+  if (null_file != NULL) fclose(null_file);
+  PerfCounters::save_trace(TRACE_FILENAME);
+  if (PerfCounters::get_count("record_count") != N_THREADS * N_RECORDS ||
+      PerfCounters::get_count("record_cache") != N_THREADS * N_RECORDS / 2 ||
+      PerfCounters::get_misses("record_cache") != N_THREADS * N_RECORDS / 2)
+  {
+    printf("Statistics recorded during the reports are wrong.\n");
+    success = false;
+  }
+  PerfCounters::reset();
+
+  // the hits and the misses grow independently of the counters with larger ids
+  int cache_id = PerfCounters::get_id("test_cache", HERMES_PERF_CACHE);
+  int count_id = PerfCounters::get_id("test_count", HERMES_PERF_COUNTER);
+  PerfCounters::add(count_id, 1);
+  PerfCounters::add_cache(cache_id, false);
+  PerfCounters::add_cache(cache_id, true);
+  PerfCounters::enable(false);
+  if (PerfCounters::get_count("test_cache") != 1 || PerfCounters::get_misses("test_cache") != 1)
+  {
+    printf("Cache statistics not collected.\n");
+    success = false;
+  }
+
+  if (success) {
+    printf("Success!\n");
+    return ERR_SUCCESS;
+  }
+  else {
+    printf("Failure!\n");
+    return ERR_FAILURE;
+  }
+}
@@ -0,0 +1,108 @@
+#include "hermes2d.h"
+
+// This test makes sure that SolutionEvaluator returns the same values as the
+// Solution it evaluates: in integration points (also on sub-elements) and in
+// arbitrary points of the domain. With OpenMP, the points are also evaluated
+// by several threads at once, each with its own evaluator.
+
+const int P_INIT = 3;          // Uniform polynomial degree of mesh elements.
+const int QUAD_ORDER = 6;      // Order of the integration points.
+const double TOL = 1e-10;
+
+BCType bc_types(int marker)
+{
+  return BC_NATURAL;
+}
+
+bool compare(scalar* a, scalar* b, int n)
+{
+  for (int i = 0; i < n; i++)
+    if (std::abs(a[i] - b[i]) > TOL * (1.0 + std::abs(a[i])))
+      return false;
+  return true;
+}
+
+int main(int argc, char* argv[])
+{
+  // Load and refine the mesh.
+  Mesh mesh;
+  H2DReader mloader;
+  mloader.load("domain.mesh", &mesh);
+  mesh.refine_all_elements();
+
+  // A solution with random coefficients.
+  H1Space space(&mesh, bc_types, NULL, P_INIT);
+  int ndof = Space::get_num_dofs(&space);
+  scalar* coeffs = new scalar[ndof];
+  srand(1);
+  for (int i = 0; i < ndof; i++)
+    coeffs[i] = (scalar) rand() / RAND_MAX - 0.5;
+  Solution sln;
+  Solution::vector_to_solution(coeffs, &space, &sln);
+  delete [] coeffs;
+
+  bool success = true;
+  SolutionEvaluator ev(&sln);
+  int items[3] = { H2D_FN_VAL_0, H2D_FN_DX_0, H2D_FN_DY_0 };
+
+  // Integration points on the elements and on one of their sons.
+  Element* e;
+  for_all_active_elements(e, &mesh)
+  {
+    sln.set_active_element(e);
+    ev.set_active_element(e);
+    for (int k = 0; k < 2; k++)
+    {
+      if (k == 1) { sln.push_transform(1); ev.push_transform(1); }
+      sln.set_quad_order(QUAD_ORDER, H2D_FN_DEFAULT);
+      int np = sln.get_quad_2d()->get_num_points(QUAD_ORDER);
+      scalar* ref[3] = { sln.get_fn_values(), sln.get_dx_values(), sln.get_dy_values() };
+      for (int j = 0; j < 3; j++)
+        if (!compare(ref[j], ev.get_values(QUAD_ORDER, items[j]), np))
+        {
+          printf("Element %d: item %d differs (transform %d).\n", e->id, j, k);
+          success = false;
+        }
+    }
+  }
+
+  // Arbitrary points.
+  const int N = 40;
+  double pts[N][2];
+  scalar ref[N];
+  for (int i = 0; i < N; i++)
+  {
+    pts[i][0] = 1.7 * rand() / RAND_MAX - 0.8;
+    pts[i][1] = 0.9 * rand() / RAND_MAX;
+    ref[i] = sln.get_pt_value(pts[i][0], pts[i][1], H2D_FN_DX_0);
+    scalar val = ev.get_pt_value(pts[i][0], pts[i][1], H2D_FN_DX_0);
+    if (!compare(ref + i, &val, 1))
+    {
+      printf("Point (%g, %g) differs.\n", pts[i][0], pts[i][1]);
+      success = false;
+    }
+  }
+
+  // Concurrent evaluation.
+  int errors = 0;
+  #pragma omp parallel reduction(+:errors)
+  {
+    SolutionEvaluator tev(&sln);
+    #pragma omp for
+    for (int i = 0; i < N; i++)
+    {
+      scalar val = tev.get_pt_value(pts[i][0], pts[i][1], H2D_FN_DX_0);
+      if (!compare(ref + i, &val, 1)) errors++;
+    }
+  }
+  if (errors) success = false;
+
+  if (success) {
+    printf("Success!\n");
+    return ERR_SUCCESS;
+  }
+  else {
+    printf("Failure!\n");
+    return ERR_FAILURE;
+  }
+}
@@ -0,0 +1,122 @@
+#include "hermes2d.h"
+
+// This test makes sure that Linearizer, Vectorizer and Orderizer produce the same
+// linearized mesh with several threads as with one thread, on a curved mesh with
+// hanging nodes.
+
+const int P_INIT = 4;          // Uniform polynomial degree of mesh elements.
+const int N_THREADS = 4;       // Maximum number of threads.
+const double TOL = 1e-10;
+
+BCType bc_types(int marker)
+{
+  return BC_NATURAL;
+}
+
+void random_solution(Space* space, Solution* sln, int seed)
+{
+  int ndof = Space::get_num_dofs(space);
+  scalar* coeffs = new scalar[ndof];
+  srand(seed);
+  for (int i = 0; i < ndof; i++)
+    coeffs[i] = (scalar) rand() / RAND_MAX - 0.5;
+  Solution::vector_to_solution(coeffs, space, sln);
+  delete [] coeffs;
+}
+
+// Sums of the areas of the triangles and of the integrals of the linearized values,
+// which do not depend on the numbering of the vertices.
+template<typename T>
+void integrate(T* verts, int3* tris, int nt, double& area, double& integral)
+{
+  area = integral = 0.0;
+  for (int i = 0; i < nt; i++)
+  {
+    T& a = verts[tris[i][0]];
+    T& b = verts[tris[i][1]];
+    T& c = verts[tris[i][2]];
+    double s = 0.5 * fabs((b[0] - a[0]) * (c[1] - a[1]) - (c[0] - a[0]) * (b[1] - a[1]));
+    area += s;
+    integral += s * (a[2] + b[2] + c[2]) / 3.0;
+  }
+}
+
+bool compare(const char* what, int n1, int n2, double a1, double a2, double i1, double i2)
+{
+  info("%s: %d / %d, area %g / %g, integral %g / %g", what, n1, n2, a1, a2, i1, i2);
+  return n1 == n2 && fabs(a1 - a2) < TOL && fabs(i1 - i2) < TOL;
+}
+
+int main(int argc, char* argv[])
+{
+  // Load the mesh, make it irregular.
+  Mesh mesh;
+  H2DReader mloader;
+  mloader.load("domain.mesh", &mesh);
+  mesh.refine_element(0);
+  mesh.refine_all_elements();
+
+  H1Space space(&mesh, bc_types, NULL, P_INIT);
+  Solution sln, sln2;
+  random_solution(&space, &sln, 1);
+  random_solution(&space, &sln2, 2);
+
+  bool success = true;
+  double a1, a2, i1, i2;
+
+  // Linearizer and Vectorizer with the automatic maximum, on several numbers of threads
+  // (the maximum must not depend on how the elements are split among the threads).
+  Linearizer lin1;
+  Vectorizer vec1;
+  lin1.process_solution(&sln, H2D_FN_VAL_0, HERMES_EPS_HIGH);
+  vec1.process_solution(&sln, H2D_FN_VAL_0, &sln2, H2D_FN_VAL_0, HERMES_EPS_NORMAL);
+  for (int n = 2; n <= N_THREADS; n++)
+  {
+    Linearizer lin2;
+    lin2.set_num_threads(n);
+    lin2.process_solution(&sln, H2D_FN_VAL_0, HERMES_EPS_HIGH);
+    integrate(lin1.get_vertices(), lin1.get_triangles(), lin1.get_num_triangles(), a1, i1);
+    integrate(lin2.get_vertices(), lin2.get_triangles(), lin2.get_num_triangles(), a2, i2);
+    if (!compare("Linearizer triangles", lin1.get_num_triangles(), lin2.get_num_triangles(), a1, a2, i1, i2) ||
+        lin1.get_num_vertices() != lin2.get_num_vertices() || lin1.get_num_edges() != lin2.get_num_edges())
+      success = false;
+
+    Vectorizer vec2;
+    vec2.set_num_threads(n);
+    vec2.process_solution(&sln, H2D_FN_VAL_0, &sln2, H2D_FN_VAL_0, HERMES_EPS_NORMAL);
+    integrate(vec1.get_vertices(), vec1.get_triangles(), vec1.get_num_triangles(), a1, i1);
+    integrate(vec2.get_vertices(), vec2.get_triangles(), vec2.get_num_triangles(), a2, i2);
+    if (!compare("Vectorizer triangles", vec1.get_num_triangles(), vec2.get_num_triangles(), a1, a2, i1, i2) ||
+        vec1.get_num_vertices() != vec2.get_num_vertices() || vec1.get_num_edges() != vec2.get_num_edges())
+      success = false;
+  }
+
+  // Orderizer.
+  Orderizer ord1, ord2;
+  ord2.set_num_threads(N_THREADS);
+  ord1.process_solution(&space);
+  ord2.process_solution(&space);
+  integrate(ord1.get_vertices(), ord1.get_triangles(), ord1.get_num_triangles(), a1, i1);
+  integrate(ord2.get_vertices(), ord2.get_triangles(), ord2.get_num_triangles(), a2, i2);
+  int *lvert1, *lvert2;
+  char **ltext1, **ltext2;
+  double2 *lbox1, *lbox2;
+  int nl1 = ord1.get_labels(lvert1, ltext1, lbox1);
+  int nl2 = ord2.get_labels(lvert2, ltext2, lbox2);
+  if (!compare("Orderizer triangles", ord1.get_num_triangles(), ord2.get_num_triangles(), a1, a2, i1, i2) ||
+      ord1.get_num_edges() != ord2.get_num_edges() || nl1 != nl2)
+    success = false;
+  for (int i = 0; i < nl1 && i < nl2; i++)
+    if (strcmp(ltext1[i], ltext2[i]) || lvert1[i] != lvert2[i]) success = false;
+
+  if (success)
+  {
+    printf("Success!\n");
+    return ERR_SUCCESS;
+  }
+  else
+  {
+    printf("Failure!\n");
+    return ERR_FAILURE;
+  }
+}
@@ -28,7 +28,9 @@ const double TAU = 0.1;                    // Time step. Note: The Crank-Nicolso
 const double T_FINAL = 5.0;                // Time interval length.
 
 // Adaptivity
-const int UNREF_FREQ = 1;                  // Every UNREF_FREQth time step the mesh is unrefined.
+const int UNREF_FREQ = 1;                  // Every UNREF_FREQth time step the mesh is coarsened.
+const double COARSEN_THRESHOLD = 0.05;     // Sons of an element are merged if the sum of their errors is below
+                                           // COARSEN_THRESHOLD times the maximum element error, see Adapt::coarsen().
 const double THRESHOLD = 0.3;              // This is a quantitative parameter of the adapt(...) function and
                                            // it has different meanings for various adaptive strategies (see below).
 const int STRATEGY = 0;                    // Adaptive strategy:
@@ -165,14 +167,7 @@ int main(int argc, char* argv[])
   int num_time_steps = (int)(T_FINAL/TAU + 0.5);
   for(int ts = 1; ts <= num_time_steps; ts++)
   {
-    // Periodic global derefinements.
-    if (ts > 1 && ts % UNREF_FREQ == 0) 
-    {
-      info("Global mesh derefinement.");
-      mesh.copy(&basemesh);
-      space.set_uniform_order(P_INIT);
-      ndof = Space::get_num_dofs(&space);
-    }
+    ndof = Space::get_num_dofs(&space);
 
     // Set up the solver, matrix, and rhs for the coarse mesh according to the solver selection.
     SparseMatrix* matrix_coarse = create_matrix(matrix_solver);
@@ -206,6 +201,7 @@ int main(int argc, char* argv[])
     // Adaptivity loop:
     bool done = false; int as = 1;
     double err_est;
+    Adapt* adaptivity = NULL;
     do {
       info("Time step %d, adaptivity step %d:", ts, as);
 
@@ -248,9 +244,9 @@ int main(int argc, char* argv[])
 
       // Calculate element errors and total error estimate.
       info("Calculating error estimate.");
-      Adapt* adaptivity = new Adapt(&space, HERMES_H1_NORM);
+      adaptivity = new Adapt(&space, HERMES_H1_NORM);
       bool solutions_for_adapt = true;
-      double err_est_rel_total = adaptivity->calc_err_est(&sln, &ref_sln, solutions_for_adapt, 
+      double err_est_rel_total = err_est = adaptivity->calc_err_est(&sln, &ref_sln, solutions_for_adapt, 
                                  HERMES_TOTAL_ERROR_REL | HERMES_ELEMENT_ERROR_REL) * 100;
 
       // Report results.
@@ -275,7 +271,7 @@ int main(int argc, char* argv[])
       delete solver;
       delete matrix;
       delete rhs;
-      delete adaptivity;
+      if (!done) delete adaptivity;
       delete ref_space;
       delete dp;
       delete [] coeff_vec;
@@ -293,6 +289,15 @@ int main(int argc, char* argv[])
 
     // Copy last reference solution into sln_prev_time.
     sln_prev_time.copy(&ref_sln);
+
+    // Periodic coarsening where the solution does not need the refinements anymore.
+    // The element errors of the last adaptivity step are used unless it changed the mesh.
+    if (ts % UNREF_FREQ == 0 && err_est < ERR_STOP)
+    {
+      info("Coarsening the mesh.");
+      adaptivity->coarsen(&selector, COARSEN_THRESHOLD, &basemesh);
+    }
+    delete adaptivity;
   }
 
   // Wait for all views to be closed.
@@ -752,9 +752,12 @@ Ord3 Adapt::get_form_order(int marker, const Ord3 &ordu, const Ord3 &ordv, RefMa
                                  matrix_form_ord_t mf_ord)
 {
 	_F_
+	ScratchArena *arena = ScratchArena::get_thread_arena();
+	ScratchScope scratch(arena);
+
 	// determine the integration order
-	Func<Ord> *ou = init_fn_ord(ordu);
-	Func<Ord> *ov = init_fn_ord(ordv);
+	Func<Ord> *ou = init_fn_ord(ordu, arena);
+	Func<Ord> *ov = init_fn_ord(ordv, arena);
 
 	double fake_wt = 1.0;
 	Geom<Ord> fake_e = init_geom(marker);
@@ -766,11 +769,6 @@ Ord3 Adapt::get_form_order(int marker, const Ord3 &ordu, const Ord3 &ordv, RefMa
 	}
 	order.limit();
 
-	free_fn(ou);
-	free_fn(ov);
-  delete ou;
-  delete ov;
-
 	return order;
 }
 
@@ -778,6 +776,10 @@ scalar Adapt::eval_error(int marker, biform_val_t bi_fn, biform_ord_t bi_ord, Me
                            MeshFunction *sln2, MeshFunction *rsln1, MeshFunction *rsln2)
 {
 	_F_
+	// the functions are taken from the arena of the thread and released on return
+	ScratchArena *arena = ScratchArena::get_thread_arena();
+	ScratchScope scratch(arena);
+
 	RefMap *rv1 = sln1->get_refmap();
 	RefMap *rv2 = sln1->get_refmap();
 	RefMap *rrv1 = rsln1->get_refmap();
@@ -794,10 +796,10 @@ scalar Adapt::eval_error(int marker, biform_val_t bi_fn, biform_ord_t bi_ord, Me
 	double *jwt = rrv1->get_jacobian(np, pt);
 	Geom<double> e = init_geom(marker, rrv1, np, pt);
 
-	Func<scalar> *err1 = init_fn(sln1, rv1, np, pt);
-	Func<scalar> *err2 = init_fn(sln2, rv2, np, pt);
-	Func<scalar> *v1 = init_fn(rsln1, rrv1, np, pt);
-	Func<scalar> *v2 = init_fn(rsln2, rrv2, np, pt);
+	Func<scalar> *err1 = init_fn(sln1, rv1, np, pt, arena);
+	Func<scalar> *err2 = init_fn(sln2, rv2, np, pt, arena);
+	Func<scalar> *v1 = init_fn(rsln1, rrv1, np, pt, arena);
+	Func<scalar> *v2 = init_fn(rsln2, rrv2, np, pt, arena);
 
 	err1->subtract(*v1);
   err2->subtract(*v2);
@@ -806,10 +808,6 @@ scalar Adapt::eval_error(int marker, biform_val_t bi_fn, biform_ord_t bi_ord, Me
 
 	delete [] jwt;
 	free_geom(&e);
-	free_fn(err1);
-	free_fn(err2);
-	free_fn(v1);
-	free_fn(v2);
 
 	return res;
 }
@@ -819,6 +817,9 @@ scalar Adapt::eval_norm(int marker, biform_val_t bi_fn, biform_ord_t bi_ord, Mes
                           MeshFunction *rsln2)
 {
 	_F_
+	ScratchArena *arena = ScratchArena::get_thread_arena();
+	ScratchScope scratch(arena);
+
 	RefMap *rv1 = rsln1->get_refmap();
 	RefMap *rv2 = rsln1->get_refmap();
 
@@ -833,15 +834,13 @@ scalar Adapt::eval_norm(int marker, biform_val_t bi_fn, biform_ord_t bi_ord, Mes
 	double *jwt = rv1->get_jacobian(np, pt);
 	Geom<double> e = init_geom(marker, rv1, np, pt);
 
-	Func<scalar> *v1 = init_fn(rsln1, rv1, np, pt);
-	Func<scalar> *v2 = init_fn(rsln2, rv2, np, pt);
+	Func<scalar> *v1 = init_fn(rsln1, rv1, np, pt, arena);
+	Func<scalar> *v2 = init_fn(rsln2, rv2, np, pt, arena);
 
 	scalar res = bi_fn(np, jwt, NULL, v1, v2, &e, NULL);
 
 	delete [] jwt;
 	free_geom(&e);
-	free_fn(v1);
-	free_fn(v2);
 
 	return res;
 }
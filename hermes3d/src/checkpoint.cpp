@@ -0,0 +1,330 @@
+// This file is part of Hermes3D
+//
+// Copyright (c) 2009 hp-FEM group at the University of Nevada, Reno (UNR).
+// Email: hpfem-group@unr.edu, home page: http://hpfem.org/.
+//
+// Hermes3D is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published
+// by the Free Software Foundation; either version 2 of the License,
+// or (at your option) any later version.
+//
+// Hermes3D is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Hermes3D; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#include "h3d_common.h"
+#include "checkpoint.h"
+#include "mesh.h"
+#include "space/space.h"
+#include "solution.h"
+#include "../../hermes_common/trace.h"
+#include "../../hermes_common/error.h"
+
+// Record tags. The data of the records are:
+//   MESH: base vertices, base elements, boundaries, refinements (see save_mesh())
+//   SPCE: ndof, max. element id, order of each element (Ord3::get_idx(), -1 if inactive)
+//   VECT: sizeof(scalar), ndof, coefficients
+static const char *H3D_CHECKPOINT_MAGIC = "H3DC";
+static const char *H3D_TAG_MESH = "MESH";
+static const char *H3D_TAG_SPACE = "SPCE";
+static const char *H3D_TAG_VECTOR = "VECT";
+
+#define output(n, type)		hermes_fwrite(&(n), sizeof(type), 1, f)
+#define input(n, type)		hermes_fread(&(n), sizeof(type), 1, f)
+
+Checkpoint::Checkpoint() {
+	_F_
+}
+
+Checkpoint::~Checkpoint() {
+	_F_
+	close();
+}
+
+void Checkpoint::create(const char *filename, bool append) {
+	_F_
+	file.create(filename, H3D_CHECKPOINT_MAGIC, append);
+}
+
+void Checkpoint::open(const char *filename) {
+	_F_
+	file.open(filename, H3D_CHECKPOINT_MAGIC);
+}
+
+void Checkpoint::close() {
+	_F_
+	file.close();
+}
+
+int Checkpoint::find(const char *tag, int step, int index, bool exact) {
+	_F_
+	int rec = file.find_record(tag, step, index, exact);
+	if (rec < 0) error("Checkpoint: no %.4s record (step %d, index %d).", tag, step, index);
+	return rec;
+}
+
+// saving /////////////////////////////////////////////////////////////////////
+
+// sort key for refinements: the sons are created when the element is refined
+static unsigned int first_son(Element *e) {
+	unsigned int first = INVALID_IDX;
+	for (int i = 0; i < e->get_num_sons(); i++) {
+		unsigned int son = e->get_son(i);
+		if (son != INVALID_IDX && (first == INVALID_IDX || son < first)) first = son;
+	}
+	return first;
+}
+
+struct RefinementRecord {
+	unsigned int son, eid;
+	int reft;
+	bool operator<(const RefinementRecord &o) const { return son < o.son; }
+};
+
+void Checkpoint::save_mesh(Mesh *mesh, int step, int index) {
+	_F_
+	FILE *f = file.begin_record(H3D_TAG_MESH, step, index);
+	unsigned int nbase = mesh->get_num_base_elements();
+
+	// base vertices (the ones created after them are midpoints of refinements)
+	unsigned int nv = 0;
+	for (unsigned int eid = 1; eid <= nbase; eid++) {
+		Element *e = mesh->elements[eid];
+		for (int iv = 0; iv < e->get_num_vertices(); iv++)
+			nv = std::max(nv, e->get_vertex(iv));
+	}
+	output(nv, unsigned int);
+	for (unsigned int i = 1; i <= nv; i++) {
+		Vertex *v = mesh->vertices[i];
+		output(v->x, double);
+		output(v->y, double);
+		output(v->z, double);
+	}
+
+	// base elements
+	output(nbase, unsigned int);
+	for (unsigned int eid = 1; eid <= nbase; eid++) {
+		Element *e = mesh->elements[eid];
+		int mode = e->get_mode();
+		unsigned int vtcs[Hex::NUM_VERTICES];	// hex is shape with the largest number of vertices
+		e->get_vertices(vtcs);
+		output(mode, int);
+		output(e->marker, int);
+		hermes_fwrite(vtcs, sizeof(unsigned int), e->get_num_vertices(), f);
+	}
+
+	// boundaries of the base elements
+	std::vector<unsigned int> bnd;
+	for (unsigned int eid = 1; eid <= nbase; eid++) {
+		Element *e = mesh->elements[eid];
+		for (int iface = 0; iface < e->get_num_faces(); iface++) {
+			Facet *facet = mesh->facets[mesh->get_facet_id(e, iface)];
+			if (facet->type != Facet::OUTER) continue;
+
+			unsigned int vtcs[Quad::NUM_VERTICES];	// quad is shape with the largest number of vertices
+			int nvtcs = e->get_face_vertices(iface, vtcs);
+			bnd.push_back(nvtcs);
+			bnd.push_back(mesh->boundaries[facet->right]->marker);
+			bnd.insert(bnd.end(), vtcs, vtcs + nvtcs);
+		}
+	}
+	unsigned int nbnd = bnd.size();
+	output(nbnd, unsigned int);
+	if (nbnd > 0) hermes_fwrite(&bnd[0], sizeof(unsigned int), nbnd, f);
+
+	// refinements in the order they were applied
+	std::vector<RefinementRecord> refs;
+	FOR_ALL_ELEMENTS(eid, mesh) {
+		Element *e = mesh->elements[eid];
+		if (e->active) continue;
+		RefinementRecord r = { first_son(e), eid, e->reft };
+		refs.push_back(r);
+	}
+	std::sort(refs.begin(), refs.end());
+	unsigned int nref = refs.size();
+	output(nref, unsigned int);
+	for (unsigned int i = 0; i < nref; i++) {
+		output(refs[i].eid, unsigned int);
+		output(refs[i].reft, int);
+	}
+
+	unsigned int max_id = mesh->get_max_element_id();
+	output(max_id, unsigned int);
+
+	file.end_record();
+}
+
+void Checkpoint::save_space(Space *space, int step, int index) {
+	_F_
+	Mesh *mesh = space->get_mesh();
+	int n = mesh->get_max_element_id() + 1;
+	int hdr[2] = { space->get_num_dofs(), n };
+
+	int *orders = new int[n];
+	MEM_CHECK(orders);
+	for (int i = 0; i < n; i++)
+		orders[i] = -1;
+	FOR_ALL_ACTIVE_ELEMENTS(eid, mesh)
+		orders[eid] = space->get_element_order(eid).get_idx();
+
+	FILE *f = file.begin_record(H3D_TAG_SPACE, step, index);
+	hermes_fwrite(hdr, sizeof(int), 2, f);
+	hermes_fwrite(orders, sizeof(int), n, f);
+	file.end_record();
+	delete [] orders;
+}
+
+void Checkpoint::save_vector(scalar *vec, int ndof, int step, int index) {
+	_F_
+	int hdr[2] = { sizeof(scalar), ndof };
+	FILE *f = file.begin_record(H3D_TAG_VECTOR, step, index);
+	hermes_fwrite(hdr, sizeof(int), 2, f);
+	hermes_fwrite(vec, sizeof(scalar), ndof, f);
+	file.end_record();
+}
+
+void Checkpoint::save(Tuple<Space *> spaces, scalar *vec, int step) {
+	_F_
+	for (int i = 0; i < spaces.size(); i++) {
+		// a mesh shared by several spaces is saved with the index of the first one
+		bool saved = false;
+		for (int j = 0; j < i; j++)
+			if (spaces[j]->get_mesh() == spaces[i]->get_mesh()) saved = true;
+		if (!saved) save_mesh(spaces[i]->get_mesh(), step, i);
+		save_space(spaces[i], step, i);
+	}
+	save_vector(vec, Space::get_num_dofs(spaces), step);
+}
+
+// loading ////////////////////////////////////////////////////////////////////
+
+void Checkpoint::load_mesh(Mesh *mesh, int step, int index) {
+	_F_
+	FILE *f = file.seek_record(find(H3D_TAG_MESH, step, index, false));
+	mesh->free();
+
+	unsigned int nv;
+	input(nv, unsigned int);
+	for (unsigned int i = 1; i <= nv; i++) {
+		double pt[3];
+		hermes_fread(pt, sizeof(double), 3, f);
+		mesh->add_vertex(pt[0], pt[1], pt[2]);
+	}
+
+	unsigned int nbase;
+	input(nbase, unsigned int);
+	for (unsigned int eid = 1; eid <= nbase; eid++) {
+		int mode, marker;
+		unsigned int vtcs[Hex::NUM_VERTICES];
+		input(mode, int);
+		input(marker, int);
+
+		Element *e = NULL;
+		switch (mode) {
+			case MODE_TETRAHEDRON:
+				hermes_fread(vtcs, sizeof(unsigned int), Tetra::NUM_VERTICES, f);
+				e = mesh->add_tetra(vtcs);
+				break;
+			case MODE_HEXAHEDRON:
+				hermes_fread(vtcs, sizeof(unsigned int), Hex::NUM_VERTICES, f);
+				e = mesh->add_hex(vtcs);
+				break;
+			case MODE_PRISM:
+				hermes_fread(vtcs, sizeof(unsigned int), Prism::NUM_VERTICES, f);
+				e = mesh->add_prism(vtcs);
+				break;
+			default:
+				error("Checkpoint: corrupt mesh data.");
+		}
+		e->marker = marker;
+	}
+
+	unsigned int nbnd;
+	input(nbnd, unsigned int);
+	std::vector<unsigned int> bnd(nbnd);
+	if (nbnd > 0) hermes_fread(&bnd[0], sizeof(unsigned int), nbnd, f);
+	for (unsigned int i = 0; i < nbnd; i += 2 + bnd[i]) {
+		if (bnd[i] == Tri::NUM_VERTICES) mesh->add_tri_boundary(&bnd[i + 2], bnd[i + 1]);
+		else if (bnd[i] == Quad::NUM_VERTICES) mesh->add_quad_boundary(&bnd[i + 2], bnd[i + 1]);
+		else error("Checkpoint: corrupt mesh data.");
+	}
+	mesh->ugh();
+
+	// replay the refinements
+	unsigned int nref;
+	input(nref, unsigned int);
+	for (unsigned int i = 0; i < nref; i++) {
+		unsigned int eid;
+		int reft;
+		input(eid, unsigned int);
+		input(reft, int);
+		mesh->refine_element(eid, reft);
+	}
+
+	unsigned int max_id;
+	input(max_id, unsigned int);
+	if (mesh->get_max_element_id() != max_id)
+		error("Checkpoint: the refinements of the mesh could not be restored.");
+}
+
+void Checkpoint::load_space(Space *space, int step, int index) {
+	_F_
+	FILE *f = file.seek_record(find(H3D_TAG_SPACE, step, index, false));
+	int hdr[2];
+	hermes_fread(hdr, sizeof(int), 2, f);
+	int n = hdr[1];
+
+	Mesh *mesh = space->get_mesh();
+	if (n != (int) mesh->get_max_element_id() + 1)
+		error("Checkpoint: the space does not match the mesh.");
+	int *orders = new int[n];
+	MEM_CHECK(orders);
+	hermes_fread(orders, sizeof(int), n, f);
+
+	FOR_ALL_ACTIVE_ELEMENTS(eid, mesh) {
+		if (orders[eid] < 0) error("Checkpoint: the space does not match the mesh.");
+		space->set_element_order(eid, Ord3::from_int(orders[eid]));
+	}
+	delete [] orders;
+
+	space->assign_dofs();
+	if (space->get_num_dofs() != hdr[0])
+		warning("Checkpoint: the space has %d DOFs, %d were saved.", space->get_num_dofs(), hdr[0]);
+}
+
+scalar *Checkpoint::load_vector(int step, int index, int *ndof) {
+	_F_
+	FILE *f = file.seek_record(find(H3D_TAG_VECTOR, step, index, true));
+	int hdr[2];
+	hermes_fread(hdr, sizeof(int), 2, f);
+	if (hdr[0] != sizeof(scalar))
+		error("Checkpoint: the vector was saved with a different scalar type.");
+
+	scalar *vec = new scalar[hdr[1]];
+	MEM_CHECK(vec);
+	hermes_fread(vec, sizeof(scalar), hdr[1], f);
+	if (ndof != NULL) *ndof = hdr[1];
+	return vec;
+}
+
+void Checkpoint::load_solutions(Tuple<Space *> spaces, Tuple<Solution *> solutions, int step) {
+	_F_
+	Space::assign_dofs(spaces);
+
+	int ndof;
+	scalar *vec = load_vector(step, 0, &ndof);
+	if (ndof != Space::get_num_dofs(spaces))
+		error("Checkpoint: the spaces have %d DOFs, the vector has %d.", Space::get_num_dofs(spaces), ndof);
+	Solution::vector_to_solutions(vec, spaces, solutions);
+	delete [] vec;
+}
+
+long Checkpoint::get_vector_offset(int step, int index) {
+	_F_
+	return file.get_record_offset(find(H3D_TAG_VECTOR, step, index, true)) + 2 * sizeof(int);
+}
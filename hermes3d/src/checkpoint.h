@@ -0,0 +1,89 @@
+// This file is part of Hermes3D
+//
+// Copyright (c) 2009 hp-FEM group at the University of Nevada, Reno (UNR).
+// Email: hpfem-group@unr.edu, home page: http://hpfem.org/.
+//
+// Hermes3D is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published
+// by the Free Software Foundation; either version 2 of the License,
+// or (at your option) any later version.
+//
+// Hermes3D is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Hermes3D; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#ifndef __H3D_CHECKPOINT_H
+#define __H3D_CHECKPOINT_H
+
+#include "h3d_common.h"
+#include "../../hermes_common/record_file.h"
+
+class Mesh;
+class Space;
+class Solution;
+
+/// Binary checkpoint file ("H3DC") for restarting computations.
+///
+/// The checkpoint stores meshes, element orders of spaces and coefficient vectors,
+/// each tagged with a time step. The format and usage are the same as in Hermes2D:
+/// records can be appended at every time step, only the record headers are read
+/// when the file is opened and the data are aligned to 8 bytes, so the vectors
+/// can be memory-mapped.
+///
+/// A mesh is stored as its base mesh (vertices, elements and boundaries) and the
+/// sequence of refinements applied to it, which is replayed when the mesh is loaded.
+/// Since the refinements are replayed in the original order, the element and vertex
+/// ids of the loaded mesh are the same as in the saved one.
+///
+class HERMES_API Checkpoint {
+public:
+	Checkpoint();
+	~Checkpoint();
+
+	/// Creates a new checkpoint file. With 'append' = true, an existing file is kept
+	/// and the new records are added after the ones already stored in it.
+	void create(const char *filename, bool append = false);
+	/// Opens a checkpoint file for reading.
+	void open(const char *filename);
+	void close();
+
+	/// Saves the mesh (the base mesh and its refinements).
+	void save_mesh(Mesh *mesh, int step, int index = 0);
+	/// Saves the element orders of the space.
+	void save_space(Space *space, int step, int index = 0);
+	/// Saves a coefficient vector of length 'ndof'.
+	void save_vector(scalar *vec, int ndof, int step, int index = 0);
+	/// Saves the meshes (each one only once), the spaces and the coefficient vector
+	/// of the whole system.
+	void save(Tuple<Space *> spaces, scalar *vec, int step);
+
+	/// Returns the last time step stored in the checkpoint.
+	int get_last_step() const { return file.get_last_step(); }
+
+	/// Loads the mesh saved at the time step 'step' or, if the mesh was not saved at that
+	/// step, the last one saved before it. With 'step' = -1, the last mesh is loaded.
+	void load_mesh(Mesh *mesh, int step = -1, int index = 0);
+	/// Sets the element orders saved in the checkpoint and assigns the DOFs. The space
+	/// must be defined on the mesh obtained by load_mesh().
+	void load_space(Space *space, int step = -1, int index = 0);
+	/// Returns a copy of the coefficient vector saved at the time step 'step' (-1 for the
+	/// last one), allocated by new[]. Its length is returned in 'ndof'.
+	scalar *load_vector(int step = -1, int index = 0, int *ndof = NULL);
+	/// Loads the coefficient vector saved by save() and converts it to solutions.
+	void load_solutions(Tuple<Space *> spaces, Tuple<Solution *> solutions, int step = -1);
+
+	/// Returns the offset of the coefficients of a saved vector in the file, e.g. for mmap().
+	long get_vector_offset(int step = -1, int index = 0);
+
+protected:
+	RecordFile file;
+
+	int find(const char *tag, int step, int index, bool exact);
+};
+
+#endif
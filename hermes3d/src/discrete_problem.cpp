@@ -41,15 +41,11 @@ void DiscreteProblem::FnCache::free()
   for (int i = e.first(); i != INVALID_IDX; i = e.next(i))
     free_geom(&e[i]);
   e.remove_all();
-  for (int i = fn.first(); i != INVALID_IDX; i = fn.next(i))
-    free_fn(fn[i]);
+  // the functions are allocated from the arena
   fn.remove_all();
-  for (int i = ext.first(); i != INVALID_IDX; i = ext.next(i))
-    delete ext[i];
   ext.remove_all();
-  for (int i = sln.first(); i != INVALID_IDX; i = sln.next(i))
-    free_fn(sln[i]);
   sln.remove_all();
+  arena.reset();
 }
 
 // DiscreteProblem ///////////////////////////////////////////////////////////////////////////////////////
@@ -72,6 +68,8 @@ DiscreteProblem::DiscreteProblem(WeakForm *wf, Tuple<Space *> spaces, bool is_li
   matrix_buffer = NULL;
   matrix_buffer_dim = 0;
 
+  scratch = NULL;
+
   values_changed = true;
   struct_changed = true;
 
@@ -155,6 +153,7 @@ bool DiscreteProblem::is_up_to_date()
 void DiscreteProblem::create(SparseMatrix *mat, Vector* rhs, bool rhsonly)
 {
   _F_
+  HERMES_PERF_SCOPE("create_sparse_structure");
 
   if (is_up_to_date())
   {
@@ -255,6 +254,7 @@ void DiscreteProblem::assemble(scalar* coeff_vec, SparseMatrix* mat, Vector* rhs
   /* BEGIN IDENTICAL CODE WITH H2D */
 
   _F_
+  HERMES_PERF_SCOPE("assemble");
   // Sanity checks.
   if (coeff_vec == NULL && this->is_linear == false) error("coeff_vec is NULL in FeProblem::assemble().");
   if (!have_spaces) error("You have to call FeProblem::set_spaces() before calling assemble().");
@@ -264,6 +264,7 @@ void DiscreteProblem::assemble(scalar* coeff_vec, SparseMatrix* mat, Vector* rhs
   }
  
   this->create(mat, rhs, rhsonly);
+  scratch = ScratchArena::get_thread_arena();
 
   // Convert the coefficient vector 'coeff_vec' into solutions Tuple 'u_ext'.
   Tuple<Solution*> u_ext;
@@ -633,7 +634,7 @@ void DiscreteProblem::init_ext_fns(ExtData<scalar> &ext_data, std::vector<MeshFu
     mFunc *efn = NULL;
     if (!fn_cache.ext.lookup(key, efn)) 
     {
-      efn = init_fn(ext[i], rm, np, pt);
+      efn = init_fn(ext[i], rm, np, pt, &fn_cache.arena);
       fn_cache.ext.set(key, efn);
     }
     assert(efn != NULL);
@@ -650,7 +651,7 @@ void DiscreteProblem::init_ext_fns(ExtData<Ord> &fake_ext_data, std::vector<Mesh
   Func<Ord> **fake_ext_fn = new Func<Ord> *[fake_ext_data.nf];
   
   for (int i = 0; i < fake_ext_data.nf; i++) 
-    fake_ext_fn[i] = init_fn_ord(ext[i]->get_fn_order());
+    fake_ext_fn[i] = init_fn_ord(ext[i]->get_fn_order(), scratch);
   
   fake_ext_data.fn = fake_ext_fn;
 }
@@ -661,7 +662,7 @@ sFunc *DiscreteProblem::get_fn(ShapeFunction *fu, int order, RefMap *rm, const i
   sFunc *u = NULL;
   if (!fn_cache.fn.lookup(key, u)) 
   {
-    u = init_fn(fu, rm, np, pt);
+    u = init_fn(fu, rm, np, pt, &fn_cache.arena);
     fn_cache.fn.set(key, u);
   }
   return u;
@@ -674,7 +675,7 @@ sFunc *DiscreteProblem::get_fn(ShapeFunction *fu, int order, RefMap *rm, int isu
   sFunc *u = NULL;
   if (!fn_cache.fn.lookup(key, u)) 
   {
-    u = init_fn(fu, rm, isurf, np, pt);
+    u = init_fn(fu, rm, isurf, np, pt, &fn_cache.arena);
     fn_cache.fn.set(key, u);
   }
   return u;
@@ -686,7 +687,7 @@ mFunc *DiscreteProblem::get_fn(Solution *fu, int order, RefMap *rm, const int np
   mFunc *u = NULL;
   if (!fn_cache.sln.lookup(key, u)) 
   {
-    u = init_fn(fu, rm, np, pt);
+    u = init_fn(fu, rm, np, pt, &fn_cache.arena);
     fn_cache.sln.set(key, u);
   }
   return u;
@@ -696,6 +697,8 @@ scalar DiscreteProblem::eval_form(WeakForm::MatrixFormVol *mfv, Tuple<Solution *
                             ShapeFunction *fv, RefMap *ru, RefMap *rv)
 {
   _F_
+  // the data needed only during this call are released on return
+  ScratchScope scratch_scope(scratch);
   // At this point H2D sets an increase of one if 
   // fu->get_num_components() == 2.
 
@@ -703,25 +706,25 @@ scalar DiscreteProblem::eval_form(WeakForm::MatrixFormVol *mfv, Tuple<Solution *
   Element *elem = fv->get_active_element();
 
   // Determine the integration order
-  Func<Ord> **oi = new Func<Ord> *[wf->neq];
+  Func<Ord> **oi = new (scratch) Func<Ord> *[wf->neq];
 
   // Order of solutions from the previous Newton iteration.
   if (u_ext != Tuple<Solution *>()) 
   {
     for (int i = 0; i < wf->neq; i++) 
     {
-      if (u_ext[i] != NULL) oi[i] = init_fn_ord(u_ext[i]->get_fn_order());
-      else oi[i] = init_fn_ord(0);
+      if (u_ext[i] != NULL) oi[i] = init_fn_ord(u_ext[i]->get_fn_order(), scratch);
+      else oi[i] = init_fn_ord(0, scratch);
     }
   } 
   else 
   {
-    for (int i = 0; i < wf->neq; i++) oi[i] = init_fn_ord(0);
+    for (int i = 0; i < wf->neq; i++) oi[i] = init_fn_ord(0, scratch);
   }
 
   // Order of shape functions.
-  Func<Ord> *ou = init_fn_ord(fu->get_fn_order());
-  Func<Ord> *ov = init_fn_ord(fv->get_fn_order());
+  Func<Ord> *ou = init_fn_ord(fu->get_fn_order(), scratch);
+  Func<Ord> *ov = init_fn_ord(fv->get_fn_order(), scratch);
 
   // Order of additional external functions.
   ExtData<Ord> fake_ext;
@@ -743,13 +746,6 @@ scalar DiscreteProblem::eval_form(WeakForm::MatrixFormVol *mfv, Tuple<Solution *
   order.limit();
   int ord_idx = order.get_idx();
 
-  // Clean up.
-  for (int i = 0; i < wf->neq; i++) free_fn(oi[i]);
-  delete [] oi;
-  free_fn(ou);
-  free_fn(ov);
-  delete ou;
-  delete ov;
 
   // Evaluate the form using the quadrature of the just calculated order.
   Quad3D *quad = get_quadrature(elem->get_mode());
@@ -768,7 +764,7 @@ scalar DiscreteProblem::eval_form(WeakForm::MatrixFormVol *mfv, Tuple<Solution *
   e = fn_cache.e[ord_idx];
 
   // Values of the previous Newton iteration, shape functions and external functions in quadrature points.
-  mFunc **prev = new mFunc *[wf->neq];
+  mFunc **prev = new (scratch) mFunc *[wf->neq];
   // OLD CODE: for (int i = 0; i < wf->neq; i++) prev[i] = get_fn(u_ext[i], ord_idx, rv, np, pt);
   if (u_ext != Tuple<Solution *>()) 
   {
@@ -790,8 +786,6 @@ scalar DiscreteProblem::eval_form(WeakForm::MatrixFormVol *mfv, Tuple<Solution *
 
   scalar res = mfv->fn(np, jwt, prev, u, v, &e, &ext);
 
-  // Clean up.
-  delete [] prev;
   //ext.free(); // FIXME: this needs to be unified with H2D.
   return res;
 }
@@ -799,6 +793,7 @@ scalar DiscreteProblem::eval_form(WeakForm::MatrixFormVol *mfv, Tuple<Solution *
 scalar DiscreteProblem::eval_form(WeakForm::VectorFormVol *vfv, Tuple<Solution *> u_ext, ShapeFunction *fv, RefMap *rv)
 {
   _F_
+  ScratchScope scratch_scope(scratch);
   // At this point H2D sets an increase of one if 
   // fu->get_num_components() == 2.
 
@@ -806,24 +801,24 @@ scalar DiscreteProblem::eval_form(WeakForm::VectorFormVol *vfv, Tuple<Solution *
   Element *elem = fv->get_active_element();
 
   // Determine the integration order.
-  Func<Ord> **oi = new Func<Ord> * [wf->neq];
+  Func<Ord> **oi = new (scratch) Func<Ord> * [wf->neq];
 
   // Order of solutions from the previous Newton iteration.
   if (u_ext != Tuple<Solution *>()) 
   {
     for (int i = 0; i < wf->neq; i++) 
     {
-      if (u_ext[i] != NULL) oi[i] = init_fn_ord(u_ext[i]->get_fn_order());
-      else oi[i] = init_fn_ord(0);
+      if (u_ext[i] != NULL) oi[i] = init_fn_ord(u_ext[i]->get_fn_order(), scratch);
+      else oi[i] = init_fn_ord(0, scratch);
     }
   } 
   else 
   {
-    for (int i = 0; i < wf->neq; i++) oi[i] = init_fn_ord(0);
+    for (int i = 0; i < wf->neq; i++) oi[i] = init_fn_ord(0, scratch);
   }
 
   // Order of the shape function.
-  Func<Ord> *ov = init_fn_ord(fv->get_fn_order());
+  Func<Ord> *ov = init_fn_ord(fv->get_fn_order(), scratch);
 
   // Order of additional external functions.
   ExtData<Ord> fake_ext;
@@ -846,11 +841,6 @@ scalar DiscreteProblem::eval_form(WeakForm::VectorFormVol *vfv, Tuple<Solution *
   order.limit();
   int ord_idx = order.get_idx();
 
-  // Clean up.
-  for (int i = 0; i < wf->neq; i++) free_fn(oi[i]);
-  delete [] oi;
-  free_fn(ov);
-  delete ov;
 
   // Evaluate the form using the quadrature of the just calculated order.
   Quad3D *quad = get_quadrature(elem->get_mode());
@@ -869,7 +859,7 @@ scalar DiscreteProblem::eval_form(WeakForm::VectorFormVol *vfv, Tuple<Solution *
   e = fn_cache.e[ord_idx];
 
   // Values of the previous Newton iteration, shape functions and external functions in quadrature points.
-  mFunc ** prev = new mFunc *[wf->neq];
+  mFunc ** prev = new (scratch) mFunc *[wf->neq];
   // OLD CODE: for (int i = 0; i < wf->neq; i++) prev[i] = get_fn(u_ext[i], ord_idx, rv, np, pt);
   if (u_ext != Tuple<Solution *>()) 
   {
@@ -890,8 +880,6 @@ scalar DiscreteProblem::eval_form(WeakForm::VectorFormVol *vfv, Tuple<Solution *
 
   scalar res = vfv->fn(np, jwt, prev, v, &e, &ext);
 
-  // Clean up.
-  delete [] prev;
   //ext.free();// FIXME: this needs to be unified with H2D.
   
   return res;
@@ -901,29 +889,30 @@ scalar DiscreteProblem::eval_form(WeakForm::MatrixFormSurf *mfs, Tuple<Solution
                                   ShapeFunction *fv, RefMap *ru, RefMap *rv, SurfPos *surf_pos)
 {
   _F_
+  ScratchScope scratch_scope(scratch);
   // At this point H2D sets an increase of one if 
   // fu->get_num_components() == 2.
 
   // Determine the integration order.
-  Func<Ord> **oi = new Func<Ord> *[wf->neq];
+  Func<Ord> **oi = new (scratch) Func<Ord> *[wf->neq];
   
   // Order of solutions from the previous Newton iteration.
   if (u_ext != Tuple<Solution *>()) 
   {
     for (int i = 0; i < wf->neq; i++) 
     {
-      if (u_ext[i] != NULL) oi[i] = init_fn_ord(u_ext[i]->get_fn_order());
-      else oi[i] = init_fn_ord(0);
+      if (u_ext[i] != NULL) oi[i] = init_fn_ord(u_ext[i]->get_fn_order(), scratch);
+      else oi[i] = init_fn_ord(0, scratch);
     }
   } 
   else 
   {
-    for (int i = 0; i < wf->neq; i++) oi[i] = init_fn_ord(0);
+    for (int i = 0; i < wf->neq; i++) oi[i] = init_fn_ord(0, scratch);
   }
 
   // Order of the shape functions.
-  Func<Ord> *ou = init_fn_ord(fu->get_fn_order());
-  Func<Ord> *ov = init_fn_ord(fv->get_fn_order());
+  Func<Ord> *ou = init_fn_ord(fu->get_fn_order(), scratch);
+  Func<Ord> *ov = init_fn_ord(fv->get_fn_order(), scratch);
 
   // Order of additional external functions.
   ExtData<Ord> fake_ext;
@@ -947,13 +936,6 @@ scalar DiscreteProblem::eval_form(WeakForm::MatrixFormSurf *mfs, Tuple<Solution
   Ord2 face_order = order.get_face_order(surf_pos->surf_num);
   int ord_idx = face_order.get_idx();
 
-  // Clean up.
-  for (int i = 0; i < wf->neq; i++) free_fn(oi[i]);
-  delete [] oi;
-  free_fn(ou);
-  free_fn(ov);
-  delete ou;
-  delete ov;
 
   // Evaluate the form using the quadrature of the just calculated order.
   Quad3D *quad = get_quadrature(fu->get_active_element()->get_mode());
@@ -972,7 +954,7 @@ scalar DiscreteProblem::eval_form(WeakForm::MatrixFormSurf *mfs, Tuple<Solution
   e = fn_cache.e[ord_idx];
 
   // Values of the previous Newton iteration, shape functions and external functions in quadrature points.
-  mFunc **prev = new mFunc *[wf->neq];
+  mFunc **prev = new (scratch) mFunc *[wf->neq];
   // OLD CODE: for (int i = 0; i < wf->neq; i++) prev[i] = get_fn(u_ext[i], ord_idx, rv, np, pt);
   if (u_ext != Tuple<Solution *>()) 
   {
@@ -995,8 +977,6 @@ scalar DiscreteProblem::eval_form(WeakForm::MatrixFormSurf *mfs, Tuple<Solution
 
   scalar res = mfs->fn(np, jwt, prev, u, v, &e, &ext);
 
-  // Clean up.
-  delete [] prev;  
   //ext.free();// FIXME: this needs to be unified with H2D.
   
   return res;
@@ -1006,26 +986,27 @@ scalar DiscreteProblem::eval_form(WeakForm::VectorFormSurf *vfs, Tuple<Solution
                                   ShapeFunction *fv, RefMap *rv, SurfPos *surf_pos)
 {
   _F_
+  ScratchScope scratch_scope(scratch);
 
   // Determine the integration order.
-  Func<Ord> **oi = new Func<Ord> *[wf->neq];
+  Func<Ord> **oi = new (scratch) Func<Ord> *[wf->neq];
 
   // Order of solutions from the previous Newton iteration.
   if (u_ext != Tuple<Solution *>()) 
   {
     for (int i = 0; i < wf->neq; i++) 
     {
-      if (u_ext[i] != NULL) oi[i] = init_fn_ord(u_ext[i]->get_fn_order());
-      else oi[i] = init_fn_ord(0);
+      if (u_ext[i] != NULL) oi[i] = init_fn_ord(u_ext[i]->get_fn_order(), scratch);
+      else oi[i] = init_fn_ord(0, scratch);
     }
   } 
   else 
   {
-    for (int i = 0; i < wf->neq; i++) oi[i] = init_fn_ord(0);
+    for (int i = 0; i < wf->neq; i++) oi[i] = init_fn_ord(0, scratch);
   }
 
   // Order of the shape function.
-  Func<Ord> *ov = init_fn_ord(fv->get_fn_order());
+  Func<Ord> *ov = init_fn_ord(fv->get_fn_order(), scratch);
 
   // Order of additional external functions.
   ExtData<Ord> fake_ext;
@@ -1049,11 +1030,6 @@ scalar DiscreteProblem::eval_form(WeakForm::VectorFormSurf *vfs, Tuple<Solution
   Ord2 face_order = order.get_face_order(surf_pos->surf_num);
   int ord_idx = face_order.get_idx();
  
-  // Clean up.
-  for (int i = 0; i < wf->neq; i++) free_fn(oi[i]);
-  delete [] oi;
-  free_fn(ov);
-  delete ov;
 
   // Evaluate the form using the quadrature of the just calculated order.
   Quad3D *quad = get_quadrature(fv->get_active_element()->get_mode());
@@ -1071,7 +1047,7 @@ scalar DiscreteProblem::eval_form(WeakForm::VectorFormSurf *vfs, Tuple<Solution
   e = fn_cache.e[ord_idx];
 
   // Values of the previous Newton iteration, shape functions and external functions in quadrature points.
-  mFunc **prev = new mFunc *[wf->neq];
+  mFunc **prev = new (scratch) mFunc *[wf->neq];
   // OLD CODE: for (int i = 0; i < wf->neq; i++) prev[i] = get_fn(u_ext[i], ord_idx, rv, np, pt);
   if (u_ext != Tuple<Solution *>()) 
   {
@@ -1092,8 +1068,6 @@ scalar DiscreteProblem::eval_form(WeakForm::VectorFormSurf *vfs, Tuple<Solution
 
   scalar res = vfs->fn(np, jwt, prev, v, &e, &ext);
 
-  // Clean up.
-  delete [] prev;
   //ext.free();// FIXME: this needs to be unified with H2D.
   
   return res;
@@ -106,11 +106,15 @@ protected:
 		Map<fn_key_t, sFunc*> fn;		// shape functions
 		Map<fn_key_t, mFunc*> ext;		// external functions
 		Map<fn_key_t, mFunc*> sln;		// sln from prev iter
+		ScratchArena arena;			// storage of fn, ext and sln
 
 		~FnCache();
 		void free();
 	} fn_cache;
 
+	/// Arena of the assembling thread for the data needed during one call of eval_form().
+	ScratchArena *scratch;
+
 	scalar eval_form(WeakForm::MatrixFormVol *mfv, Tuple<Solution *> u_ext, ShapeFunction *fu,
 	                 ShapeFunction *fv, RefMap *ru, RefMap *rv);
 	scalar eval_form(WeakForm::VectorFormVol *vfv, Tuple<Solution *> u_ext, ShapeFunction *fv, RefMap *rv);
@@ -79,12 +79,12 @@ void free_geom(Geom<double> *e) {
 	delete [] e->nz;
 }
 
-Func<Ord> *init_fn_ord(const Ord3 &order) {
+Func<Ord> *init_fn_ord(const Ord3 &order, ScratchArena *arena) {
 	_F_
 	int o = order.get_ord();
-	Ord *d = new Ord(o);
+	Ord *d = new (arena) Ord(o);
 
-	Func<Ord> * f = new Func<Ord>;
+	Func<Ord> * f = new (arena) Func<Ord>;
 	f->val = d;
 	f->dx = f->dy = f->dz = d;
 	f->val0 = f->val1 = f->val2 = d;
@@ -95,17 +95,17 @@ Func<Ord> *init_fn_ord(const Ord3 &order) {
 	return f;
 }
 
-sFunc *init_fn(ShapeFunction *shfn, RefMap *rm, const int np, const QuadPt3D *pt) {
+sFunc *init_fn(ShapeFunction *shfn, RefMap *rm, const int np, const QuadPt3D *pt, ScratchArena *arena) {
 	_F_
 
-	sFunc *u = new sFunc; MEM_CHECK(u);
+	sFunc *u = new (arena) sFunc; MEM_CHECK(u);
 	u->nc = shfn->get_num_components();
 	shfn->precalculate(np, pt, FN_DEFAULT);
 	if (u->nc == 1) {
-		u->val = new double [np]; MEM_CHECK(u->val);
-		u->dx = new double [np]; MEM_CHECK(u->dx);
-		u->dy = new double [np]; MEM_CHECK(u->dy);
-		u->dz = new double [np]; MEM_CHECK(u->dz);
+		u->val = new (arena) double [np]; MEM_CHECK(u->val);
+		u->dx = new (arena) double [np]; MEM_CHECK(u->dx);
+		u->dy = new (arena) double [np]; MEM_CHECK(u->dy);
+		u->dz = new (arena) double [np]; MEM_CHECK(u->dz);
 
 		double *val = shfn->get_fn_values();
 		double *dx = shfn->get_dx_values();
@@ -121,9 +121,9 @@ sFunc *init_fn(ShapeFunction *shfn, RefMap *rm, const int np, const QuadPt3D *pt
 		delete [] m;
 	}
 	else if (u->nc == 3) {
-		u->val0 = new double [np]; MEM_CHECK(u->val0);
-		u->val1 = new double [np]; MEM_CHECK(u->val1);
-		u->val2 = new double [np]; MEM_CHECK(u->val2);
+		u->val0 = new (arena) double [np]; MEM_CHECK(u->val0);
+		u->val1 = new (arena) double [np]; MEM_CHECK(u->val1);
+		u->val2 = new (arena) double [np]; MEM_CHECK(u->val2);
 
 		double *val[3];
 		for (int c = 0; c < 3; c++)
@@ -139,9 +139,9 @@ sFunc *init_fn(ShapeFunction *shfn, RefMap *rm, const int np, const QuadPt3D *pt
 	}
 
 	if (shfn->get_type() == Hcurl) {
-		u->curl0 = new double [np]; MEM_CHECK(u->curl0);
-		u->curl1 = new double [np]; MEM_CHECK(u->curl1);
-		u->curl2 = new double [np]; MEM_CHECK(u->curl2);
+		u->curl0 = new (arena) double [np]; MEM_CHECK(u->curl0);
+		u->curl1 = new (arena) double [np]; MEM_CHECK(u->curl1);
+		u->curl2 = new (arena) double [np]; MEM_CHECK(u->curl2);
 
 		double *dx[3], *dy[3], *dz[3];
 		for (int c = 0; c < 3; c++) {
@@ -168,18 +168,19 @@ sFunc *init_fn(ShapeFunction *shfn, RefMap *rm, const int np, const QuadPt3D *pt
 }
 
 
-sFunc *init_fn(ShapeFunction *shfn, RefMap *rm, int iface, const int np, const QuadPt3D *pt) {
+sFunc *init_fn(ShapeFunction *shfn, RefMap *rm, int iface, const int np, const QuadPt3D *pt,
+               ScratchArena *arena) {
 	_F_
 
-	sFunc *u = new sFunc; MEM_CHECK(u);
+	sFunc *u = new (arena) sFunc; MEM_CHECK(u);
   u->num_gip = np;
 	u->nc = shfn->get_num_components();
 	shfn->precalculate(np, pt, FN_DEFAULT);
 	if (u->nc == 1) {
-		u->val = new double [np]; MEM_CHECK(u->val);
-		u->dx = new double [np]; MEM_CHECK(u->dx);
-		u->dy = new double [np]; MEM_CHECK(u->dy);
-		u->dz = new double [np]; MEM_CHECK(u->dz);
+		u->val = new (arena) double [np]; MEM_CHECK(u->val);
+		u->dx = new (arena) double [np]; MEM_CHECK(u->dx);
+		u->dy = new (arena) double [np]; MEM_CHECK(u->dy);
+		u->dz = new (arena) double [np]; MEM_CHECK(u->dz);
 
 		double *val = shfn->get_fn_values();
 		double *dx = shfn->get_dx_values();
@@ -199,9 +200,9 @@ sFunc *init_fn(ShapeFunction *shfn, RefMap *rm, int iface, const int np, const Q
 		double *nx, *ny, *nz;
 		rm->calc_face_normal(iface, np, pt, nx, ny, nz);
 
-		u->val0 = new double [np]; MEM_CHECK(u->val0);
-		u->val1 = new double [np]; MEM_CHECK(u->val1);
-		u->val2 = new double [np]; MEM_CHECK(u->val2);
+		u->val0 = new (arena) double [np]; MEM_CHECK(u->val0);
+		u->val1 = new (arena) double [np]; MEM_CHECK(u->val1);
+		u->val2 = new (arena) double [np]; MEM_CHECK(u->val2);
 
 		double *val[3];
 		for (int c = 0; c < 3; c++)
@@ -230,18 +231,18 @@ sFunc *init_fn(ShapeFunction *shfn, RefMap *rm, int iface, const int np, const Q
 	return u;
 }
 
-mFunc *init_fn(MeshFunction *f, RefMap *rm, const int np, const QuadPt3D *pt) {
+mFunc *init_fn(MeshFunction *f, RefMap *rm, const int np, const QuadPt3D *pt, ScratchArena *arena) {
 	_F_
 
-	mFunc *u = new mFunc;
+	mFunc *u = new (arena) mFunc;
   u->num_gip = np;
 	u->nc = f->get_num_components();
 	f->precalculate(np, pt, FN_DEFAULT);
 	if (u->nc == 1) {
-		u->val = new scalar [np]; MEM_CHECK(u->val);
-		u->dx = new scalar [np]; MEM_CHECK(u->dx);
-		u->dy = new scalar [np]; MEM_CHECK(u->dy);
-		u->dz = new scalar [np]; MEM_CHECK(u->dz);
+		u->val = new (arena) scalar [np]; MEM_CHECK(u->val);
+		u->dx = new (arena) scalar [np]; MEM_CHECK(u->dx);
+		u->dy = new (arena) scalar [np]; MEM_CHECK(u->dy);
+		u->dz = new (arena) scalar [np]; MEM_CHECK(u->dz);
 
 		memcpy(u->val, f->get_fn_values(), np * sizeof(scalar));
 		memcpy(u->dx, f->get_dx_values(), np * sizeof(scalar));
@@ -250,45 +251,45 @@ mFunc *init_fn(MeshFunction *f, RefMap *rm, const int np, const QuadPt3D *pt) {
 	}
 	else if (u->nc == 3) {
 		// FN
-		u->val0 = new scalar [np]; MEM_CHECK(u->val0);
-		u->val1 = new scalar [np]; MEM_CHECK(u->val1);
-		u->val2 = new scalar [np]; MEM_CHECK(u->val2);
+		u->val0 = new (arena) scalar [np]; MEM_CHECK(u->val0);
+		u->val1 = new (arena) scalar [np]; MEM_CHECK(u->val1);
+		u->val2 = new (arena) scalar [np]; MEM_CHECK(u->val2);
 
 		memcpy(u->val0, f->get_fn_values(0), np * sizeof(scalar));
 		memcpy(u->val1, f->get_fn_values(1), np * sizeof(scalar));
 		memcpy(u->val2, f->get_fn_values(2), np * sizeof(scalar));
 
 		// DX
-		u->dx0 = new scalar [np]; MEM_CHECK(u->dx0);
-		u->dx1 = new scalar [np]; MEM_CHECK(u->dx1);
-		u->dx2 = new scalar [np]; MEM_CHECK(u->dx2);
+		u->dx0 = new (arena) scalar [np]; MEM_CHECK(u->dx0);
+		u->dx1 = new (arena) scalar [np]; MEM_CHECK(u->dx1);
+		u->dx2 = new (arena) scalar [np]; MEM_CHECK(u->dx2);
 
 		memcpy(u->dx0, f->get_dx_values(0), np * sizeof(scalar));
 		memcpy(u->dx1, f->get_dx_values(1), np * sizeof(scalar));
 		memcpy(u->dx2, f->get_dx_values(2), np * sizeof(scalar));
 
 		// DY
-		u->dy0 = new scalar [np]; MEM_CHECK(u->dy0);
-		u->dy1 = new scalar [np]; MEM_CHECK(u->dy1);
-		u->dy2 = new scalar [np]; MEM_CHECK(u->dy2);
+		u->dy0 = new (arena) scalar [np]; MEM_CHECK(u->dy0);
+		u->dy1 = new (arena) scalar [np]; MEM_CHECK(u->dy1);
+		u->dy2 = new (arena) scalar [np]; MEM_CHECK(u->dy2);
 
 		memcpy(u->dy0, f->get_dy_values(0), np * sizeof(scalar));
 		memcpy(u->dy1, f->get_dy_values(1), np * sizeof(scalar));
 		memcpy(u->dy2, f->get_dy_values(2), np * sizeof(scalar));
 
 		// DZ
-		u->dz0 = new scalar [np]; MEM_CHECK(u->dz0);
-		u->dz1 = new scalar [np]; MEM_CHECK(u->dz1);
-		u->dz2 = new scalar [np]; MEM_CHECK(u->dz2);
+		u->dz0 = new (arena) scalar [np]; MEM_CHECK(u->dz0);
+		u->dz1 = new (arena) scalar [np]; MEM_CHECK(u->dz1);
+		u->dz2 = new (arena) scalar [np]; MEM_CHECK(u->dz2);
 
 		memcpy(u->dz0, f->get_dz_values(0), np * sizeof(scalar));
 		memcpy(u->dz1, f->get_dz_values(1), np * sizeof(scalar));
 		memcpy(u->dz2, f->get_dz_values(2), np * sizeof(scalar));
 
     // CURL
-		u->curl0 = new scalar [np]; MEM_CHECK(u->curl0);
-		u->curl1 = new scalar [np]; MEM_CHECK(u->curl1);
-		u->curl2 = new scalar [np]; MEM_CHECK(u->curl2);
+		u->curl0 = new (arena) scalar [np]; MEM_CHECK(u->curl0);
+		u->curl1 = new (arena) scalar [np]; MEM_CHECK(u->curl1);
+		u->curl2 = new (arena) scalar [np]; MEM_CHECK(u->curl2);
 
     for (int i = 0; i < np; i++)
       u->curl0[i] = u->dy2[i] - u->dz1[i];
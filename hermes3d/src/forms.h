@@ -25,6 +25,7 @@
 #include "function.h"
 #include "solution.h"
 #include "refmap.h"
+#include "../../hermes_common/scratch_arena.h"
 
 #define callback(a)	a<double, scalar>, a<Ord, Ord>
 //#define FORM_CB(a)	a<double, scalar>, a<Ord, Ord>
@@ -192,17 +193,22 @@ Geom<double> init_geom(int marker, RefMap *rm, int iface, const int np, const Qu
 /// Free data related to the element geometry
 void free_geom(Geom<double> *e);
 
+// The following functions allocate the functions (including their arrays) from 'arena'
+// or, if it is NULL, from the heap. Functions allocated from an arena must not be passed
+// to free_fn(), they are released together with the arena (see ScratchArena).
+
 /// Init the function for calculation the integration order
-Func<Ord> *init_fn_ord(const Ord3 &order);
+Func<Ord> *init_fn_ord(const Ord3 &order, ScratchArena *arena = NULL);
 
 /// Init the function for the evaluation of the volumetric integral
-sFunc *init_fn(ShapeFunction *fu, RefMap *rm, const int np, const QuadPt3D *pt);
+sFunc *init_fn(ShapeFunction *fu, RefMap *rm, const int np, const QuadPt3D *pt, ScratchArena *arena = NULL);
 
 /// Init the function for the evaluation of the surface integral
-sFunc *init_fn(ShapeFunction *shfn, RefMap *rm, int iface, const int np, const QuadPt3D *pt);
+sFunc *init_fn(ShapeFunction *shfn, RefMap *rm, int iface, const int np, const QuadPt3D *pt,
+               ScratchArena *arena = NULL);
 
 /// Init the mesh-function for the evaluation of the volumetric/surface integral
-mFunc *init_fn(MeshFunction *f, RefMap *rm, const int np, const QuadPt3D *pt);
+mFunc *init_fn(MeshFunction *f, RefMap *rm, const int np, const QuadPt3D *pt, ScratchArena *arena = NULL);
 
 void free_fn(Func<Ord> *f);
 void free_fn(sFunc *f);
@@ -20,6 +20,7 @@
 #define __H3D_COMMON_H_
 
 #include "../../hermes_common/common.h"
+#include "../../hermes_common/perf_counters.h"
 
 // H3D-specific error codes.
 #define H3D_ERR_FACE_INDEX_OUT_OF_RANGE         "Face index out of range."
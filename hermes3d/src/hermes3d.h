@@ -55,6 +55,7 @@
 // mesh loaders
 #include "meshloader.h"
 #include "loader/mesh3d.h"
+#include "loader/mesh3d_binary.h"
 #include "loader/hdf5.h"
 #include "loader/exodusii.h"
 
@@ -104,6 +105,7 @@
 #include "adapt/h1projipol.h"
 
 #include "ogprojection.h"
+#include "checkpoint.h"
 
 // global H3D iface
 void set_verbose(bool verb = true);
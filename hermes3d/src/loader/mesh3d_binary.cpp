@@ -0,0 +1,183 @@
+// This file is part of Hermes3D
+//
+// Copyright (c) 2009 hp-FEM group at the University of Nevada, Reno (UNR).
+// Email: hpfem-group@unr.edu, home page: http://hpfem.org/.
+//
+// Hermes3D is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published
+// by the Free Software Foundation; either version 2 of the License,
+// or (at your option) any later version.
+//
+// Hermes3D is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Hermes3D; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#include "mesh3d_binary.h"
+#include <string.h>
+#include "../../../hermes_common/error.h"
+#include "../../../hermes_common/trace.h"
+#include "../../../hermes_common/callstack.h"
+#include "../mesh.h"
+
+// file header: magic, version, number of vertices, tetras, hexes, prisms, tris, quads
+static const char *H3DB_MAGIC = "H3DB";
+static const int H3DB_VERSION = 1;
+
+enum { H3DB_VERTICES, H3DB_TETRAS, H3DB_HEXES, H3DB_PRISMS, H3DB_TRIS, H3DB_QUADS, H3DB_NUM_SECTIONS };
+
+// number of entries per item of each section (vertices are doubles, the rest are vertex
+// indices followed by a marker)
+static const int section_size[H3DB_NUM_SECTIONS] = {
+	Vertex::NUM_COORDS,
+	Tetra::NUM_VERTICES + 1,
+	Hex::NUM_VERTICES + 1,
+	Prism::NUM_VERTICES + 1,
+	Tri::NUM_VERTICES + 1,
+	Quad::NUM_VERTICES + 1
+};
+
+H3DBinaryReader::H3DBinaryReader() {
+	_F_
+}
+
+H3DBinaryReader::~H3DBinaryReader() {
+	_F_
+}
+
+static bool read_section(FILE *file, unsigned int *data, unsigned int count, int size, unsigned int max_vertex_index) {
+	_F_
+	if (count == 0) return true;
+	if (fread(data, sizeof(unsigned int), count * size, file) != count * size) return false;
+	for (unsigned int i = 0; i < count; i++) {
+		unsigned int *vs = data + i * size;
+		for (int j = 0; j < size - 1; j++)
+			if (vs[j] <= 0 || vs[j] > max_vertex_index) return false;
+	}
+	return true;
+}
+
+bool H3DBinaryReader::load(const char *file_name, Mesh *mesh) {
+	_F_
+	assert(mesh != NULL);
+
+	FILE *file = fopen(file_name, "rb");
+	if (file == NULL) return false;
+
+	char magic[4];
+	int ver;
+	unsigned int count[H3DB_NUM_SECTIONS];
+	if (fread(magic, 1, 4, file) != 4 || memcmp(magic, H3DB_MAGIC, 4) ||
+	    fread(&ver, sizeof(int), 1, file) != 1 || ver > H3DB_VERSION ||
+	    fread(count, sizeof(unsigned int), H3DB_NUM_SECTIONS, file) != H3DB_NUM_SECTIONS) {
+		fclose(file);
+		return false;
+	}
+
+	// vertices
+	unsigned int nv = count[H3DB_VERTICES];
+	double *pts = new double[Vertex::NUM_COORDS * nv];
+	MEM_CHECK(pts);
+	bool ok = fread(pts, sizeof(double), Vertex::NUM_COORDS * nv, file) == Vertex::NUM_COORDS * nv;
+	if (ok) {
+		for (unsigned int i = 0; i < nv; i++)
+			mesh->add_vertex(pts[3 * i], pts[3 * i + 1], pts[3 * i + 2]);
+	}
+	delete [] pts;
+
+	// the remaining sections in one buffer, reused for each of them
+	unsigned int max_items = 0;
+	for (int s = H3DB_TETRAS; s < H3DB_NUM_SECTIONS; s++)
+		max_items = std::max(max_items, count[s] * section_size[s]);
+	unsigned int *data = new unsigned int[max_items + 1];
+	MEM_CHECK(data);
+
+	for (int s = H3DB_TETRAS; ok && s < H3DB_NUM_SECTIONS; s++) {
+		int size = section_size[s];
+		if (!(ok = read_section(file, data, count[s], size, nv))) break;
+
+		for (unsigned int i = 0; i < count[s]; i++) {
+			unsigned int *vs = data + i * size;
+			int marker = vs[size - 1];
+			switch (s) {
+				case H3DB_TETRAS: mesh->add_tetra(vs)->marker = marker; break;
+				case H3DB_HEXES: mesh->add_hex(vs)->marker = marker; break;
+				case H3DB_PRISMS: mesh->add_prism(vs)->marker = marker; break;
+				case H3DB_TRIS: mesh->add_tri_boundary(vs, marker); break;
+				case H3DB_QUADS: mesh->add_quad_boundary(vs, marker); break;
+			}
+		}
+	}
+	delete [] data;
+	fclose(file);
+	if (!ok) return false;
+
+	// check if all "outer" faces have defined boundary condition
+	for (int i = mesh->facets.first(); i != INVALID_IDX; i = mesh->facets.next(i)) {
+		Facet *facet = mesh->facets.get(i);
+		if ((facet->left == INVALID_IDX) || (facet->right == INVALID_IDX)) return false;
+	}
+
+	mesh->ugh();
+	return true;
+}
+
+bool H3DBinaryReader::save(const char *file_name, Mesh *mesh) {
+	_F_
+	assert(mesh != NULL);
+
+	// active elements and outer facets, with vertex indices and markers
+	std::vector<unsigned int> sec[H3DB_NUM_SECTIONS];
+	FOR_ALL_ACTIVE_ELEMENTS(eid, mesh) {
+		Element *elem = mesh->elements[eid];
+		int s;
+		switch (elem->get_mode()) {
+			case MODE_TETRAHEDRON: s = H3DB_TETRAS; break;
+			case MODE_HEXAHEDRON: s = H3DB_HEXES; break;
+			case MODE_PRISM: s = H3DB_PRISMS; break;
+			default: EXIT(HERMES_ERR_UNKNOWN_MODE);
+		}
+		unsigned int vtcs[Hex::NUM_VERTICES];
+		elem->get_vertices(vtcs);
+		sec[s].insert(sec[s].end(), vtcs, vtcs + elem->get_num_vertices());
+		sec[s].push_back(elem->marker);
+	}
+
+	for (int i = mesh->facets.first(); i != INVALID_IDX; i = mesh->facets.next(i)) {
+		Facet *facet = mesh->facets.get(i);
+		if (facet->type != Facet::OUTER || !mesh->elements[facet->left]->active) continue;
+
+		int s = (facet->mode == MODE_TRIANGLE) ? H3DB_TRIS : H3DB_QUADS;
+		unsigned int vtcs[Quad::NUM_VERTICES];
+		int nvtcs = mesh->elements[facet->left]->get_face_vertices(facet->left_face_num, vtcs);
+		sec[s].insert(sec[s].end(), vtcs, vtcs + nvtcs);
+		sec[s].push_back(mesh->boundaries[facet->right]->marker);
+	}
+
+	FILE *file = fopen(file_name, "wb");
+	if (file == NULL) return false;
+
+	unsigned int count[H3DB_NUM_SECTIONS];
+	count[H3DB_VERTICES] = mesh->vertices.count();
+	for (int s = H3DB_TETRAS; s < H3DB_NUM_SECTIONS; s++)
+		count[s] = sec[s].size() / section_size[s];
+
+	hermes_fwrite(H3DB_MAGIC, 1, 4, file);
+	hermes_fwrite(&H3DB_VERSION, sizeof(int), 1, file);
+	hermes_fwrite(count, sizeof(unsigned int), H3DB_NUM_SECTIONS, file);
+
+	for (int i = mesh->vertices.first(); i != INVALID_IDX; i = mesh->vertices.next(i)) {
+		Vertex *v = mesh->vertices[i];
+		double pt[Vertex::NUM_COORDS] = { v->x, v->y, v->z };
+		hermes_fwrite(pt, sizeof(double), Vertex::NUM_COORDS, file);
+	}
+	for (int s = H3DB_TETRAS; s < H3DB_NUM_SECTIONS; s++)
+		if (!sec[s].empty()) hermes_fwrite(&sec[s][0], sizeof(unsigned int), sec[s].size(), file);
+
+	fclose(file);
+	return true;
+}
@@ -0,0 +1,42 @@
+// This file is part of Hermes3D
+//
+// Copyright (c) 2009 hp-FEM group at the University of Nevada, Reno (UNR).
+// Email: hpfem-group@unr.edu, home page: http://hpfem.org/.
+//
+// Hermes3D is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published
+// by the Free Software Foundation; either version 2 of the License,
+// or (at your option) any later version.
+//
+// Hermes3D is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Hermes3D; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#ifndef _MESH3D_BINARY_LOADER_H_
+#define _MESH3D_BINARY_LOADER_H_
+
+#include "../meshloader.h"
+
+/// Mesh loader for the binary Hermes3D format ("H3DB")
+///
+/// The file holds the same sections as the Mesh3D format (vertices, tetras, hexes,
+/// prisms, tris and quads), each stored as one array that is read by a single fread().
+/// A text mesh can be converted once by loading it with H3DReader and saving it
+/// with H3DBinaryReader::save().
+///
+/// @ingroup meshloaders
+class HERMES_API H3DBinaryReader : public MeshLoader {
+public:
+	H3DBinaryReader();
+	virtual ~H3DBinaryReader();
+
+	virtual bool load(const char *file_name, Mesh *mesh);
+	virtual bool save(const char *file_name, Mesh *mesh);
+};
+
+#endif
@@ -713,6 +713,9 @@ Mesh::Mesh() {
 	nactive = 0;
 	nbase = 0;
 	seq = g_mesh_seq++;
+	ordering = HERMES_SFC_NONE;
+	base_order = NULL;
+	base_order_size = 0;
 }
 
 Mesh::~Mesh() {
@@ -740,6 +743,11 @@ void Mesh::free() {
 
 	midpoints.remove_all();
 	edges.remove_all();
+
+	delete [] base_order;
+	base_order = NULL;
+	base_order_size = 0;
+	ordering = HERMES_SFC_NONE;
 }
 
 void Mesh::copy(const Mesh &mesh) {
@@ -831,6 +839,7 @@ void Mesh::copy(const Mesh &mesh) {
 	nbase = mesh.nbase;
 	nactive = mesh.nactive;
 	seq = mesh.seq;
+	copy_element_ordering(mesh);
 }
 
 void Mesh::copy_base(const Mesh &mesh) {
@@ -890,6 +899,89 @@ void Mesh::copy_base(const Mesh &mesh) {
 
 	this->nbase = this->nactive = mesh.nbase;
 	this->seq = g_mesh_seq++;
+	copy_element_ordering(mesh);
+}
+
+// element ordering
+
+struct SfcKey {
+	unsigned long long key;
+	unsigned int id;
+	bool operator<(const SfcKey &other) const { return key < other.key; }
+};
+
+void Mesh::set_element_ordering(SpaceFillingCurve curve) {
+	_F_
+	ordering = curve;
+	delete [] base_order;
+	base_order = NULL;
+	base_order_size = 0;
+	if (ordering != HERMES_SFC_NONE)
+		calc_base_element_order();
+}
+
+const unsigned int *Mesh::get_base_element_order() {
+	_F_
+	if (ordering == HERMES_SFC_NONE) return NULL;
+	if (base_order == NULL || base_order_size != nbase)
+		calc_base_element_order();
+	return base_order;
+}
+
+void Mesh::calc_base_element_order() {
+	_F_
+	// centroids and the bounding box of the base mesh
+	double lo[3] = { 1e300, 1e300, 1e300 };
+	double hi[3] = { -1e300, -1e300, -1e300 };
+	double (*c)[3] = new double[nbase][3];
+	for (unsigned int id = 1; id <= nbase; id++) {
+		Element *e = elements[id];
+		int nv = e->get_num_vertices();
+		unsigned int vtcs[Hex::NUM_VERTICES];  // hex is shape with the largest number of vertices
+		e->get_vertices(vtcs);
+		double *ci = c[id - 1];
+		ci[0] = ci[1] = ci[2] = 0.0;
+		for (int i = 0; i < nv; i++) {
+			Vertex *v = vertices[vtcs[i]];
+			double pt[3] = { v->x, v->y, v->z };
+			for (int k = 0; k < 3; k++) {
+				ci[k] += pt[k] / nv;
+				lo[k] = std::min(lo[k], pt[k]);
+				hi[k] = std::max(hi[k], pt[k]);
+			}
+		}
+	}
+
+	SfcKey *keys = new SfcKey[nbase];
+	for (unsigned int i = 0; i < nbase; i++) {
+		keys[i].id = i + 1;
+		keys[i].key = sfc_index(ordering, c[i], lo, hi, 3);
+	}
+	std::stable_sort(keys, keys + nbase);
+
+	delete [] base_order;
+	base_order = new unsigned int[nbase];
+	MEM_CHECK(base_order);
+	for (unsigned int i = 0; i < nbase; i++)
+		base_order[i] = keys[i].id;
+	base_order_size = nbase;
+
+	delete [] keys;
+	delete [] c;
+}
+
+void Mesh::copy_element_ordering(const Mesh &mesh) {
+	_F_
+	ordering = mesh.ordering;
+	delete [] base_order;
+	base_order = NULL;
+	base_order_size = 0;
+	if (mesh.base_order != NULL && mesh.base_order_size == nbase) {
+		base_order = new unsigned int[nbase];
+		MEM_CHECK(base_order);
+		memcpy(base_order, mesh.base_order, sizeof(unsigned int) * nbase);
+		base_order_size = nbase;
+	}
 }
 
 unsigned int Mesh::get_facet_id(Element *e, int face_num) const {
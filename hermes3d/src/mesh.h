@@ -29,6 +29,7 @@ class MeshLoader;
 #include "../../hermes_common/array.h"
 #include "../../hermes_common/arrayptr.h"
 #include "../../hermes_common/mapord.h"
+#include "../../hermes_common/sfc.h"
 
 /// Iterates over all mesh vertex indices.
 ///
@@ -589,6 +590,14 @@ public:
 	/// Regularize mesh (only 1-irregularity rule implemented)
 	void regularize();
 
+	/// Sets the order in which Traverse visits the base elements. With HERMES_SFC_MORTON
+	/// or HERMES_SFC_HILBERT, the base elements are sorted along the curve through their
+	/// centroids. HERMES_SFC_NONE restores the default order by element id.
+	void set_element_ordering(SpaceFillingCurve curve);
+	/// Returns the base element ids in the traversal order (i.e. an array of
+	/// get_num_base_elements() ids), or NULL if they are traversed by their ids.
+	const unsigned int *get_base_element_order();
+
 	//
 	unsigned int get_facet_id(Element *e, int face_num) const;
 
@@ -645,6 +654,12 @@ protected:
 	unsigned int nbase;							/// number of base elements
 	unsigned int nactive;						/// number of active elements
 
+	SpaceFillingCurve ordering;
+	unsigned int *base_order;				/// base element ids sorted along the curve
+	unsigned int base_order_size;				/// number of base elements when 'base_order' was calculated
+	void calc_base_element_order();
+	void copy_element_ordering(const Mesh &mesh);
+
 	Tetra *create_tetra(unsigned int vtcs[]);
 	Hex *create_hex(unsigned int vtcs[]);
 	Prism *create_prism(unsigned int vtcs[]);
@@ -111,10 +111,12 @@ void Space::ElementData::dump(int id) {
 
 Space::Space(Mesh *mesh, Shapeset *shapeset, BCType (*bc_type_callback)(int), 
              scalar (*bc_value_callback_by_coord)(int, double, double, double), Ord3 p_init)
-     : mesh(mesh), shapeset(shapeset)
+     : mesh(mesh), shapeset(shapeset), ced_arena(16 * 1024)
 {
   _F_
   if (mesh == NULL) error("Space must be initialized with an existing mesh.");
+  this->num_threads = 1;
+  this->incremental = false;
   this->set_bc_types_init(bc_type_callback);
   this->set_essential_bc_values(bc_value_callback_by_coord);
   //this->set_essential_bc_values((scalar3 &(*)(int, double, double, double)) NULL);
@@ -689,7 +691,7 @@ Space::FaceData *Space::create_face_node_data(unsigned int fid, bool ced) {
 	return fd;
 }
 
-void Space::fc_face(unsigned int eid, int iface, bool ced) {
+void Space::fc_face(unsigned int eid, int iface, bool ced, FcNodes &nodes) {
 	_F_
 
 	if (eid == INVALID_IDX) return;
@@ -703,7 +705,7 @@ void Space::fc_face(unsigned int eid, int iface, bool ced) {
 	unsigned int fid = mesh->get_facet_id(elem, iface);
 	Facet *facet = mesh->facets[fid];
 
-	if (ced) face_ced.set(fid);
+	if (ced) nodes.ced_faces.push_back(fid);
 
 	// set CEDs
 	unsigned int emp[4], fmp;
@@ -713,17 +715,17 @@ void Space::fc_face(unsigned int eid, int iface, bool ced) {
 			emp[1] = mesh->peek_midpoint(vtcs[3], vtcs[0]);
 
 			// vertices
-			create_vertex_node_data(emp[0], ced);
-			create_vertex_node_data(emp[1], ced);
+			nodes.vertices.push_back(std::make_pair(emp[0], ced));
+			nodes.vertices.push_back(std::make_pair(emp[1], ced));
 			// edges
-			create_edge_node_data(mesh->get_edge_id(vtcs[1], emp[0]), ced);
-			create_edge_node_data(mesh->get_edge_id(emp[0], vtcs[2]), ced);
-			create_edge_node_data(mesh->get_edge_id(vtcs[3], emp[1]), ced);
-			create_edge_node_data(mesh->get_edge_id(emp[1], vtcs[0]), ced);
-
-			create_edge_node_data(mesh->get_edge_id(vtcs[0], vtcs[1]), false);
-			create_edge_node_data(mesh->get_edge_id(emp[0], emp[1]), ced);
-			create_edge_node_data(mesh->get_edge_id(vtcs[2], vtcs[3]), false);
+			nodes.edges.push_back(std::make_pair(mesh->get_edge_id(vtcs[1], emp[0]), ced));
+			nodes.edges.push_back(std::make_pair(mesh->get_edge_id(emp[0], vtcs[2]), ced));
+			nodes.edges.push_back(std::make_pair(mesh->get_edge_id(vtcs[3], emp[1]), ced));
+			nodes.edges.push_back(std::make_pair(mesh->get_edge_id(emp[1], vtcs[0]), ced));
+
+			nodes.edges.push_back(std::make_pair(mesh->get_edge_id(vtcs[0], vtcs[1]), false));
+			nodes.edges.push_back(std::make_pair(mesh->get_edge_id(emp[0], emp[1]), ced));
+			nodes.edges.push_back(std::make_pair(mesh->get_edge_id(vtcs[2], vtcs[3]), false));
 			break;
 
 		case H3D_REFT_QUAD_VERT:
@@ -731,17 +733,17 @@ void Space::fc_face(unsigned int eid, int iface, bool ced) {
 			emp[1] = mesh->peek_midpoint(vtcs[2], vtcs[3]);
 
 			// vertices
-			create_vertex_node_data(emp[0], ced);
-			create_vertex_node_data(emp[1], ced);
+			nodes.vertices.push_back(std::make_pair(emp[0], ced));
+			nodes.vertices.push_back(std::make_pair(emp[1], ced));
 			// edges by edges
-			create_edge_node_data(mesh->get_edge_id(vtcs[0], emp[0]), ced);
-			create_edge_node_data(mesh->get_edge_id(emp[0], vtcs[1]), ced);
-			create_edge_node_data(mesh->get_edge_id(vtcs[2], emp[1]), ced);
-			create_edge_node_data(mesh->get_edge_id(emp[1], vtcs[3]), ced);
-
-			create_edge_node_data(mesh->get_edge_id(vtcs[0], vtcs[3]), false);
-			create_edge_node_data(mesh->get_edge_id(emp[0], emp[1]), ced);
-			create_edge_node_data(mesh->get_edge_id(vtcs[1], vtcs[2]), false);
+			nodes.edges.push_back(std::make_pair(mesh->get_edge_id(vtcs[0], emp[0]), ced));
+			nodes.edges.push_back(std::make_pair(mesh->get_edge_id(emp[0], vtcs[1]), ced));
+			nodes.edges.push_back(std::make_pair(mesh->get_edge_id(vtcs[2], emp[1]), ced));
+			nodes.edges.push_back(std::make_pair(mesh->get_edge_id(emp[1], vtcs[3]), ced));
+
+			nodes.edges.push_back(std::make_pair(mesh->get_edge_id(vtcs[0], vtcs[3]), false));
+			nodes.edges.push_back(std::make_pair(mesh->get_edge_id(emp[0], emp[1]), ced));
+			nodes.edges.push_back(std::make_pair(mesh->get_edge_id(vtcs[1], vtcs[2]), false));
 			break;
 
 		case H3D_REFT_QUAD_BOTH:
@@ -753,14 +755,14 @@ void Space::fc_face(unsigned int eid, int iface, bool ced) {
 
 			// vertices
 			for (int iv = 0; iv < Quad::NUM_VERTICES; iv++)
-				create_vertex_node_data(emp[iv], ced);
-			create_vertex_node_data(fmp, ced);
+				nodes.vertices.push_back(std::make_pair(emp[iv], ced));
+			nodes.vertices.push_back(std::make_pair(fmp, ced));
 			// edges
 			for (int i = 0; i < Quad::NUM_VERTICES; i++) {
 				int i1 = (i + 1) % Quad::NUM_VERTICES;
-				create_edge_node_data(mesh->get_edge_id(vtcs[i], emp[i]), ced);
-				create_edge_node_data(mesh->get_edge_id(emp[i], vtcs[i1]), ced);
-				create_edge_node_data(mesh->get_edge_id(emp[i], fmp), ced);
+				nodes.edges.push_back(std::make_pair(mesh->get_edge_id(vtcs[i], emp[i]), ced));
+				nodes.edges.push_back(std::make_pair(mesh->get_edge_id(emp[i], vtcs[i1]), ced));
+				nodes.edges.push_back(std::make_pair(mesh->get_edge_id(emp[i], fmp), ced));
 			}
 			break;
 	}
@@ -769,33 +771,33 @@ void Space::fc_face(unsigned int eid, int iface, bool ced) {
 	// faces (common for all types of refinements)
 	for (int i = 0; i < Facet::MAX_SONS; i++) {
 		unsigned int sid = facet->sons[i];
-		if (sid != INVALID_IDX) create_face_node_data(sid, ced);
+		if (sid != INVALID_IDX) nodes.faces.push_back(std::make_pair(sid, ced));
 	}
 }
 
-void Space::fc_face_left(unsigned int fid) {
+void Space::fc_face_left(unsigned int fid, FcNodes &nodes) {
 	_F_
 	if (fid == INVALID_IDX) return;
 
 	Facet *facet = mesh->facets[fid];
-	fc_face(facet->left, facet->left_face_num, true);
+	fc_face(facet->left, facet->left_face_num, true, nodes);
 	// recur to sons
 	for (int i = 0; i < Facet::MAX_SONS; i++)
-		fc_face_left(facet->sons[i]);
+		fc_face_left(facet->sons[i], nodes);
 }
 
-void Space::fc_face_right(unsigned int fid) {
+void Space::fc_face_right(unsigned int fid, FcNodes &nodes) {
 	_F_
 	if (fid == INVALID_IDX) return;
 
 	Facet *facet = mesh->facets[fid];
-	fc_face(facet->right, facet->right_face_num, true);
+	fc_face(facet->right, facet->right_face_num, true, nodes);
 	// recur to sons
 	for (int i = 0; i < Facet::MAX_SONS; i++)
-		fc_face_right(facet->sons[i]);
+		fc_face_right(facet->sons[i], nodes);
 }
 
-void Space::fc_element(unsigned int idx) {
+void Space::fc_element(unsigned int idx, FcNodes &nodes) {
 	_F_
 	if (idx == INVALID_IDX) return;
 
@@ -810,26 +812,26 @@ void Space::fc_element(unsigned int idx) {
 		unsigned int *vtcs = new unsigned int[nv];
 		elem->get_face_vertices(iface, vtcs);
 		for (int iv = 0; iv < nv; iv++)
-			create_vertex_node_data(vtcs[iv], false);
+			nodes.vertices.push_back(std::make_pair(vtcs[iv], false));
     delete [] vtcs;
 		// edges
 		int ne = elem->get_num_face_edges(iface);
 		const int *edge_idx = elem->get_face_edges(iface);
 		for (int ie = 0; ie < ne; ie++)
-			create_edge_node_data(mesh->get_edge_id(elem, edge_idx[ie]), false);
+			nodes.edges.push_back(std::make_pair(mesh->get_edge_id(elem, edge_idx[ie]), false));
 
 		// face
-		create_face_node_data(fid, false);
+		nodes.faces.push_back(std::make_pair(fid, false));
 
 		// handle possible CEDs
 		if (facet->type == Facet::INNER) {
 			if (facet->lactive && !facet->ractive) {
-				fc_face(facet->left, facet->left_face_num, true);
-				fc_face_right(fid);
+				fc_face(facet->left, facet->left_face_num, true, nodes);
+				fc_face_right(fid, nodes);
 			}
 			else if (!facet->lactive && facet->ractive) {
-				fc_face(facet->right, facet->right_face_num, true);
-				fc_face_left(fid);
+				fc_face(facet->right, facet->right_face_num, true, nodes);
+				fc_face_left(fid, nodes);
 			}
 			else if (!facet->lactive && !facet->ractive) {
 				// facet sons
@@ -841,10 +843,10 @@ void Space::fc_element(unsigned int idx) {
 							Facet *son_facet = mesh->facets[son];
 
 							if (son_facet->lactive && !son_facet->ractive) {
-								fc_face(facet->left, facet->left_face_num, true);
+								fc_face(facet->left, facet->left_face_num, true, nodes);
 							}
 							else if (!son_facet->lactive && son_facet->ractive) {
-								fc_face(facet->right, facet->right_face_num, true);
+								fc_face(facet->right, facet->right_face_num, true, nodes);
 							}
 						}
 					}
@@ -854,7 +856,7 @@ void Space::fc_element(unsigned int idx) {
 	}
 }
 
-void Space::fc_base(unsigned int eid, int iface)
+void Space::fc_base(unsigned int eid, int iface, FcNodes &nodes)
 {
 	if (eid == INVALID_IDX) return;
 
@@ -865,17 +867,17 @@ void Space::fc_base(unsigned int eid, int iface)
 	unsigned int *vtcs = new unsigned int[nv];
 	elem->get_face_vertices(iface, vtcs);
 	for (int iv = 0; iv < nv; iv++)
-		create_vertex_node_data(vtcs[iv], false);
+		nodes.vertices.push_back(std::make_pair(vtcs[iv], false));
   delete [] vtcs;
 	// edges
 	int ne = elem->get_num_face_edges(iface);
 	const int *edge_idx = elem->get_face_edges(iface);
 	for (int ie = 0; ie < ne; ie++)
-		create_edge_node_data(mesh->get_edge_id(elem, edge_idx[ie]), false);
+		nodes.edges.push_back(std::make_pair(mesh->get_edge_id(elem, edge_idx[ie]), false));
 
 	//
 	unsigned int fid = mesh->get_facet_id(elem, iface);
-	create_face_node_data(fid, false);
+	nodes.faces.push_back(std::make_pair(fid, false));
 
 }
 
@@ -937,29 +939,84 @@ void Space::find_constraints()
 		}
 	}
 
-	for (unsigned int idx = open.first(); idx != INVALID_IDX; idx = open.next(idx)) {
-		unsigned int fid = open[idx];
-		Facet *facet = mesh->facets[fid];
-		assert(facet != NULL);
+	int nf = 0;
+	unsigned int *fids = new unsigned int[open.count()];
+	MEM_CHECK(fids);
+	for (unsigned int idx = open.first(); idx != INVALID_IDX; idx = open.next(idx))
+		fids[nf++] = open[idx];
 
-		fc_base(facet->left, facet->left_face_num);
-		if (facet->type == Facet::INNER)
-			fc_base(facet->right, facet->right_face_num);
+	// the facets are split among the threads, every thread collects the nodes it finds
+	int nthreads = std::max(1, std::min(num_threads, nf));
+	FcWork *work = new FcWork[nthreads];
+	MEM_CHECK(work);
+	for (int t = 0; t < nthreads; t++) {
+		work[t].space = this;
+		work[t].fids = fids + (int) ((long) nf * t / nthreads);
+		work[t].nf = (int) ((long) nf * (t + 1) / nthreads) - (int) ((long) nf * t / nthreads);
+	}
 
-		// handle possible CEDs
-		if (facet->type == Facet::INNER) {
-			if (facet->lactive && !facet->ractive) {
-				fc_face(facet->left, facet->left_face_num, true);
-				fc_face_right(fid);
-			}
-			else if (!facet->lactive && facet->ractive) {
-				fc_face(facet->right, facet->right_face_num, true);
-				fc_face_left(fid);
-			}
+	bool *started = new bool[nthreads];
+	for (int t = 1; t < nthreads; t++)
+		started[t] = (pthread_create(&work[t].thread, NULL, fc_worker, work + t) == 0);
+	fc_worker(work + 0);
+	for (int t = 1; t < nthreads; t++) {
+		if (started[t]) pthread_join(work[t].thread, NULL);
+		else fc_worker(work + t);
+	}
+	delete [] started;
+
+	// the final state of a node does not depend on the order in which it was found
+	for (int t = 0; t < nthreads; t++)
+		create_nodes(work[t].nodes);
+
+	delete [] work;
+	delete [] fids;
+}
+
+void Space::fc_facet(unsigned int fid, FcNodes &nodes)
+{
+	_F_
+	Facet *facet = mesh->facets[fid];
+	assert(facet != NULL);
+
+	fc_base(facet->left, facet->left_face_num, nodes);
+	if (facet->type == Facet::INNER)
+		fc_base(facet->right, facet->right_face_num, nodes);
+
+	// handle possible CEDs
+	if (facet->type == Facet::INNER) {
+		if (facet->lactive && !facet->ractive) {
+			fc_face(facet->left, facet->left_face_num, true, nodes);
+			fc_face_right(fid, nodes);
+		}
+		else if (!facet->lactive && facet->ractive) {
+			fc_face(facet->right, facet->right_face_num, true, nodes);
+			fc_face_left(fid, nodes);
 		}
 	}
 }
 
+void *Space::fc_worker(void *data)
+{
+	FcWork *work = (FcWork *) data;
+	for (int i = 0; i < work->nf; i++)
+		work->space->fc_facet(work->fids[i], work->nodes);
+	return NULL;
+}
+
+void Space::create_nodes(FcNodes &nodes)
+{
+	_F_
+	for (unsigned int i = 0; i < nodes.vertices.size(); i++)
+		create_vertex_node_data(nodes.vertices[i].first, nodes.vertices[i].second);
+	for (unsigned int i = 0; i < nodes.edges.size(); i++)
+		create_edge_node_data(nodes.edges[i].first, nodes.edges[i].second);
+	for (unsigned int i = 0; i < nodes.faces.size(); i++)
+		create_face_node_data(nodes.faces[i].first, nodes.faces[i].second);
+	for (unsigned int i = 0; i < nodes.ced_faces.size(); i++)
+		face_ced.set(nodes.ced_faces[i]);
+}
+
 inline void Space::output_component(BaseVertexComponent *&current, BaseVertexComponent *&last, BaseVertexComponent *min, bool add) {
 	_F_
 	// if the edge is already in the list, just add half of the other coef
@@ -982,9 +1039,9 @@ inline void Space::output_component(BaseVertexComponent *&current, BaseVertexCom
 /// @param[in] l - list
 /// @param[in] n - number of elements in the list
 template<typename T>
-static T *duplicate_baselist(T *l, int n) {
+static T *duplicate_baselist(ScratchArena &arena, T *l, int n) {
 	_F_
-	T *dup = (T *) malloc(n * sizeof(T));
+	T *dup = arena.alloc_array<T>(n);
 	memcpy(dup, l, n * sizeof(T));
 	return dup;
 }
@@ -992,13 +1049,13 @@ static T *duplicate_baselist(T *l, int n) {
 Space::BaseVertexComponent *Space::merge_baselist(BaseVertexComponent *l1, int n1, BaseVertexComponent *l2, int n2, int &ncomponents, bool add) {
 	_F_
 	if (l1 == NULL && l2 == NULL) { ncomponents = 0; return NULL; }
-	if (l1 == NULL) { ncomponents = n2; return duplicate_baselist<BaseVertexComponent>(l2, n2); }
-	if (l2 == NULL) { ncomponents = n1; return duplicate_baselist<BaseVertexComponent>(l1, n1); }
+	if (l1 == NULL) { ncomponents = n2; return duplicate_baselist<BaseVertexComponent>(ced_arena, l2, n2); }
+	if (l2 == NULL) { ncomponents = n1; return duplicate_baselist<BaseVertexComponent>(ced_arena, l1, n1); }
 
 	// estimate the upper bound of the result size
 	int max_result = n1 + n2;
 
-	BaseVertexComponent *result = (BaseVertexComponent *) malloc(max_result * sizeof(BaseVertexComponent));
+	BaseVertexComponent *result = ced_arena.alloc_array<BaseVertexComponent>(max_result);
 	BaseVertexComponent *current = result;
 	BaseVertexComponent *last = NULL;
 
@@ -1013,11 +1070,9 @@ Space::BaseVertexComponent *Space::merge_baselist(BaseVertexComponent *l1, int n
 	while (i1 < n1) output_component(current, last, l1 + i1++, add);
 	while (i2 < n2) output_component(current, last, l2 + i2++, add);
 
-	// if we produced less components than we expected, reallocate the resulting array
-	// ...this should be OK as we are always shrinking the array so no copying should occur
+	// the unused part of the array stays in the arena until assign_dofs() releases it
 	ncomponents = current - result;
-	if (ncomponents < max_result) return (BaseVertexComponent *) realloc(result, ncomponents * sizeof(BaseVertexComponent));
-	else return result;
+	return result;
 }
 
 inline void Space::output_component(BaseEdgeComponent *&current, BaseEdgeComponent *&last, BaseEdgeComponent *min, bool add) {
@@ -1042,11 +1097,11 @@ inline void Space::output_component(BaseEdgeComponent *&current, BaseEdgeCompone
 Space::BaseEdgeComponent *Space::merge_baselist(BaseEdgeComponent *l1, int n1, BaseEdgeComponent *l2, int n2, int &ncomponents, bool add) {
 	_F_
 	if (l1 == NULL && l2 == NULL) { ncomponents = 0; return NULL; }
-	if (l1 == NULL) { ncomponents = n2; return duplicate_baselist<BaseEdgeComponent>(l2, n2); }
-	if (l2 == NULL) { ncomponents = n1; return duplicate_baselist<BaseEdgeComponent>(l1, n1); }
+	if (l1 == NULL) { ncomponents = n2; return duplicate_baselist<BaseEdgeComponent>(ced_arena, l2, n2); }
+	if (l2 == NULL) { ncomponents = n1; return duplicate_baselist<BaseEdgeComponent>(ced_arena, l1, n1); }
 
 	int max_result = n1 + n2;
-	BaseEdgeComponent *result = (BaseEdgeComponent *) malloc(max_result * sizeof(BaseEdgeComponent));
+	BaseEdgeComponent *result = ced_arena.alloc_array<BaseEdgeComponent>(max_result);
 	BaseEdgeComponent *current = result;
 	BaseEdgeComponent *last = NULL;
 
@@ -1062,8 +1117,7 @@ Space::BaseEdgeComponent *Space::merge_baselist(BaseEdgeComponent *l1, int n1, B
 	while (i2 < n2) output_component(current, last, l2 + i2++, add);
 
 	ncomponents = current - result;
-	if (ncomponents < max_result) return (BaseEdgeComponent *) realloc(result, ncomponents * sizeof(BaseEdgeComponent));
-	else return result;
+	return result;
 }
 
 inline void Space::output_component_over(BaseFaceComponent *&current, BaseFaceComponent *min, BaseFaceComponent *m) {
@@ -1113,7 +1167,7 @@ Space::BaseFaceComponent *Space::merge_baselist(BaseFaceComponent *l1, int n1, B
 	if (l1 == NULL && l2 == NULL) { ncomponents = 0; return NULL; }
 
 	int max_result = n1 + n2;
-	BaseFaceComponent *result = (BaseFaceComponent *) malloc(max_result * sizeof(BaseFaceComponent));
+	BaseFaceComponent *result = ced_arena.alloc_array<BaseFaceComponent>(max_result);
 	BaseFaceComponent *current = result;
 	BaseFaceComponent *last = NULL;
 
@@ -1159,8 +1213,7 @@ Space::BaseFaceComponent *Space::merge_baselist(BaseFaceComponent *l1, int n1, B
 		ncomponents = current - result;
 	}
 
-	if (ncomponents < max_result) return (BaseFaceComponent *) realloc(result, ncomponents * sizeof(BaseFaceComponent));
-	else return result;
+	return result;
 }
 
 /// @param[in] vtx1 - vertex 1
@@ -1199,7 +1252,6 @@ void Space::calc_vertex_vertex_ced(unsigned int vtx1, unsigned int vtx2) {
 	}
 
 	assert(vd_mid->ced == 1);
-	::free(vd_mid->baselist);
 	int ncomp = 0;
 	vd_mid->baselist = merge_baselist(bl[0], nc[0], bl[1], nc[1], ncomp, false);
 	vd_mid->ncomponents = ncomp;
@@ -1249,16 +1301,12 @@ void Space::calc_mid_vertex_vertex_ced(unsigned int mid, unsigned int vtx1, unsi
 	tmp_bl[0] = merge_baselist(bl[0], nc[0], bl[2], nc[2], tmp_nc[0], false);
 	tmp_bl[1] = merge_baselist(bl[1], nc[1], bl[3], nc[3], tmp_nc[1], false);
 
-	::free(vd_mid->baselist);
 	int ncomp = 0;
 	vd_mid->baselist = merge_baselist(tmp_bl[0], tmp_nc[0], tmp_bl[1], tmp_nc[1], ncomp, false);
 	vd_mid->ncomponents = ncomp;
 
 	for (int i = 0; i < ncomp; i++)
 		PRINTF(" - [%d]: dof = %d, coef = %lf\n", i, vd_mid->baselist[i].dof, vd_mid->baselist[i].coef);
-
-	::free(tmp_bl[0]);
-	::free(tmp_bl[1]);
 }
 
 void Space::calc_vertex_edge_ced(unsigned int vtx, unsigned int eid, int ori, int part) {
@@ -1292,7 +1340,7 @@ void Space::calc_vertex_edge_ced(unsigned int vtx, unsigned int eid, int ori, in
 			FaceData *cng_fnode = fn_data[fcomp->face_id]; 						// constraining face node
 			nc += cng_fnode->n;
 		}
-		BaseVertexComponent *baselist = (BaseVertexComponent *) malloc(nc * sizeof(BaseVertexComponent));
+		BaseVertexComponent *baselist = ced_arena.alloc_array<BaseVertexComponent>(nc);
 
 		int nci = 0;
 		// update the edge part
@@ -1332,18 +1380,14 @@ void Space::calc_vertex_edge_ced(unsigned int vtx, unsigned int eid, int ori, in
 			}
 		}
 
-		BaseVertexComponent *tmp = vd->baselist;
 		vd->baselist = merge_baselist(vd->baselist, vd->ncomponents, baselist, nc, ncomp, true);
 		vd->ncomponents = ncomp;
-
-		::free(tmp);
-		::free(baselist);
 	}
 	else {
 		get_interval_part(part, lo, hi);
 		double mid = (lo + hi) * 0.5;
 
-		BaseVertexComponent *baselist = (BaseVertexComponent *) malloc(ed->n * sizeof(BaseVertexComponent));
+		BaseVertexComponent *baselist = ced_arena.alloc_array<BaseVertexComponent>(ed->n);
 		if (ed->n > 0) {
 			int *indices = shapeset->get_edge_indices(0, ori, ed->order);
 			for (int j = 0, dof = ed->dof; j < ed->n; j++) {
@@ -1354,12 +1398,8 @@ void Space::calc_vertex_edge_ced(unsigned int vtx, unsigned int eid, int ori, in
 			}
 		}
 
-		BaseVertexComponent *tmp = vd->baselist;
 		vd->baselist = merge_baselist(vd->baselist, vd->ncomponents, baselist, ed->n, ncomp, true);
 		vd->ncomponents = ncomp;
-
-		::free(tmp);
-		::free(baselist);
 	}
 }
 
@@ -1432,7 +1472,7 @@ void Space::calc_mid_vertex_edge_ced(unsigned int vtx, unsigned int fmp, unsigne
 		PRINTF(" - fnc = %d\n", cng_fnode->n);
 	}
 
-	BaseVertexComponent *baselist = (BaseVertexComponent *) malloc(nc * sizeof(BaseVertexComponent));
+	BaseVertexComponent *baselist = ced_arena.alloc_array<BaseVertexComponent>(nc);
 	PRINTF(" - nc = %d\n", nc);
 
 	assert(vtx != INVALID_IDX);
@@ -1481,7 +1521,6 @@ void Space::calc_mid_vertex_edge_ced(unsigned int vtx, unsigned int fmp, unsigne
 		}
 	}
 
-	BaseVertexComponent *tmp = vd->baselist;
 	int ncomp = 0;
 	vd->baselist = merge_baselist(vd->baselist, vd->ncomponents, baselist, nc, ncomp, true);
 	vd->ncomponents = ncomp;
@@ -1489,8 +1528,6 @@ void Space::calc_mid_vertex_edge_ced(unsigned int vtx, unsigned int fmp, unsigne
 	for (int i = 0; i < ncomp; i++)
 		PRINTF(" - [%d]: dof = %d, coef = %lf\n", i, vd->baselist[i].dof, vd->baselist[i].coef);
 
-	::free(tmp);
-
 	// ----
 	assert(fmp != INVALID_IDX);
 	VertexData *fmp_vd = vn_data[fmp];
@@ -1515,12 +1552,8 @@ void Space::calc_mid_vertex_edge_ced(unsigned int vtx, unsigned int fmp, unsigne
 		fnc = 1;
 	}
 
-	tmp = fmp_vd->baselist;
 	fmp_vd->baselist = merge_baselist(bl, fnc, baselist, nc, ncomp, true);
 	fmp_vd->ncomponents = ncomp;
-
-	::free(tmp);
-	::free(baselist);
 }
 
 
@@ -1549,7 +1582,7 @@ void Space::calc_vertex_face_ced(unsigned int vtx, unsigned int fid, int ori, in
 		EXIT("Unusual vertex/face CED situation, please report.");
 	}
 	else {
-		BaseVertexComponent *baselist = (BaseVertexComponent *) malloc(fd->n * sizeof(BaseVertexComponent));
+		BaseVertexComponent *baselist = ced_arena.alloc_array<BaseVertexComponent>(fd->n);
 
 		if (fd->n > 0) {
 			int *indices = shapeset->get_face_indices(2, ori, fd->order);
@@ -1569,7 +1602,6 @@ void Space::calc_vertex_face_ced(unsigned int vtx, unsigned int fid, int ori, in
 			}
 		}
 
-		BaseVertexComponent *tmp = vd->baselist;
 		int ncomp = 0;
 		vd->baselist = merge_baselist(vd->baselist, vd->ncomponents, baselist, fd->n, ncomp, true);
 		vd->ncomponents = ncomp;
@@ -1577,9 +1609,6 @@ void Space::calc_vertex_face_ced(unsigned int vtx, unsigned int fid, int ori, in
 		PRINTF("--\n");
 		for (int i = 0; i < vd->ncomponents; i++)
 			PRINTF(" - [%d]: dof = %d, coef = %lf\n", i, vd->baselist[i].dof, vd->baselist[i].coef);
-
-		::free(tmp);
-		::free(baselist);
 	}
 }
 
@@ -1608,25 +1637,23 @@ void Space::calc_edge_edge_ced(unsigned int seid, unsigned int eid, int ori, int
 		PRINTF(" - CED version\n");
 		// use the baselist from the "parent" edge and update the part and ori (?)
 		int ncomp = cng_ed->edge_ncomponents;
-		BaseEdgeComponent *edge_bl = (BaseEdgeComponent *) malloc(ncomp * sizeof(BaseEdgeComponent));
+		BaseEdgeComponent *edge_bl = ced_arena.alloc_array<BaseEdgeComponent>(ncomp);
 		for (int i = 0; i < ncomp; i++) {
 			edge_bl[i] = cng_ed->edge_baselist[i];
 			edge_bl[i].part.part = combine_face_part(edge_bl[i].part.part, epart);
 		}
-		::free(ed->edge_baselist);
 		ed->edge_baselist = edge_bl;
 		ed->edge_ncomponents = ncomp;
 
 		// face components
 		ncomp = cng_ed->face_ncomponents;
-		BaseFaceComponent *face_bl = (BaseFaceComponent *) malloc(ncomp * sizeof(BaseFaceComponent));
+		BaseFaceComponent *face_bl = ced_arena.alloc_array<BaseFaceComponent>(ncomp);
 		for (int i = 0; i < ncomp; i++) {
 			face_bl[i] = cng_ed->face_baselist[i];
 
 			if (face_bl[i].dir == PART_ORI_VERT) face_bl[i].part.vert = combine_face_part(face_bl[i].part.vert, epart);
 			else face_bl[i].part.horz = combine_face_part(face_bl[i].part.horz, epart);
 		}
-		::free(ed->face_baselist);
 		ed->face_baselist = face_bl;
 		ed->face_ncomponents = ncomp;
 
@@ -1645,14 +1672,13 @@ void Space::calc_edge_edge_ced(unsigned int seid, unsigned int eid, int ori, int
 	}
 	else {
 		int nc = 1;
-		BaseEdgeComponent *baselist = (BaseEdgeComponent *) malloc(nc * sizeof(BaseEdgeComponent));
+		BaseEdgeComponent *baselist = ced_arena.alloc_array<BaseEdgeComponent>(nc);
 		baselist[0].edge_id = eid;
 		baselist[0].ori = ori;
 		baselist[0].part.part = part;
 		baselist[0].coef = 1.0;
 
 		assert(ed->ced == 1);
-		BaseEdgeComponent *tmp = ed->edge_baselist;
 		int ncomp = 0;
 		ed->edge_baselist = merge_baselist(ed->edge_baselist, ed->edge_ncomponents, baselist, nc, ncomp, false);
 		ed->edge_ncomponents = ncomp;
@@ -1662,9 +1688,6 @@ void Space::calc_edge_edge_ced(unsigned int seid, unsigned int eid, int ori, int
 			PRINTF(" - [%d]: edge_id = %ld, ori = %d, part = %d, coef = %lf\n",
 				i, ec.edge_id, ec.ori, ec.part.part, ec.coef);
 		}
-
-		::free(tmp);
-		::free(baselist);
 	}
 }
 
@@ -1684,7 +1707,6 @@ void Space::calc_mid_edge_edge_ced(unsigned int meid, unsigned int eid[], int or
 	EdgeData *ed[] = { en_data[eid[0]], en_data[eid[1]] };
     BaseEdgeComponent *bl[2], dummy_bl[2];		// base lists of eid1 and eid2
 	int nc[2] = { 0, 0 };						// number of components of bl[0] and bl[1]
-	bool free_bl[2];							// tru if the bl[i] should be freed
 
 	// get baselists of vn[0] and vn[1] - pretend we have them even if they are unconstrained
 	for (int k = 0; k < 2; k++) {
@@ -1692,7 +1714,7 @@ void Space::calc_mid_edge_edge_ced(unsigned int meid, unsigned int eid[], int or
 			PRINTF(" - CED version\n");
 			// use the baselist from the "parent" edge and update the part and ori (?)
 			int ncomp = ed[k]->edge_ncomponents;
-			BaseEdgeComponent *edge_bl = (BaseEdgeComponent *) malloc(ncomp * sizeof(BaseEdgeComponent));
+			BaseEdgeComponent *edge_bl = ced_arena.alloc_array<BaseEdgeComponent>(ncomp);
 			for (int i = 0; i < ncomp; i++) {
 				edge_bl[i] = ed[k]->edge_baselist[i];
 				edge_bl[i].part.part = combine_face_part(edge_bl[i].part.part, epart);
@@ -1700,7 +1722,6 @@ void Space::calc_mid_edge_edge_ced(unsigned int meid, unsigned int eid[], int or
 
 			bl[k] = edge_bl;
 			nc[k] = ncomp;
-			free_bl[k] = true;
 		}
 		else {	// make up an artificial baselist
 			dummy_bl[k].edge_id = eid[k];
@@ -1710,7 +1731,6 @@ void Space::calc_mid_edge_edge_ced(unsigned int meid, unsigned int eid[], int or
 
 			bl[k] = &dummy_bl[k];
 			nc[k] = 1;
-			free_bl[k] = false;
 		}
 	}
 
@@ -1723,9 +1743,6 @@ void Space::calc_mid_edge_edge_ced(unsigned int meid, unsigned int eid[], int or
 		PRINTF(" - [%d]: edge_id = %ld, ori = %d, part = %d, coef = %lf\n",
 			i, ec.edge_id, ec.ori, ec.part.part, ec.coef);
 	}
-
-	if (free_bl[0]) ::free(bl[0]);
-	if (free_bl[1]) ::free(bl[1]);
 }
 
 
@@ -1780,7 +1797,6 @@ void Space::calc_edge_face_ced(unsigned int mid_eid, unsigned int eid[], unsigne
 	dummy_bl.dir = part_ori;
 	dummy_bl.coef = 1.0;
 
-	::free(mid_ed->face_baselist);
 	int ncomp = 0;
 	mid_ed->face_baselist = merge_baselist(&dummy_bl, 1, mbl, mnc, ncomp, fid, true);
 	mid_ed->face_ncomponents = ncomp;
@@ -1790,8 +1806,6 @@ void Space::calc_edge_face_ced(unsigned int mid_eid, unsigned int eid[], unsigne
 		PRINTF(" - [%d]: face_id = %ld, ori = %d, iface = %d, part = (%d, %d), dir = %d, coef = %lf\n",
 			i, fc.face_id, fc.ori, fc.iface, fc.part.horz, fc.part.vert, fc.dir, fc.coef);
 	}
-
-	::free(mbl);
 }
 
 /// @param[in] sfid - small facet id (constrained)
@@ -2186,23 +2200,35 @@ int Space::assign_dofs(int first_dof, int stride) {
 	this->first_dof = next_dof = first_dof;
 	this->stride = stride;
 
-	// free data
+	// free data (in the incremental mode, the old nodes are kept until their
+	// projections are taken over)
+	bool reuse = incremental && was_assigned && !bc_changed;
+	ArrayPtr<VertexData> old_vn;
+	ArrayPtr<EdgeData> old_en;
+	ArrayPtr<FaceData> old_fn;
+
 	FOR_ALL_VERTEX_NODES(i)
-		delete vn_data[i];
+		if (reuse) old_vn.set(i, vn_data[i]);
+		else delete vn_data[i];
 	vn_data.remove_all();
 
 	FOR_ALL_EDGE_NODES(i)
-		delete en_data[i];
+		if (reuse) old_en.set(i, en_data[i]);
+		else delete en_data[i];
 	en_data.remove_all();
 
 	FOR_ALL_FACE_NODES(i)
-		delete fn_data[i];
+		if (reuse) old_fn.set(i, fn_data[i]);
+		else delete fn_data[i];
 	fn_data.remove_all();
 
 	for (int i = fi_data.first(); i != INVALID_IDX; i = fi_data.next(i))
 		delete fi_data[i];
 	fi_data.remove_all();
 
+	// the baselists of the old nodes are not used any more
+	ced_arena.reset();
+
 	// find constraints
 	find_constraints();
 
@@ -2210,10 +2236,21 @@ int Space::assign_dofs(int first_dof, int stride) {
 	set_bc_information();
 
 	assign_dofs_internal();
+	if (reuse) {
+		reuse_bc_projections(old_vn, old_en, old_fn);
+
+		for (unsigned int i = old_vn.first(); i != INVALID_IDX; i = old_vn.next(i))
+			delete old_vn[i];
+		for (unsigned int i = old_en.first(); i != INVALID_IDX; i = old_en.next(i))
+			delete old_en[i];
+		for (unsigned int i = old_fn.first(); i != INVALID_IDX; i = old_fn.next(i))
+			delete old_fn[i];
+	}
 	update_constraints();
 
 	mesh_seq = mesh->get_seq();
 	was_assigned = true;
+	bc_changed = false;
         this->ndof = (next_dof - first_dof) / stride;
 	seq++;
 
@@ -2221,6 +2258,57 @@ int Space::assign_dofs(int first_dof, int stride) {
 }
 
 
+/// Takes over the projections of the Dirichlet BC from the nodes of the previous call of
+/// assign_dofs() if neither the node nor its neighborhood on the boundary has changed. The
+/// projection of an edge depends on the values at its vertices, the projection of a face
+/// on the values at its vertices and edges.
+void Space::reuse_bc_projections(ArrayPtr<VertexData> &old_vn, ArrayPtr<EdgeData> &old_en, ArrayPtr<FaceData> &old_fn)
+{
+	_F_
+	FOR_ALL_ACTIVE_ELEMENTS(eid, mesh) {
+		Element *e = mesh->elements[eid];
+		for (int iface = 0; iface < e->get_num_faces(); iface++) {
+			unsigned int fid = mesh->get_facet_id(e, iface);
+			if (mesh->facets[fid]->type != Facet::OUTER) continue;
+
+			bool same_vertices = true;
+			const int *vtx = e->get_face_vertices(iface);
+			for (int iv = 0; iv < e->get_num_face_vertices(iface); iv++) {
+				unsigned int vid = e->get_vertex(vtx[iv]);
+				VertexData *vd = vn_data[vid], *old = old_vn.exists(vid) ? old_vn[vid] : NULL;
+				if (old == NULL || old->bc_type != vd->bc_type || old->marker != vd->marker)
+					same_vertices = false;
+			}
+			if (!same_vertices) continue;
+
+			bool same_edges = true;
+			const int *edge = e->get_face_edges(iface);
+			for (int ie = 0; ie < e->get_num_face_edges(iface); ie++) {
+				unsigned int edge_id = mesh->get_edge_id(e, edge[ie]);
+				EdgeData *ed = en_data[edge_id], *old = old_en.exists(edge_id) ? old_en[edge_id] : NULL;
+				if (old == NULL || ed->ced || old->ced || old->order != ed->order || old->n != ed->n ||
+				    old->bc_type != ed->bc_type || old->marker != ed->marker) {
+					same_edges = false;
+					continue;
+				}
+				if (ed->bc_type == BC_ESSENTIAL && ed->bc_proj == NULL && old->bc_proj != NULL) {
+					ed->bc_proj = old->bc_proj;
+					old->bc_proj = NULL;
+				}
+			}
+			if (!same_edges) continue;
+
+			FaceData *fd = fn_data[fid], *old = old_fn.exists(fid) ? old_fn[fid] : NULL;
+			if (old != NULL && !fd->ced && !old->ced && old->order == fd->order && old->n == fd->n &&
+			    old->bc_type == fd->bc_type && old->marker == fd->marker &&
+			    fd->bc_type == BC_ESSENTIAL && fd->bc_proj == NULL && old->bc_proj != NULL) {
+				fd->bc_proj = old->bc_proj;
+				old->bc_proj = NULL;
+			}
+		}
+	}
+}
+
 void Space::uc_dep(unsigned int eid)
 {
 	_F_
@@ -2345,6 +2433,7 @@ void Space::set_bc_types(BCType(*bc_type_callback)(int))
   _F_
   if (bc_type_callback == NULL) bc_type_callback = default_bc_type;
   this->bc_type_callback = bc_type_callback;
+  bc_changed = true;
   seq++;
 
   // since space changed, enumerate basis functions
@@ -2356,6 +2445,7 @@ void Space::set_bc_types_init(BCType (*bc_type_callback)(int))
   _F_
   if (bc_type_callback == NULL) bc_type_callback = default_bc_type;
   this->bc_type_callback = bc_type_callback;
+  bc_changed = true;
   seq++;
 }
 
@@ -2364,6 +2454,7 @@ void Space::set_essential_bc_values(scalar(*bc_value_callback_by_coord)(int, dou
   _F_
   if (bc_value_callback_by_coord == NULL) bc_value_callback_by_coord = default_bc_value_by_coord;
   this->bc_value_callback_by_coord = bc_value_callback_by_coord;
+  bc_changed = true;
   seq++;
 }
 
@@ -2383,6 +2474,7 @@ void Space::copy_callbacks(const Space *space)
   bc_type_callback = space->bc_type_callback;
   bc_value_callback_by_coord = space->bc_value_callback_by_coord;
   bc_vec_value_callback_by_coord = space->bc_vec_value_callback_by_coord;
+  bc_changed = true;
 }
 
 void Space::calc_boundary_projections() 
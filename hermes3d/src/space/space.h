@@ -28,6 +28,7 @@
 #include "../order.h"
 
 #include "../../../hermes_common/bitarray.h"
+#include "../../../hermes_common/scratch_arena.h"
 
 /// @defgroup spaces Spaces
 ///
@@ -109,6 +110,20 @@ public:
   virtual void enforce_minimum_rule();
   virtual int assign_dofs(int first_dof = 0, int stride = 1);
 
+  /// Sets the number of threads assign_dofs() uses to find the constrained nodes. The
+  /// facets are split among the threads, the nodes are created afterwards by the
+  /// calling thread, so the result does not depend on the number of threads.
+  void set_num_threads(int num_threads) { this->num_threads = std::max(1, num_threads); }
+  int get_num_threads() const { return num_threads; }
+
+  /// In the incremental mode, assign_dofs() takes the projections of the Dirichlet BC
+  /// on the edges and faces that did not change since the previous call (same order,
+  /// marker and neighborhood, not constrained) from the previous call, so after an
+  /// adaptivity step only the nodes around the refined elements are projected again.
+  /// The mesh may only be refined between the calls and the values of the BC must not
+  /// change (setting new BC callbacks disables the reuse for the next call).
+  void set_incremental(bool incremental) { this->incremental = incremental; }
+
   /// \brief Returns the number of basis functions contained in the space.
   int get_num_dofs() { return ndof; }
 
@@ -146,6 +161,10 @@ protected:
   int seq, mesh_seq;
   bool was_assigned;
 
+  int num_threads;
+  bool incremental;
+  bool bc_changed;              /// BC callbacks set since the last assign_dofs()
+
   // CED
   struct BaseVertexComponent {
     int dof;
@@ -203,10 +222,6 @@ protected:
       bc_proj = 0.0;
     }
 
-    ~VertexData() {
-      if (ced) ::free(baselist);
-    }
-
     void dump(int id);
   };
 
@@ -236,10 +251,6 @@ protected:
 
     virtual ~EdgeData() {
       delete [] bc_proj;
-      if (ced) {
-	::free(edge_baselist);
-	::free(face_baselist);
-      }
     }
 
     void dump(int id);
@@ -324,6 +335,7 @@ protected:
 
   void init_data_tables();
   void free_data_tables();
+  void reuse_bc_projections(ArrayPtr<VertexData> &old_vn, ArrayPtr<EdgeData> &old_en, ArrayPtr<FaceData> &old_fn);
 
   // CED
   struct FaceInfo {
@@ -356,17 +368,36 @@ protected:
   void update_constraints();
 
   // find constraints
+  /// Nodes found by the fc_*() functions. The functions only read the mesh, so they can
+  /// run in several threads, the nodes are created afterwards by create_nodes().
+  struct FcNodes {
+    std::vector<std::pair<unsigned int, bool> > vertices, edges, faces;
+    std::vector<unsigned int> ced_faces;
+  };
+
+  /// Facets processed by one thread of find_constraints().
+  struct FcWork {
+    Space *space;
+    unsigned int *fids;
+    int nf;
+    FcNodes nodes;
+    pthread_t thread;
+  };
+
   void find_constraints();
-  void fc_base(unsigned int eid, int iface);
+  void fc_facet(unsigned int fid, FcNodes &nodes);
+  void fc_base(unsigned int eid, int iface, FcNodes &nodes);
   /// @param[in] eid - ID of the element
   /// @param[in] iface - local number of the face on the element eid
-  void fc_face(unsigned int eid, int iface, bool ced);
+  void fc_face(unsigned int eid, int iface, bool ced, FcNodes &nodes);
   /// @param[in] fid - ID of the facet
-  void fc_face_left(unsigned int fid);
+  void fc_face_left(unsigned int fid, FcNodes &nodes);
   /// @param[in] fid - ID of the facet
-  void fc_face_right(unsigned int fid);
+  void fc_face_right(unsigned int fid, FcNodes &nodes);
   /// @param[in] idx - ID of the element
-  void fc_element(unsigned int idx);
+  void fc_element(unsigned int idx, FcNodes &nodes);
+  void create_nodes(FcNodes &nodes);
+  static void *fc_worker(void *data);
   BitArray face_ced;
 
   // update constraints
@@ -377,6 +408,10 @@ protected:
 
   Array<FaceInfo *> fi_data;
 
+  /// Storage of the lists of components of the constrained nodes (baselists), released
+  /// at once by assign_dofs().
+  ScratchArena ced_arena;
+
   VertexData *create_vertex_node_data(unsigned int vid, bool ced);
   EdgeData *create_edge_node_data(unsigned int eid, bool ced);
   FaceData *create_face_node_data(unsigned int fid, bool ced);
@@ -543,8 +543,10 @@ Element **Traverse::get_next_state(bool *bnd, SurfPos *surf_pos) {
 			s = push_state();
 			static const Box unity = { 0, ONE, 0, ONE, 0, ONE };
 			s->cr = unity;
+			// the base elements may be visited along a space-filling curve
+			unsigned int eid = (order != NULL) ? order[id - 1] : id;
 			for (int i = 0; i < num; i++) {
-				s->e[i] = meshes[i]->elements[id];
+				s->e[i] = meshes[i]->elements[eid];
 				if (s->e[i]->active && fn != NULL) fn[i]->set_active_element(s->e[i]);
 				s->er[i] = unity;
 				subs[i] = 0;
@@ -618,6 +620,7 @@ void Traverse::begin(int n, Mesh **meshes, Transformable **fn) {
 	subs = new uint64[num];
 	MEM_CHECK(subs);
 	id = 1;				// element IDs start with one
+	order = meshes[0]->get_base_element_order();
 
 	// TODO: check that meshes are compatible
 }
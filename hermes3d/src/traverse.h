@@ -72,6 +72,7 @@ private:
 	int top, size;
 
 	unsigned int id;
+	const unsigned int *order;	// base element order of the first mesh, see Mesh::set_element_ordering()
 	Element *base;
 	int (*sons)[8];
 	uint64 *subs;
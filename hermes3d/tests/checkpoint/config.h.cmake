@@ -0,0 +1,10 @@
+#cmakedefine WITH_UMFPACK
+#cmakedefine WITH_PARDISO
+#cmakedefine WITH_PETSC
+#cmakedefine WITH_MPI
+
+#cmakedefine TRACING
+#cmakedefine DEBUG
+
+#cmakedefine OUTPUT_DIR "@OUTPUT_DIR@"
+
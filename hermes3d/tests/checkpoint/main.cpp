@@ -0,0 +1,176 @@
+#define HERMES_REPORT_WARN
+#define HERMES_REPORT_INFO
+#define HERMES_REPORT_VERBOSE
+#include "config.h"
+//#include <getopt.h>
+#include <hermes3d.h>
+
+// This test makes sure that the checkpoint restores the mesh (with its refinements),
+// the element orders of the space and the coefficient vector, both for the last time
+// step and for an earlier one, and that a mesh which was not saved at a time step is
+// taken from the last step before it.
+
+#define EPS								1e-12
+
+BCType bc_types(int marker)
+{
+	return (marker == 1) ? BC_ESSENTIAL : BC_NATURAL;
+}
+
+// Fills the coefficient vector of a time step.
+void fill_vector(scalar *vec, int ndof, int step)
+{
+	for (int i = 0; i < ndof; i++)
+		vec[i] = sin((step + 1.3) * (i + 1));
+}
+
+// Compares the meshes element by element.
+bool compare_meshes(Mesh *mesh, Mesh *loaded)
+{
+	if (mesh->get_max_element_id() != loaded->get_max_element_id() ||
+	    mesh->get_num_active_elements() != loaded->get_num_active_elements()) {
+		printf("The numbers of elements differ.\n");
+		return false;
+	}
+
+	FOR_ALL_ACTIVE_ELEMENTS(eid, mesh) {
+		Element *e = loaded->elements[eid];
+		if (e == NULL || !e->active || e->marker != mesh->elements[eid]->marker) {
+			printf("Element %u differs.\n", eid);
+			return false;
+		}
+		for (int iv = 0; iv < e->get_num_vertices(); iv++) {
+			Vertex *v1 = mesh->vertices[mesh->elements[eid]->get_vertex(iv)];
+			Vertex *v2 = loaded->vertices[e->get_vertex(iv)];
+			if (fabs(v1->x - v2->x) > EPS || fabs(v1->y - v2->y) > EPS || fabs(v1->z - v2->z) > EPS) {
+				printf("The vertices of element %u differ.\n", eid);
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+// Compares the spaces and the solutions.
+bool compare_spaces(Space *space, Space *loaded, Solution *sln, Solution *loaded_sln)
+{
+	if (Space::get_num_dofs(space) != Space::get_num_dofs(loaded)) {
+		printf("The numbers of DOFs differ: %d, %d.\n", Space::get_num_dofs(space), Space::get_num_dofs(loaded));
+		return false;
+	}
+	FOR_ALL_ACTIVE_ELEMENTS(eid, space->get_mesh()) {
+		if (space->get_element_order(eid).get_idx() != loaded->get_element_order(eid).get_idx()) {
+			printf("The order of element %u differs.\n", eid);
+			return false;
+		}
+	}
+
+	double err = h1_error(sln, loaded_sln);
+	double norm = h1_norm(sln);
+	printf("norm %.15g, error %g\n", norm, err);
+	return norm > 0.0 && err < EPS * norm;
+}
+
+int main(int argc, char **args)
+{
+	// Test variable.
+	int success_test = 1;
+
+	if (argc < 2) error("Not enough parameters.");
+
+	Mesh mesh;
+	H3DReader mloader;
+	if (!mloader.load(args[1], &mesh)) error("Loading mesh file '%s'.", args[1]);
+	mesh.refine_element(1, H3D_H3D_H3D_REFT_HEX_XYZ);
+	mesh.refine_element(3, H3D_REFT_HEX_X);
+
+	// step 0: a space with different orders in the elements
+	H1Space space(&mesh, bc_types, NULL, Ord3(2, 2, 2));
+	FOR_ALL_ACTIVE_ELEMENTS(eid, &mesh)
+		if (eid % 3 == 0) space.set_element_order(eid, Ord3(3, 2, 4));
+	space.assign_dofs();
+	int ndof0 = Space::get_num_dofs(&space);
+	scalar *vec0 = new scalar[ndof0];
+	fill_vector(vec0, ndof0, 0);
+
+	Checkpoint chk;
+	chk.create("checkpoint.h3dc");
+	chk.save(Tuple<Space *>(&space), vec0, 0);
+
+	// step 1: only the vector changes, the mesh and the space are not saved
+	scalar *vec1 = new scalar[ndof0];
+	fill_vector(vec1, ndof0, 1);
+	chk.save_vector(vec1, ndof0, 1);
+	chk.close();
+
+	// step 2 is appended: the mesh is refined further
+	Mesh mesh0;
+	mesh0.copy(mesh);
+	H1Space space0(&mesh0, bc_types, NULL, Ord3(2, 2, 2));
+	FOR_ALL_ACTIVE_ELEMENTS(eid, &mesh0)
+		space0.set_element_order(eid, space.get_element_order(eid));
+	space0.assign_dofs();
+	Solution sln0_copy(&mesh0);
+	Solution::vector_to_solution(vec0, &space0, &sln0_copy);
+
+	mesh.refine_element(mesh.get_max_element_id() - 1, H3D_H3D_REFT_HEX_YZ);
+	mesh.refine_element(4, H3D_REFT_HEX_Z);
+	H1Space space2(&mesh, bc_types, NULL, Ord3(3, 3, 3));
+	int ndof2 = Space::get_num_dofs(&space2);
+	scalar *vec2 = new scalar[ndof2];
+	fill_vector(vec2, ndof2, 2);
+	Solution sln2(&mesh);
+	Solution::vector_to_solution(vec2, &space2, &sln2);
+
+	chk.create("checkpoint.h3dc", true);
+	chk.save(Tuple<Space *>(&space2), vec2, 2);
+	chk.close();
+
+	// reload all steps
+	chk.open("checkpoint.h3dc");
+	if (chk.get_last_step() != 2) {
+		printf("The last step is %d.\n", chk.get_last_step());
+		success_test = 0;
+	}
+
+	Mesh loaded_mesh;
+	chk.load_mesh(&loaded_mesh);
+	if (!compare_meshes(&mesh, &loaded_mesh)) success_test = 0;
+	H1Space loaded_space(&loaded_mesh, bc_types, NULL, Ord3(1, 1, 1));
+	chk.load_space(&loaded_space);
+	Solution loaded_sln(&loaded_mesh);
+	chk.load_solutions(Tuple<Space *>(&loaded_space), Tuple<Solution *>(&loaded_sln));
+	if (!compare_spaces(&space2, &loaded_space, &sln2, &loaded_sln)) success_test = 0;
+
+	// the mesh of step 1 is the one saved at step 0
+	Mesh loaded_mesh0;
+	chk.load_mesh(&loaded_mesh0, 1);
+	if (!compare_meshes(&mesh0, &loaded_mesh0)) success_test = 0;
+	H1Space loaded_space0(&loaded_mesh0, bc_types, NULL, Ord3(1, 1, 1));
+	chk.load_space(&loaded_space0, 1);
+	Solution loaded_sln0(&loaded_mesh0);
+	chk.load_solutions(Tuple<Space *>(&loaded_space0), Tuple<Solution *>(&loaded_sln0), 0);
+	if (!compare_spaces(&space0, &loaded_space0, &sln0_copy, &loaded_sln0)) success_test = 0;
+
+	int ndof;
+	scalar *loaded_vec1 = chk.load_vector(1, 0, &ndof);
+	if (ndof != ndof0) success_test = 0;
+	else
+		for (int i = 0; i < ndof; i++)
+			if (loaded_vec1[i] != vec1[i]) success_test = 0;
+	chk.close();
+
+	delete [] vec0;
+	delete [] vec1;
+	delete [] vec2;
+	delete [] loaded_vec1;
+
+	if (success_test) {
+		info("Success!");
+		return ERR_SUCCESS;
+	}
+	else {
+		info("Failure!");
+		return ERR_FAILURE;
+	}
+}
@@ -0,0 +1,12 @@
+#cmakedefine WITH_UMFPACK
+#cmakedefine WITH_PARDISO
+#cmakedefine WITH_PETSC
+#cmakedefine WITH_MPI
+
+#cmakedefine DEV_TESTS
+
+#cmakedefine TRACING
+#cmakedefine DEBUG
+
+#cmakedefine OUTPUT_DIR "@OUTPUT_DIR@"
+
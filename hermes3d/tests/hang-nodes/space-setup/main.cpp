@@ -0,0 +1,119 @@
+#define HERMES_REPORT_WARN
+#define HERMES_REPORT_INFO
+#define HERMES_REPORT_VERBOSE
+#include "config.h"
+#include <hermes3d.h>
+
+// Checks that a space built on several threads and a space updated incrementally
+// after a refinement produce the same DOFs and constraints as a serial space.
+//
+// Usage: space-setup <mesh> [<elem> <reft>]...
+
+BCType bc_types(int marker) {
+	return BC_ESSENTIAL;
+}
+
+scalar essential_bc_values(int ess_bdy_marker, double x, double y, double z) {
+	return x*x*y*y*z*z + x*x*y*y*y - x*x*z + z*z*z*z;
+}
+
+int parse_reft(char *str) {
+	if (strcasecmp(str, "x") == 0) return H3D_REFT_HEX_X;
+	else if (strcasecmp(str, "y") == 0) return H3D_REFT_HEX_Y;
+	else if (strcasecmp(str, "z") == 0) return H3D_REFT_HEX_Z;
+	else if (strcasecmp(str, "xy") == 0 || strcasecmp(str, "yx") == 0) return H3D_H3D_REFT_HEX_XY;
+	else if (strcasecmp(str, "xz") == 0 || strcasecmp(str, "zx") == 0) return H3D_H3D_REFT_HEX_XZ;
+	else if (strcasecmp(str, "yz") == 0 || strcasecmp(str, "zy") == 0) return H3D_H3D_REFT_HEX_YZ;
+	else if (strcasecmp(str, "xyz") == 0) return H3D_H3D_H3D_REFT_HEX_XYZ;
+	else return H3D_REFT_HEX_NONE;
+}
+
+void refine(Mesh *mesh, char **args, int from, int to) {
+	for (int i = from; i < to; i += 2) {
+		int elem_id;
+		sscanf(args[i], "%d", &elem_id);
+		mesh->refine_element(elem_id + 1, parse_reft(args[i + 1]));
+	}
+}
+
+// Compare the assembly lists of all active elements of two spaces.
+bool same_spaces(Mesh *mesh, Space *ref, Space *space) {
+	if (ref->get_num_dofs() != space->get_num_dofs()) {
+		info("number of DOFs differs: %d <-> %d", ref->get_num_dofs(), space->get_num_dofs());
+		return false;
+	}
+
+	AsmList al_ref, al;
+	FOR_ALL_ACTIVE_ELEMENTS(idx, mesh) {
+		ref->get_element_assembly_list(mesh->elements[idx], &al_ref);
+		space->get_element_assembly_list(mesh->elements[idx], &al);
+		if (al_ref.cnt != al.cnt) {
+			info("element %u: assembly lists differ in length (%d <-> %d)", idx, al_ref.cnt, al.cnt);
+			return false;
+		}
+		for (int i = 0; i < al.cnt; i++) {
+			if (al_ref.idx[i] != al.idx[i] || al_ref.dof[i] != al.dof[i] ||
+			    fabs(al_ref.coef[i] - al.coef[i]) > 1e-12) {
+				info("element %u: assembly lists differ at position %d", idx, i);
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+int main(int argc, char **args)
+{
+	if (argc < 2) error("Not enough parameters.");
+
+	Ord3 order(2, 3, 4);
+	H1ShapesetLobattoHex shapeset;
+
+	// Reference: serial setup on the final mesh.
+	Mesh mesh;
+	H3DReader mloader;
+	if (!mloader.load(args[1], &mesh)) error("Loading mesh file '%s'.", args[1]);
+	refine(&mesh, args, 2, argc);
+
+	H1Space space(&mesh, bc_types, essential_bc_values, order, &shapeset);
+	info("ndof: %d", Space::get_num_dofs(&space));
+
+	bool success = true;
+
+	// Constraints found on several threads.
+	H1Space mt_space(&mesh, bc_types, essential_bc_values, order, &shapeset);
+	mt_space.set_num_threads(3);
+	mt_space.assign_dofs();
+	if (!same_spaces(&mesh, &space, &mt_space)) {
+		info("threaded setup differs from the serial one");
+		success = false;
+	}
+
+	// Incremental update: set up the space before the last refinement, then refine and reassign.
+	Mesh inc_mesh;
+	if (!mloader.load(args[1], &inc_mesh)) error("Loading mesh file '%s'.", args[1]);
+	int last = argc >= 4 ? argc - 2 : argc;
+	refine(&inc_mesh, args, 2, last);
+
+	H1Space inc_space(&inc_mesh, bc_types, essential_bc_values, order, &shapeset);
+	inc_space.set_incremental(true);
+	inc_space.assign_dofs();
+
+	refine(&inc_mesh, args, last, argc);
+	FOR_ALL_ACTIVE_ELEMENTS(idx, &inc_mesh)
+		inc_space.set_element_order(idx, order);
+	inc_space.assign_dofs();
+	if (!same_spaces(&inc_mesh, &space, &inc_space)) {
+		info("incremental setup differs from the serial one");
+		success = false;
+	}
+
+	if (success) {
+		info("Success!");
+		return ERR_SUCCESS;
+	}
+	else {
+		info("Failure!");
+		return ERR_FAILURE;
+	}
+}
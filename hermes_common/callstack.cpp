@@ -22,6 +22,18 @@
 #include <signal.h>
 #include <stdlib.h>
 
+#if defined(_MSC_VER)
+#define HERMES_THREAD_LOCAL __declspec(thread)
+#else
+#define HERMES_THREAD_LOCAL __thread
+#endif
+
+// the call stack of each thread: a ring of the innermost calls, the depth of the stack
+// and the lowest level whose entry was not overwritten by a deeper call
+static HERMES_THREAD_LOCAL CallStackObj *stack_ring[HERMES_CALLSTACK_SIZE];
+static HERMES_THREAD_LOCAL int stack_depth;
+static HERMES_THREAD_LOCAL int stack_low;
+
 // global instance of the call stack object
 static CallStack callstack;
 
@@ -32,18 +44,18 @@ CallStackObj::CallStackObj(int ln, const char *func, const char *file) {
 	this->func = func;
 	this->file = file;
 
-	// add this object to the call stack
-	if (callstack.size < callstack.max_size) {
-		callstack.stack[callstack.size] = this;
-		callstack.size++;
-	}
+	// add this object to the call stack, overwriting the oldest entry if the ring is full
+	stack_ring[stack_depth % HERMES_CALLSTACK_SIZE] = this;
+	stack_depth++;
+	if (stack_depth - stack_low > HERMES_CALLSTACK_SIZE)
+		stack_low = stack_depth - HERMES_CALLSTACK_SIZE;
 }
 
 CallStackObj::~CallStackObj() {
-	// remove the object only if it is on the top of the call stack
-	if (callstack.size > 0 && callstack.stack[callstack.size - 1] == this) {
-		callstack.size--;
-		callstack.stack[callstack.size] = NULL;
+	// the objects are destroyed in the reverse order, so this one is on the top
+	if (stack_depth > 0) {
+		stack_depth--;
+		if (stack_low > stack_depth) stack_low = stack_depth;
 	}
 }
 
@@ -84,24 +96,24 @@ void callstack_finalize() {
 
 CallStack &get_callstack() { return callstack; }
 
-CallStack::CallStack(int max_size) {
-	this->max_size = max_size;
-	this->size = 0;
-	this->stack = new CallStackObj *[max_size];
-
-	// initialize signals
-	callstack_initialize();
-}
+// installs the signal handlers at startup
+static struct CallStackInit {
+	CallStackInit() { callstack_initialize(); }
+} callstack_init;
 
-CallStack::~CallStack() {
-	delete [] stack;
+int CallStack::get_depth() {
+	return stack_depth;
 }
 
 void CallStack::dump() {
-	if (size > 0) {
+	if (stack_depth > 0) {
 		fprintf(stderr, "Call stack:\n");
-		for (int i = size - 1; i >= 0; i--)
-			fprintf(stderr, "  %s:%d: %s\n", stack[i]->file, stack[i]->line, stack[i]->func);
+		for (int i = stack_depth - 1; i >= stack_low; i--) {
+			CallStackObj *obj = stack_ring[i % HERMES_CALLSTACK_SIZE];
+			fprintf(stderr, "  %s:%d: %s\n", obj->file, obj->line, obj->func);
+		}
+		if (stack_low > 0)
+			fprintf(stderr, "  ... (%d more)\n", stack_low);
 	}
 	else {
 		fprintf(stderr, "No call stack available.\n");
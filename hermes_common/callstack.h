@@ -23,8 +23,16 @@
 #include <stdio.h>
 #include "compat.h"
 
+/// Number of calls kept for each thread. Deeper calls overwrite the oldest entries,
+/// so a dump shows the innermost HERMES_CALLSTACK_SIZE calls.
+#define HERMES_CALLSTACK_SIZE		32
+
+// With HERMES_NO_CALLSTACK defined (WITH_CALLSTACK = NO in CMake), _F_ expands to nothing
+// and the tracing costs nothing. The crash handler is installed in both cases.
+#if defined(HERMES_NO_CALLSTACK)
+#define _F_
 // __PRETTY_FUNCTION__ missing on MSVC
-#ifdef _MSC_VER		// #ifdef _WIN32 was here in H3D
+#elif defined(_MSC_VER)		// #ifdef _WIN32 was here in H3D
 #define _F_ CallStackObj __call_stack_obj(__LINE__, __FUNCTION__, __FILE__);
 #else
 #define _F_ CallStackObj __call_stack_obj(__LINE__, __PRETTY_FUNCTION__, __FILE__);
@@ -43,23 +51,19 @@ public:
 	const char *func;			// function name
 };
 
-/// Call stack object
+/// Call stack of the current thread
+///
+/// Every thread has its own stack (a ring of HERMES_CALLSTACK_SIZE entries in thread-local
+/// storage), so _F_ can be used from several threads without locking.
 ///
 class HERMES_API CallStack 
 {
 public:
-	CallStack(int max_size = 32);
-	~CallStack();
-
-	// dump the call stack objects to standard error
+	// dump the call stack objects of the current thread to standard error
 	void dump();
 
-protected:
-	CallStackObj **stack;
-	int size;
-	int max_size;
-
-	friend class CallStackObj;
+	// number of the calls of the current thread on the stack (including the overwritten ones)
+	int get_depth();
 };
 
 CallStack &get_callstack();
@@ -86,19 +86,21 @@ enum MatrixSolverType
    SOLVER_PARDISO,
    SOLVER_SUPERLU,
    SOLVER_AMESOS,
-   SOLVER_AZTECOO
+   SOLVER_AZTECOO,
+   SOLVER_BANDED
 };
 
 // Should be in the same order as MatrixSolverTypes above, so that the
 // names may be accessed by the same enumeration variable.
-const std::string MatrixSolverNames[7] = {
+const std::string MatrixSolverNames[8] = {
   "UMFPACK",
   "PETSc",
   "MUMPS",
   "Pardiso",
   "SuperLU",
   "Trilinos/Amesos",
-  "Trilinos/AztecOO"
+  "Trilinos/AztecOO",
+  "Band LU"
 };
 
 #define UMFPACK_NOT_COMPILED  HERMES " was not built with UMFPACK support."
@@ -176,6 +178,9 @@ inline double conj(double a) {  return a; }
 
 #else
 
+  #include <complex>
+
+  typedef std::complex<double> cplx;  // complex forms in the real version, see complex_block.h
   typedef double scalar;
   
   #define CONJ(a)       (a)
@@ -32,6 +32,7 @@
 #include "solver/mumps.h"
 #include "solver/nox.h"
 #include "solver/aztecoo.h"
+#include "solver/band.h"
 
 #define HERMES_TINY 1.0e-20
 
@@ -302,6 +303,11 @@ SparseMatrix* create_matrix(MatrixSolverType matrix_solver)
       return new SuperLUMatrix;
       break;
     }
+    case SOLVER_BANDED: 
+    {
+      return new BandMatrix;
+      break;
+    }
     default: 
       error("Unknown matrix solver requested.");
   }
@@ -363,6 +369,13 @@ Solver* create_linear_solver(MatrixSolverType matrix_solver, Matrix* matrix, Vec
       info("Using SuperLU."); 
       break;
     }
+    case SOLVER_BANDED: 
+    {
+      info("Using the band solver."); 
+      if (rhs != NULL) return new BandLinearSolver(static_cast<BandMatrix*>(matrix), static_cast<BandVector*>(rhs)); 
+      else return new BandLinearSolver(static_cast<BandMatrix*>(matrix), static_cast<BandVector*>(rhs_dummy)); 
+      break;
+    }
     default: 
       error("Unknown matrix solver requested.");
   }
@@ -404,6 +417,11 @@ Vector* create_vector(MatrixSolverType matrix_solver)
       return new SuperLUVector;
       break;
     }
+    case SOLVER_BANDED: 
+    {
+      return new BandVector;
+      break;
+    }
     default: 
       error("Unknown matrix solver requested.");
   }
@@ -0,0 +1,404 @@
+// Copyright (c) 2009 hp-FEM group at the University of Nevada, Reno (UNR).
+// Distributed under the terms of the BSD license (see the LICENSE
+// file for the exact terms).
+// Email: hermes1d@googlegroups.com, home page: http://hpfem.org/
+
+#include "perf_counters.h"
+#include <vector>
+#include <string>
+#include <string.h>
+
+#ifdef _MSC_VER
+#define HERMES_PERF_THREAD_LOCAL __declspec(thread)
+#else
+#define HERMES_PERF_THREAD_LOCAL __thread
+#endif
+
+bool PerfCounters::enabled = false;
+bool PerfCounters::tracing = false;
+
+// node of the tree of timers; node 0 is the root
+struct PerfNode
+{
+  int id, parent, first_child, next_sibling;
+  long calls;
+  double total, start;
+};
+
+struct PerfEvent
+{
+  int id;
+  double start, dur;
+};
+
+// statistics of one thread; they are written by the thread and read by the reports,
+// both under 'mutex'
+struct PerfThreadData
+{
+  pthread_mutex_t mutex;
+  int tid;
+  int generation;             // the statistics are valid if it equals perf_generation
+  std::vector<PerfNode> nodes;
+  int current;
+  std::vector<long> counts;   // counter values, cache hits
+  std::vector<long> misses;   // cache misses
+  std::vector<PerfEvent> events;
+
+  void clear()
+  {
+    PerfNode root = { -1, -1, -1, -1, 0, 0.0, 0.0 };
+    nodes.clear();
+    nodes.push_back(root);
+    current = 0;
+    counts.clear();
+    misses.clear();
+    events.clear();
+  }
+};
+
+// the registry: names and kinds of the counters, data of all threads; a thread holding
+// 'perf_mutex' may lock the mutex of a thread, not the other way round
+static pthread_mutex_t perf_mutex = PTHREAD_MUTEX_INITIALIZER;
+static std::vector<std::string> perf_names;
+static std::vector<PerfCounterKind> perf_kinds;
+static std::vector<PerfThreadData*> perf_threads;
+static int perf_generation = 0;    // incremented by reset()
+
+static HERMES_PERF_THREAD_LOCAL PerfThreadData* perf_data = NULL;
+
+
+// seconds since an arbitrary point
+static double perf_time()
+{
+#ifdef WIN32
+  LARGE_INTEGER ticks, freq;
+  QueryPerformanceCounter(&ticks);
+  QueryPerformanceFrequency(&freq);
+  return (double) ticks.QuadPart / (double) freq.QuadPart;
+#else
+  timespec tm;
+  clock_gettime(CLOCK_MONOTONIC, &tm);
+  return tm.tv_sec + tm.tv_nsec * 1e-9;
+#endif
+}
+
+static double perf_origin = perf_time();
+
+
+static PerfThreadData* get_thread_data()
+{
+  if (perf_data == NULL)
+  {
+    perf_data = new PerfThreadData;
+    pthread_mutex_init(&perf_data->mutex, NULL);
+    perf_data->clear();
+    pthread_mutex_lock(&perf_mutex);
+    perf_data->tid = perf_threads.size();
+    perf_data->generation = perf_generation;
+    perf_threads.push_back(perf_data);
+    pthread_mutex_unlock(&perf_mutex);
+  }
+  else if (perf_data->generation != perf_generation)
+  {
+    // the statistics were reset, only the owning thread clears them
+    pthread_mutex_lock(&perf_data->mutex);
+    perf_data->clear();
+    perf_data->generation = perf_generation;
+    pthread_mutex_unlock(&perf_data->mutex);
+  }
+  return perf_data;
+}
+
+
+void PerfCounters::enable(bool enable, bool trace)
+{
+  enabled = enable;
+  tracing = enable && trace;
+}
+
+
+void PerfCounters::reset()
+{
+  // the other threads may be just writing to their statistics, so they are not cleared
+  // here: they are ignored by the reports and cleared by their threads on the next access
+  pthread_mutex_lock(&perf_mutex);
+  perf_generation++;
+  pthread_mutex_unlock(&perf_mutex);
+}
+
+
+int PerfCounters::get_id(const char* name, PerfCounterKind kind)
+{
+  pthread_mutex_lock(&perf_mutex);
+  int id;
+  for (id = 0; id < (int) perf_names.size(); id++)
+    if (perf_kinds[id] == kind && perf_names[id] == name) break;
+  if (id == (int) perf_names.size())
+  {
+    perf_names.push_back(name);
+    perf_kinds.push_back(kind);
+  }
+  pthread_mutex_unlock(&perf_mutex);
+  return id;
+}
+
+
+void PerfCounters::begin(int id)
+{
+  PerfThreadData* td = get_thread_data();
+  pthread_mutex_lock(&td->mutex);
+
+  // find the timer among the children of the current one
+  int child = td->nodes[td->current].first_child;
+  while (child >= 0 && td->nodes[child].id != id)
+    child = td->nodes[child].next_sibling;
+
+  if (child < 0)
+  {
+    PerfNode node = { id, td->current, -1, td->nodes[td->current].first_child, 0, 0.0, 0.0 };
+    child = td->nodes.size();
+    td->nodes.push_back(node);
+    td->nodes[td->current].first_child = child;
+  }
+
+  td->current = child;
+  td->nodes[child].start = perf_time();
+  pthread_mutex_unlock(&td->mutex);
+}
+
+
+void PerfCounters::end(int id)
+{
+  double now = perf_time();
+  PerfThreadData* td = get_thread_data();
+  pthread_mutex_lock(&td->mutex);
+  PerfNode& node = td->nodes[td->current];
+  if (node.id != id) // the statistics were reset inside the scope
+  {
+    pthread_mutex_unlock(&td->mutex);
+    return;
+  }
+
+  double dur = now - node.start;
+  node.total += dur;
+  node.calls++;
+  if (tracing)
+  {
+    PerfEvent ev = { id, node.start - perf_origin, dur };
+    td->events.push_back(ev);
+  }
+  td->current = node.parent;
+  pthread_mutex_unlock(&td->mutex);
+}
+
+
+void PerfCounters::add(int id, long n)
+{
+  PerfThreadData* td = get_thread_data();
+  pthread_mutex_lock(&td->mutex);
+  if ((int) td->counts.size() <= id) td->counts.resize(id + 1, 0);
+  td->counts[id] += n;
+  pthread_mutex_unlock(&td->mutex);
+}
+
+
+void PerfCounters::add_cache(int id, bool hit)
+{
+  PerfThreadData* td = get_thread_data();
+  pthread_mutex_lock(&td->mutex);
+  if ((int) td->counts.size() <= id) td->counts.resize(id + 1, 0);
+  if ((int) td->misses.size() <= id) td->misses.resize(id + 1, 0);
+  if (hit) td->counts[id]++; else td->misses[id]++;
+  pthread_mutex_unlock(&td->mutex);
+}
+
+
+//// reports ///////////////////////////////////////////////////////////////////////////////////////
+
+// adds the subtree of 'src' rooted at 'sn' to the merged tree 'dst' under the node 'dn'
+static void merge_tree(std::vector<PerfNode>& dst, int dn, const std::vector<PerfNode>& src, int sn)
+{
+  for (int c = src[sn].first_child; c >= 0; c = src[c].next_sibling)
+  {
+    int d = dst[dn].first_child, last = -1;
+    while (d >= 0 && dst[d].id != src[c].id) { last = d; d = dst[d].next_sibling; }
+    if (d < 0)
+    {
+      // appended, so that the children are listed in the order of their first use
+      PerfNode node = { src[c].id, dn, -1, -1, 0, 0.0, 0.0 };
+      d = dst.size();
+      dst.push_back(node);
+      if (last < 0) dst[dn].first_child = d; else dst[last].next_sibling = d;
+    }
+    dst[d].calls += src[c].calls;
+    dst[d].total += src[c].total;
+    merge_tree(dst, d, src, c);
+  }
+}
+
+// the children of each thread are stored in the reverse order of their first use
+static void reverse_children(std::vector<PerfNode>& nodes)
+{
+  for (unsigned int n = 0; n < nodes.size(); n++)
+  {
+    int prev = -1, c = nodes[n].first_child;
+    while (c >= 0)
+    {
+      int next = nodes[c].next_sibling;
+      nodes[c].next_sibling = prev;
+      prev = c;
+      c = next;
+    }
+    nodes[n].first_child = prev;
+  }
+}
+
+static void print_tree(FILE* f, const std::vector<PerfNode>& nodes, int n, int depth)
+{
+  for (int c = nodes[n].first_child; c >= 0; c = nodes[c].next_sibling)
+  {
+    double self = nodes[c].total;
+    for (int cc = nodes[c].first_child; cc >= 0; cc = nodes[cc].next_sibling)
+      self -= nodes[cc].total;
+
+    char name[256];
+    snprintf(name, sizeof(name), "%*s%s", 2 * depth, "", perf_names[nodes[c].id].c_str());
+    fprintf(f, "  %-40s %10ld %12.6f %12.6f\n", name, nodes[c].calls, nodes[c].total, self);
+    print_tree(f, nodes, c, depth + 1);
+  }
+}
+
+// merges the statistics of all threads; the caller holds 'perf_mutex'
+static void merge_all(std::vector<PerfNode>& tree, std::vector<long>& counts, std::vector<long>& misses)
+{
+  PerfNode root = { -1, -1, -1, -1, 0, 0.0, 0.0 };
+  tree.assign(1, root);
+  counts.assign(perf_names.size(), 0);
+  misses.assign(perf_names.size(), 0);
+  for (unsigned int t = 0; t < perf_threads.size(); t++)
+  {
+    PerfThreadData* td = perf_threads[t];
+    pthread_mutex_lock(&td->mutex);
+    if (td->generation == perf_generation)
+    {
+      std::vector<PerfNode> nodes = td->nodes;
+      reverse_children(nodes);
+      merge_tree(tree, 0, nodes, 0);
+      for (unsigned int i = 0; i < td->counts.size(); i++) counts[i] += td->counts[i];
+      for (unsigned int i = 0; i < td->misses.size(); i++) misses[i] += td->misses[i];
+    }
+    pthread_mutex_unlock(&td->mutex);
+  }
+}
+
+
+void PerfCounters::report(FILE* f)
+{
+  pthread_mutex_lock(&perf_mutex);
+  std::vector<PerfNode> tree;
+  std::vector<long> counts, misses;
+  merge_all(tree, counts, misses);
+
+  fprintf(f, "Performance counters (%d threads):\n", (int) perf_threads.size());
+  fprintf(f, "  %-40s %10s %12s %12s\n", "timer", "calls", "total [s]", "self [s]");
+  print_tree(f, tree, 0, 0);
+
+  bool header = false;
+  for (unsigned int i = 0; i < perf_names.size(); i++)
+    if (perf_kinds[i] == HERMES_PERF_COUNTER && counts[i])
+    {
+      if (!header) { fprintf(f, "  %-40s %10s\n", "counter", "value"); header = true; }
+      fprintf(f, "  %-40s %10ld\n", perf_names[i].c_str(), counts[i]);
+    }
+
+  header = false;
+  for (unsigned int i = 0; i < perf_names.size(); i++)
+    if (perf_kinds[i] == HERMES_PERF_CACHE && (counts[i] || misses[i]))
+    {
+      if (!header) { fprintf(f, "  %-40s %10s %12s %12s\n", "cache", "hits", "misses", "hit rate"); header = true; }
+      fprintf(f, "  %-40s %10ld %12ld %11.1f%%\n", perf_names[i].c_str(), counts[i], misses[i],
+              100.0 * counts[i] / (counts[i] + misses[i]));
+    }
+  pthread_mutex_unlock(&perf_mutex);
+}
+
+
+bool PerfCounters::save_trace(const char* filename)
+{
+  FILE* f = fopen(filename, "w");
+  if (f == NULL) return false;
+
+  pthread_mutex_lock(&perf_mutex);
+  fprintf(f, "{\"traceEvents\":[\n");
+  bool first = true;
+  for (unsigned int t = 0; t < perf_threads.size(); t++)
+  {
+    PerfThreadData* td = perf_threads[t];
+    fprintf(f, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"thread %d\"}}",
+            first ? "" : ",\n", td->tid, td->tid);
+    first = false;
+
+    // the timestamps and durations are in microseconds
+    pthread_mutex_lock(&td->mutex);
+    if (td->generation == perf_generation)
+      for (unsigned int i = 0; i < td->events.size(); i++)
+      {
+        const PerfEvent& ev = td->events[i];
+        fprintf(f, ",\n{\"name\":\"%s\",\"cat\":\"hermes\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%d}",
+                perf_names[ev.id].c_str(), ev.start * 1e6, ev.dur * 1e6, td->tid);
+      }
+    pthread_mutex_unlock(&td->mutex);
+  }
+  fprintf(f, "\n],\"displayTimeUnit\":\"ms\"}\n");
+  pthread_mutex_unlock(&perf_mutex);
+
+  fclose(f);
+  return true;
+}
+
+
+double PerfCounters::get_time(const char* name)
+{
+  double total = 0.0;
+  pthread_mutex_lock(&perf_mutex);
+  for (unsigned int t = 0; t < perf_threads.size(); t++)
+  {
+    PerfThreadData* td = perf_threads[t];
+    pthread_mutex_lock(&td->mutex);
+    if (td->generation == perf_generation)
+      for (unsigned int n = 1; n < td->nodes.size(); n++)
+        if (perf_names[td->nodes[n].id] == name) total += td->nodes[n].total;
+    pthread_mutex_unlock(&td->mutex);
+  }
+  pthread_mutex_unlock(&perf_mutex);
+  return total;
+}
+
+
+static long get_sum(const char* name, bool miss)
+{
+  long total = 0;
+  pthread_mutex_lock(&perf_mutex);
+  for (unsigned int id = 0; id < perf_names.size(); id++)
+    if (perf_kinds[id] != HERMES_PERF_TIMER && perf_names[id] == name)
+      for (unsigned int t = 0; t < perf_threads.size(); t++)
+      {
+        PerfThreadData* td = perf_threads[t];
+        pthread_mutex_lock(&td->mutex);
+        const std::vector<long>& v = miss ? td->misses : td->counts;
+        if (td->generation == perf_generation && id < v.size()) total += v[id];
+        pthread_mutex_unlock(&td->mutex);
+      }
+  pthread_mutex_unlock(&perf_mutex);
+  return total;
+}
+
+long PerfCounters::get_count(const char* name)
+{
+  return get_sum(name, false);
+}
+
+long PerfCounters::get_misses(const char* name)
+{
+  return get_sum(name, true);
+}
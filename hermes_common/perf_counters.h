@@ -0,0 +1,104 @@
+// Copyright (c) 2009 hp-FEM group at the University of Nevada, Reno (UNR).
+// Distributed under the terms of the BSD license (see the LICENSE
+// file for the exact terms).
+// Email: hermes1d@googlegroups.com, home page: http://hpfem.org/
+
+#ifndef __HERMES_COMMON_PERF_COUNTERS_H
+#define __HERMES_COMMON_PERF_COUNTERS_H
+
+#include "common.h"
+
+/// Kinds of the performance counters.
+enum PerfCounterKind {
+  HERMES_PERF_TIMER,   ///< Scoped timer (HERMES_PERF_SCOPE).
+  HERMES_PERF_COUNTER, ///< Event counter (HERMES_PERF_COUNT).
+  HERMES_PERF_CACHE    ///< Cache hits and misses (HERMES_PERF_CACHE_HIT).
+};
+
+/// Registry of performance counters: hierarchical scoped timers, event counters and
+/// cache hit rates.
+///
+/// The library is instrumented by the macros below (assembling, solvers, adaptivity,
+/// projections, linearizers, precalculated tables). Nothing is collected unless
+/// enable() is called, so a disabled counter costs one branch. The timers nest: a
+/// timer started inside another one is reported as its child. The statistics are
+/// collected by each thread separately, under a lock of the thread that is contended
+/// only by the reports, and merged by report(). The reports and the getters can be
+/// called while other threads are recording.
+/// With tracing enabled, every timed scope is also recorded as an event and the
+/// events can be saved in the Chrome trace format (chrome://tracing, Perfetto).
+///
+/// \code
+///   PerfCounters::enable(true, true);
+///   ... solve ...
+///   PerfCounters::report();
+///   PerfCounters::save_trace("trace.json");
+/// \endcode
+///
+class HERMES_API PerfCounters
+{
+public:
+  /// Enables or disables the collection. With 'trace' = true, the timed scopes are
+  /// also recorded as events for save_trace().
+  static void enable(bool enable = true, bool trace = false);
+  static bool is_enabled() { return enabled; }
+
+  /// Clears all statistics and events of all threads. The other threads clear their own
+  /// statistics when they next use a timer or a counter, so it can be called while they run.
+  static void reset();
+
+  /// Prints the timers (as a tree), the counters and the cache hit rates, summed over all threads.
+  static void report(FILE* f = stdout);
+  /// Saves the recorded events in the Chrome trace (JSON) format.
+  static bool save_trace(const char* filename);
+
+  /// Returns the total time of the timer 'name' in all threads and all places of the tree.
+  static double get_time(const char* name);
+  /// Returns the value of the counter 'name' (the number of hits for caches).
+  static long get_count(const char* name);
+  /// Returns the number of misses of the cache 'name'.
+  static long get_misses(const char* name);
+
+  /// For internal use (by the macros below).
+  static int get_id(const char* name, PerfCounterKind kind);
+  static void begin(int id);
+  static void end(int id);
+  static void add(int id, long n);
+  static void add_cache(int id, bool hit);
+
+  static bool enabled;
+  static bool tracing;
+};
+
+/// Times the enclosing scope (see HERMES_PERF_SCOPE).
+class HERMES_API PerfScope
+{
+public:
+  PerfScope(int id) : id(PerfCounters::enabled ? id : -1) { if (this->id >= 0) PerfCounters::begin(id); }
+  ~PerfScope() { if (id >= 0) PerfCounters::end(id); }
+
+protected:
+  int id;
+};
+
+#define HERMES_PERF_CONCAT2(a, b) a##b
+#define HERMES_PERF_CONCAT(a, b) HERMES_PERF_CONCAT2(a, b)
+
+/// Times the rest of the enclosing scope under the timer 'name' (a string literal).
+#define HERMES_PERF_SCOPE(name) \
+  static const int HERMES_PERF_CONCAT(__perf_id_, __LINE__) = PerfCounters::get_id(name, HERMES_PERF_TIMER); \
+  PerfScope HERMES_PERF_CONCAT(__perf_scope_, __LINE__)(HERMES_PERF_CONCAT(__perf_id_, __LINE__))
+
+/// Adds 'n' to the counter 'name'.
+#define HERMES_PERF_COUNT(name, n) \
+  do { if (PerfCounters::enabled) { \
+    static const int __perf_id = PerfCounters::get_id(name, HERMES_PERF_COUNTER); \
+    PerfCounters::add(__perf_id, n); } } while (0)
+
+/// Records a hit ('hit' = true) or a miss of the cache 'name'.
+#define HERMES_PERF_CACHE_HIT(name, hit) \
+  do { if (PerfCounters::enabled) { \
+    static const int __perf_id = PerfCounters::get_id(name, HERMES_PERF_CACHE); \
+    PerfCounters::add_cache(__perf_id, hit); } } while (0)
+
+#endif
@@ -0,0 +1,198 @@
+// Copyright (c) 2009 hp-FEM group at the University of Nevada, Reno (UNR).
+// Distributed under the terms of the BSD license (see the LICENSE
+// file for the exact terms).
+// Email: hermes1d@googlegroups.com, home page: http://hpfem.org/
+
+#include "record_file.h"
+
+static const int RECORD_FILE_VERSION = 1;
+static const unsigned long long RECORD_INCOMPLETE = (unsigned long long) -1;
+
+RecordFile::RecordFile()
+{
+  f = NULL;
+  writing = false;
+  rec_start = -1;
+}
+
+
+RecordFile::~RecordFile()
+{
+  close();
+}
+
+
+void RecordFile::create(const char* filename, const char* magic, bool append)
+{
+  close();
+  memcpy(this->magic, magic, 4);
+  writing = true;
+
+  if (append && (f = fopen(filename, "r+b")) != NULL)
+  {
+    // existing file: scan it and continue after its last complete record
+    open_existing(filename);
+    long end = records.empty() ? 8 : records.back().offset + (long) ((records.back().size + 7) & ~7ULL);
+    fseek(f, end, SEEK_SET);
+    return;
+  }
+
+  f = fopen(filename, "w+b");
+  if (f == NULL) error("Could not open %s for writing.", filename);
+  int ver = RECORD_FILE_VERSION;
+  hermes_fwrite(magic, 1, 4, f);
+  hermes_fwrite(&ver, sizeof(int), 1, f);
+}
+
+
+void RecordFile::open(const char* filename, const char* magic)
+{
+  close();
+  memcpy(this->magic, magic, 4);
+  writing = false;
+
+  f = fopen(filename, "rb");
+  if (f == NULL) error("Could not open %s.", filename);
+  open_existing(filename);
+}
+
+
+void RecordFile::open_existing(const char* filename)
+{
+  struct { char magic[4]; int ver; } hdr;
+  hermes_fread(&hdr, sizeof(hdr), 1, f);
+  if (memcmp(hdr.magic, magic, 4))
+    error("%s is not a %.4s file.", filename, magic);
+  if (hdr.ver > RECORD_FILE_VERSION)
+    error("Unsupported file version.");
+
+  fseek(f, 0, SEEK_END);
+  long length = ftell(f);
+  long pos = 8;
+
+  // only the record headers are read, the data are skipped
+  records.clear();
+  while (pos + 24 <= length)
+  {
+    fseek(f, pos, SEEK_SET);
+    Record r;
+    int reserved;
+    hermes_fread(r.tag, 1, 4, f);
+    hermes_fread(&r.step, sizeof(int), 1, f);
+    hermes_fread(&r.index, sizeof(int), 1, f);
+    hermes_fread(&reserved, sizeof(int), 1, f);
+    hermes_fread(&r.size, sizeof(r.size), 1, f);
+    r.offset = pos + 24;
+
+    // a record that was not finished (e.g. the program was killed while writing it)
+    if (r.size == RECORD_INCOMPLETE || r.offset + (long) r.size > length)
+    {
+      warn("Ignoring an incomplete record at the end of %s.", filename);
+      break;
+    }
+    records.push_back(r);
+    pos = r.offset + (long) ((r.size + 7) & ~7ULL);
+  }
+}
+
+
+void RecordFile::close()
+{
+  if (f == NULL) return;
+  if (rec_start >= 0) end_record();
+  fclose(f);
+  f = NULL;
+  records.clear();
+}
+
+
+FILE* RecordFile::begin_record(const char* tag, int step, int index)
+{
+  if (f == NULL || !writing) error("The file is not open for writing.");
+  if (rec_start >= 0) error("Previous record not finished.");
+
+  Record r;
+  memcpy(r.tag, tag, 4);
+  r.step = step;
+  r.index = index;
+  r.size = RECORD_INCOMPLETE;
+
+  int reserved = 0;
+  rec_start = ftell(f);
+  hermes_fwrite(r.tag, 1, 4, f);
+  hermes_fwrite(&r.step, sizeof(int), 1, f);
+  hermes_fwrite(&r.index, sizeof(int), 1, f);
+  hermes_fwrite(&reserved, sizeof(int), 1, f);
+  hermes_fwrite(&r.size, sizeof(r.size), 1, f);
+  r.offset = rec_start + 24;
+  records.push_back(r);
+  return f;
+}
+
+
+void RecordFile::end_record()
+{
+  if (rec_start < 0) error("No record started.");
+
+  // patch the size in the header and pad the data to a multiple of 8 bytes
+  long end = ftell(f);
+  Record& r = records.back();
+  r.size = end - r.offset;
+  fseek(f, rec_start + 16, SEEK_SET);
+  hermes_fwrite(&r.size, sizeof(r.size), 1, f);
+  fseek(f, end, SEEK_SET);
+
+  static const char zeros[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+  int pad = (int) ((8 - r.size % 8) % 8);
+  if (pad) hermes_fwrite(zeros, 1, pad, f);
+  fflush(f);
+  rec_start = -1;
+}
+
+
+void RecordFile::write_record(const char* tag, int step, int index, const void* data, size_t size)
+{
+  begin_record(tag, step, index);
+  if (size) hermes_fwrite(data, 1, size, f);
+  end_record();
+}
+
+
+int RecordFile::find_record(const char* tag, int step, int index, bool exact) const
+{
+  int best = -1;
+  for (int i = records.size() - 1; i >= 0; i--)
+  {
+    const Record& r = records[i];
+    if (memcmp(r.tag, tag, 4) || r.index != index) continue;
+    if (step < 0 || r.step == step) return i;
+    if (!exact && r.step < step && (best < 0 || r.step > records[best].step))
+      best = i;
+  }
+  return best;
+}
+
+
+int RecordFile::get_last_step() const
+{
+  int step = -1;
+  for (unsigned int i = 0; i < records.size(); i++)
+    step = std::max(step, records[i].step);
+  return step;
+}
+
+
+FILE* RecordFile::seek_record(int rec)
+{
+  if (f == NULL) error("The file is not open.");
+  if (rec < 0 || rec >= (int) records.size()) error("Invalid record number (%d).", rec);
+  fseek(f, records[rec].offset, SEEK_SET);
+  return f;
+}
+
+
+void RecordFile::read_record(int rec, void* data)
+{
+  seek_record(rec);
+  if (records[rec].size) hermes_fread(data, 1, (size_t) records[rec].size, f);
+}
@@ -0,0 +1,84 @@
+// Copyright (c) 2009 hp-FEM group at the University of Nevada, Reno (UNR).
+// Distributed under the terms of the BSD license (see the LICENSE
+// file for the exact terms).
+// Email: hermes1d@googlegroups.com, home page: http://hpfem.org/
+
+#ifndef __HERMES_COMMON_RECORD_FILE_H
+#define __HERMES_COMMON_RECORD_FILE_H
+
+#include "common.h"
+
+/// Binary container made of tagged records, used for checkpoints.
+///
+/// The file starts with an 8-byte header (a four-character magic and a version)
+/// followed by records. Each record has a 24-byte header holding a four-character
+/// tag, the time step and the index of the record (e.g. the component of a system)
+/// and the size of its data. The data of every record starts at an 8-byte aligned
+/// offset, so the file can also be memory-mapped and the arrays used in place
+/// (see get_record_offset()).
+///
+/// New records can be appended to an existing file at any time (one set per time
+/// step). When the file is opened for reading, only the record headers are scanned;
+/// the data are read on demand.
+///
+class HERMES_API RecordFile
+{
+public:
+  RecordFile();
+  ~RecordFile();
+
+  /// Creates a new file, or opens an existing one for appending ('append' = true).
+  void create(const char* filename, const char* magic, bool append = false);
+  /// Opens an existing file for reading and scans its records.
+  void open(const char* filename, const char* magic);
+  /// Closes the file.
+  void close();
+
+  /// Starts a new record; the data are then written to the returned stream.
+  FILE* begin_record(const char* tag, int step, int index = 0);
+  /// Finishes the record started by begin_record().
+  void end_record();
+  /// Writes a whole record at once.
+  void write_record(const char* tag, int step, int index, const void* data, size_t size);
+
+  /// Returns the number of records in the file.
+  int get_num_records() const { return records.size(); }
+  /// Returns the record with the given tag and index belonging to the time step 'step'
+  /// or, if 'step' is -1, the last one written. If 'exact' is false, the last record
+  /// written for a step not later than 'step' is returned. Returns -1 if there is no
+  /// such record.
+  int find_record(const char* tag, int step = -1, int index = 0, bool exact = true) const;
+  /// Returns the last time step stored in the file (-1 if the file is empty).
+  int get_last_step() const;
+
+  int get_record_step(int rec) const { return records[rec].step; }
+  int get_record_index(int rec) const { return records[rec].index; }
+  /// Returns the size of the data of the record in bytes.
+  size_t get_record_size(int rec) const { return (size_t) records[rec].size; }
+  /// Returns the offset of the data of the record in the file (8-byte aligned).
+  long get_record_offset(int rec) const { return records[rec].offset; }
+
+  /// Positions the stream at the beginning of the data of the record.
+  FILE* seek_record(int rec);
+  /// Reads the whole data of the record into 'data'.
+  void read_record(int rec, void* data);
+
+protected:
+  struct Record
+  {
+    char tag[4];
+    int step, index;
+    unsigned long long size;
+    long offset;
+  };
+
+  FILE* f;
+  char magic[4];
+  bool writing;
+  std::vector<Record> records;
+  long rec_start; ///< position of the header of the record being written
+
+  void open_existing(const char* filename);
+};
+
+#endif
@@ -0,0 +1,90 @@
+// Copyright (c) 2009 hp-FEM group at the University of Nevada, Reno (UNR).
+// Distributed under the terms of the BSD license (see the LICENSE
+// file for the exact terms).
+// Email: hermes1d@googlegroups.com, home page: http://hpfem.org/
+
+#include "scratch_arena.h"
+#include <algorithm>
+
+ScratchArena::ScratchArena(size_t chunk_size)
+{
+  this->chunk_size = chunk_size;
+  Chunk c = { new char[chunk_size], chunk_size };
+  chunks.push_back(c);
+  current = 0;
+  used = 0;
+}
+
+
+ScratchArena::~ScratchArena()
+{
+  for (unsigned int i = 0; i < chunks.size(); i++)
+    delete [] chunks[i].data;
+}
+
+
+void ScratchArena::next_chunk(size_t size)
+{
+  // the following blocks may be free after a rewind()
+  while (++current < (int) chunks.size())
+    if (chunks[current].size >= size) { used = 0; return; }
+
+  size_t n = std::max(size, chunk_size);
+  Chunk c = { new char[n], n };
+  chunks.push_back(c);
+  current = chunks.size() - 1;
+  used = 0;
+}
+
+
+void ScratchArena::reset()
+{
+  if (chunks.size() > 1)
+  {
+    size_t total = get_capacity();
+    for (unsigned int i = 0; i < chunks.size(); i++)
+      delete [] chunks[i].data;
+    chunks.clear();
+    Chunk c = { new char[total], total };
+    chunks.push_back(c);
+  }
+  current = 0;
+  used = 0;
+}
+
+
+size_t ScratchArena::get_capacity() const
+{
+  size_t total = 0;
+  for (unsigned int i = 0; i < chunks.size(); i++)
+    total += chunks[i].size;
+  return total;
+}
+
+
+//// thread arenas /////////////////////////////////////////////////////////////////////////////////
+
+static pthread_key_t arena_key;
+static pthread_once_t arena_key_once = PTHREAD_ONCE_INIT;
+
+static void free_thread_arena(void* arena)
+{
+  delete (ScratchArena*) arena;
+}
+
+static void create_arena_key()
+{
+  pthread_key_create(&arena_key, free_thread_arena);
+}
+
+ScratchArena* ScratchArena::get_thread_arena()
+{
+  pthread_once(&arena_key_once, create_arena_key);
+  ScratchArena* arena = (ScratchArena*) pthread_getspecific(arena_key);
+  if (arena == NULL)
+  {
+    arena = new ScratchArena;
+    pthread_setspecific(arena_key, arena);
+  }
+  return arena;
+}
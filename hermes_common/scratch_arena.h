@@ -0,0 +1,126 @@
+// Copyright (c) 2009 hp-FEM group at the University of Nevada, Reno (UNR).
+// Distributed under the terms of the BSD license (see the LICENSE
+// file for the exact terms).
+// Email: hermes1d@googlegroups.com, home page: http://hpfem.org/
+
+#ifndef __HERMES_COMMON_SCRATCH_ARENA_H
+#define __HERMES_COMMON_SCRATCH_ARENA_H
+
+#include "common.h"
+#include <new>
+#include <vector>
+
+/// Default size of one block of memory of a ScratchArena.
+#define HERMES_ARENA_CHUNK_SIZE (256 * 1024)
+
+/// Bump allocator for short-lived scratch data (values of functions in integration
+/// points, geometry, external data of the weak forms, ...).
+///
+/// Memory is taken from large blocks by advancing a pointer and is never freed
+/// individually. Instead, everything allocated after a mark is released at once by
+/// rewind() (see also ScratchScope) and everything by reset(). The blocks are kept, so
+/// after the first few elements the assembling does not call malloc() at all. No
+/// destructors are called, hence only objects whose destructors do not free
+/// anything may be placed into the arena.
+///
+/// The arena is not thread-safe, get_thread_arena() returns a separate arena for
+/// each thread.
+///
+class HERMES_API ScratchArena
+{
+public:
+  ScratchArena(size_t chunk_size = HERMES_ARENA_CHUNK_SIZE);
+  ~ScratchArena();
+
+  /// Returns 'size' bytes aligned to 16 bytes.
+  void* alloc(size_t size)
+  {
+    size = (size + 15) & ~((size_t) 15);
+    if (used + size > chunks[current].size) next_chunk(size);
+    void* ptr = chunks[current].data + used;
+    used += size;
+    return ptr;
+  }
+
+  /// Returns an uninitialized array of 'n' items.
+  template<typename T>
+  T* alloc_array(int n) { return (T*) alloc(n * sizeof(T)); }
+
+  /// Position in the arena, see rewind().
+  struct Mark
+  {
+    int chunk;
+    size_t used;
+  };
+  Mark get_mark() const { Mark m = { current, used }; return m; }
+
+  /// Releases everything allocated after the mark was obtained.
+  void rewind(const Mark& mark) { current = mark.chunk; used = mark.used; }
+  /// Releases everything. If more than one block was needed, the blocks are replaced
+  /// by one block large enough for all of them.
+  void reset();
+
+  /// Returns the size of all blocks.
+  size_t get_capacity() const;
+
+  /// Returns the arena of the calling thread (created on the first call, freed when
+  /// the thread exits).
+  static ScratchArena* get_thread_arena();
+
+protected:
+  struct Chunk
+  {
+    char* data;
+    size_t size;
+  };
+
+  std::vector<Chunk> chunks;
+  int current;        ///< Block from which is allocated.
+  size_t used;        ///< Bytes used in the current block.
+  size_t chunk_size;
+
+  void next_chunk(size_t size);
+
+private:
+  ScratchArena(const ScratchArena&);
+  ScratchArena& operator=(const ScratchArena&);
+};
+
+
+/// Releases everything allocated from the arena during the lifetime of the scope.
+///
+/// \code
+///   ScratchScope scratch(arena);
+///   double* tmp = arena->alloc_array<double>(np);
+///   ...
+/// \endcode
+///
+class HERMES_API ScratchScope
+{
+public:
+  ScratchScope(ScratchArena* arena) : arena(arena), mark(arena->get_mark()) { }
+  ~ScratchScope() { arena->rewind(mark); }
+
+protected:
+  ScratchArena* arena;
+  ScratchArena::Mark mark;
+};
+
+
+/// Allocates an object from the arena or, if 'arena' is NULL, from the heap, e.g.
+/// "new (arena) double[np]". Objects allocated from the heap are deleted as usual.
+inline void* operator new(size_t size, ScratchArena* arena)
+{
+  return (arena != NULL) ? arena->alloc(size) : ::operator new(size);
+}
+
+inline void* operator new[](size_t size, ScratchArena* arena)
+{
+  return (arena != NULL) ? arena->alloc(size) : ::operator new[](size);
+}
+
+// called only if a constructor throws
+inline void operator delete(void* ptr, ScratchArena* arena) { if (arena == NULL) ::operator delete(ptr); }
+inline void operator delete[](void* ptr, ScratchArena* arena) { if (arena == NULL) ::operator delete[](ptr); }
+
+#endif
@@ -0,0 +1,81 @@
+// Copyright (c) 2009 hp-FEM group at the University of Nevada, Reno (UNR).
+// Distributed under the terms of the BSD license (see the LICENSE
+// file for the exact terms).
+// Email: hermes1d@googlegroups.com, home page: http://hpfem.org/
+
+#ifndef __HERMES_COMMON_SFC_H
+#define __HERMES_COMMON_SFC_H
+
+/// Space-filling curves used to order mesh elements for better memory locality.
+enum SpaceFillingCurve
+{
+  HERMES_SFC_NONE,    ///< No curve, elements are visited by their id.
+  HERMES_SFC_MORTON,  ///< Morton (Z-order) curve.
+  HERMES_SFC_HILBERT  ///< Hilbert curve.
+};
+
+/// Number of bits per coordinate used for the curve indices (dim * bits must fit in 64 bits).
+const int HERMES_SFC_BITS = 16;
+
+/// Returns the index of the point X (integer coordinates in [0, 2^bits)) along
+/// the Morton curve in 'dim' dimensions.
+inline unsigned long long sfc_morton_index(const unsigned int* X, int dim, int bits = HERMES_SFC_BITS)
+{
+  unsigned long long h = 0;
+  for (int b = bits - 1; b >= 0; b--)
+    for (int i = dim - 1; i >= 0; i--)
+      h = (h << 1) | ((X[i] >> b) & 1);
+  return h;
+}
+
+/// Returns the index of the point X (integer coordinates in [0, 2^bits)) along
+/// the Hilbert curve in 'dim' dimensions. Uses the transposition algorithm of
+/// J. Skilling, Programming the Hilbert curve, AIP Conf. Proc. 707 (2004).
+inline unsigned long long sfc_hilbert_index(const unsigned int* X, int dim, int bits = HERMES_SFC_BITS)
+{
+  unsigned int x[3], M = 1u << (bits - 1), P, Q, t;
+  for (int i = 0; i < dim; i++) x[i] = X[i];
+
+  // inverse undo excess work
+  for (Q = M; Q > 1; Q >>= 1)
+  {
+    P = Q - 1;
+    for (int i = 0; i < dim; i++)
+      if (x[i] & Q) x[0] ^= P;
+      else { t = (x[0] ^ x[i]) & P; x[0] ^= t; x[i] ^= t; }
+  }
+
+  // Gray encode
+  for (int i = 1; i < dim; i++) x[i] ^= x[i-1];
+  t = 0;
+  for (Q = M; Q > 1; Q >>= 1)
+    if (x[dim-1] & Q) t ^= Q - 1;
+  for (int i = 0; i < dim; i++) x[i] ^= t;
+
+  // interleave the transposed index
+  unsigned long long h = 0;
+  for (int b = bits - 1; b >= 0; b--)
+    for (int i = 0; i < dim; i++)
+      h = (h << 1) | ((x[i] >> b) & 1);
+  return h;
+}
+
+/// Returns the curve index of a point with real coordinates 'pt', lying in the
+/// bounding box [lo, hi].
+inline unsigned long long sfc_index(SpaceFillingCurve curve, const double* pt, const double* lo, const double* hi, int dim)
+{
+  unsigned int X[3];
+  const double max = (double) ((1u << HERMES_SFC_BITS) - 1);
+  for (int i = 0; i < dim; i++)
+  {
+    double len = hi[i] - lo[i];
+    double s = (len > 0) ? (pt[i] - lo[i]) / len : 0.0;
+    if (s < 0.0) s = 0.0;
+    if (s > 1.0) s = 1.0;
+    X[i] = (unsigned int) (s * max + 0.5);
+  }
+  if (curve == HERMES_SFC_HILBERT) return sfc_hilbert_index(X, dim);
+  return sfc_morton_index(X, dim);
+}
+
+#endif
@@ -19,6 +19,7 @@
 
 #include "amesos.h"
 #include "../callstack.h"
+#include "../perf_counters.h"
 
 #ifdef HAVE_AMESOS
   #include <Amesos_ConfigDefs.h>
@@ -85,6 +86,7 @@ bool AmesosSolver::use_transpose()
 bool AmesosSolver::solve()
 {
   _F_
+  HERMES_PERF_SCOPE("solve");
 #ifdef HAVE_AMESOS
   assert(m != NULL);
   assert(rhs != NULL);
@@ -137,6 +139,7 @@ bool AmesosSolver::solve()
 bool AmesosSolver::setup_factorization()
 {
   _F_
+  HERMES_PERF_SCOPE("factorize");
 #ifdef HAVE_AMESOS
   // Perform both factorization phases for the first time.
   int eff_fact_scheme;
@@ -19,6 +19,7 @@
 
 #include "aztecoo.h"
 #include "../callstack.h"
+#include "../perf_counters.h"
 #ifdef HAVE_KOMPLEX
   #include <Komplex_LinearProblem.h>
 #endif
@@ -99,6 +100,7 @@ void AztecOOSolver::set_param(int param, double value)
 bool AztecOOSolver::solve()
 {
   _F_
+  HERMES_PERF_SCOPE("solve");
 #ifdef HAVE_AZTECOO
   assert(m != NULL);
   assert(rhs != NULL);
@@ -0,0 +1,384 @@
+// This file is part of Hermes
+//
+// Copyright (c) 2009 hp-FEM group at the University of Nevada, Reno (UNR).
+// Email: hpfem-group@unr.edu, home page: http://hpfem.org/.
+//
+// Hermes is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published
+// by the Free Software Foundation; either version 2 of the License,
+// or (at your option) any later version.
+//
+// Hermes is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Hermes; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+
+#include "band.h"
+
+#include <climits>
+
+#include "../trace.h"
+#include "../error.h"
+#include "../utils.h"
+#include "../callstack.h"
+#include "../perf_counters.h"
+
+BandMatrix::BandMatrix() {
+  _F_
+  size = 0;
+  kl = ku = 0;
+  width = 0;
+  Ab = NULL;
+}
+
+BandMatrix::~BandMatrix() {
+  _F_
+  free();
+}
+
+void BandMatrix::alloc() {
+  _F_
+  assert(pages != NULL);
+  assert(size > 0);
+
+  // find the bandwidths, deleting the pages along the way
+  kl = ku = 0;
+  for (int j = 0; j < size; j++) {
+    Page *page = pages[j];
+    while (page != NULL) {
+      for (int k = 0; k < page->count; k++) {
+        int i = page->idx[k];
+        if (i > j) kl = std::max(kl, i - j);
+        else ku = std::max(ku, j - i);
+      }
+      Page *tmp = page;
+      page = page->next;
+      delete tmp;
+    }
+  }
+  delete [] pages;
+  pages = NULL;
+
+  width = 2 * kl + ku + 1;
+  // the band is indexed with ints
+  if ((double) size * width > INT_MAX)
+    error("The band of the matrix (%d rows, width %d) is too large for the band solver, "
+          "use a sparse direct solver or a DOF ordering with a smaller bandwidth.", size, width);
+  Ab = new scalar [size * width];
+  MEM_CHECK(Ab);
+  memset(Ab, 0, sizeof(scalar) * size * width);
+}
+
+void BandMatrix::free() {
+  _F_
+  delete [] Ab; Ab = NULL;
+  kl = ku = 0;
+  width = 0;
+}
+
+scalar BandMatrix::get(int m, int n) {
+  _F_
+  if (n < m - kl || n > m + ku) return 0.0;
+  return entry(m, n);
+}
+
+void BandMatrix::zero() {
+  _F_
+  memset(Ab, 0, sizeof(scalar) * size * width);
+}
+
+void BandMatrix::add(int m, int n, scalar v) {
+  _F_
+  if (v != 0.0 && m >= 0 && n >= 0)   // ignore dirichlet DOFs
+  {
+    if (n < m - kl || n > m + ku)
+      error("Band matrix entry (%d, %d) is outside of the band.", m, n);
+    entry(m, n) += v;
+  }
+}
+
+void BandMatrix::add(int m, int n, scalar **mat, int *rows, int *cols) {
+  _F_
+  HERMES_PERF_SCOPE("matrix_insert");
+  for (int i = 0; i < m; i++)       // rows
+    for (int j = 0; j < n; j++)     // cols
+      add(rows[i], cols[j], mat[i][j]);
+}
+
+bool BandMatrix::dump(FILE *file, const char *var_name, EMatrixDumpFormat fmt) {
+  _F_
+  switch (fmt)
+  {
+    case DF_MATLAB_SPARSE:
+    {
+      int nnz = 0;
+      for (int i = 0; i < size; i++)
+        for (int j = std::max(0, i - kl); j <= std::min(size - 1, i + ku); j++)
+          if (entry(i, j) != 0.0) nnz++;
+
+      fprintf(file, "%% Size: %dx%d\n%% Nonzeros: %d\ntemp = zeros(%d, 3);\ntemp = [\n", size, size, nnz, nnz);
+      for (int i = 0; i < size; i++)
+        for (int j = std::max(0, i - kl); j <= std::min(size - 1, i + ku); j++)
+          if (entry(i, j) != 0.0)
+            fprintf(file, "%d %d " SCALAR_FMT "\n", i + 1, j + 1, SCALAR(entry(i, j)));
+      fprintf(file, "];\n%s = spconvert(temp);\n", var_name);
+
+      return true;
+    }
+
+    default:
+      return false;
+  }
+}
+
+int BandMatrix::get_matrix_size() const {
+  _F_
+  return sizeof(scalar) * size * width + 3 * sizeof(int);
+}
+
+double BandMatrix::get_fill_in() const {
+  _F_
+  return (kl + ku + 1) / (double) size;
+}
+
+
+// BandVector ///////
+
+BandVector::BandVector() {
+  _F_
+  v = NULL;
+  size = 0;
+}
+
+BandVector::~BandVector() {
+  _F_
+  free();
+}
+
+void BandVector::alloc(int n) {
+  _F_
+  free();
+  this->size = n;
+  v = new scalar [n];
+  MEM_CHECK(v);
+  this->zero();
+}
+
+void BandVector::zero() {
+  _F_
+  memset(v, 0, size * sizeof(scalar));
+}
+
+void BandVector::free() {
+  _F_
+  delete [] v;
+  v = NULL;
+  size = 0;
+}
+
+void BandVector::set(int idx, scalar y) {
+  _F_
+  if (idx >= 0) v[idx] = y;
+}
+
+void BandVector::add(int idx, scalar y) {
+  _F_
+  if (idx >= 0) v[idx] += y;
+}
+
+void BandVector::add(int n, int *idx, scalar *y) {
+  _F_
+  for (int i = 0; i < n; i++)
+    if (idx[i] >= 0) v[idx[i]] += y[i];
+}
+
+bool BandVector::dump(FILE *file, const char *var_name, EMatrixDumpFormat fmt) {
+  _F_
+  switch (fmt)
+  {
+    case DF_MATLAB_SPARSE:
+      fprintf(file, "%% Size: %dx1\n%s = [\n", size, var_name);
+      for (int i = 0; i < size; i++)
+        fprintf(file, SCALAR_FMT "\n", SCALAR(v[i]));
+      fprintf(file, " ];\n");
+      return true;
+
+    default:
+      return false;
+  }
+}
+
+// Band solver //////
+
+BandLinearSolver::BandLinearSolver(BandMatrix *m, BandVector *rhs)
+  : LinearSolver(HERMES_FACTORIZE_FROM_SCRATCH), m(m), rhs(rhs), size(0), lu(NULL), l(NULL), piv(NULL)
+{
+  _F_
+}
+
+BandLinearSolver::~BandLinearSolver() {
+  _F_
+  free_factorization_data();
+}
+
+bool BandLinearSolver::solve() {
+  _F_
+  HERMES_PERF_SCOPE("solve");
+  assert(m != NULL);
+  assert(rhs != NULL);
+
+  assert(m->size == rhs->size);
+
+  TimePeriod tmr;
+
+  if ( !setup_factorization() )
+  {
+    warning("LU factorization could not be completed.");
+    return false;
+  }
+
+  if(sln)
+    delete [] sln;
+  sln = new scalar[size];
+  MEM_CHECK(sln);
+  memcpy(sln, rhs->v, size * sizeof(scalar));
+
+  int kl = m->kl, ku = m->ku, width = m->width;
+
+  // forward substitution, the row interchanges are applied in the order of the factorization
+  for (int k = 0; k < size; k++) {
+    if (piv[k] != k) std::swap(sln[k], sln[piv[k]]);
+    int last = std::min(size - 1, k + kl);
+    for (int i = k + 1; i <= last; i++)
+      sln[i] -= l[k * kl + i - k - 1] * sln[k];
+  }
+
+  // back substitution
+  for (int k = size - 1; k >= 0; k--) {
+    scalar *row = lu + k * width - k + kl;
+    int last = std::min(size - 1, k + kl + ku);
+    scalar s = sln[k];
+    for (int j = k + 1; j <= last; j++)
+      s -= row[j] * sln[j];
+    sln[k] = s / row[k];
+  }
+
+  tmr.tick();
+  time = tmr.accumulated();
+
+  return true;
+}
+
+bool BandLinearSolver::solve_transposed(Vector* b) {
+  _F_
+  HERMES_PERF_SCOPE("solve");
+  assert(m != NULL);
+  assert(m->size == b->length());
+
+  TimePeriod tmr;
+
+  // PA = LU is not computed again, A^T = U^T L^T P is used instead
+  if (lu == NULL && !setup_factorization())
+  {
+    warning("LU factorization could not be completed.");
+    return false;
+  }
+
+  if(sln)
+    delete [] sln;
+  sln = new scalar[size];
+  MEM_CHECK(sln);
+  for (int i = 0; i < size; i++)
+    sln[i] = b->get(i);
+
+  int kl = m->kl, ku = m->ku, width = m->width;
+  // forward substitution with U^T
+  for (int k = 0; k < size; k++) {
+    scalar s = sln[k];
+    for (int j = std::max(0, k - kl - ku); j < k; j++)
+      s -= lu[j * width + k - j + kl] * sln[j];
+    sln[k] = s / lu[k * width + kl];
+  }
+  // back substitution with L^T, the row interchanges are undone in the reverse order
+  for (int k = size - 1; k >= 0; k--) {
+    int last = std::min(size - 1, k + kl);
+    for (int i = k + 1; i <= last; i++)
+      sln[k] -= l[k * kl + i - k - 1] * sln[i];
+    if (piv[k] != k) std::swap(sln[k], sln[piv[k]]);
+  }
+
+  tmr.tick();
+  time = tmr.accumulated();
+  return true;
+}
+
+bool BandLinearSolver::setup_factorization()
+{
+  _F_
+  HERMES_PERF_SCOPE("factorize");
+  if (factorization_scheme == HERMES_REUSE_FACTORIZATION_COMPLETELY && lu != NULL && size == m->size)
+    return true;
+
+  int kl = m->kl, ku = m->ku, width = m->width;
+  if (lu == NULL || size != m->size) {
+    free_factorization_data();
+    size = m->size;
+    lu = new scalar[size * width];
+    l = new scalar[std::max(1, size * kl)];
+    piv = new int[size];
+    MEM_CHECK(lu);
+    MEM_CHECK(l);
+    MEM_CHECK(piv);
+  }
+  memcpy(lu, m->Ab, size * width * sizeof(scalar));
+
+  for (int k = 0; k < size; k++) {
+    int last_row = std::min(size - 1, k + kl);
+    int last_col = std::min(size - 1, k + kl + ku);
+
+    // partial pivoting within the band
+    int p = k;
+    double max = std::abs(lu[k * width + kl]);
+    for (int i = k + 1; i <= last_row; i++) {
+      double a = std::abs(lu[i * width + k - i + kl]);
+      if (a > max) { max = a; p = i; }
+    }
+    if (max == 0.0) {
+      warning("Band solver: the matrix is singular (column %d).", k);
+      free_factorization_data();
+      return false;
+    }
+    piv[k] = p;
+    if (p != k)
+      for (int j = k; j <= last_col; j++)
+        std::swap(lu[k * width + j - k + kl], lu[p * width + j - p + kl]);
+
+    // elimination
+    scalar *pivot_row = lu + k * width - k + kl;
+    for (int i = k + 1; i <= last_row; i++) {
+      scalar *row = lu + i * width - i + kl;
+      scalar mult = row[k] / pivot_row[k];
+      l[k * kl + i - k - 1] = mult;
+      row[k] = 0.0;
+      if (mult != 0.0)
+        for (int j = k + 1; j <= last_col; j++)
+          row[j] -= mult * pivot_row[j];
+    }
+  }
+
+  return true;
+}
+
+void BandLinearSolver::free_factorization_data()
+{
+  _F_
+  delete [] lu; lu = NULL;
+  delete [] l; l = NULL;
+  delete [] piv; piv = NULL;
+  size = 0;
+}
@@ -0,0 +1,116 @@
+// This file is part of Hermes
+//
+// Copyright (c) 2009 hp-FEM group at the University of Nevada, Reno (UNR).
+// Email: hpfem-group@unr.edu, home page: http://hpfem.org/.
+//
+// Hermes is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published
+// by the Free Software Foundation; either version 2 of the License,
+// or (at your option) any later version.
+//
+// Hermes is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Hermes; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+#ifndef _BAND_SOLVER_H_
+#define _BAND_SOLVER_H_
+
+#include "solver.h"
+#include "../matrix.h"
+
+/// Band matrix.
+///
+/// The lower and upper bandwidths are determined from the sparsity pattern given by
+/// pre_add_ij(). Each row stores the entries from the lower to the upper bandwidth
+/// plus the space for the fill-in caused by pivoting during the LU factorization.
+/// Suitable for problems with a small bandwidth, e.g. in 1D where the unknowns
+/// are numbered element by element.
+///
+class HERMES_API BandMatrix : public SparseMatrix {
+public:
+  BandMatrix();
+  virtual ~BandMatrix();
+
+  virtual void alloc();
+  virtual void free();
+  virtual scalar get(int m, int n);
+  virtual void zero();
+  virtual void add(int m, int n, scalar v);
+  virtual void add(int m, int n, scalar **mat, int *rows, int *cols);
+  virtual bool dump(FILE *file, const char *var_name, EMatrixDumpFormat fmt = DF_MATLAB_SPARSE);
+  virtual int get_matrix_size() const;
+  virtual double get_fill_in() const;
+
+  /// Returns the number of subdiagonals.
+  int get_lower_bandwidth() const { return kl; }
+  /// Returns the number of superdiagonals.
+  int get_upper_bandwidth() const { return ku; }
+
+protected:
+  int kl, ku;   // Lower and upper bandwidth.
+  int width;    // Length of a stored row (2 * kl + ku + 1).
+  scalar *Ab;   // Row i stores the columns i - kl ... i + kl + ku.
+
+  scalar& entry(int i, int j) { return Ab[i * width + j - i + kl]; }
+
+  friend class BandLinearSolver;
+};
+
+class HERMES_API BandVector : public Vector {
+public:
+  BandVector();
+  virtual ~BandVector();
+
+  virtual void alloc(int ndofs);
+  virtual void free();
+  virtual scalar get(int idx) { return v[idx]; }
+  virtual void extract(scalar *v) const { memcpy(v, this->v, size * sizeof(scalar)); }
+  virtual void zero();
+  virtual void set(int idx, scalar y);
+  virtual void add(int idx, scalar y);
+  virtual void add(int n, int *idx, scalar *y);
+  virtual bool dump(FILE *file, const char *var_name, EMatrixDumpFormat fmt = DF_MATLAB_SPARSE);
+
+protected:
+  scalar *v;
+
+  friend class BandLinearSolver;
+};
+
+
+/// Direct solver for band matrices (LU factorization with partial pivoting).
+///
+/// The cost of the factorization is O(n * kl * (kl + ku)), the memory O(n * (2 * kl + ku)).
+/// The factors are kept, so with HERMES_REUSE_FACTORIZATION_COMPLETELY only the
+/// triangular solves are performed. solve_transposed() uses the factors of the last
+/// solve().
+///
+/// @ingroup solvers
+class HERMES_API BandLinearSolver : public LinearSolver {
+public:
+  BandLinearSolver(BandMatrix *m, BandVector *rhs);
+  virtual ~BandLinearSolver();
+
+  virtual bool solve();
+  virtual bool solve_transposed(Vector* b);
+
+protected:
+  BandMatrix *m;
+  BandVector *rhs;
+
+  // LU factorization of the matrix 'm'.
+  int size;
+  scalar *lu;   // U, stored in the same way as the matrix.
+  scalar *l;    // Multipliers, kl for each column.
+  int *piv;     // Row interchanged with the k-th row in the k-th step.
+
+  bool setup_factorization();
+  void free_factorization_data();
+};
+
+#endif
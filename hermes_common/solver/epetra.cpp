@@ -20,6 +20,7 @@
 #include "epetra.h"
 #include "../error.h"
 #include "../callstack.h"
+#include "../perf_counters.h"
 
 // EpetraMatrix ////////////////////////////////////////////////////////////////////////////////////
 
@@ -191,6 +192,7 @@ void EpetraMatrix::add(int m, int n, scalar v)
 void EpetraMatrix::add(int m, int n, scalar **mat, int *rows, int *cols)
 {
   _F_
+  HERMES_PERF_SCOPE("matrix_insert");
 #ifdef HAVE_EPETRA
   for (int i = 0; i < m; i++)				// rows
     for (int j = 0; j < n; j++)			// cols
@@ -22,6 +22,7 @@
 #include "../error.h"
 #include "../utils.h"
 #include "../callstack.h"
+#include "../perf_counters.h"
 
 #if !defined(H2D_COMPLEX) && !defined(H3D_COMPLEX)
   #define MUMPS         dmumps_c
@@ -185,6 +186,7 @@ void MumpsMatrix::add(int m, int n, scalar v)
 void MumpsMatrix::add(int m, int n, scalar **mat, int *rows, int *cols)
 {
   _F_
+  HERMES_PERF_SCOPE("matrix_insert");
   for (int i = 0; i < m; i++)       // rows
     for (int j = 0; j < n; j++)     // cols
       add(rows[i], cols[j], mat[i][j]);
@@ -470,6 +472,7 @@ MumpsSolver::~MumpsSolver()
 bool MumpsSolver::solve()
 {
   _F_
+  HERMES_PERF_SCOPE("solve");
 #ifdef WITH_MUMPS
   bool ret = false;
   assert(m != NULL);
@@ -523,6 +526,7 @@ bool MumpsSolver::solve()
 bool MumpsSolver::setup_factorization()
 {
   _F_
+  HERMES_PERF_SCOPE("factorize");
 #ifdef WITH_MUMPS
   // When called for the first time, all three phases (analysis, factorization,
   // solution) must be performed. 
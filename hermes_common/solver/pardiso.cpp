@@ -23,6 +23,7 @@
 #include "../error.h"
 #include "../utils.h"
 #include "../callstack.h"
+#include "../perf_counters.h"
 
 #ifdef WITH_PARDISO
   #ifdef __cplusplus
@@ -165,6 +166,7 @@ void PardisoMatrix::add(int m, int n, scalar v) {
 void PardisoMatrix::add(int m, int n, scalar **mat, int *rows, int *cols) 
 {
   _F_
+  HERMES_PERF_SCOPE("matrix_insert");
   for (int i = 0; i < m; i++)       // rows
     for (int j = 0; j < n; j++)     // cols
       add(rows[i], cols[j], mat[i][j]);
@@ -437,6 +439,7 @@ PardisoLinearSolver::~PardisoLinearSolver()
 bool PardisoLinearSolver::solve() 
 {
   _F_
+  HERMES_PERF_SCOPE("solve");
 #ifdef WITH_PARDISO
   assert(m != NULL);
   assert(rhs != NULL);
@@ -487,6 +490,7 @@ bool PardisoLinearSolver::solve()
 bool PardisoLinearSolver::setup_factorization()
 {
   _F_
+  HERMES_PERF_SCOPE("factorize");
 #ifdef WITH_PARDISO
   // When called for the first time, all three phases (analysis, factorization,
   // solution) must be performed. 
@@ -21,6 +21,7 @@
 #include "../trace.h"
 #include "../error.h"
 #include "../callstack.h"
+#include "../perf_counters.h"
 
 // TODO: Check #ifdef WITH_MPI and use the parallel methods from PETSc accordingly.
 
@@ -116,6 +117,7 @@ void PetscMatrix::add(int m, int n, scalar v) {
 
 void PetscMatrix::add(int m, int n, scalar **mat, int *rows, int *cols) {
   _F_
+  HERMES_PERF_SCOPE("matrix_insert");
 #ifdef WITH_PETSC
   // TODO: pass in just the block of the matrix without HERMES_DIRICHLET_DOFs (so that can use MatSetValues directly without checking
   // row and cols for -1)
@@ -262,6 +264,7 @@ PetscLinearSolver::~PetscLinearSolver() {
 
 bool PetscLinearSolver::solve() {
   _F_
+  HERMES_PERF_SCOPE("solve");
 #ifdef WITH_PETSC
   assert(m != NULL);
   assert(rhs != NULL);
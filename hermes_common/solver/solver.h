@@ -98,6 +98,12 @@ public:
   virtual bool solve() = 0;
   scalar *get_solution() { return sln; }
 
+  /// Solves the system with the transposed matrix, A^T x = b, e.g. the dual problem of
+  /// goal-oriented adaptivity. Solvers that keep the factorization of A from solve()
+  /// reuse it. The solution replaces the one of solve().
+  /// \return False if the solver cannot solve transposed systems.
+  virtual bool solve_transposed(Vector* b) { return false; }
+
   int get_error() { return error; }
   double get_time() { return time; }
   
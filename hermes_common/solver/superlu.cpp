@@ -22,6 +22,7 @@
 #include "../error.h"
 #include "../utils.h"
 #include "../callstack.h"
+#include "../perf_counters.h"
 
 // Binary search for the location of a particular CSC/CSR matrix entry.
 //
@@ -151,6 +152,7 @@ void SuperLUMatrix::add(int m, int n, scalar v)
 void SuperLUMatrix::add(int m, int n, scalar **mat, int *rows, int *cols)
 {
   _F_
+  HERMES_PERF_SCOPE("matrix_insert");
   for (int i = 0; i < m; i++)       // rows
     for (int j = 0; j < n; j++)     // cols
       add(rows[i], cols[j], mat[i][j]);
@@ -432,6 +434,7 @@ SuperLUSolver::~SuperLUSolver()
 bool SuperLUSolver::solve()
 {
   _F_
+  HERMES_PERF_SCOPE("solve");
 #ifdef WITH_SUPERLU
   assert(m != NULL);
   assert(rhs != NULL);
@@ -611,6 +614,7 @@ bool SuperLUSolver::solve()
 bool SuperLUSolver::setup_factorization()
 {
   _F_
+  HERMES_PERF_SCOPE("factorize");
 #ifdef WITH_SUPERLU
   if (has_A && factorization_scheme != HERMES_FACTORIZE_FROM_SCRATCH && A.nrow != m->size)
   {
@@ -30,6 +30,7 @@
 #include "../error.h"
 #include "../utils.h"
 #include "../callstack.h"
+#include "../perf_counters.h"
 
 static int find_position(int *Ai, int Alen, int idx) {
   _F_
@@ -146,6 +147,7 @@ void UMFPackMatrix::add(int m, int n, scalar v) {
 
 void UMFPackMatrix::add(int m, int n, scalar **mat, int *rows, int *cols) {
   _F_
+  HERMES_PERF_SCOPE("matrix_insert");
   for (int i = 0; i < m; i++)       // rows
     for (int j = 0; j < n; j++)     // cols
       add(rows[i], cols[j], mat[i][j]);
@@ -200,6 +202,23 @@ double UMFPackMatrix::get_fill_in() const {
   return nnz / (double) (size * size);
 }
 
+void UMFPackMatrix::multiply_with_vector(scalar* vector_in, scalar* vector_out) {
+  _F_
+  for (int i = 0; i < size; i++) vector_out[i] = 0;
+  for (int j = 0; j < size; j++)
+    for (int i = Ap[j]; i < Ap[j + 1]; i++)
+      vector_out[Ai[i]] += Ax[i] * vector_in[j];
+}
+
+int UMFPackMatrix::get_bandwidth() const {
+  _F_
+  int bw = 0;
+  for (int j = 0; j < size; j++)
+    for (int i = Ap[j]; i < Ap[j + 1]; i++)
+      bw = std::max(bw, std::abs(Ai[i] - j));
+  return bw;
+}
+
 
 // UMFPackVector ///////
 
@@ -348,6 +367,7 @@ static void check_status(const char *fn_name, int status) {
 
 bool UMFPackLinearSolver::solve() {
   _F_
+  HERMES_PERF_SCOPE("solve");
 #ifdef WITH_UMFPACK
   assert(m != NULL);
   assert(rhs != NULL);
@@ -385,9 +405,52 @@ bool UMFPackLinearSolver::solve() {
 #endif
 }
 
+bool UMFPackLinearSolver::solve_transposed(Vector* b) {
+  _F_
+  HERMES_PERF_SCOPE("solve");
+#ifdef WITH_UMFPACK
+  assert(m != NULL);
+  assert(m->size == b->length());
+
+  TimePeriod tmr;
+
+  // The factorization of the last solve() is used, the transposition is done by UMFPACK.
+  if (numeric == NULL && !setup_factorization())
+  {
+    warning("LU factorization could not be completed.");
+    return false;
+  }
+
+  scalar* bv = new scalar[m->size];
+  for (int i = 0; i < m->size; i++)
+    bv[i] = b->get(i);
+
+  if(sln)
+    delete [] sln;
+  sln = new scalar[m->size];
+  MEM_CHECK(sln);
+  memset(sln, 0, m->size * sizeof(scalar));
+
+  int status = umfpack_solve(UMFPACK_Aat, m->Ap, m->Ai, m->Ax, sln, bv, numeric, NULL, NULL);
+  delete [] bv;
+  if (status != UMFPACK_OK) {
+    check_status("umfpack_di_solve", status);
+    return false;
+  }
+
+  tmr.tick();
+  time = tmr.accumulated();
+
+  return true;
+#else
+  return false;
+#endif
+}
+
 bool UMFPackLinearSolver::setup_factorization()
 {
   _F_
+  HERMES_PERF_SCOPE("factorize");
 #ifdef WITH_UMFPACK
   // Perform both factorization phases for the first time.
   int eff_fact_scheme;
@@ -38,6 +38,11 @@ public:
   virtual bool dump(FILE *file, const char *var_name, EMatrixDumpFormat fmt = DF_MATLAB_SPARSE);
   virtual int get_matrix_size() const;
   virtual double get_fill_in() const;
+
+  /// Sparse matrix-vector product, vector_out = A * vector_in.
+  void multiply_with_vector(scalar* vector_in, scalar* vector_out);
+  /// Returns the bandwidth max |i - j| over the nonzero entries a_ij.
+  int get_bandwidth() const;
   
 protected:
   // UMFPack specific data structures for storing the system matrix (CSC format).
@@ -82,6 +87,7 @@ public:
   virtual ~UMFPackLinearSolver();
 
   virtual bool solve();
+  virtual bool solve_transposed(Vector* b);
     
 protected:
   UMFPackMatrix *m;